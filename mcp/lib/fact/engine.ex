@@ -22,7 +22,19 @@ defmodule Fact.EngineMetric do
     :convert_us,
     :report_us
   ]
-  @metric_fields [:convert_us, :discover_us, :report_us, :switch_cmd_us]
+  @metric_fields [
+    :convert_us,
+    :convert_p99_us,
+    :discover_us,
+    :discover_p99_us,
+    :discover_max_hold_us,
+    :first_reading_us,
+    :report_us,
+    :report_p99_us,
+    :restored_devs,
+    :switch_cmd_us,
+    :switch_cmd_p99_us
+  ]
 
   series do
     database(Application.get_env(:mcp, Fact.Influx) |> Keyword.get(:database))
@@ -37,9 +49,16 @@ defmodule Fact.EngineMetric do
     tag(:engine)
 
     field(:convert_us)
+    field(:convert_p99_us)
     field(:discover_us)
+    field(:discover_p99_us)
+    field(:discover_max_hold_us)
+    field(:first_reading_us)
     field(:report_us)
+    field(:report_p99_us)
+    field(:restored_devs)
     field(:switch_cmd_us)
+    field(:switch_cmd_p99_us)
   end
 
   def make_point(%{type: @metric_type, metric: _, engine: _} = r) do
@@ -57,9 +76,16 @@ defmodule Fact.EngineMetric do
     pt = set_tag(pt, tags, :engine)
 
     pt = set_field(pt, fields, :convert_us)
+    pt = set_field(pt, fields, :convert_p99_us)
     pt = set_field(pt, fields, :discover_us)
+    pt = set_field(pt, fields, :discover_p99_us)
+    pt = set_field(pt, fields, :discover_max_hold_us)
+    pt = set_field(pt, fields, :first_reading_us)
     pt = set_field(pt, fields, :report_us)
+    pt = set_field(pt, fields, :report_p99_us)
+    pt = set_field(pt, fields, :restored_devs)
     pt = set_field(pt, fields, :switch_cmd_us)
+    pt = set_field(pt, fields, :switch_cmd_p99_us)
 
     %{pt | timestamp: Map.get(r, :mtime, TimeSupport.unix_now(:second))}
   end
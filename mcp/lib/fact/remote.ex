@@ -38,7 +38,10 @@ defmodule Fact.Remote do
         :heap_min,
         :batt_mv,
         :reset_reason,
-        :ap_rssi
+        :ap_rssi,
+        :tasks,
+        :stack_free,
+        :executor
       ])
 
     tags = Map.take(r, [:name, :host]) |> Map.put(:env, @env)
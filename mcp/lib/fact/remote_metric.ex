@@ -0,0 +1,91 @@
+defmodule Fact.RemoteMetric do
+  @moduledoc false
+
+  require Logger
+
+  use Instream.Series
+  import(Fact.Influx, only: [write: 2])
+  alias Fact.RemoteMetric
+
+  alias Janice.TimeSupport
+
+  @metric_type "mcr_stat"
+  @metric_name "metrics"
+
+  series do
+    database(Application.get_env(:mcp, Fact.Influx) |> Keyword.get(:database))
+    # 'type' maps to the measurement
+    measurement(@metric_type)
+
+    tag(:application, default: "janice")
+    tag(:env, default: Application.get_env(:mcp, :build_env, "dev"))
+    tag(:host)
+    tag(:name)
+    tag(:metric, default: @metric_name)
+    tag(:key)
+    tag(:kind)
+
+    # counters (the change since the previous export) and gauges
+    field(:val)
+
+    # histograms (of microseconds)
+    field(:count)
+    field(:min_us)
+    field(:max_us)
+  end
+
+  # the remote exports only the metrics that changed since the previous
+  # export, a point is made for each metric:
+  #  counters:    %{"mqtt.msgs_in": 12}
+  #  gauges:      %{"heap.free": 123_456}
+  #  histograms:  %{"mcrDS.convert": %{count: 4, min_us: 10, max_us: 900}}
+  def make_points(%{type: @metric_type, metric: @metric_name} = r) do
+    mtime = Map.get(r, :mtime, TimeSupport.unix_now(:second))
+
+    counters =
+      for {key, val} <- Map.get(r, :counters, %{}),
+          do: make_point(r, mtime, key, "counter", %{val: val})
+
+    gauges =
+      for {key, val} <- Map.get(r, :gauges, %{}),
+          do: make_point(r, mtime, key, "gauge", %{val: val})
+
+    histograms =
+      for {key, hist} <- Map.get(r, :histograms, %{}) do
+        fields = Map.take(hist, [:count, :min_us, :max_us])
+
+        make_point(r, mtime, key, "histogram", fields)
+      end
+
+    counters ++ gauges ++ histograms
+  end
+
+  # trap when the input map doesn't match
+  def make_points(%{} = r) do
+    Logger.warn(["no match for ", inspect(r, pretty: true)])
+    []
+  end
+
+  def record(%{record: true} = r) do
+    db = Application.get_env(:mcp, Fact.Influx) |> Keyword.get(:database)
+
+    make_points(r) |> write(database: db, async: true, precision: :second)
+  end
+
+  def record(%{}), do: {:not_recorded}
+
+  def valid?(%{} = r) do
+    type = Map.get(r, :type, nil)
+    metric = Map.get(r, :metric, nil)
+
+    type === @metric_type and metric === @metric_name
+  end
+
+  defp make_point(r, mtime, key, kind, fields) do
+    pt = %RemoteMetric{}
+
+    tags = %{pt.tags | host: r.host, name: r.name, key: to_string(key), kind: kind}
+
+    %{pt | tags: tags, fields: Map.merge(pt.fields, fields), timestamp: mtime}
+  end
+end
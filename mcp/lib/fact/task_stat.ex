@@ -0,0 +1,69 @@
+defmodule Fact.TaskStat do
+  @moduledoc false
+
+  require Logger
+
+  use Instream.Series
+  import(Fact.Influx, only: [write: 2])
+  alias Fact.TaskStat
+
+  alias Janice.TimeSupport
+
+  @metric_type "mcr_stat"
+  @metric_name "task_stats"
+
+  series do
+    database(Application.get_env(:mcp, Fact.Influx) |> Keyword.get(:database))
+    # 'type' maps to the measurement
+    measurement(@metric_type)
+
+    tag(:application, default: "janice")
+    tag(:env, default: Application.get_env(:mcp, :build_env, "dev"))
+    tag(:host)
+    tag(:name)
+    tag(:metric, default: @metric_name)
+    tag(:task)
+    tag(:state)
+
+    field(:cpu_pct)
+    field(:stack_free)
+  end
+
+  # the remote publishes the tasks compactly as a list of:
+  #  [name, cpu (per mille of a single core), stack free, state]
+  def make_points(%{type: @metric_type, metric: @metric_name, tasks: tasks} = r)
+      when is_list(tasks) do
+    mtime = Map.get(r, :mtime, TimeSupport.unix_now(:second))
+
+    for [task, cpu_pm, stack_free, state] <- tasks do
+      pt = %TaskStat{}
+
+      tags = %{pt.tags | host: r.host, name: r.name, task: task, state: state}
+      fields = %{pt.fields | cpu_pct: cpu_pm / 10.0, stack_free: stack_free}
+
+      %{pt | tags: tags, fields: fields, timestamp: mtime}
+    end
+  end
+
+  # trap when the input map doesn't match
+  def make_points(%{} = r) do
+    Logger.warn(["no match for ", inspect(r, pretty: true)])
+    []
+  end
+
+  def record(%{record: true} = r) do
+    db = Application.get_env(:mcp, Fact.Influx) |> Keyword.get(:database)
+
+    make_points(r) |> write(database: db, async: true, precision: :second)
+  end
+
+  def record(%{}), do: {:not_recorded}
+
+  def valid?(%{} = r) do
+    type = Map.get(r, :type, nil)
+    metric = Map.get(r, :metric, nil)
+    tasks = Map.get(r, :tasks, nil)
+
+    type === @metric_type and metric === @metric_name and is_list(tasks)
+  end
+end
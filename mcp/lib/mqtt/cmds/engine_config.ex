@@ -0,0 +1,24 @@
+defmodule Mqtt.EngineConfig do
+  @moduledoc false
+
+  require Logger
+
+  alias Janice.TimeSupport
+
+  # the settings of an engine that may be changed at runtime, only the
+  # settings included are changed (the remaining are unchanged)
+  @settings [:convert_secs, :discover_secs, :report_secs, :convert, :discover]
+
+  def new_cmd(host, engine, opts \\ [])
+      when is_binary(host) and is_binary(engine) and is_list(opts),
+      do:
+        Map.merge(
+          %{
+            cmd: "engine.config",
+            mtime: TimeSupport.unix_now(:second),
+            host: host,
+            engine: engine
+          },
+          Keyword.take(opts, @settings) |> Enum.into(%{})
+        )
+end
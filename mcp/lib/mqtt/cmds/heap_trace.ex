@@ -0,0 +1,55 @@
+defmodule Mqtt.HeapTrace do
+  @moduledoc false
+
+  require Logger
+
+  alias Janice.TimeSupport
+
+  # request the allocations by call site of a remote (requires the remote
+  # be built with CONFIG_MCR_HEAP_TRACE), reset: true zeros the counts
+  # after they are published
+  def new_cmd(host, opts \\ []) when is_binary(host) and is_list(opts),
+    do: %{
+      cmd: "heap.trace",
+      mtime: TimeSupport.unix_now(:second),
+      host: host,
+      reset: Keyword.get(opts, :reset, false)
+    }
+
+  # log the heap trace reading published by the remote, one line per tag:
+  #  [tag, allocs, frees, bytes, live bytes, peak bytes]
+  def log(%{name: name, enabled: false}),
+    do: Logger.info([name, " heap trace not enabled"])
+
+  def log(%{name: name, tags: tags} = r) when is_list(tags) do
+    Logger.info([
+      name,
+      " heap free=",
+      inspect(r.free_heap),
+      " min_free=",
+      inspect(r.min_free_heap)
+    ])
+
+    for [tag, allocs, frees, bytes, live, peak] <- tags do
+      Logger.info([
+        name,
+        " heap ",
+        tag,
+        " allocs=",
+        inspect(allocs),
+        " frees=",
+        inspect(frees),
+        " bytes=",
+        inspect(bytes),
+        " live=",
+        inspect(live),
+        " peak=",
+        inspect(peak)
+      ])
+    end
+
+    :ok
+  end
+
+  def log(_r), do: :ok
+end
@@ -11,7 +11,7 @@ defmodule Mqtt.SetPulseWidth do
       when is_list(opts) do
     import Janice.TimeSupport, only: [unix_now: 1]
 
-    %{
+    cmd = %{
       cmd: "pwm",
       mtime: unix_now(:second),
       device: device,
@@ -20,5 +20,28 @@ defmodule Mqtt.SetPulseWidth do
       duty: Keyword.get(opts, :duty, 0),
       fade_ms: Keyword.get(opts, :fade_ms, 30)
     }
+
+    # a profile (list of steps) is executed by the remote device
+    cmd =
+      case Keyword.get(opts, :steps) do
+        nil ->
+          cmd
+
+        steps when is_list(steps) ->
+          Map.merge(cmd, %{steps: steps, loop: Keyword.get(opts, :loop, false)})
+      end
+
+    # other channels (of the same remote device) started with this one,
+    # optionally at execute_at (unix time in ms)
+    case Keyword.get(opts, :group) do
+      nil ->
+        cmd
+
+      group when is_list(group) ->
+        Map.merge(cmd, %{
+          group: group,
+          execute_at: Keyword.get(opts, :execute_at, 0)
+        })
+    end
   end
 end
@@ -9,10 +9,14 @@ defmodule Mqtt.Inbound do
 
   alias Fact.EngineMetric
   alias Fact.FreeRamStat
+  alias Fact.RemoteMetric
+  alias Fact.TaskStat
 
   # alias Fact.RunMetric
 
+  alias Mqtt.HeapTrace
   alias Mqtt.Reading
+  alias Mqtt.Trace
 
   def start_link(s) do
     GenServer.start_link(Mqtt.Inbound, s, name: Mqtt.Inbound)
@@ -173,6 +177,11 @@ defmodule Mqtt.Inbound do
     async = Keyword.get(opts, :async, true)
 
     cond do
+      # readings held by the remote during an outage are processed with
+      # their original mtime except for state that has since been superseded
+      Reading.replay_stale?(r) ->
+        Logger.debug([r.host, " ignoring replayed ", r.type, " reading"])
+
       # HACK:
       #   handle the paritial implmentation of pipeline handling of
       #   messages.  as of 2010-03-25 only switch messages are processed
@@ -246,9 +255,26 @@ defmodule Mqtt.Inbound do
       Reading.free_ram_stat?(r) ->
         Map.put_new(r, :record, r.runtime_metrics) |> FreeRamStat.record()
 
+      # the config applied by an engine.config cmd is echoed by the remote
+      Reading.engine_metric?(r) and Map.has_key?(r, :config) ->
+        log = Map.get(r, :log, true)
+        log && Logger.info([r.name, " ", r.engine, " config ", inspect(r.config)])
+
       Reading.engine_metric?(r) ->
         Map.put_new(r, :record, r.runtime_metrics) |> EngineMetric.record()
 
+      Reading.remote_metric?(r) ->
+        Map.put_new(r, :record, r.runtime_metrics) |> RemoteMetric.record()
+
+      Reading.task_stat?(r) ->
+        Map.put_new(r, :record, r.runtime_metrics) |> TaskStat.record()
+
+      Reading.heap_trace?(r) ->
+        HeapTrace.log(r)
+
+      Reading.trace?(r) ->
+        Trace.log(r)
+
       Reading.simple_text?(r) ->
         log = Map.get(r, :log, true)
         log && Logger.info([r.name, " ", r.text])
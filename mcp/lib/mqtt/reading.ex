@@ -4,6 +4,8 @@ defmodule Mqtt.Reading do
   require Logger
 
   alias Fact.EngineMetric
+  alias Fact.RemoteMetric
+  alias Fact.TaskStat
 
   alias Janice.TimeSupport
 
@@ -149,6 +151,49 @@ defmodule Mqtt.Reading do
     r.mtime > epoch_first_year
   end
 
+  @doc ~S"""
+  Was the Reading held by the remote during an outage and replayed?
+
+  NOTE: 1. A replayed reading retains the mtime of when it was taken
+
+   ##Examples:
+    iex> json =
+    ...>   ~s({"host":"mcr.macaddr", "device":"ds/28.0000",
+    ...>       "mtime": 1506867918, "type": "temp", "tc": 20.0, "tf": 80.0,
+    ...>       "replay": true})
+    ...> Jason.decode!(json, keys: :atoms) |> Mqtt.Reading.replay?()
+    true
+  """
+  def replay?(%{replay: true}), do: true
+  def replay?(%{}), do: false
+
+  @doc ~S"""
+  Is the Reading a replay of state since superseded?
+
+  NOTE: 1. The current state of a switch, pwm or the remote itself is
+           reported again once the remote reconnects so a replay of the
+           state during the outage is stale
+
+   ##Examples:
+    iex> json =
+    ...>   ~s({"host": "mcr.macaddr",
+    ...>       "mtime": 2106, "type": "pwm", "duty": 2048, "duty_min": 1,
+    ...>       "duty_max": 4095, "replay": true})
+    ...> Jason.decode!(json, keys: :atoms) |> Mqtt.Reading.replay_stale?()
+    true
+
+    iex> json =
+    ...>   ~s({"host":"mcr.macaddr", "device":"ds/28.0000",
+    ...>       "mtime": 1506867918, "type": "temp", "tc": 20.0, "tf": 80.0,
+    ...>       "replay": true})
+    ...> Jason.decode!(json, keys: :atoms) |> Mqtt.Reading.replay_stale?()
+    false
+  """
+  def replay_stale?(%{} = r) do
+    replay?(r) and
+      (boot?(r) or startup?(r) or remote_runtime?(r) or switch?(r) or pwm?(r))
+  end
+
   @doc ~S"""
   Is the Reading a pwm?
 
@@ -300,6 +345,23 @@ defmodule Mqtt.Reading do
     metadata?(r) and EngineMetric.valid?(r)
   end
 
+  def task_stat?(%{} = r) do
+    metadata?(r) and TaskStat.valid?(r)
+  end
+
+  def remote_metric?(%{} = r) do
+    metadata?(r) and RemoteMetric.valid?(r)
+  end
+
+  def trace?(%{} = r) do
+    metadata?(r) and r.type == "mcr_stat" and Map.get(r, :metric) == "trace"
+  end
+
+  def heap_trace?(%{} = r) do
+    metadata?(r) and r.type == "mcr_stat" and
+      Map.get(r, :metric) == "heap_trace"
+  end
+
   @doc ~S"""
   Is the Reading a cmdack?
 
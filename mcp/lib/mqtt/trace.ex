@@ -0,0 +1,134 @@
+defmodule Mqtt.Trace do
+  @moduledoc false
+
+  require Logger
+
+  alias Janice.TimeSupport
+
+  # the names of the events, phases, bus jobs and cmd types as numbered by
+  # the remote (see misc/trace.hpp, engines/types.hpp, engines/bus_sched.hpp
+  # and cmds/types.hpp of mcr_esp)
+  @events [
+    :none,
+    :bus_take,
+    :bus_give,
+    :phase_start,
+    :phase_stop,
+    :msg_in_send,
+    :msg_in_recv,
+    :msg_out_send,
+    :msg_out_recv,
+    :publish,
+    :cmd_parse,
+    :cmd_process,
+    :cmd_done
+  ]
+
+  @phases ["core", "convert", "discover", "report", "command"]
+  @bus_jobs ["command", "report", "convert", "discover"]
+
+  @cmds [
+    "unknown",
+    "none",
+    "time.sync",
+    "set.switch",
+    "heartbeat",
+    "set.name",
+    "restart",
+    "engines.suspend",
+    "ota.https",
+    "pwm",
+    "engine.config",
+    "heap.trace",
+    "trace.dump"
+  ]
+
+  # request the event trace ring of a remote, clear: true discards the
+  # events published
+  def new_cmd(host, opts \\ []) when is_binary(host) and is_list(opts),
+    do: %{
+      cmd: "trace.dump",
+      mtime: TimeSupport.unix_now(:second),
+      host: host,
+      clear: Keyword.get(opts, :clear, false)
+    }
+
+  # decode the events of a chunk, the time of each event is relative
+  # (in microseconds, negative) to the time of the dump
+  def decode(%{events: events, now_us: now_us} = r) when is_list(events) do
+    sources = Map.get(r, :sources, [])
+
+    for [us, event, core, arg] <- events do
+      %{
+        rel_us: -wrap(now_us - us),
+        core: core,
+        event: Enum.at(@events, event, :unknown)
+      }
+      |> Map.merge(decode_arg(Enum.at(@events, event), arg, sources))
+    end
+  end
+
+  def decode(_r), do: []
+
+  # render the events of a chunk as a timeline, one line per event
+  def timeline(%{} = r) do
+    for e <- decode(r) do
+      [
+        :io_lib.format("~12.3fms", [e.rel_us / 1000]),
+        " core",
+        Integer.to_string(e.core),
+        " ",
+        Atom.to_string(e.event),
+        render_detail(e)
+      ]
+      |> IO.iodata_to_binary()
+    end
+  end
+
+  def log(%{name: name, enabled: false}),
+    do: Logger.info([name, " trace not enabled"])
+
+  def log(%{name: name, chunk: chunk, chunks: chunks} = r) do
+    Logger.info([
+      name,
+      " trace chunk ",
+      Integer.to_string(chunk + 1),
+      "/",
+      Integer.to_string(chunks)
+    ])
+
+    for line <- timeline(r), do: Logger.info([name, " ", line])
+
+    :ok
+  end
+
+  def log(_r), do: :ok
+
+  defp decode_arg(event, arg, sources)
+       when event in [:bus_take, :bus_give, :phase_start, :phase_stop] do
+    src = Enum.at(sources, Bitwise.bsr(arg, 8), "unknown")
+    detail = Bitwise.band(arg, 0xFF)
+
+    case event do
+      :bus_take -> %{source: src, job: Enum.at(@bus_jobs, detail, "unknown")}
+      :bus_give -> %{source: src}
+      _phase -> %{source: src, phase: Enum.at(@phases, detail, "unknown")}
+    end
+  end
+
+  defp decode_arg(event, arg, _sources)
+       when event in [:cmd_parse, :cmd_process, :cmd_done],
+       do: %{cmd: Enum.at(@cmds, arg, "unknown")}
+
+  defp decode_arg(_event, arg, _sources), do: %{len: arg}
+
+  defp render_detail(%{source: src} = e),
+    do: [" ", src, " ", Map.get(e, :job, Map.get(e, :phase, ""))]
+
+  defp render_detail(%{cmd: cmd}), do: [" ", cmd]
+  defp render_detail(%{len: len}), do: [" len=", Integer.to_string(len)]
+
+  # the timestamps are the low 32 bits of the remote's microsecond clock
+  defp wrap(us) when us < 0, do: us + 0x100000000
+  defp wrap(us), do: us
+end
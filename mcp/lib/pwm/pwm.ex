@@ -157,6 +157,28 @@ defmodule PulseWidth do
     end
   end
 
+  @doc """
+    Send a profile to the remote device which executes the steps locally
+
+    steps is a list of maps (or keyword lists) of :duty, :fade_ms and
+    :hold_ms.  include loop: true in opts to repeat the profile until the
+    next command for the device.
+  """
+  def profile(name, steps, opts \\ [])
+      when is_binary(name) and is_list(steps) and is_list(opts) do
+    with %PulseWidth{} = pwm <- find(name) do
+      steps = for step <- steps, do: Enum.into(step, %{})
+
+      record_cmd(pwm, [steps: steps] ++ opts)
+    else
+      nil ->
+        Keyword.get(opts, :log, false) &&
+          Logger.warn([inspect(name), " not found"])
+
+        {:not_found, name}
+    end
+  end
+
   # when processing an external update the reading map will contain
   # the actual %PulseWidth{} struct when it has been found (already exists)
   # in this case perform the appropriate updates
@@ -301,7 +323,16 @@ defmodule PulseWidth do
 
     with {:ok, %PulseWidth{} = pwm} <- add_cmd(pwm, utc_now()),
          {:cmd, %PulseWidthCmd{} = cmd} <- {:cmd, hd(pwm.cmds)},
-         cmd_opts <- Keyword.take(opts, [:duty, :fade_ms, :ack]),
+         cmd_opts <-
+           Keyword.take(opts, [
+             :duty,
+             :fade_ms,
+             :ack,
+             :steps,
+             :loop,
+             :group,
+             :execute_at
+           ]),
          cmd <- create_cmd(pwm, cmd, cmd_opts),
          pub_rc <- publish_cmd(cmd) do
       [pwm: pwm, pub_rc: pub_rc] ++ opts
@@ -19,7 +19,10 @@ defmodule Remote do
   alias Janice.TimeSupport
 
   alias Mqtt.Client
+  alias Mqtt.EngineConfig
+  alias Mqtt.HeapTrace
   alias Mqtt.SetName
+  alias Mqtt.Trace
 
   schema "remote" do
     field(:host, :string)
@@ -221,6 +224,32 @@ defmodule Remote do
     IO.puts("\tRemote.deprecate(id)")
   end
 
+  # adjust the cadences of an engine (e.g. "mcrDS") of remotes at runtime,
+  # the remote persists the config and echoes the config applied.
+  #  opts: convert_secs, discover_secs, report_secs, convert, discover
+  def engine_config(what, engine, opts \\ [])
+      when is_binary(engine) and is_list(opts) do
+    for %{host: host} <- remote_list(what) |> Enum.filter(&is_map/1) do
+      EngineConfig.new_cmd(host, engine, opts) |> Client.publish_cmd()
+    end
+  end
+
+  # request the heap trace (allocations by call site) of remotes, the
+  # remote publishes the table as a reading.  opts: reset
+  def heap_trace(what, opts \\ []) when is_list(opts) do
+    for %{host: host} <- remote_list(what) |> Enum.filter(&is_map/1) do
+      HeapTrace.new_cmd(host, opts) |> Client.publish_cmd()
+    end
+  end
+
+  # request the event trace ring of remotes, the remote publishes the ring
+  # in chunks that are logged as a timeline.  opts: clear
+  def trace_dump(what, opts \\ []) when is_list(opts) do
+    for %{host: host} <- remote_list(what) |> Enum.filter(&is_map/1) do
+      Trace.new_cmd(host, opts) |> Client.publish_cmd()
+    end
+  end
+
   def external_update(%{host: host, mtime: _mtime} = eu) do
     log = Map.get(eu, :log, true)
 
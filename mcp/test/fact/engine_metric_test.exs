@@ -95,6 +95,32 @@ defmodule FactEngineMetricTest do
              (res == :ok or res == {:not_recorded})
   end
 
+  test "reading with report_p99_us > 0" do
+    raw =
+      ext(0, "dsTest")
+      |> Map.put(:report_us, 1_000_000)
+      |> Map.put(:report_p99_us, 2_097_151)
+
+    pt = Fact.EngineMetric.make_point(raw)
+    res = Fact.EngineMetric.record(raw)
+
+    assert pt.fields.report_p99_us > 0 and
+             (res == :ok or res == {:not_recorded})
+  end
+
+  test "reading with first_reading_us > 0" do
+    raw =
+      ext(0, "dsTest")
+      |> Map.put(:first_reading_us, 1_500_000)
+      |> Map.put(:restored_devs, 4)
+
+    pt = Fact.EngineMetric.make_point(raw)
+    res = Fact.EngineMetric.record(raw)
+
+    assert pt.fields.first_reading_us > 0 and pt.fields.restored_devs == 4 and
+             (res == :ok or res == {:not_recorded})
+  end
+
   test "reading with all fields > 0" do
     raw =
       ext(0, "dsTest")
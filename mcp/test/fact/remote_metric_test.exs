@@ -0,0 +1,73 @@
+defmodule FactRemoteMetricTest do
+  @moduledoc false
+
+  use ExUnit.Case, async: true
+  import ExUnit.CaptureLog
+
+  alias Janice.TimeSupport
+
+  def preferred_vsn, do: "b4edefc"
+  def host(num), do: "mcr.010203040" <> Integer.to_string(num)
+  def name(num), do: "test_name" <> Integer.to_string(num)
+
+  def ext(num),
+    do: %{
+      vsn: preferred_vsn(),
+      host: host(num),
+      name: name(0),
+      type: "mcr_stat",
+      metric: "metrics",
+      interval_ms: 60_000,
+      counters: %{"mqtt.msgs_in": 12, "dev.read_errors": 1},
+      gauges: %{"heap.free": 123_456},
+      histograms: %{
+        "mcrDS.convert": %{count: 4, min_us: 10, max_us: 900, buckets: [0, 1]}
+      },
+      mtime: TimeSupport.unix_now(:second),
+      log: false
+    }
+
+  test "reading is a valid RemoteMetric?" do
+    assert ext(0) |> Fact.RemoteMetric.valid?()
+  end
+
+  test "reading is NOT a valid RemoteMetric?" do
+    refute ext(0) |> Map.put(:metric, "task_stats") |> Fact.RemoteMetric.valid?()
+  end
+
+  test "bad input reading" do
+    msg =
+      capture_log(fn ->
+        ext(0) |> Map.delete(:type) |> Fact.RemoteMetric.make_points()
+      end)
+
+    assert msg =~ "no match"
+  end
+
+  test "a point is made for each metric" do
+    points = ext(0) |> Fact.RemoteMetric.make_points()
+
+    assert length(points) == 4
+
+    gauge = Enum.find(points, fn pt -> pt.tags.key == "heap.free" end)
+    assert gauge.tags.kind == "gauge" and gauge.fields.val == 123_456
+
+    hist = Enum.find(points, fn pt -> pt.tags.key == "mcrDS.convert" end)
+    assert hist.tags.kind == "histogram" and hist.fields.max_us == 900
+  end
+
+  test "an export with only counters" do
+    points =
+      ext(0)
+      |> Map.drop([:gauges, :histograms])
+      |> Fact.RemoteMetric.make_points()
+
+    assert Enum.all?(points, fn pt -> pt.tags.kind == "counter" end)
+  end
+
+  test "reading is recorded" do
+    res = ext(0) |> Map.put(:record, true) |> Fact.RemoteMetric.record()
+
+    assert res == :ok or res == {:not_recorded}
+  end
+end
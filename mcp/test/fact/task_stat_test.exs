@@ -0,0 +1,55 @@
+defmodule FactTaskStatTest do
+  @moduledoc false
+
+  use ExUnit.Case, async: true
+  import ExUnit.CaptureLog
+
+  alias Janice.TimeSupport
+
+  def preferred_vsn, do: "b4edefc"
+  def host(num), do: "mcr.010203040" <> Integer.to_string(num)
+  def name(num), do: "test_name" <> Integer.to_string(num)
+
+  def ext(num),
+    do: %{
+      vsn: preferred_vsn(),
+      host: host(num),
+      name: name(0),
+      type: "mcr_stat",
+      metric: "task_stats",
+      interval_ms: 60_000,
+      tasks: [["mcrDS", 125, 1024, "B"], ["IDLE0", 850, 512, "R"]],
+      mtime: TimeSupport.unix_now(:second),
+      log: false
+    }
+
+  test "reading is a valid TaskStat?" do
+    assert ext(0) |> Fact.TaskStat.valid?()
+  end
+
+  test "reading is NOT a valid TaskStat?" do
+    refute ext(0) |> Map.delete(:tasks) |> Fact.TaskStat.valid?()
+  end
+
+  test "bad input reading" do
+    msg =
+      capture_log(fn ->
+        ext(0) |> Map.delete(:type) |> Fact.TaskStat.make_points()
+      end)
+
+    assert msg =~ "no match"
+  end
+
+  test "a point is made for each task" do
+    [ds, idle] = ext(0) |> Fact.TaskStat.make_points()
+
+    assert ds.tags.task == "mcrDS" and ds.fields.cpu_pct == 12.5
+    assert idle.tags.state == "R" and idle.fields.stack_free == 512
+  end
+
+  test "reading is recorded" do
+    res = ext(0) |> Map.put(:record, true) |> Fact.TaskStat.record()
+
+    assert res == :ok or res == {:not_recorded}
+  end
+end
@@ -0,0 +1,23 @@
+defmodule MqttEngineConfigTest do
+  @moduledoc false
+  use ExUnit.Case, async: true
+  alias Mqtt.EngineConfig
+
+  test "create engine config cmd" do
+    cmd = EngineConfig.new_cmd("mcr.host", "mcrDS", report_secs: 15)
+
+    assert is_map(cmd)
+    assert cmd.cmd === "engine.config"
+    assert cmd.engine === "mcrDS"
+    assert cmd.report_secs === 15
+    refute Map.has_key?(cmd, :convert_secs)
+  end
+
+  test "create engine config cmd (unknown settings are dropped)" do
+    cmd = EngineConfig.new_cmd("mcr.host", "all", discover: false, bogus: 1)
+
+    assert is_map(cmd)
+    refute cmd.discover
+    refute Map.has_key?(cmd, :bogus)
+  end
+end
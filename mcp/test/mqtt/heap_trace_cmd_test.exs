@@ -0,0 +1,33 @@
+defmodule MqttHeapTraceTest do
+  @moduledoc false
+  use ExUnit.Case, async: true
+  alias Mqtt.HeapTrace
+
+  test "create heap trace cmd" do
+    cmd = HeapTrace.new_cmd("mcr.host")
+
+    assert is_map(cmd)
+    assert cmd.cmd === "heap.trace"
+    assert cmd.host === "mcr.host"
+    refute cmd.reset
+  end
+
+  test "create heap trace cmd (with reset)" do
+    cmd = HeapTrace.new_cmd("mcr.host", reset: true)
+
+    assert cmd.reset
+  end
+
+  test "log heap trace reading" do
+    r = %{
+      name: "mcr.test",
+      enabled: true,
+      free_heap: 123_456,
+      min_free_heap: 100_000,
+      tags: [["reading_json", 10, 10, 20_480, 0, 2048]]
+    }
+
+    assert HeapTrace.log(r) === :ok
+    assert HeapTrace.log(%{name: "mcr.test", enabled: false}) === :ok
+  end
+end
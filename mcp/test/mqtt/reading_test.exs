@@ -56,4 +56,29 @@ defmodule Mcp.ReadingTest do
     assert is_map(r3)
     assert Map.has_key?(r3, :msgpack)
   end
+
+  test "can decode a reading marked as a replay by the remote" do
+    r1 = %{
+      host: "mcr.macaddr",
+      device: "ds/28.0000",
+      mtime: 1_506_867_918,
+      type: "temp",
+      tc: 20.1,
+      tf: 80.1
+    }
+
+    # as the remote: increment the fixmap entries then append "replay": true
+    <<0x8::4, entries::4, rest::binary>> =
+      Msgpax.pack!(r1) |> IO.iodata_to_binary()
+
+    replayed = <<0x8::4, entries + 1::4>> <> rest <> <<0xA6, "replay", 0xC3>>
+
+    {rc, r2} = Reading.decode(replayed)
+
+    assert rc == :ok
+    assert r2.mtime == r1.mtime
+    assert Reading.replay?(r2)
+    refute Reading.replay_stale?(r2)
+    refute Reading.replay?(r1)
+  end
 end
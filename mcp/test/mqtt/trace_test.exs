@@ -0,0 +1,61 @@
+defmodule MqttTraceTest do
+  @moduledoc false
+  use ExUnit.Case, async: true
+  alias Mqtt.Trace
+
+  @chunk %{
+    name: "mcr.test",
+    enabled: true,
+    chunk: 0,
+    chunks: 1,
+    now_us: 10_000,
+    sources: ["mcr", "mcrDS"],
+    events: [
+      [1_000, 1, 0, 0x0102],
+      [2_000, 3, 1, 0x0101],
+      [3_000, 9, 0, 256],
+      [4_000, 10, 0, 11]
+    ]
+  }
+
+  test "create trace dump cmd" do
+    cmd = Trace.new_cmd("mcr.host", clear: true)
+
+    assert cmd.cmd === "trace.dump"
+    assert cmd.host === "mcr.host"
+    assert cmd.clear
+  end
+
+  test "decode trace chunk" do
+    [take, phase, publish, cmd] = Trace.decode(@chunk)
+
+    assert take.event === :bus_take
+    assert take.rel_us === -9_000
+    assert take.source === "mcrDS"
+    assert take.job === "convert"
+
+    assert phase.event === :phase_start
+    assert phase.core === 1
+    assert phase.phase === "convert"
+
+    assert publish.event === :publish
+    assert publish.len === 256
+
+    assert cmd.event === :cmd_parse
+    assert cmd.cmd === "heap.trace"
+  end
+
+  test "decode handles timestamp wrap" do
+    [e] = Trace.decode(%{@chunk | now_us: 100, events: [[0xFFFFFF00, 2, 0, 0x0100]]})
+
+    assert e.rel_us === -356
+  end
+
+  test "render trace chunk timeline" do
+    lines = Trace.timeline(@chunk)
+
+    assert length(lines) === 4
+    assert hd(lines) =~ "bus_take mcrDS convert"
+    assert Trace.log(@chunk) === :ok
+  end
+end
@@ -42,6 +42,19 @@ defmodule PulseWidthTest do
     assert true
   end
 
+  test "can send a profile to a PulseWidth" do
+    device = device(3, 1)
+
+    steps = [
+      %{duty: 4095, fade_ms: 1000, hold_ms: 500},
+      [duty: 0, fade_ms: 1000, hold_ms: 500]
+    ]
+
+    rc = PulseWidth.profile(device, steps, loop: true)
+
+    refute match?({:not_found, _}, rc)
+  end
+
   test "the truth will set you free" do
     assert true
   end
@@ -0,0 +1,97 @@
+/*
+    engine_fakes.cpp - Master Control Remote Engine Host Test Fakes
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "engine_fakes.hpp"
+#include "misc/mcr_restart.hpp"
+#include "net/mcr_net.hpp"
+#include "protocols/mqtt.hpp"
+
+static std::vector<std::string> _published;
+static void (*_on_publish)() = nullptr;
+
+const std::vector<std::string> &host_mqtt_published() { return _published; }
+void host_mqtt_clear() { _published.clear(); }
+
+uint32_t host_mqtt_published_with(const char *text) {
+  uint32_t count = 0;
+
+  for (auto &json : _published) {
+    count += (json.find(text) != std::string::npos);
+  }
+
+  return count;
+}
+
+void host_mqtt_on_publish(void (*hook)()) { _on_publish = hook; }
+
+namespace mcr {
+
+// the members of mcrMQTT are never used, the object is only the target of
+// the publish calls
+mcrMQTT::mcrMQTT() {}
+
+mcrMQTT_t *mcrMQTT::instance() {
+  static mcrMQTT_t mqtt;
+
+  return &mqtt;
+}
+
+void mcrMQTT::publish(Reading_t *reading) { publish(reading->json()); }
+void mcrMQTT::publish(Reading_t &reading) { publish(reading.json()); }
+void mcrMQTT::publish(Reading_ptr_t reading) { publish(reading->json()); }
+
+void mcrMQTT::publish(string_t *json) {
+  _published.push_back(*json);
+  delete json;
+
+  if (_on_publish != nullptr) {
+    _on_publish();
+  }
+}
+
+static const string_t _name = "host";
+static const string_t _mac = "000000000000";
+
+const string_t &Net::getName() { return _name; }
+const string_t &Net::hostID() { return _name; }
+const string_t &Net::macAddress() { return _mac; }
+bool Net::waitForName(uint32_t wait_ms) { return true; }
+bool Net::waitForNormalOps(uint32_t wait_ms) { return true; }
+
+// an engine restarts when the bus is unusable, a failure of the test
+mcrRestart::mcrRestart() {}
+mcrRestart::~mcrRestart() {}
+
+mcrRestart_t *mcrRestart::instance() {
+  static mcrRestart_t restart;
+
+  return &restart;
+}
+
+void mcrRestart::restart(const char *text, const char *func,
+                         uint32_t reboot_delay_ms) {
+  printf("restart requested by %s: %s\n", func ? func : "unknown",
+         text ? text : "");
+  abort();
+}
+} // namespace mcr
@@ -0,0 +1,43 @@
+/*
+    engine_fakes.hpp - Master Control Remote Engine Host Test Fakes
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+// the engines run against fakes of mqtt and the network (engine_fakes.cpp):
+// the network is always in normal ops and the readings published are kept
+// for the test to inspect
+
+#ifndef mcr_engine_fakes_hpp
+#define mcr_engine_fakes_hpp
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// the json of each reading published since the last clear
+const std::vector<std::string> &host_mqtt_published();
+void host_mqtt_clear();
+
+// the number of the readings published that contain text
+uint32_t host_mqtt_published_with(const char *text);
+
+// called as each reading is published (e.g. to check the bus is not held),
+// nullptr to remove
+void host_mqtt_on_publish(void (*hook)());
+
+#endif // mcr_engine_fakes_hpp
@@ -0,0 +1,50 @@
+/*
+    host_test.h - Master Control Remote Host Test Support
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+// the host tests are plain executables (one per area) run by ctest.  a test
+// is a function of CHECK()s, main() runs each with RUN() and returns the
+// number of failed checks.
+
+#ifndef mcr_host_test_h
+#define mcr_host_test_h
+
+#include <stdio.h>
+
+static int host_test_failures = 0;
+
+#define CHECK(expr)                                                            \
+  do {                                                                         \
+    if (!(expr)) {                                                             \
+      printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #expr);         \
+      host_test_failures++;                                                    \
+    }                                                                          \
+  } while (0)
+
+#define RUN(test)                                                              \
+  do {                                                                         \
+    int before = host_test_failures;                                           \
+    test();                                                                    \
+    printf("%-40s %s\n", #test,                                                \
+           (host_test_failures == before) ? "passed" : "FAILED");              \
+  } while (0)
+
+#define HOST_TEST_RESULT() (host_test_failures > 0 ? 1 : 0)
+
+#endif // mcr_host_test_h
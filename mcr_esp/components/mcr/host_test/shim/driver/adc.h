@@ -0,0 +1,4 @@
+// host shim:  the types referenced by net/mcr_net.hpp
+#pragma once
+
+typedef enum { ADC_CHANNEL_7 = 7 } adc_channel_t;
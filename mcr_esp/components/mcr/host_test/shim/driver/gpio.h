@@ -0,0 +1,55 @@
+// host shim:  the types referenced by owb.c and the hardware config
+#pragma once
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+typedef enum {
+  GPIO_NUM_13 = 13,
+  GPIO_NUM_15 = 15,
+  GPIO_NUM_21 = 21,
+  GPIO_NUM_27 = 27,
+  GPIO_NUM_32 = 32,
+  GPIO_NUM_33 = 33,
+  GPIO_NUM_34 = 34,
+  GPIO_NUM_36 = 36,
+  GPIO_NUM_39 = 39
+} gpio_num_t;
+
+#define GPIO_SEL_15 (1ULL << 15)
+#define GPIO_SEL_21 (1ULL << 21)
+#define GPIO_SEL_27 (1ULL << 27)
+#define GPIO_SEL_32 (1ULL << 32)
+#define GPIO_SEL_33 (1ULL << 33)
+#define GPIO_SEL_34 (1ULL << 34)
+#define GPIO_SEL_36 (1ULL << 36)
+#define GPIO_SEL_39 (1ULL << 39)
+
+typedef enum { GPIO_MODE_INPUT = 1, GPIO_MODE_OUTPUT = 2 } gpio_mode_t;
+typedef enum { GPIO_PULLUP_DISABLE = 0, GPIO_PULLUP_ENABLE } gpio_pullup_t;
+typedef enum {
+  GPIO_PULLDOWN_DISABLE = 0,
+  GPIO_PULLDOWN_ENABLE
+} gpio_pulldown_t;
+typedef enum { GPIO_INTR_DISABLE = 0 } gpio_int_type_t;
+
+typedef struct {
+  uint64_t pin_bit_mask;
+  gpio_mode_t mode;
+  gpio_pullup_t pull_up_en;
+  gpio_pulldown_t pull_down_en;
+  gpio_int_type_t intr_type;
+} gpio_config_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// no-ops
+esp_err_t gpio_config(const gpio_config_t *config);
+esp_err_t gpio_set_level(gpio_num_t pin, uint32_t level);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,79 @@
+// host shim:  the i2c master command link API.  links record the queued
+// commands, i2c_master_cmd_begin() executes them against the simulated
+// devices (drivers/i2c_sim.h) and the link allocations are counted.  the
+// driver install and config are accepted and do nothing.
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "driver/gpio.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+typedef int i2c_port_t;
+#define I2C_NUM_0 (0)
+#define I2C_NUM_1 (1)
+#define I2C_NUM_MAX (2)
+
+typedef enum { I2C_MODE_SLAVE = 0, I2C_MODE_MASTER } i2c_mode_t;
+typedef void *i2c_cmd_handle_t;
+
+typedef struct {
+  i2c_mode_t mode;
+  int sda_io_num;
+  gpio_pullup_t sda_pullup_en;
+  int scl_io_num;
+  gpio_pullup_t scl_pullup_en;
+  struct {
+    uint32_t clk_speed;
+  } master;
+} i2c_config_t;
+
+typedef enum { I2C_MASTER_WRITE = 0, I2C_MASTER_READ } i2c_rw_t;
+
+typedef enum {
+  I2C_MASTER_ACK = 0,
+  I2C_MASTER_NACK,
+  I2C_MASTER_LAST_NACK
+} i2c_ack_type_t;
+
+typedef struct {
+  uint32_t creates;
+  uint32_t deletes;
+  uint32_t begins;
+  uint32_t bytes; // written and read (excluding the address)
+} host_i2c_stats_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+esp_err_t i2c_param_config(i2c_port_t port, const i2c_config_t *conf);
+esp_err_t i2c_driver_install(i2c_port_t port, i2c_mode_t mode,
+                             size_t slv_rx_buf_len, size_t slv_tx_buf_len,
+                             int intr_alloc_flags);
+esp_err_t i2c_driver_delete(i2c_port_t port);
+esp_err_t i2c_set_timeout(i2c_port_t port, int timeout);
+esp_err_t i2c_get_timeout(i2c_port_t port, int *timeout);
+
+i2c_cmd_handle_t i2c_cmd_link_create(void);
+void i2c_cmd_link_delete(i2c_cmd_handle_t cmd);
+
+esp_err_t i2c_master_start(i2c_cmd_handle_t cmd);
+esp_err_t i2c_master_write_byte(i2c_cmd_handle_t cmd, uint8_t data,
+                                bool ack_en);
+esp_err_t i2c_master_write(i2c_cmd_handle_t cmd, uint8_t *data,
+                           size_t data_len, bool ack_en);
+esp_err_t i2c_master_read(i2c_cmd_handle_t cmd, uint8_t *data,
+                          size_t data_len, i2c_ack_type_t ack);
+esp_err_t i2c_master_stop(i2c_cmd_handle_t cmd);
+esp_err_t i2c_master_cmd_begin(i2c_port_t port, i2c_cmd_handle_t cmd,
+                               TickType_t ticks_to_wait);
+
+host_i2c_stats_t *host_i2c_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,15 @@
+// host shim:  the peripheral module control (no-ops)
+#pragma once
+
+typedef enum { PERIPH_I2C0_MODULE = 0, PERIPH_I2C1_MODULE } periph_module_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void periph_module_enable(periph_module_t module);
+void periph_module_disable(periph_module_t module);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,10 @@
+// host shim:  the types referenced by owb_rmt.h
+#pragma once
+
+typedef enum {
+  RMT_CHANNEL_0 = 0,
+  RMT_CHANNEL_1,
+  RMT_CHANNEL_2,
+  RMT_CHANNEL_3,
+  RMT_CHANNEL_MAX = 8
+} rmt_channel_t;
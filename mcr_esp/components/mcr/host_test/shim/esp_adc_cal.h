@@ -0,0 +1,8 @@
+// host shim:  the types referenced by net/mcr_net.hpp
+#pragma once
+
+typedef struct {
+  int unused;
+} esp_adc_cal_characteristics_t;
+
+typedef enum { ESP_ADC_CAL_VAL_DEFAULT_VREF } esp_adc_cal_value_t;
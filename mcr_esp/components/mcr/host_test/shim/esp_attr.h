@@ -0,0 +1,5 @@
+// host shim
+#pragma once
+
+#define IRAM_ATTR
+#define RTC_NOINIT_ATTR
@@ -0,0 +1,4 @@
+// host shim:  the types referenced by net/mcr_net.hpp
+#pragma once
+
+typedef const char *esp_event_base_t;
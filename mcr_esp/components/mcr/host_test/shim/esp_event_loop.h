@@ -0,0 +1,4 @@
+// host shim
+#pragma once
+
+#include "esp_event.h"
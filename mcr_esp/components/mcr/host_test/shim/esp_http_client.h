@@ -0,0 +1,15 @@
+// host shim:  the types referenced by cmds/ota.hpp
+#pragma once
+
+#include "esp_err.h"
+
+typedef struct {
+  int event_id;
+} esp_http_client_event_t;
+
+typedef struct {
+  const char *url;
+  const char *cert_pem;
+  esp_err_t (*event_handler)(esp_http_client_event_t *evt);
+  int timeout_ms;
+} esp_http_client_config_t;
@@ -0,0 +1,38 @@
+// host shim:  logging is discarded unless HOST_TEST_LOG is defined
+#pragma once
+
+#include <stdio.h>
+
+typedef enum {
+  ESP_LOG_NONE,
+  ESP_LOG_ERROR,
+  ESP_LOG_WARN,
+  ESP_LOG_INFO,
+  ESP_LOG_DEBUG,
+  ESP_LOG_VERBOSE
+} esp_log_level_t;
+
+#ifndef LOG_LOCAL_LEVEL
+#define LOG_LOCAL_LEVEL ESP_LOG_INFO
+#endif
+
+#ifdef HOST_TEST_LOG
+#define HOST_LOG(tag, fmt, ...) printf("%s: " fmt "\n", tag, ##__VA_ARGS__)
+#else
+#define HOST_LOG(tag, fmt, ...)                                                \
+  do {                                                                         \
+    if (0) {                                                                   \
+      printf("%s: " fmt "\n", tag, ##__VA_ARGS__);                             \
+    }                                                                          \
+  } while (0)
+#endif
+
+#define ESP_LOGE(tag, fmt, ...) HOST_LOG(tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) HOST_LOG(tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) HOST_LOG(tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...) HOST_LOG(tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGV(tag, fmt, ...) HOST_LOG(tag, fmt, ##__VA_ARGS__)
+
+#define esp_log_level_set(tag, level)
+#define ESP_LOG_BUFFER_HEX_LEVEL(tag, buff, len, level)
+#define ESP_LOG_BUFFER_HEXDUMP(tag, buff, len, level)
@@ -0,0 +1,10 @@
+// host shim:  the types referenced by cmds/ota.hpp
+#pragma once
+
+#include <stdint.h>
+
+typedef struct {
+  uint32_t address;
+  uint32_t size;
+  char label[17];
+} esp_partition_t;
@@ -0,0 +1,4 @@
+// host shim
+#pragma once
+
+#define SPI_FLASH_SEC_SIZE 4096
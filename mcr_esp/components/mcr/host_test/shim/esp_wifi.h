@@ -0,0 +1,22 @@
+// host shim:  the types referenced by readings/remote.hpp and net/mcr_net.hpp
+#pragma once
+
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "esp_event.h"
+
+typedef struct {
+  uint8_t bssid[6];
+  uint8_t ssid[33];
+  uint8_t primary;
+  int8_t rssi;
+} wifi_ap_record_t;
+
+typedef struct {
+  uint32_t ip, netmask, gw;
+} tcpip_adapter_ip_info_t;
+
+typedef struct {
+  uint32_t ip;
+} tcpip_adapter_dns_info_t;
@@ -0,0 +1,24 @@
+// host shim:  the tests are single threaded so a wait for bits that are not
+// set simply waits out the ticks (advancing the simulated clock)
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+typedef void *EventGroupHandle_t;
+typedef uint32_t EventBits_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+EventGroupHandle_t xEventGroupCreate(void);
+EventBits_t xEventGroupGetBits(EventGroupHandle_t evg);
+EventBits_t xEventGroupSetBits(EventGroupHandle_t evg, EventBits_t bits);
+EventBits_t xEventGroupClearBits(EventGroupHandle_t evg, EventBits_t bits);
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t evg, EventBits_t bits,
+                                BaseType_t clear_on_exit, BaseType_t wait_all,
+                                TickType_t ticks_to_wait);
+
+#ifdef __cplusplus
+}
+#endif
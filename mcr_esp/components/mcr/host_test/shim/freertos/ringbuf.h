@@ -0,0 +1,6 @@
+// host shim
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+typedef void *RingbufHandle_t;
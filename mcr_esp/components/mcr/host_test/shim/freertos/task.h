@@ -0,0 +1,73 @@
+// host shim
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+typedef void *TaskHandle_t;
+typedef TaskHandle_t xTaskHandle;
+
+#define taskSCHEDULER_SUSPENDED ((BaseType_t)0)
+#define taskSCHEDULER_NOT_STARTED ((BaseType_t)1)
+#define taskSCHEDULER_RUNNING ((BaseType_t)2)
+
+typedef void (*TaskFunction_t)(void *);
+
+typedef enum {
+  eRunning = 0,
+  eReady,
+  eBlocked,
+  eSuspended,
+  eDeleted,
+  eInvalid
+} eTaskState;
+
+typedef struct {
+  TaskHandle_t xHandle;
+  const char *pcTaskName;
+  UBaseType_t xTaskNumber;
+  eTaskState eCurrentState;
+  UBaseType_t uxCurrentPriority;
+  UBaseType_t uxBasePriority;
+  uint32_t ulRunTimeCounter;
+  uint32_t usStackHighWaterMark;
+  BaseType_t xCoreID;
+} TaskStatus_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// advances the simulated clock (see esp_timer.h)
+void vTaskDelay(const TickType_t ticks);
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+BaseType_t xTaskGetSchedulerState(void);
+
+// the tick count follows the simulated clock, a delay until the next wake
+// advances it
+TickType_t xTaskGetTickCount(void);
+void vTaskDelayUntil(TickType_t *const prev_wake, const TickType_t increment);
+
+// tasks are never started, the handle returned only carries the name and
+// priority
+BaseType_t xTaskCreate(TaskFunction_t func, const char *const name,
+                       const uint32_t stack, void *const params,
+                       UBaseType_t priority, TaskHandle_t *const handle);
+void vTaskDelete(TaskHandle_t task);
+void vTaskSuspend(TaskHandle_t task);
+char *pcTaskGetTaskName(TaskHandle_t task);
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task);
+void vTaskPrioritySet(TaskHandle_t task, UBaseType_t priority);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+UBaseType_t uxTaskGetNumberOfTasks(void);
+UBaseType_t uxTaskGetSystemState(TaskStatus_t *const status,
+                                 const UBaseType_t max,
+                                 uint32_t *const total_run_time);
+
+// the task (and scheduler state) seen by the code under test
+void host_set_current_task(TaskHandle_t task);
+void host_set_scheduler_state(BaseType_t state);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,150 @@
+// host shim:  the definitions for driver/i2c.h
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "driver/i2c.h"
+#include "driver/periph_ctrl.h"
+#include "drivers/i2c_sim.h"
+
+typedef enum { OP_START, OP_WRITE_BYTE, OP_WRITE, OP_READ, OP_STOP } op_type_t;
+
+typedef struct {
+  op_type_t type;
+  uint8_t byte;
+  uint8_t *data;
+  size_t len;
+} op_t;
+
+typedef struct {
+  op_t ops[8];
+  int count;
+} link_t;
+
+static host_i2c_stats_t _stats;
+
+static esp_err_t _queue(i2c_cmd_handle_t cmd, op_type_t type, uint8_t byte,
+                        uint8_t *data, size_t len) {
+  link_t *link = (link_t *)cmd;
+
+  if (link->count >= (int)(sizeof(link->ops) / sizeof(op_t))) {
+    return ESP_ERR_NO_MEM;
+  }
+
+  op_t op = {type, byte, data, len};
+  link->ops[link->count++] = op;
+
+  return ESP_OK;
+}
+
+esp_err_t i2c_param_config(i2c_port_t port, const i2c_config_t *conf) {
+  return ESP_OK;
+}
+
+esp_err_t i2c_driver_install(i2c_port_t port, i2c_mode_t mode,
+                             size_t slv_rx_buf_len, size_t slv_tx_buf_len,
+                             int intr_alloc_flags) {
+  return ESP_OK;
+}
+
+esp_err_t i2c_driver_delete(i2c_port_t port) { return ESP_OK; }
+
+static int _timeout = 0;
+
+esp_err_t i2c_set_timeout(i2c_port_t port, int timeout) {
+  _timeout = timeout;
+  return ESP_OK;
+}
+
+esp_err_t i2c_get_timeout(i2c_port_t port, int *timeout) {
+  *timeout = _timeout;
+  return ESP_OK;
+}
+
+void periph_module_enable(periph_module_t module) {}
+void periph_module_disable(periph_module_t module) {}
+
+i2c_cmd_handle_t i2c_cmd_link_create(void) {
+  _stats.creates++;
+  return calloc(1, sizeof(link_t));
+}
+
+void i2c_cmd_link_delete(i2c_cmd_handle_t cmd) {
+  _stats.deletes++;
+  free(cmd);
+}
+
+esp_err_t i2c_master_start(i2c_cmd_handle_t cmd) {
+  return _queue(cmd, OP_START, 0, NULL, 0);
+}
+
+esp_err_t i2c_master_write_byte(i2c_cmd_handle_t cmd, uint8_t data,
+                                bool ack_en) {
+  return _queue(cmd, OP_WRITE_BYTE, data, NULL, 0);
+}
+
+esp_err_t i2c_master_write(i2c_cmd_handle_t cmd, uint8_t *data,
+                           size_t data_len, bool ack_en) {
+  return _queue(cmd, OP_WRITE, 0, data, data_len);
+}
+
+esp_err_t i2c_master_read(i2c_cmd_handle_t cmd, uint8_t *data,
+                          size_t data_len, i2c_ack_type_t ack) {
+  return _queue(cmd, OP_READ, 0, data, data_len);
+}
+
+esp_err_t i2c_master_stop(i2c_cmd_handle_t cmd) {
+  return _queue(cmd, OP_STOP, 0, NULL, 0);
+}
+
+// like the IDF v4.0 driver the items of the link are consumed as they are
+// executed (the byte count and data pointer of each write and read are
+// advanced in place) so executing a link again transfers no data
+esp_err_t i2c_master_cmd_begin(i2c_port_t port, i2c_cmd_handle_t cmd,
+                               TickType_t ticks_to_wait) {
+  link_t *link = (link_t *)cmd;
+  const uint8_t *send = NULL;
+  size_t send_len = 0;
+  uint8_t *recv = NULL;
+  size_t recv_len = 0;
+  uint8_t addr = 0;
+
+  _stats.begins++;
+
+  for (int i = 0; i < link->count; i++) {
+    op_t *op = &(link->ops[i]);
+
+    switch (op->type) {
+    case OP_WRITE_BYTE:
+      addr = op->byte >> 1;
+      break;
+    case OP_WRITE:
+      send = op->data;
+      send_len = op->len;
+      break;
+    case OP_READ:
+      recv = op->data;
+      recv_len = op->len;
+      break;
+    default:
+      break;
+    }
+
+    op->data += op->len;
+    op->len = 0;
+  }
+
+  _stats.bytes += send_len + recv_len;
+
+  if ((send_len > 0) && (recv_len > 0)) {
+    return i2c_sim_write_read(port, addr, send, send_len, recv, recv_len);
+  }
+
+  if (recv_len > 0) {
+    return i2c_sim_read(port, addr, recv, recv_len);
+  }
+
+  return i2c_sim_write(port, addr, send, send_len);
+}
+
+host_i2c_stats_t *host_i2c_stats(void) { return &_stats; }
@@ -0,0 +1,121 @@
+// host shim:  an in memory nvs, a single namespace is enough for the engines
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "nvs.h"
+#include "nvs_flash.h"
+
+#define HOST_NVS_MAX_KEYS 32
+#define HOST_NVS_KEY_LEN 16
+
+typedef struct {
+  char key[HOST_NVS_KEY_LEN];
+  void *value;
+  size_t length;
+} host_nvs_entry;
+
+static host_nvs_entry _entries[HOST_NVS_MAX_KEYS];
+
+static host_nvs_entry *_find(const char *key) {
+  for (int i = 0; i < HOST_NVS_MAX_KEYS; i++) {
+    if (_entries[i].value && (strcmp(_entries[i].key, key) == 0)) {
+      return &(_entries[i]);
+    }
+  }
+
+  return NULL;
+}
+
+esp_err_t nvs_flash_init(void) { return ESP_OK; }
+
+esp_err_t nvs_flash_erase(void) {
+  host_nvs_clear();
+  return ESP_OK;
+}
+
+esp_err_t nvs_open(const char *name, nvs_open_mode open_mode,
+                   nvs_handle *out_handle) {
+  *out_handle = 1;
+  return ESP_OK;
+}
+
+esp_err_t nvs_set_blob(nvs_handle handle, const char *key, const void *value,
+                       size_t length) {
+  host_nvs_entry *entry = _find(key);
+
+  if (strlen(key) >= HOST_NVS_KEY_LEN) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  for (int i = 0; (entry == NULL) && (i < HOST_NVS_MAX_KEYS); i++) {
+    if (_entries[i].value == NULL) {
+      entry = &(_entries[i]);
+      strcpy(entry->key, key);
+    }
+  }
+
+  if (entry == NULL) {
+    return ESP_ERR_NVS_NO_FREE_PAGES;
+  }
+
+  free(entry->value);
+  entry->value = malloc(length);
+  entry->length = length;
+  memcpy(entry->value, value, length);
+
+  return ESP_OK;
+}
+
+esp_err_t nvs_get_blob(nvs_handle handle, const char *key, void *out_value,
+                       size_t *length) {
+  host_nvs_entry *entry = _find(key);
+
+  if (entry == NULL) {
+    return ESP_ERR_NVS_NOT_FOUND;
+  }
+
+  // as nvs, a NULL out_value queries the length
+  if (out_value == NULL) {
+    *length = entry->length;
+    return ESP_OK;
+  }
+
+  if (*length < entry->length) {
+    return ESP_ERR_NVS_INVALID_LENGTH;
+  }
+
+  memcpy(out_value, entry->value, entry->length);
+  *length = entry->length;
+
+  return ESP_OK;
+}
+
+esp_err_t nvs_erase_key(nvs_handle handle, const char *key) {
+  host_nvs_entry *entry = _find(key);
+
+  if (entry == NULL) {
+    return ESP_ERR_NVS_NOT_FOUND;
+  }
+
+  free(entry->value);
+  memset(entry, 0x00, sizeof(host_nvs_entry));
+
+  return ESP_OK;
+}
+
+esp_err_t nvs_erase_all(nvs_handle handle) {
+  host_nvs_clear();
+  return ESP_OK;
+}
+
+esp_err_t nvs_commit(nvs_handle handle) { return ESP_OK; }
+
+void nvs_close(nvs_handle handle) {}
+
+void host_nvs_clear(void) {
+  for (int i = 0; i < HOST_NVS_MAX_KEYS; i++) {
+    free(_entries[i].value);
+    memset(&(_entries[i]), 0x00, sizeof(host_nvs_entry));
+  }
+}
@@ -0,0 +1,51 @@
+// host shim:  the configuration of the engines built for the host tests,
+// the buses are simulated (owb_sim, i2c_sim)
+#pragma once
+
+#define CONFIG_MCR_ENV "host"
+#define CONFIG_MCR_CMD_Q_MAX_DEPTH 30
+
+#define CONFIG_MCR_W1_BUSES 1
+#define CONFIG_MCR_W1_PIN 14
+#define CONFIG_MCR_W1_SIMULATED 1
+#define CONFIG_MCR_W1_SIM_TEMP_DEVICES 4
+#define CONFIG_MCR_W1_SIM_SWITCH_DEVICES 2
+#define CONFIG_MCR_W1_SIM_CRC_ERROR_EVERY 0
+#define CONFIG_MCR_DS_CONVERT_FREQUENCY_SECS 7
+#define CONFIG_MCR_DS_DISCOVER_FREQUENCY_SECS 30
+#define CONFIG_MCR_DS_REPORT_FREQUENCY_SECS 7
+#define CONFIG_MCR_DS_ENGINE_FREQUENCY_SECS 30
+#define CONFIG_MCR_DS_TEMP_CONVERT_POLL_MS 50
+#define CONFIG_MCR_DS_DISCOVER_TASK_PRIORITY 12
+#define CONFIG_MCR_DS_CONVERT_TASK_PRIORITY 13
+#define CONFIG_MCR_DS_REPORT_TASK_PRIORITY 13
+#define CONFIG_MCR_DS_COMMAND_TASK_PRIORITY 14
+
+#define CONFIG_MCR_I2C_PORTS 1
+#define CONFIG_MCR_I2C_SCL_PIN 22
+#define CONFIG_MCR_I2C_SDA_PIN 23
+#define CONFIG_MCR_I2C_SIMULATED 1
+#define CONFIG_MCR_I2C_SIM_SHT31_DEVICES 2
+#define CONFIG_MCR_I2C_SIM_SOIL_DEVICES 2
+#define CONFIG_MCR_I2C_SIM_MCP23008_DEVICES 2
+#define CONFIG_MCR_I2C_SWEEP_BUSES 2
+#define CONFIG_MCR_I2C_SHT31_REPEATABILITY 0
+#define CONFIG_MCR_I2C_DISCOVER_FREQUENCY_SECS 30
+#define CONFIG_MCR_I2C_REPORT_FREQUENCY_SECS 7
+#define CONFIG_MCR_I2C_ENGINE_FREQUENCY_SECS 7
+#define CONFIG_MCR_I2C_DISCOVER_TASK_PRIORITY 12
+#define CONFIG_MCR_I2C_REPORT_TASK_PRIORITY 13
+#define CONFIG_MCR_I2C_COMMAND_TASK_PRIORITY 14
+
+#define CONFIG_MCR_MQTT_HOST "localhost"
+#define CONFIG_MCR_MQTT_PORT 1883
+#define CONFIG_MCR_MQTT_USER "mqtt"
+#define CONFIG_MCR_MQTT_PASSWD "mqtt"
+#define CONFIG_MCR_MQTT_RINGBUFFER_PENDING_MSGS 128
+#define CONFIG_MCR_MQTT_INBOUND_MSG_WAIT_MS 1
+#define CONFIG_MCR_MQTT_INBOUND_RB_WAIT_MS 1000
+#define CONFIG_MCR_MQTT_OUTBOUND_MSG_WAIT_MS 30
+#define CONFIG_MCR_MQTT_STORE_RAM_BYTES 32768
+#define CONFIG_MCR_MQTT_REPLAY_INTERVAL_MS 100
+#define CONFIG_MCR_MQTT_TASK_PRIORITY 14
+#define CONFIG_MCR_MQTT_INBOUND_TASK_PRIORITY 10
@@ -0,0 +1,380 @@
+// host shim:  the definitions for the shim headers
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "driver/gpio.h"
+#include "driver/ledc.h"
+#include "esp_err.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/event_groups.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+static int64_t _now_us = 0;
+
+struct esp_timer {
+  esp_timer_create_args_t args;
+  int64_t fire_at_us; // zero when stopped
+};
+
+#define HOST_MAX_TIMERS 8
+static esp_timer_handle_t _timers[HOST_MAX_TIMERS];
+static int64_t _timer_latency_us = 0;
+
+int64_t esp_timer_get_time(void) { return _now_us; }
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args,
+                           esp_timer_handle_t *out_handle) {
+  for (int i = 0; i < HOST_MAX_TIMERS; i++) {
+    if (_timers[i] == NULL) {
+      _timers[i] = calloc(1, sizeof(struct esp_timer));
+      _timers[i]->args = *create_args;
+      *out_handle = _timers[i];
+      return ESP_OK;
+    }
+  }
+
+  return ESP_ERR_NO_MEM;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+  if (timer->fire_at_us != 0) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  timer->fire_at_us = _now_us + timeout_us + _timer_latency_us;
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+  if (timer->fire_at_us == 0) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  timer->fire_at_us = 0;
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+  for (int i = 0; i < HOST_MAX_TIMERS; i++) {
+    if (_timers[i] == timer) {
+      _timers[i] = NULL;
+    }
+  }
+
+  free(timer);
+  return ESP_OK;
+}
+
+// the earliest timer due by until_us, NULL when there is none
+static esp_timer_handle_t _next_timer(int64_t until_us) {
+  esp_timer_handle_t next = NULL;
+
+  for (int i = 0; i < HOST_MAX_TIMERS; i++) {
+    esp_timer_handle_t t = _timers[i];
+
+    if (t && t->fire_at_us && (t->fire_at_us <= until_us) &&
+        ((next == NULL) || (t->fire_at_us < next->fire_at_us))) {
+      next = t;
+    }
+  }
+
+  return next;
+}
+
+void host_set_timer_latency_us(int64_t us) { _timer_latency_us = us; }
+
+void host_advance_us(int64_t us) {
+  int64_t until_us = _now_us + us;
+  esp_timer_handle_t timer;
+
+  while ((timer = _next_timer(until_us)) != NULL) {
+    _now_us = timer->fire_at_us;
+    timer->fire_at_us = 0;
+    timer->args.callback(timer->args.arg);
+  }
+
+  _now_us = until_us;
+}
+
+void vTaskDelay(const TickType_t ticks) {
+  host_advance_us((int64_t)ticks * portTICK_PERIOD_MS * 1000);
+}
+
+static TaskHandle_t _current_task = (TaskHandle_t)1;
+static BaseType_t _scheduler_state = taskSCHEDULER_RUNNING;
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) { return _current_task; }
+BaseType_t xTaskGetSchedulerState(void) { return _scheduler_state; }
+
+void host_set_current_task(TaskHandle_t task) { _current_task = task; }
+void host_set_scheduler_state(BaseType_t state) { _scheduler_state = state; }
+
+TickType_t xTaskGetTickCount(void) {
+  return (TickType_t)(_now_us / (portTICK_PERIOD_MS * 1000));
+}
+
+void vTaskDelayUntil(TickType_t *const prev_wake, const TickType_t increment) {
+  TickType_t wake = *prev_wake + increment;
+  TickType_t now = xTaskGetTickCount();
+
+  if (wake > now) {
+    vTaskDelay(wake - now);
+  }
+
+  *prev_wake = wake;
+}
+
+// the priority of each task handle seen, a task not yet seen has the
+// priority of a task created without one (1)
+#define HOST_MAX_TASKS 16
+static struct {
+  TaskHandle_t handle;
+  UBaseType_t priority;
+} _priorities[HOST_MAX_TASKS];
+
+static UBaseType_t *_priority(TaskHandle_t task) {
+  task = (task == NULL) ? _current_task : task;
+
+  for (int i = 0; i < HOST_MAX_TASKS; i++) {
+    if (_priorities[i].handle == NULL) {
+      _priorities[i].handle = task;
+      _priorities[i].priority = 1;
+    }
+
+    if (_priorities[i].handle == task) {
+      return &(_priorities[i].priority);
+    }
+  }
+
+  fprintf(stderr, "more than %d tasks\n", HOST_MAX_TASKS);
+  abort();
+}
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task) { return *_priority(task); }
+
+void vTaskPrioritySet(TaskHandle_t task, UBaseType_t priority) {
+  *_priority(task) = priority;
+}
+
+char *pcTaskGetTaskName(TaskHandle_t task) { return (char *)"host"; }
+
+void vTaskSuspend(TaskHandle_t task) {}
+
+const char *esp_err_to_name(esp_err_t code) {
+  return (code == ESP_OK) ? "ESP_OK" : "ESP_FAIL";
+}
+
+struct host_sem {
+  bool mutex;
+  UBaseType_t count;
+  UBaseType_t max;
+};
+
+static SemaphoreHandle_t _sem_create(bool mutex, UBaseType_t max,
+                                     UBaseType_t initial) {
+  struct host_sem *sem = calloc(1, sizeof(struct host_sem));
+
+  sem->mutex = mutex;
+  sem->max = max;
+  sem->count = initial;
+
+  return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) { return _sem_create(true, 1, 1); }
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max,
+                                           UBaseType_t initial) {
+  return _sem_create(false, max, initial);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem) { free(sem); }
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t handle, TickType_t ticks_to_wait) {
+  struct host_sem *sem = (struct host_sem *)handle;
+
+  if (sem->count == 0) {
+    // nothing else runs to give the semaphore so a wait forever never ends
+    if (sem->mutex) {
+      fprintf(stderr, "mutex %p taken twice\n", handle);
+      abort();
+    }
+
+    if (ticks_to_wait == portMAX_DELAY) {
+      fprintf(stderr, "semaphore %p would never be given\n", handle);
+      abort();
+    }
+
+    vTaskDelay(ticks_to_wait);
+    return pdFALSE;
+  }
+
+  sem->count--;
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t handle) {
+  struct host_sem *sem = (struct host_sem *)handle;
+
+  if (sem->count == sem->max) {
+    return pdFALSE;
+  }
+
+  sem->count++;
+  return pdTRUE;
+}
+
+esp_err_t gpio_config(const gpio_config_t *config) { return ESP_OK; }
+esp_err_t gpio_set_level(gpio_num_t pin, uint32_t level) { return ESP_OK; }
+
+static host_ledc_fade_t _fades[HOST_LEDC_MAX_FADES];
+static uint32_t _fade_count = 0;
+
+esp_err_t ledc_set_fade_time_and_start(ledc_mode_t speed_mode,
+                                       ledc_channel_t channel,
+                                       uint32_t target_duty,
+                                       uint32_t max_fade_time_ms,
+                                       ledc_fade_mode_t fade_mode) {
+  if (_fade_count < HOST_LEDC_MAX_FADES) {
+    host_ledc_fade_t fade = {_now_us, speed_mode, channel, target_duty,
+                             max_fade_time_ms};
+    _fades[_fade_count++] = fade;
+  }
+
+  return ESP_OK;
+}
+
+const host_ledc_fade_t *host_ledc_fades(uint32_t *count) {
+  *count = _fade_count;
+  return _fades;
+}
+
+void host_ledc_clear(void) { _fade_count = 0; }
+
+uint32_t esp_random(void) { return (uint32_t)rand(); }
+
+struct host_event_group {
+  EventBits_t bits;
+};
+
+EventGroupHandle_t xEventGroupCreate(void) {
+  return calloc(1, sizeof(struct host_event_group));
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t evg) {
+  return ((struct host_event_group *)evg)->bits;
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t evg, EventBits_t bits) {
+  return ((struct host_event_group *)evg)->bits |= bits;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t evg, EventBits_t bits) {
+  struct host_event_group *group = (struct host_event_group *)evg;
+  EventBits_t prev = group->bits;
+
+  group->bits &= ~bits;
+  return prev;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t evg, EventBits_t bits,
+                                BaseType_t clear_on_exit, BaseType_t wait_all,
+                                TickType_t ticks_to_wait) {
+  struct host_event_group *group = (struct host_event_group *)evg;
+  EventBits_t set = group->bits & bits;
+  bool satisfied = wait_all ? (set == bits) : (set != 0);
+
+  if (satisfied == false) {
+    // nothing else runs to set the bits so a wait forever never ends
+    if (ticks_to_wait == portMAX_DELAY) {
+      fprintf(stderr, "event group %p bits 0x%x would never be set\n", evg,
+              bits);
+      abort();
+    }
+
+    // a timer may set the bits while waiting
+    vTaskDelay(ticks_to_wait);
+    set = group->bits & bits;
+    satisfied = wait_all ? (set == bits) : (set != 0);
+  }
+
+  EventBits_t result = group->bits;
+
+  if (satisfied && clear_on_exit) {
+    group->bits &= ~bits;
+  }
+
+  return result;
+}
+
+struct host_queue {
+  UBaseType_t length;
+  UBaseType_t item_size;
+  UBaseType_t count;
+  UBaseType_t head;
+  uint8_t items[];
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+  struct host_queue *queue =
+      calloc(1, sizeof(struct host_queue) + (length * item_size));
+
+  queue->length = length;
+  queue->item_size = item_size;
+
+  return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue) { free(queue); }
+
+BaseType_t xQueueSendToBack(QueueHandle_t handle, const void *item,
+                            TickType_t ticks_to_wait) {
+  struct host_queue *queue = (struct host_queue *)handle;
+
+  if (queue->count == queue->length) {
+    return pdFALSE;
+  }
+
+  UBaseType_t tail = (queue->head + queue->count) % queue->length;
+  memcpy(&(queue->items[tail * queue->item_size]), item, queue->item_size);
+  queue->count++;
+
+  return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t handle, void *item,
+                         TickType_t ticks_to_wait) {
+  struct host_queue *queue = (struct host_queue *)handle;
+
+  if (queue->count == 0) {
+    if (ticks_to_wait == portMAX_DELAY) {
+      fprintf(stderr, "queue %p would never receive\n", handle);
+      abort();
+    }
+
+    vTaskDelay(ticks_to_wait);
+    return pdFALSE;
+  }
+
+  memcpy(item, &(queue->items[queue->head * queue->item_size]),
+         queue->item_size);
+  queue->head = (queue->head + 1) % queue->length;
+  queue->count--;
+
+  return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+  return ((struct host_queue *)queue)->count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t handle) {
+  struct host_queue *queue = (struct host_queue *)handle;
+
+  return queue->length - queue->count;
+}
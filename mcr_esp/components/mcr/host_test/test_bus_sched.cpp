@@ -0,0 +1,200 @@
+/*
+    test_bus_sched.cpp - Master Control Remote Engine Bus Scheduler Host Test
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+// the waiters of the bus scheduler that do not block (the passes run by the
+// executor):  registered once, handed the bus by give() in priority order
+// and notified so the pass continues without polling the bus.  the shim is
+// single threaded so only takes that do not block are used.
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+
+#include "engines/bus_sched.hpp"
+#include "esp_timer.h"
+#include "host_test.h"
+
+using namespace mcr;
+
+static const EventBits_t yield_bit = BIT0;
+
+static EventGroupHandle_t evg = nullptr;
+static mcrBusScheduler_t *sched = nullptr;
+
+static void *notified_arg = nullptr;
+static uint32_t notified = 0;
+
+static void notify(void *arg) {
+  notified_arg = arg;
+  notified++;
+}
+
+static void fresh() {
+  delete sched;
+
+  if (evg == nullptr) {
+    evg = xEventGroupCreate();
+  }
+
+  xEventGroupClearBits(evg, yield_bit);
+  sched = new mcrBusScheduler(evg, yield_bit);
+
+  notified_arg = nullptr;
+  notified = 0;
+}
+
+static BusWaiter_t waiter(void *arg) {
+  BusWaiter_t w = {};
+
+  w.notify = &notify;
+  w.arg = arg;
+
+  return w;
+}
+
+static bool yieldBitSet() { return (xEventGroupGetBits(evg) & yield_bit); }
+
+static void free_bus_is_taken_at_once() {
+  fresh();
+
+  BusWaiter_t w = waiter(nullptr);
+
+  CHECK(sched->take(BUS_REPORT, 0, &w));
+  CHECK(w.waiting == false);
+
+  sched->give();
+  CHECK(sched->take(BUS_DISCOVER, 0));
+  sched->give();
+
+  CHECK(notified == 0);
+}
+
+static void busy_bus_registers_the_waiter_once() {
+  fresh();
+
+  BusWaiter_t w = waiter(&w);
+
+  CHECK(sched->take(BUS_REPORT));
+
+  CHECK(sched->take(BUS_DISCOVER, 0, &w) == false);
+  CHECK(w.waiting);
+
+  // the pass continues (e.g. its fallback wait passed) before the bus is
+  // handed to it
+  CHECK(sched->take(BUS_DISCOVER, 0, &w) == false);
+  CHECK(sched->yieldRequested() == false);
+
+  sched->give();
+  CHECK(notified == 1);
+  CHECK(notified_arg == &w);
+  CHECK(w.granted);
+
+  CHECK(sched->take(BUS_DISCOVER, 0, &w));
+  sched->give();
+
+  // registered once so the bus is not handed to the waiter again
+  CHECK(notified == 1);
+  CHECK(sched->take(BUS_REPORT, 0));
+  sched->give();
+}
+
+static void handed_bus_is_held_for_the_waiter() {
+  fresh();
+
+  BusWaiter_t w = waiter(&w);
+
+  CHECK(sched->take(BUS_REPORT));
+  CHECK(sched->take(BUS_CONVERT, 0, &w) == false);
+
+  host_advance_us(5000);
+  sched->give();
+
+  // handed to the waiter, not taken by whoever asks first
+  CHECK(sched->take(BUS_COMMAND, 0) == false);
+  CHECK(sched->take(BUS_CONVERT, 0, &w));
+
+  mcrHistogram_t waits[BUS_JOB_CLASSES];
+
+  sched->give();
+  sched->snapshotWaits(waits);
+
+  CHECK(waits[BUS_CONVERT].count() == 1);
+  CHECK(waits[BUS_CONVERT].max() >= 5000);
+}
+
+static void higher_priority_waiter_is_handed_the_bus_first() {
+  fresh();
+
+  BusWaiter_t report = waiter(&report);
+  BusWaiter_t command = waiter(&command);
+
+  CHECK(sched->take(BUS_DISCOVER));
+
+  CHECK(sched->take(BUS_REPORT, 0, &report) == false);
+  CHECK(yieldBitSet());
+
+  CHECK(sched->take(BUS_COMMAND, 0, &command) == false);
+  CHECK(sched->yieldRequested());
+
+  sched->give();
+  CHECK(notified == 1);
+  CHECK(notified_arg == &command);
+  CHECK(report.granted == false);
+
+  // report is still waiting while command holds the bus
+  CHECK(sched->take(BUS_COMMAND, 0, &command));
+  CHECK(yieldBitSet() == false);
+
+  sched->give();
+  CHECK(notified == 2);
+  CHECK(notified_arg == &report);
+
+  CHECK(sched->take(BUS_REPORT, 0, &report));
+  sched->give();
+}
+
+static void give_by_non_holder_is_ignored() {
+  fresh();
+
+  BusWaiter_t w = waiter(&w);
+
+  CHECK(sched->take(BUS_REPORT));
+  CHECK(sched->take(BUS_DISCOVER, 0, &w) == false);
+
+  sched->give();
+  CHECK(notified == 1);
+
+  // until the waiter takes the bus there is no holder task to give it
+  sched->give();
+  CHECK(notified == 1);
+  CHECK(sched->take(BUS_REPORT, 0) == false);
+
+  CHECK(sched->take(BUS_DISCOVER, 0, &w));
+  sched->give();
+}
+
+int main() {
+  RUN(free_bus_is_taken_at_once);
+  RUN(busy_bus_registers_the_waiter_once);
+  RUN(handed_bus_is_held_for_the_waiter);
+  RUN(higher_priority_waiter_is_handed_the_bus_first);
+  RUN(give_by_non_holder_is_ignored);
+
+  return HOST_TEST_RESULT();
+}
@@ -0,0 +1,158 @@
+/*
+    test_ds_engine.cpp - Master Control Remote DS Engine Host Test
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+// the passes of mcrDS (engines/ds.cpp) run against the simulated bus
+// (owb_sim) as the phase tasks run them.  the bus time of each phase is
+// reported from the simulated bus stats.
+
+#include <cstdint>
+#include <cstdio>
+
+#include "engine_fakes.hpp"
+#include "engines/ds.hpp"
+#include "host_test.h"
+
+#define TEMP_DEVICES CONFIG_MCR_W1_SIM_TEMP_DEVICES
+#define DEVICES (TEMP_DEVICES + (CONFIG_MCR_W1_SIM_SWITCH_DEVICES * 3))
+
+namespace mcr {
+
+class mcrDSHostTest {
+public:
+  static mcrDS_t *ds() {
+    static mcrDS_t *ds = nullptr;
+
+    if (ds == nullptr) {
+      ds = mcrDS::instance(0);
+      ds->initBus();
+    }
+
+    return ds;
+  }
+
+  static owb_sim_driver_info *sim() { return ds()->_sim; }
+
+  // runs a pass until complete (as passUntilComplete()), the stats are of
+  // the bus activity of the pass
+  static owb_sim_stats pass(TaskTypes_t phase, const char *name) {
+    owb_sim_clear_stats(sim());
+    ds()->passUntilComplete(phase);
+
+    const owb_sim_stats &stats = sim()->stats;
+    printf("  %-8s bus_us=%-6llu resets=%-3u bits w=%-5u r=%u\n", name,
+           (unsigned long long)stats.bus_us, stats.resets, stats.bits_written,
+           stats.bits_read);
+
+    return stats;
+  }
+
+  static bool bitsSet(EventBits_t bits) {
+    return (ds()->waitFor(bits, 0) & bits) == bits;
+  }
+
+  static bool devicesAvailable() {
+    return bitsSet(ds()->devicesAvailableBit());
+  }
+
+  static bool tempAvailable() {
+    return bitsSet(ds()->temperatureAvailableBit());
+  }
+
+  static uint32_t knownDevices() { return ds()->numKnownDevices(); }
+
+  // the bus is not held (e.g. given back after a failed reset)
+  static bool busFree() {
+    if (ds()->takeBus(BUS_COMMAND, 0) == false) {
+      return false;
+    }
+
+    ds()->giveBus();
+    return true;
+  }
+};
+} // namespace mcr
+
+using namespace mcr;
+
+static void discover_finds_every_device() {
+  owb_sim_stats stats = mcrDSHostTest::pass(DISCOVER, "discover");
+
+  CHECK(mcrDSHostTest::knownDevices() == DEVICES);
+  CHECK(mcrDSHostTest::devicesAvailable());
+  CHECK(stats.crc_errors == 0);
+}
+
+static void convert_makes_temperatures_available() {
+  int64_t start = esp_timer_get_time();
+  owb_sim_stats stats = mcrDSHostTest::pass(CONVERT, "convert");
+
+  CHECK(mcrDSHostTest::tempAvailable());
+  CHECK((esp_timer_get_time() - start) >= (750 * 1000));
+  CHECK(stats.resets > 0);
+}
+
+static void report_publishes_every_device() {
+  host_mqtt_clear();
+  owb_sim_stats stats = mcrDSHostTest::pass(REPORT, "report");
+
+  // the readings are serialized as msgpack, the strings are in the clear
+  CHECK(host_mqtt_published_with("ds/") == DEVICES);
+  CHECK(host_mqtt_published_with("temp") == TEMP_DEVICES);
+  CHECK(stats.crc_errors == 0);
+}
+
+// the bus is taken once for the pass and each device read begins with the
+// only reset of that device (the reset of the take for the first device) so
+// the bus time is the reads plus a reset per device
+static void report_resets_the_bus_once_per_device() {
+  owb_sim_stats stats = mcrDSHostTest::pass(REPORT, "report");
+  const uint64_t bits = stats.bits_written + stats.bits_read;
+
+  CHECK(stats.resets == DEVICES);
+  CHECK(stats.reset_errors == 0);
+  CHECK(stats.bus_us ==
+        ((DEVICES * OWB_SIM_RESET_US) + (bits * OWB_SIM_SLOT_US)));
+}
+
+// a failed bus reset (e.g. the receive of the rmt driver timed out) ends the
+// pass and the bus is given back
+static void reset_failure_ends_the_pass() {
+  owb_sim_inject &inject = mcrDSHostTest::sim()->inject;
+
+  inject.reset_error_every = 1;
+  owb_sim_stats convert = mcrDSHostTest::pass(CONVERT, "convert");
+  owb_sim_stats report = mcrDSHostTest::pass(REPORT, "report");
+  inject.reset_error_every = 0;
+
+  CHECK(convert.reset_errors == 1);
+  CHECK(mcrDSHostTest::tempAvailable() == false);
+  CHECK(report.reset_errors == 1);
+  CHECK(mcrDSHostTest::busFree());
+}
+
+int main() {
+  RUN(discover_finds_every_device);
+  RUN(convert_makes_temperatures_available);
+  RUN(report_publishes_every_device);
+  RUN(report_resets_the_bus_once_per_device);
+  RUN(reset_failure_ends_the_pass);
+
+  return HOST_TEST_RESULT();
+}
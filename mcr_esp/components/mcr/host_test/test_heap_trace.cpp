@@ -0,0 +1,173 @@
+/*
+    test_heap_trace.cpp - Master Control Remote Heap Trace Host Test
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+// the heap trace accounting (built with CONFIG_MCR_HEAP_TRACE) under a
+// simulated workload:  operator new / delete of this executable are the
+// traced allocators and tasks are switched via the FreeRTOS shim.
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "freertos/task.h"
+#include "host_test.h"
+#include "misc/heap_trace.hpp"
+
+using namespace mcr;
+
+#define TASK(n) ((TaskHandle_t)(uintptr_t)(n))
+
+static HeapTagStats_t stats[HEAP_TAG_MAX];
+
+static const HeapTagStats_t &tag_stats(HeapTag_t tag) {
+  mcrHeapTrace::snapshot(stats);
+  return stats[tag];
+}
+
+// each pass of the workload builds a document (like Reading::json) within a
+// scope, a message from another task is outside of any scope.
+//
+// NOTE:  the allocators are called directly since a new expression may be
+//        elided by the compiler
+static void simulated_workload() {
+  const uint32_t passes = 100;
+
+  mcrHeapTrace::snapshot(stats, true);
+  host_set_current_task(TASK(1));
+
+  for (uint32_t pass = 0; pass < passes; pass++) {
+    void *doc = nullptr;
+
+    {
+      mcrHeapScope scope(HEAP_TAG_READING_JSON);
+      doc = ::operator new(512);
+    }
+
+    CHECK(tag_stats(HEAP_TAG_READING_JSON).live_bytes == 512);
+
+    // freed outside the scope, the free is attributed to the allocation
+    ::operator delete(doc);
+
+    host_set_current_task(TASK(2));
+    ::operator delete(::operator new(sizeof(pass)));
+    host_set_current_task(TASK(1));
+  }
+
+  const HeapTagStats_t &json = tag_stats(HEAP_TAG_READING_JSON);
+  CHECK(json.allocs == passes);
+  CHECK(json.frees == passes);
+  CHECK(json.bytes == (passes * 512));
+  CHECK(json.live_bytes == 0);
+  CHECK(json.peak_bytes == 512);
+
+  CHECK(tag_stats(HEAP_TAG_OTHER).allocs >= passes);
+}
+
+static void nested_scopes_restore() {
+  host_set_current_task(TASK(1));
+
+  mcrHeapScope outer(HEAP_TAG_INCOMING_MSG);
+  CHECK(mcrHeapTrace::currentTag() == HEAP_TAG_INCOMING_MSG);
+
+  {
+    mcrHeapScope inner(HEAP_TAG_CMD_FACTORY);
+    CHECK(mcrHeapTrace::currentTag() == HEAP_TAG_CMD_FACTORY);
+
+    // the scope is per task
+    host_set_current_task(TASK(2));
+    CHECK(mcrHeapTrace::currentTag() == HEAP_TAG_OTHER);
+    host_set_current_task(TASK(1));
+  }
+
+  CHECK(mcrHeapTrace::currentTag() == HEAP_TAG_INCOMING_MSG);
+}
+
+static void explicit_records_and_reset() {
+  mcrHeapTrace::snapshot(stats, true);
+
+  // call sites using malloc() (e.g. i2c command links) record explicitly
+  mcrHeapTrace::recordAlloc(HEAP_TAG_I2C_CMD_LINK, 0);
+  mcrHeapTrace::recordAlloc(HEAP_TAG_I2C_CMD_LINK, 0);
+  mcrHeapTrace::recordFree(HEAP_TAG_I2C_CMD_LINK, 0);
+  CHECK(tag_stats(HEAP_TAG_I2C_CMD_LINK).allocs == 2);
+  CHECK(tag_stats(HEAP_TAG_I2C_CMD_LINK).frees == 1);
+
+  mcrHeapTrace::recordAlloc(HEAP_TAG_READING_JSON, 100);
+  mcrHeapTrace::recordAlloc(HEAP_TAG_READING_JSON, 50);
+  mcrHeapTrace::recordFree(HEAP_TAG_READING_JSON, 100);
+
+  // a reset zeroes the counts, what is still allocated remains live
+  mcrHeapTrace::snapshot(stats, true);
+  CHECK(stats[HEAP_TAG_READING_JSON].peak_bytes == 150);
+
+  const HeapTagStats_t &json = tag_stats(HEAP_TAG_READING_JSON);
+  CHECK(json.allocs == 0);
+  CHECK(json.bytes == 0);
+  CHECK(json.live_bytes == 50);
+  CHECK(json.peak_bytes == 50);
+
+  // a free larger than what is live does not underflow
+  mcrHeapTrace::recordFree(HEAP_TAG_READING_JSON, 100);
+  CHECK(tag_stats(HEAP_TAG_READING_JSON).live_bytes == 0);
+}
+
+static void full_scope_table_counts_other() {
+  std::vector<std::unique_ptr<mcrHeapScope>> scopes;
+
+  for (uint32_t i = 0; i < mcrHeapTrace::max_scopes; i++) {
+    host_set_current_task(TASK(10 + i));
+    scopes.emplace_back(new mcrHeapScope(HEAP_TAG_CMD_FACTORY));
+    CHECK(mcrHeapTrace::currentTag() == HEAP_TAG_CMD_FACTORY);
+  }
+
+  host_set_current_task(TASK(10 + mcrHeapTrace::max_scopes));
+  {
+    mcrHeapScope scope(HEAP_TAG_CMD_FACTORY);
+    CHECK(mcrHeapTrace::currentTag() == HEAP_TAG_OTHER);
+  }
+
+  for (uint32_t i = 0; i < mcrHeapTrace::max_scopes; i++) {
+    host_set_current_task(TASK(10 + i));
+    scopes[i].reset();
+    CHECK(mcrHeapTrace::currentTag() == HEAP_TAG_OTHER);
+  }
+
+  host_set_current_task(TASK(1));
+}
+
+static void before_scheduler_is_other() {
+  host_set_current_task(TASK(1));
+  mcrHeapScope scope(HEAP_TAG_READING_JSON);
+
+  host_set_scheduler_state(taskSCHEDULER_NOT_STARTED);
+  CHECK(mcrHeapTrace::currentTag() == HEAP_TAG_OTHER);
+  host_set_scheduler_state(taskSCHEDULER_RUNNING);
+}
+
+int main() {
+  RUN(simulated_workload);
+  RUN(nested_scopes_restore);
+  RUN(explicit_records_and_reset);
+  RUN(full_scope_table_counts_other);
+  RUN(before_scheduler_is_other);
+
+  return HOST_TEST_RESULT();
+}
@@ -0,0 +1,147 @@
+/*
+    test_i2c_engine.cpp - Master Control Remote I2C Engine Host Test
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+// the passes of mcrI2c (engines/i2c.cpp) run against the simulated devices
+// (i2c_sim) of a mixed population (SHT31, seesaw soil and MCP23008) as the
+// phase tasks run them.  the time of the report pass is compared to reading
+// the devices one after the other.
+
+#include <cstdint>
+#include <cstdio>
+
+#include "engine_fakes.hpp"
+#include "engines/i2c.hpp"
+#include "host_test.h"
+
+#define SHT31_DEVICES CONFIG_MCR_I2C_SIM_SHT31_DEVICES
+#define SOIL_DEVICES CONFIG_MCR_I2C_SIM_SOIL_DEVICES
+#define MCP23008_DEVICES CONFIG_MCR_I2C_SIM_MCP23008_DEVICES
+#define DEVICES (SHT31_DEVICES + SOIL_DEVICES + MCP23008_DEVICES)
+
+namespace mcr {
+
+class mcrI2cHostTest {
+public:
+  static mcrI2c_t *i2c() {
+    static mcrI2c_t *i2c = nullptr;
+
+    if (i2c == nullptr) {
+      i2c = mcrI2c::instance(0);
+      i2c->initBus();
+    }
+
+    return i2c;
+  }
+
+  // runs a pass until complete (as passUntilComplete()), returns the time
+  // the pass took
+  static int64_t pass(TaskTypes_t phase, const char *name) {
+    int64_t start = esp_timer_get_time();
+
+    i2c_sim_clear_stats(0);
+    i2c()->passUntilComplete(phase);
+
+    int64_t pass_us = esp_timer_get_time() - start;
+    const i2c_sim_stats *stats = i2c_sim_get_stats(0);
+    printf("  %-8s pass_us=%-7lld bus_us=%-6llu transactions=%-3u nacks=%u\n",
+           name, (long long)pass_us, (unsigned long long)stats->bus_us,
+           stats->transactions, stats->nacks);
+
+    return pass_us;
+  }
+
+  static uint32_t knownDevices() { return i2c()->numKnownDevices(); }
+
+  // the time to read the known devices one after the other:  the waits of
+  // each device (e.g. the SHT31 measurement) do not overlap
+  static int64_t serialReadUs() {
+    int64_t read_us = 0;
+
+    mcrI2c::DeviceList_t devs = i2c()->devices();
+    for (auto &item : *devs) {
+      read_us += findDriver(item.second->devAddr())->convert_us;
+    }
+
+    return read_us;
+  }
+
+  // the bus is not held (e.g. while a reading is published)
+  static bool busFree() {
+    if (i2c()->takeBus(BUS_COMMAND, 0) == false) {
+      return false;
+    }
+
+    i2c()->giveBus();
+    return true;
+  }
+
+private:
+  static const i2cDriver_t *findDriver(uint8_t addr) {
+    return mcrI2c::findDriver(addr);
+  }
+};
+} // namespace mcr
+
+using namespace mcr;
+
+static uint32_t published_holding_bus = 0;
+
+static void check_bus_free() {
+  published_holding_bus += (mcrI2cHostTest::busFree() == false);
+}
+
+static void discover_finds_every_device() {
+  mcrI2cHostTest::pass(DISCOVER, "discover");
+
+  CHECK(mcrI2cHostTest::knownDevices() == DEVICES);
+}
+
+// the waits of the devices overlap the steps of the others so the pass is
+// shorter than the longest wait plus the steps, not the sum of the waits
+static void report_interleaves_mixed_devices() {
+  host_mqtt_clear();
+  int64_t pass_us = mcrI2cHostTest::pass(REPORT, "report");
+  int64_t serial_us = mcrI2cHostTest::serialReadUs();
+
+  printf("  serial   read_us=%lld\n", (long long)serial_us);
+
+  CHECK(host_mqtt_published_with("i2c/") == DEVICES);
+  CHECK(pass_us < serial_us);
+}
+
+static void report_publishes_without_the_bus() {
+  host_mqtt_clear();
+  published_holding_bus = 0;
+
+  host_mqtt_on_publish(&check_bus_free);
+  mcrI2cHostTest::pass(REPORT, "report");
+  host_mqtt_on_publish(nullptr);
+
+  CHECK(host_mqtt_published_with("i2c/") == DEVICES);
+  CHECK(published_holding_bus == 0);
+}
+
+int main() {
+  RUN(discover_finds_every_device);
+  RUN(report_interleaves_mixed_devices);
+  RUN(report_publishes_without_the_bus);
+
+  return HOST_TEST_RESULT();
+}
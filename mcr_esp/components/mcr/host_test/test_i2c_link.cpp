@@ -0,0 +1,133 @@
+/*
+    test_i2c_link.cpp - Master Control Remote I2C Command Link Host Test
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+// device reads with a command link per transaction (see devs/i2c_link.hpp)
+// executed by the driver shim (shim/driver/i2c.h) which, like the driver,
+// consumes the items of a link as it executes
+
+#include <cstdint>
+
+#include <driver/i2c.h>
+
+#include "devs/i2c_link.hpp"
+#include "drivers/i2c_sim.h"
+#include "esp_timer.h"
+#include "host_test.h"
+
+using namespace mcr;
+
+#define SHT31 0x44
+#define MCP23008 0x20
+
+// the single shot SHT31 read of mcrI2c:  WRITE, (WAIT), READ
+static const uint8_t sht31_measure[] = {0x24, 0x00};
+
+// same as mcrI2c::busTransaction()
+static esp_err_t transaction(uint8_t addr, const uint8_t *send,
+                             uint32_t send_len, uint8_t *recv,
+                             uint32_t recv_len) {
+  i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+
+  i2cQueueTransaction(cmd, addr, send, send_len, recv, recv_len);
+  esp_err_t esp_rc = i2c_master_cmd_begin(0, cmd, 0);
+  i2c_cmd_link_delete(cmd);
+
+  return esp_rc;
+}
+
+static float sht31_tc(const uint8_t *buff) {
+  return (((buff[0] << 8) | buff[1]) * 175.0 / 0xffff) - 45.0;
+}
+
+static void replayed_link_transfers_nothing() {
+  uint8_t buff[6] = {};
+
+  i2c_sim_initialize(0, false);
+  i2c_sim_device *dev = i2c_sim_add_device(I2C_SIM_SHT31, 0, 0, SHT31);
+
+  dev->temp_c = 20;
+  CHECK(transaction(SHT31, sht31_measure, 2, nullptr, 0) == ESP_OK);
+  host_advance_us(15000);
+
+  i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+  i2cQueueTransaction(cmd, SHT31, nullptr, 0, buff, sizeof(buff));
+
+  host_i2c_stats_t before = *host_i2c_stats();
+  CHECK(i2c_master_cmd_begin(0, cmd, 0) == ESP_OK);
+  CHECK((host_i2c_stats()->bytes - before.bytes) == sizeof(buff));
+
+  float tc = sht31_tc(buff);
+  CHECK((tc > 19.99) && (tc < 20.01));
+
+  // the items were consumed by the first execution
+  dev->temp_c = 30;
+  CHECK(transaction(SHT31, sht31_measure, 2, nullptr, 0) == ESP_OK);
+  host_advance_us(15000);
+
+  before = *host_i2c_stats();
+  i2c_master_cmd_begin(0, cmd, 0);
+  CHECK((host_i2c_stats()->bytes - before.bytes) == 0);
+
+  tc = sht31_tc(buff);
+  CHECK((tc > 19.99) && (tc < 20.01));
+
+  i2c_cmd_link_delete(cmd);
+}
+
+static void link_per_transaction() {
+  uint8_t sht31_buff[6] = {};
+  uint8_t mcp_buff[11] = {};
+  const uint8_t gpio_reg[] = {0x00};
+  const uint32_t passes = 50;
+
+  i2c_sim_initialize(0, false);
+  i2c_sim_device *sht31_dev = i2c_sim_add_device(I2C_SIM_SHT31, 0, 0, SHT31);
+  i2c_sim_device *mcp_dev = i2c_sim_add_device(I2C_SIM_MCP23008, 0, 0, MCP23008);
+
+  host_i2c_stats_t before = *host_i2c_stats();
+
+  for (uint32_t pass = 0; pass < passes; pass++) {
+    sht31_dev->temp_c = pass;
+    mcp_dev->regs[0x0a] = pass;
+
+    CHECK(transaction(SHT31, sht31_measure, 2, nullptr, 0) == ESP_OK);
+    host_advance_us(15000);
+    CHECK(transaction(SHT31, nullptr, 0, sht31_buff, 6) == ESP_OK);
+    CHECK(transaction(MCP23008, gpio_reg, 1, mcp_buff, 11) == ESP_OK);
+
+    // each transaction receives the current data
+    float tc = sht31_tc(sht31_buff);
+    CHECK((tc > (pass - 0.01)) && (tc < (pass + 0.01)));
+    CHECK(mcp_buff[0x0a] == pass);
+  }
+
+  host_i2c_stats_t *after = host_i2c_stats();
+
+  CHECK((after->creates - before.creates) == (passes * 3));
+  CHECK((after->deletes - before.deletes) == (passes * 3));
+  CHECK((after->begins - before.begins) == (passes * 3));
+}
+
+int main() {
+  RUN(replayed_link_transfers_nothing);
+  RUN(link_per_transaction);
+
+  return HOST_TEST_RESULT();
+}
@@ -0,0 +1,170 @@
+/*
+    test_i2c_sim.c - Master Control Remote Simulated I2C Host Test
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+// the simulated i2c devices as seen by mcrI2c with CONFIG_MCR_I2C_SIMULATED
+
+#include <math.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "drivers/i2c_sim.h"
+#include "esp_timer.h"
+#include "host_test.h"
+
+#define SHT31 0x44
+#define SEESAW 0x36
+#define MCP23008 0x20
+#define MUX 0x70
+
+// same algorithm as mcrI2c::crcSHT31()
+static bool crc_sht31(const uint8_t *data) {
+  uint8_t crc = 0xff;
+
+  for (int j = 0; j < 2; j++) {
+    crc ^= data[j];
+
+    for (int i = 0; i < 8; i++) {
+      crc = (crc & 0x80) ? (crc << 1) ^ 0x31 : (crc << 1);
+    }
+  }
+
+  return (crc == data[2]);
+}
+
+static void sht31_crc_reference() {
+  // datasheet example: 0xbeef has crc 0x92
+  const uint8_t data[] = {0xbe, 0xef, 0x92};
+
+  CHECK(crc_sht31(data));
+}
+
+static void sht31_read_before_ready_is_nacked() {
+  const uint8_t measure[] = {0x24, 0x00}; // high repeatability, no stretch
+  uint8_t buff[6] = {};
+
+  i2c_sim_initialize(0, false);
+  i2c_sim_device *dev = i2c_sim_add_device(I2C_SIM_SHT31, 0, 0, SHT31);
+  dev->temp_c = 21.5;
+  dev->rh = 40.0;
+
+  CHECK(i2c_sim_write(0, SHT31, measure, sizeof(measure)) == ESP_OK);
+  CHECK(i2c_sim_read(0, SHT31, buff, sizeof(buff)) == ESP_FAIL);
+  CHECK(i2c_sim_get_stats(0)->nacks == 1);
+
+  host_advance_us(15000);
+  CHECK(i2c_sim_read(0, SHT31, buff, sizeof(buff)) == ESP_OK);
+  CHECK(crc_sht31(&(buff[0])));
+  CHECK(crc_sht31(&(buff[3])));
+
+  float tc = (((buff[0] << 8) | buff[1]) * 175.0 / 0xffff) - 45.0;
+  float rh = ((buff[3] << 8) | buff[4]) * 100.0 / 0xffff;
+  CHECK(fabsf(tc - 21.5) < 0.01);
+  CHECK(fabsf(rh - 40.0) < 0.01);
+
+  // the measurement is consumed by the read
+  CHECK(i2c_sim_read(0, SHT31, buff, sizeof(buff)) == ESP_FAIL);
+}
+
+static void sht31_clock_stretch_waits() {
+  const uint8_t measure[] = {0x2c, 0x06}; // high repeatability, stretch
+  uint8_t buff[6] = {};
+
+  i2c_sim_initialize(0, false);
+  i2c_sim_add_device(I2C_SIM_SHT31, 0, 0, SHT31);
+
+  int64_t start = esp_timer_get_time();
+  CHECK(i2c_sim_write(0, SHT31, measure, sizeof(measure)) == ESP_OK);
+  CHECK(i2c_sim_read(0, SHT31, buff, sizeof(buff)) == ESP_OK);
+  CHECK((esp_timer_get_time() - start) >= 15000);
+  CHECK(crc_sht31(&(buff[0])));
+}
+
+static void seesaw_requires_delay() {
+  const uint8_t moisture[] = {0x0f, 0x10};
+  uint8_t buff[2] = {};
+
+  i2c_sim_initialize(0, false);
+  i2c_sim_device *dev = i2c_sim_add_device(I2C_SIM_SEESAW_SOIL, 0, 0, SEESAW);
+  dev->moisture = 742;
+
+  // without a delay between the write and the read the seesaw nacks
+  CHECK(i2c_sim_write_read(0, SEESAW, moisture, sizeof(moisture), buff,
+                           sizeof(buff)) == ESP_FAIL);
+
+  CHECK(i2c_sim_write(0, SEESAW, moisture, sizeof(moisture)) == ESP_OK);
+  host_advance_us(3000);
+  CHECK(i2c_sim_read(0, SEESAW, buff, sizeof(buff)) == ESP_OK);
+  CHECK(((buff[0] << 8) | buff[1]) == 742);
+}
+
+static void mcp23008_registers() {
+  const uint8_t set_olat[] = {0x0a, 0x5a};
+  const uint8_t select_gpio[] = {0x09};
+  uint8_t regs[11] = {};
+
+  i2c_sim_initialize(0, false);
+  i2c_sim_add_device(I2C_SIM_MCP23008, 0, 0, MCP23008);
+
+  CHECK(i2c_sim_write(0, MCP23008, set_olat, sizeof(set_olat)) == ESP_OK);
+
+  // sequential reads wrap from the last register (OLAT) to the first
+  const uint8_t select_iodir[] = {0x00};
+  CHECK(i2c_sim_write_read(0, MCP23008, select_iodir, 1, regs,
+                           sizeof(regs)) == ESP_OK);
+  CHECK(regs[0x00] == 0xff);
+  CHECK(regs[0x0a] == 0x5a);
+
+  CHECK(i2c_sim_write(0, MCP23008, select_gpio, 1) == ESP_OK);
+  CHECK(i2c_sim_read(0, MCP23008, regs, 2) == ESP_OK);
+  CHECK(regs[1] == 0x5a);
+}
+
+static void multiplexer_selects_bus() {
+  const uint8_t bus3[] = {1 << 3};
+  const uint8_t bus0[] = {1 << 0};
+  uint8_t selected = 0;
+
+  i2c_sim_initialize(1, true);
+  i2c_sim_add_device(I2C_SIM_MCP23008, 1, 3, MCP23008);
+
+  // devices only respond when their bus is selected
+  CHECK(i2c_sim_write(1, MUX, bus0, 1) == ESP_OK);
+  CHECK(i2c_sim_read(1, MCP23008, &selected, 1) == ESP_FAIL);
+
+  CHECK(i2c_sim_write(1, MUX, bus3, 1) == ESP_OK);
+  CHECK(i2c_sim_read(1, MUX, &selected, 1) == ESP_OK);
+  CHECK(selected == bus3[0]);
+  CHECK(i2c_sim_read(1, MCP23008, &selected, 1) == ESP_OK);
+
+  // without a multiplexer the mux address is not acknowledged
+  i2c_sim_initialize(0, false);
+  CHECK(i2c_sim_write(0, MUX, bus3, 1) == ESP_FAIL);
+}
+
+int main() {
+  RUN(sht31_crc_reference);
+  RUN(sht31_read_before_ready_is_nacked);
+  RUN(sht31_clock_stretch_waits);
+  RUN(seesaw_requires_delay);
+  RUN(mcp23008_registers);
+  RUN(multiplexer_selects_bus);
+
+  return HOST_TEST_RESULT();
+}
@@ -0,0 +1,164 @@
+/*
+    test_owb_crc.c - Master Control Remote 1-Wire CRC Host Test
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+// owb_crc16_bytes() (table driven) compared to the bitwise CRC16 it replaced
+// (mcrDS::crc16) then timed on the DS2408 channel access frame.
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "drivers/owb.h"
+#include "host_test.h"
+
+// the bitwise CRC16 previously used by mcrDS (Maxim AN27)
+static uint16_t bitwise_crc16(const uint8_t *input, uint16_t len,
+                              uint16_t crc) {
+  static const uint8_t oddparity[16] = {0, 1, 1, 0, 1, 0, 0, 1,
+                                        1, 0, 0, 1, 0, 1, 1, 0};
+
+  for (uint16_t i = 0; i < len; i++) {
+    uint16_t cdata = input[i];
+    cdata = (cdata ^ crc) & 0xff;
+    crc >>= 8;
+
+    if (oddparity[cdata & 0x0F] ^ oddparity[cdata >> 4])
+      crc ^= 0xC001;
+
+    cdata <<= 6;
+    crc ^= cdata;
+    cdata <<= 1;
+    crc ^= cdata;
+  }
+
+  return crc;
+}
+
+// as mcrDS::check_crc16():  devices transmit the inverted crc, low byte first
+static bool check_inverted(const uint8_t *frame, size_t len,
+                           const uint8_t *inverted_crc) {
+  uint16_t crc = ~owb_crc16_bytes(0, frame, len);
+
+  return ((crc & 0xff) == inverted_crc[0]) && ((crc >> 8) == inverted_crc[1]);
+}
+
+// append the inverted crc16 (as transmitted by a device)
+static void append_inverted(uint8_t *frame, size_t len) {
+  uint16_t crc = ~bitwise_crc16(frame, len, 0);
+
+  frame[len] = crc & 0xff;
+  frame[len + 1] = crc >> 8;
+}
+
+static void crc16_check_value() {
+  const uint8_t check[] = "123456789";
+
+  // CRC-16/ARC (the polynomial of 1-Wire) and the inverted form
+  // (CRC-16/MAXIM) as published for the check string
+  CHECK(owb_crc16_bytes(0, check, 9) == 0xBB3D);
+  CHECK((uint16_t)~owb_crc16_bytes(0, check, 9) == 0x44C2);
+}
+
+static void crc16_matches_bitwise() {
+  uint8_t buff[64];
+
+  srand(2020);
+
+  for (int i = 0; i < 20000; i++) {
+    size_t len = 1 + (rand() % sizeof(buff));
+    uint16_t seed = rand() & 0xffff;
+
+    for (size_t j = 0; j < len; j++) {
+      buff[j] = rand() & 0xff;
+    }
+
+    CHECK(owb_crc16_bytes(seed, buff, len) == bitwise_crc16(buff, len, seed));
+  }
+}
+
+// DS2406 read status:  cmd (0xaa), address (0x0000), eight status bytes
+// then the inverted crc16 of the cmd, address and status
+static void crc16_ds2406_status_frame() {
+  uint8_t frame[13] = {0xaa, 0x00, 0x00, 0x00, 0x00, 0x00,
+                       0x00, 0x00, 0x7f, 0x00, 0x00};
+
+  append_inverted(frame, 11);
+  CHECK(check_inverted(frame, 11, &frame[11]));
+
+  // a single bit in error is detected
+  frame[8] ^= 0x01;
+  CHECK(check_inverted(frame, 11, &frame[11]) == false);
+}
+
+// DS2408 channel access read:  cmd (0xf5), 32 bytes of channel state then
+// the inverted crc16 of the cmd and channel state (see mcrDS::readDS2408)
+static void crc16_ds2408_channel_access_frame() {
+  uint8_t frame[35] = {0xf5};
+
+  for (int i = 1; i < 33; i++) {
+    frame[i] = (i & 1) ? 0xa5 : 0x5a;
+  }
+
+  append_inverted(frame, 33);
+  CHECK(check_inverted(frame, 33, &frame[33]));
+
+  // the crc may be accumulated across reads (e.g. cmd then data)
+  uint16_t crc = owb_crc16_bytes(0, frame, 1);
+  crc = owb_crc16_bytes(crc, frame + 1, 32);
+  CHECK(crc == bitwise_crc16(frame, 33, 0));
+
+  frame[20] ^= 0x80;
+  CHECK(check_inverted(frame, 33, &frame[33]) == false);
+}
+
+// not a check:  reports the time of each on a DS2408 frame
+static void crc16_benchmark() {
+  uint8_t frame[33] = {0xf5};
+  const int loops = 200000;
+  volatile uint16_t sink = 0;
+
+  clock_t start = clock();
+  for (int i = 0; i < loops; i++) {
+    frame[1] = i & 0xff;
+    sink ^= owb_crc16_bytes(0, frame, sizeof(frame));
+  }
+  clock_t table = clock() - start;
+
+  start = clock();
+  for (int i = 0; i < loops; i++) {
+    frame[1] = i & 0xff;
+    sink ^= bitwise_crc16(frame, sizeof(frame), 0);
+  }
+  clock_t bitwise = clock() - start;
+
+  printf("crc16 of 33 bytes:  table %0.1fns bitwise %0.1fns\n",
+         (double)table * 1e9 / CLOCKS_PER_SEC / loops,
+         (double)bitwise * 1e9 / CLOCKS_PER_SEC / loops);
+}
+
+int main() {
+  RUN(crc16_check_value);
+  RUN(crc16_matches_bitwise);
+  RUN(crc16_ds2406_status_frame);
+  RUN(crc16_ds2408_channel_access_frame);
+  crc16_benchmark();
+
+  return HOST_TEST_RESULT();
+}
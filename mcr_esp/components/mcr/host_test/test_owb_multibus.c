@@ -0,0 +1,264 @@
+/*
+    test_owb_multibus.c - Master Control Remote Multiple 1-Wire Bus Host Test
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+// several simulated buses populated as mcrDS::simulatedDevices() does (one
+// mcrDS instance per bus) to check device ids are unique across buses and
+// that the buses share no state so each may run from its own task
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "drivers/owb.h"
+#include "drivers/owb_sim.h"
+#include "esp_timer.h"
+#include "host_test.h"
+
+#define BUSES 3
+#define TEMP_DEVICES 4
+#define SWITCH_DEVICES 2
+#define DEVICES (TEMP_DEVICES + (SWITCH_DEVICES * 3))
+#define PASSES 200
+
+static owb_sim_driver_info sim[BUSES];
+static OneWireBus *buses[BUSES];
+
+// same as mcrDS::simulatedDevices()
+static void sim_buses() {
+  for (int bus = 0; bus < BUSES; bus++) {
+    uint64_t serial = (uint64_t)(bus + 1) << 32;
+
+    memset(&(sim[bus]), 0x00, sizeof(owb_sim_driver_info));
+    buses[bus] = owb_sim_initialize(&(sim[bus]));
+
+    for (int i = 0; i < TEMP_DEVICES; i++) {
+      owb_sim_device *dev = owb_sim_add_device(&(sim[bus]), 0x28, serial++);
+      dev->temp_raw += (i * 8);
+    }
+
+    for (int i = 0; i < SWITCH_DEVICES; i++) {
+      owb_sim_add_device(&(sim[bus]), 0x12, serial++); // DS2406
+      owb_sim_add_device(&(sim[bus]), 0x29, serial++); // DS2408
+      owb_sim_add_device(&(sim[bus]), 0x3a, serial++); // DS2413
+    }
+  }
+}
+
+// same as the dsDev id
+static void device_id(const uint8_t *rom, char *id) {
+  sprintf(id, "ds/%02x%02x%02x%02x%02x%02x%02x", rom[0], rom[1], rom[2],
+          rom[3], rom[4], rom[5], rom[6]);
+}
+
+static int discover(OneWireBus *bus, char ids[][32]) {
+  OneWireBus_SearchState search = {};
+  bool found = false;
+  int count = 0;
+
+  owb_search_first(bus, &search, &found);
+
+  while (found && (count < DEVICES)) {
+    if (owb_crc8_bytes(0, search.rom_code.bytes, 8) != 0)
+      return -1;
+
+    device_id(search.rom_code.bytes, ids[count++]);
+    owb_search_next(bus, &search, &found);
+  }
+
+  return count;
+}
+
+static bool select_device(OneWireBus *bus, const owb_sim_device *dev) {
+  bool present = false;
+
+  owb_reset(bus, &present);
+  owb_write_byte(bus, OWB_ROM_MATCH);
+  owb_write_rom_code(bus, dev->rom_code);
+
+  return present;
+}
+
+static bool read_scratchpad(OneWireBus *bus, const owb_sim_device *dev,
+                            int16_t *raw) {
+  uint8_t scratchpad[9] = {};
+
+  if (select_device(bus, dev) == false)
+    return false;
+
+  owb_write_byte(bus, 0xbe);
+  owb_read_bytes(bus, scratchpad, sizeof(scratchpad));
+
+  *raw = (int16_t)(scratchpad[0] | (scratchpad[1] << 8));
+  return owb_crc8_bytes(0, scratchpad, sizeof(scratchpad)) == 0;
+}
+
+static void device_ids_unique_across_buses() {
+  static char ids[BUSES * DEVICES][32];
+
+  sim_buses();
+
+  for (int bus = 0; bus < BUSES; bus++) {
+    CHECK(discover(buses[bus], &(ids[bus * DEVICES])) == DEVICES);
+  }
+
+  for (int i = 0; i < (BUSES * DEVICES); i++) {
+    for (int j = i + 1; j < (BUSES * DEVICES); j++) {
+      CHECK(strcmp(ids[i], ids[j]) != 0);
+    }
+  }
+}
+
+static void each_bus_finds_only_its_devices() {
+  char ids[DEVICES][32];
+  char expect[32];
+
+  sim_buses();
+
+  for (int bus = 0; bus < BUSES; bus++) {
+    CHECK(discover(buses[bus], ids) == DEVICES);
+
+    for (int d = 0; d < sim[bus].num_devices; d++) {
+      bool found = false;
+
+      device_id(sim[bus].devices[d].rom_code.bytes, expect);
+      for (int i = 0; i < DEVICES; i++) {
+        found = found || (strcmp(ids[i], expect) == 0);
+      }
+
+      CHECK(found);
+    }
+  }
+}
+
+static void convert_on_one_bus_leaves_others_idle() {
+  uint8_t convert_cmd[] = {OWB_ROM_SKIP, 0x44};
+  uint8_t data = 0x00;
+  bool present = false;
+  int16_t raw = 0;
+
+  sim_buses();
+
+  owb_reset(buses[0], &present);
+  owb_write_bytes(buses[0], convert_cmd, sizeof(convert_cmd));
+
+  // bus 0 is held low by the convert while bus 1 is free for a read
+  owb_read_byte(buses[0], &data);
+  CHECK(data == 0x00);
+
+  CHECK(read_scratchpad(buses[1], &(sim[1].devices[1]), &raw));
+  CHECK(raw == sim[1].devices[1].temp_raw);
+
+  owb_read_byte(buses[0], &data);
+  CHECK(data == 0x00);
+  CHECK(sim[2].stats.bits_written == 0);
+
+  host_advance_us(750000);
+  owb_read_byte(buses[0], &data);
+  CHECK(data != 0x00);
+}
+
+static void concurrent_converts_complete_together() {
+  uint8_t convert_cmd[] = {OWB_ROM_SKIP, 0x44};
+  uint8_t data = 0x00;
+  bool present = false;
+
+  sim_buses();
+
+  for (int bus = 0; bus < BUSES; bus++) {
+    owb_reset(buses[bus], &present);
+    owb_write_bytes(buses[bus], convert_cmd, sizeof(convert_cmd));
+  }
+
+  // the converts overlap so one convert time covers every bus
+  host_advance_us(750000);
+
+  for (int bus = 0; bus < BUSES; bus++) {
+    owb_read_byte(buses[bus], &data);
+    CHECK(data != 0x00);
+  }
+}
+
+// a bus task: discover then repeatedly read every temperature device and
+// write / read back each DS2408, returns the number of failures
+static void *bus_task(void *arg) {
+  int bus = (int)(intptr_t)arg;
+  owb_sim_driver_info *info = &(sim[bus]);
+  char ids[DEVICES][32];
+  intptr_t failures = 0;
+
+  for (int pass = 0; pass < PASSES; pass++) {
+    failures += (discover(buses[bus], ids) != DEVICES);
+
+    for (int d = 0; d < info->num_devices; d++) {
+      const owb_sim_device *dev = &(info->devices[d]);
+      uint8_t family = dev->rom_code.fields.family[0];
+
+      if (family == 0x28) {
+        int16_t raw = 0;
+
+        failures += (read_scratchpad(buses[bus], dev, &raw) == false);
+        failures += (raw != dev->temp_raw);
+      }
+
+      if (family == 0x29) {
+        uint8_t state = (uint8_t)(pass + bus);
+        uint8_t write_cmd[] = {0x5a, state, (uint8_t)~state};
+        uint8_t confirm[2] = {};
+
+        failures += (select_device(buses[bus], dev) == false);
+        owb_write_bytes(buses[bus], write_cmd, sizeof(write_cmd));
+        owb_read_bytes(buses[bus], confirm, sizeof(confirm));
+
+        failures += (confirm[0] != 0xaa) || (confirm[1] != state);
+      }
+    }
+  }
+
+  return (void *)failures;
+}
+
+static void buses_run_from_separate_tasks() {
+  pthread_t tasks[BUSES];
+
+  sim_buses();
+
+  for (int bus = 0; bus < BUSES; bus++) {
+    CHECK(pthread_create(&(tasks[bus]), NULL, bus_task,
+                         (void *)(intptr_t)bus) == 0);
+  }
+
+  for (int bus = 0; bus < BUSES; bus++) {
+    void *failures = NULL;
+
+    pthread_join(tasks[bus], &failures);
+    CHECK((intptr_t)failures == 0);
+    CHECK(sim[bus].stats.crc_errors == 0);
+  }
+}
+
+int main() {
+  RUN(device_ids_unique_across_buses);
+  RUN(each_bus_finds_only_its_devices);
+  RUN(convert_on_one_bus_leaves_others_idle);
+  RUN(concurrent_converts_complete_together);
+  RUN(buses_run_from_separate_tasks);
+
+  return HOST_TEST_RESULT();
+}
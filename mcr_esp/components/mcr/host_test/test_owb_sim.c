@@ -0,0 +1,177 @@
+/*
+    test_owb_sim.c - Master Control Remote Simulated 1-Wire Host Test
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+// the owb driver (search, ROM commands, crc) run against the simulated bus
+// as mcrDS does with CONFIG_MCR_W1_SIMULATED
+
+#include <string.h>
+
+#include "drivers/owb.h"
+#include "drivers/owb_sim.h"
+#include "esp_timer.h"
+#include "host_test.h"
+
+static owb_sim_driver_info sim;
+
+static OneWireBus *sim_bus() {
+  OneWireBus *bus = owb_sim_initialize(&sim);
+
+  owb_sim_add_device(&sim, 0x28, 0x000001); // DS18B20
+  owb_sim_add_device(&sim, 0x28, 0x000002); // DS18B20
+  owb_sim_add_device(&sim, 0x29, 0x000003); // DS2408
+  owb_sim_add_device(&sim, 0x12, 0x000004); // DS2406
+
+  return bus;
+}
+
+static bool select_device(OneWireBus *bus, const owb_sim_device *dev) {
+  bool present = false;
+
+  owb_reset(bus, &present);
+  owb_write_byte(bus, OWB_ROM_MATCH);
+  owb_write_rom_code(bus, dev->rom_code);
+
+  return present;
+}
+
+static void search_finds_all_devices() {
+  OneWireBus *bus = sim_bus();
+  OneWireBus_SearchState search = {};
+  bool found = false;
+  int count = 0;
+
+  owb_search_first(bus, &search, &found);
+
+  while (found) {
+    CHECK(owb_crc8_bytes(0, search.rom_code.bytes, 8) == 0);
+    count++;
+
+    owb_search_next(bus, &search, &found);
+  }
+
+  CHECK(count == 4);
+}
+
+static void temperature_convert_and_scratchpad() {
+  OneWireBus *bus = sim_bus();
+  const owb_sim_device *dev = &(sim.devices[1]);
+  uint8_t convert_cmd[] = {OWB_ROM_SKIP, 0x44};
+  uint8_t data = 0xff;
+  bool present = false;
+
+  sim.devices[1].temp_raw = 25 * 16 + 8; // 25.5C
+
+  owb_reset(bus, &present);
+  CHECK(present);
+  owb_write_bytes(bus, convert_cmd, sizeof(convert_cmd));
+
+  // devices hold the bus low until the (12-bit) convert completes
+  owb_read_byte(bus, &data);
+  CHECK(data == 0x00);
+
+  host_advance_us(750000);
+  owb_read_byte(bus, &data);
+  CHECK(data != 0x00);
+
+  uint8_t scratchpad[9] = {};
+  CHECK(select_device(bus, dev));
+  owb_write_byte(bus, 0xbe);
+  owb_read_bytes(bus, scratchpad, sizeof(scratchpad));
+
+  CHECK(owb_crc8_bytes(0, scratchpad, sizeof(scratchpad)) == 0);
+  CHECK((int16_t)(scratchpad[0] | (scratchpad[1] << 8)) == (25 * 16 + 8));
+}
+
+static void ds2408_write_then_channel_access_read() {
+  OneWireBus *bus = sim_bus();
+  const owb_sim_device *dev = &(sim.devices[2]);
+  uint8_t write_cmd[] = {0x5a, 0x3c, (uint8_t)~0x3c};
+  uint8_t confirm[2] = {};
+
+  CHECK(select_device(bus, dev));
+  owb_write_bytes(bus, write_cmd, sizeof(write_cmd));
+  owb_read_bytes(bus, confirm, sizeof(confirm));
+
+  CHECK(confirm[0] == 0xaa);
+  CHECK(confirm[1] == 0x3c);
+
+  // cmd, 32 bytes of channel state then the inverted crc16 of both
+  uint8_t frame[35] = {0xf5};
+
+  CHECK(select_device(bus, dev));
+  owb_write_byte(bus, frame[0]);
+  owb_read_bytes(bus, frame + 1, 34);
+
+  uint16_t crc = ~owb_crc16_bytes(0, frame, 33);
+  CHECK(frame[1] == 0x3c);
+  CHECK(frame[33] == (crc & 0xff));
+  CHECK(frame[34] == (crc >> 8));
+}
+
+static void injected_crc_error_is_detected() {
+  OneWireBus *bus = sim_bus();
+  uint8_t scratchpad[9] = {};
+
+  sim.inject.crc_every = 1;
+
+  CHECK(select_device(bus, &(sim.devices[0])));
+  owb_write_byte(bus, 0xbe);
+  owb_read_bytes(bus, scratchpad, sizeof(scratchpad));
+
+  CHECK(owb_crc8_bytes(0, scratchpad, sizeof(scratchpad)) != 0);
+  CHECK(sim.stats.crc_errors == 1);
+}
+
+static void injected_presence_error() {
+  OneWireBus *bus = sim_bus();
+  bool present = true;
+
+  sim.inject.presence_every = 2;
+
+  owb_reset(bus, &present);
+  CHECK(present);
+  owb_reset(bus, &present);
+  CHECK(present == false);
+  CHECK(sim.stats.presence_errors == 1);
+}
+
+static void injected_reset_error_is_returned() {
+  OneWireBus *bus = sim_bus();
+  bool present = true;
+
+  sim.inject.reset_error_every = 2;
+
+  CHECK(owb_reset(bus, &present) == OWB_STATUS_OK);
+  CHECK(present);
+  CHECK(owb_reset(bus, &present) == OWB_STATUS_HW_ERROR);
+  CHECK(present == false);
+  CHECK(sim.stats.reset_errors == 1);
+}
+
+int main() {
+  RUN(search_finds_all_devices);
+  RUN(temperature_convert_and_scratchpad);
+  RUN(ds2408_write_then_channel_access_read);
+  RUN(injected_crc_error_is_detected);
+  RUN(injected_presence_error);
+  RUN(injected_reset_error_is_returned);
+
+  return HOST_TEST_RESULT();
+}
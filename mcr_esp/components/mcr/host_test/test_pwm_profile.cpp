@@ -0,0 +1,223 @@
+/*
+    test_pwm_profile.cpp - Master Control Remote PWM Profile Host Test
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+// pwm profiles (see devs/pwm_profile.hpp) executed against the mocked LEDC
+// layer (shim/driver/ledc.h) with the timers fired by the simulated clock
+
+#include <cstdint>
+
+#include <driver/ledc.h>
+
+#include "devs/pwm_profile.hpp"
+#include "esp_timer.h"
+#include "host_test.h"
+
+using namespace mcr;
+
+static const host_ledc_fade_t *fades(uint32_t &count) {
+  return host_ledc_fades(&count);
+}
+
+static void steps_are_timed_from_the_start() {
+  pwmProfileRunner_t runner;
+  pwmProfile_t profile = {};
+  uint32_t count = 0;
+
+  profile.steps[0] = {1000, 100, 400};
+  profile.steps[1] = {0, 0, 250};
+  profile.steps[2] = {4095, 50, 0};
+  profile.count = 3;
+
+  host_ledc_clear();
+  int64_t start = esp_timer_get_time();
+
+  CHECK(runner.start(profile, LEDC_HIGH_SPEED_MODE, LEDC_CHANNEL_2) ==
+        ESP_OK);
+  CHECK(runner.running());
+
+  host_advance_us(2000000);
+
+  const host_ledc_fade_t *f = fades(count);
+  CHECK(count == 3);
+  CHECK((f[0].at_us == start) && (f[0].duty == 1000) && (f[0].fade_ms == 100));
+  CHECK((f[1].at_us == start + 500000) && (f[1].duty == 0));
+  CHECK((f[2].at_us == start + 750000) && (f[2].duty == 4095));
+  CHECK((f[2].channel == LEDC_CHANNEL_2) &&
+        (f[2].speed_mode == LEDC_HIGH_SPEED_MODE));
+
+  CHECK(runner.running() == false);
+}
+
+static void loop_repeats_without_drift() {
+  pwmProfileRunner_t runner;
+  pwmProfile_t profile = {};
+  uint32_t count = 0;
+
+  profile.steps[0] = {100, 0, 100};
+  profile.steps[1] = {200, 30, 70};
+  profile.count = 2;
+  profile.loop = true;
+
+  host_ledc_clear();
+  int64_t start = esp_timer_get_time();
+
+  runner.start(profile, LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_1);
+
+  // each step starts late but the next step is scheduled from the start of
+  // the profile so the lateness does not accumulate
+  host_set_timer_latency_us(3000);
+  host_advance_us(1000000 + 3000);
+  host_set_timer_latency_us(0);
+
+  const host_ledc_fade_t *f = fades(count);
+  CHECK(count == 11);
+
+  for (uint32_t i = 0; i < count; i++) {
+    int64_t late_us = f[i].at_us - (start + (i * 100000));
+
+    CHECK((late_us >= 0) && (late_us <= 3000));
+    CHECK(f[i].duty == ((i % 2) ? 200 : 100));
+  }
+
+  CHECK(runner.running());
+  runner.stop();
+}
+
+static void stop_and_replace() {
+  pwmProfileRunner_t runner;
+  pwmProfile_t blink = {};
+  pwmProfile_t once = {};
+  uint32_t count = 0;
+
+  blink.steps[0] = {4095, 0, 500};
+  blink.steps[1] = {0, 0, 500};
+  blink.count = 2;
+  blink.loop = true;
+
+  once.steps[0] = {2048, 1000, 0};
+  once.count = 1;
+
+  host_ledc_clear();
+  runner.start(blink, LEDC_HIGH_SPEED_MODE, LEDC_CHANNEL_0);
+  host_advance_us(600000);
+
+  // a new profile replaces the running profile
+  runner.start(once, LEDC_HIGH_SPEED_MODE, LEDC_CHANNEL_0);
+  host_advance_us(5000000);
+
+  const host_ledc_fade_t *f = fades(count);
+  CHECK(count == 3);
+  CHECK(f[2].duty == 2048);
+  CHECK(runner.running() == false);
+
+  runner.start(blink, LEDC_HIGH_SPEED_MODE, LEDC_CHANNEL_0);
+  runner.stop();
+  host_advance_us(5000000);
+
+  fades(count);
+  CHECK(count == 4);
+}
+
+static void invalid_profiles_are_rejected() {
+  pwmProfileRunner_t runner;
+  pwmProfile_t profile = {};
+  uint32_t count = 0;
+
+  host_ledc_clear();
+
+  // no steps
+  CHECK(runner.start(profile, LEDC_HIGH_SPEED_MODE, LEDC_CHANNEL_0) ==
+        ESP_ERR_INVALID_ARG);
+
+  // a loop that takes no time
+  profile.steps[0] = {100, 0, 0};
+  profile.count = 1;
+  profile.loop = true;
+  CHECK(runner.start(profile, LEDC_HIGH_SPEED_MODE, LEDC_CHANNEL_0) ==
+        ESP_ERR_INVALID_ARG);
+
+  profile.count = pwmProfile_t::max_steps + 1;
+  profile.loop = false;
+  CHECK(runner.start(profile, LEDC_HIGH_SPEED_MODE, LEDC_CHANNEL_0) ==
+        ESP_ERR_INVALID_ARG);
+
+  fades(count);
+  CHECK(count == 0);
+  CHECK(runner.lastRC() == ESP_ERR_INVALID_ARG);
+}
+
+static void duty_follows_the_steps() {
+  pwmProfileRunner_t runner;
+  pwmProfile_t profile = {};
+  uint32_t duty = 0;
+
+  profile.steps[0] = {1000, 100, 400};
+  profile.steps[1] = {3000, 0, 500};
+  profile.steps[2] = {500, 50, 0};
+  profile.count = 3;
+
+  host_ledc_clear();
+  runner.start(profile, LEDC_HIGH_SPEED_MODE, LEDC_CHANNEL_0, &duty);
+  CHECK(duty == 1000);
+
+  host_advance_us(600000);
+  CHECK(duty == 3000);
+
+  // the duty of the last step remains once the profile is complete
+  host_advance_us(1000000);
+  CHECK(duty == 500);
+  CHECK(runner.running() == false);
+}
+
+static void copies_start_stopped() {
+  pwmProfileRunner_t runner;
+  pwmProfile_t profile = {};
+  uint32_t count = 0;
+
+  profile.steps[0] = {10, 0, 100};
+  profile.count = 1;
+  profile.loop = true;
+
+  host_ledc_clear();
+  runner.start(profile, LEDC_HIGH_SPEED_MODE, LEDC_CHANNEL_3);
+
+  {
+    // destroying the copy does not touch the timer of the original
+    pwmProfileRunner_t copy(runner);
+    CHECK(copy.running() == false);
+  }
+
+  host_advance_us(250000);
+  fades(count);
+  CHECK(count == 3);
+
+  runner.stop();
+}
+
+int main() {
+  RUN(steps_are_timed_from_the_start);
+  RUN(loop_repeats_without_drift);
+  RUN(stop_and_replace);
+  RUN(invalid_profiles_are_rejected);
+  RUN(duty_follows_the_steps);
+  RUN(copies_start_stopped);
+
+  return HOST_TEST_RESULT();
+}
@@ -0,0 +1,287 @@
+/*
+    test_registry.cpp - Master Control Remote Engine Device Registry Host Test
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+// the known device registry of mcrEngine (see engines/registry.hpp):  key
+// order, the id index, snapshots that survive adds and, not a check, the
+// cost of lookup and iteration compared to maps guarded by the same mutex.
+
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "engines/registry.hpp"
+#include "host_test.h"
+
+using namespace mcr;
+
+// the subset of mcrDev used by the registry
+class hostDev {
+public:
+  hostDev(uint64_t key) : _key(key) {
+    char id[32];
+
+    snprintf(id, sizeof(id), "ds/%014llx", (unsigned long long)key);
+    _id = id;
+  }
+
+  uint64_t key() const { return _key; }
+  const string_t &id() const { return _id; }
+
+private:
+  uint64_t _key;
+  string_t _id;
+};
+
+typedef mcrDevRegistry<hostDev> hostRegistry_t;
+
+// a spread of keys (e.g. ROM codes) added in an order unrelated to the key
+static uint64_t key_at(uint32_t i) {
+  return ((uint64_t)(i * 2654435761u) << 8) | 0x28;
+}
+
+static void kept_in_key_order() {
+  hostRegistry_t reg(100);
+  std::vector<hostDev> devs;
+
+  for (uint32_t i = 0; i < 50; i++) {
+    devs.emplace_back(key_at(i));
+  }
+
+  for (auto &dev : devs) {
+    CHECK(reg.add(&dev) == REGISTRY_ADDED);
+  }
+
+  hostRegistry_t::DeviceList_t snap = reg.snapshot();
+  CHECK(snap->size() == 50);
+
+  for (uint32_t i = 1; i < snap->size(); i++) {
+    CHECK((*snap)[i - 1].first < (*snap)[i].first);
+  }
+
+  for (auto &dev : devs) {
+    CHECK(reg.find(dev.key()) == &dev);
+    CHECK(reg.find(dev.id()) == &dev);
+  }
+
+  CHECK(reg.find(key_at(51)) == nullptr);
+  CHECK(reg.find(string_t("ds/none")) == nullptr);
+}
+
+static void known_and_full() {
+  hostRegistry_t reg(2);
+  hostDev a(1), a_again(1), b(2), c(3);
+
+  CHECK(reg.add(&a) == REGISTRY_ADDED);
+  CHECK(reg.add(&a_again) == REGISTRY_KNOWN);
+  CHECK(reg.find(a.key()) == &a);
+
+  CHECK(reg.add(&b) == REGISTRY_ADDED);
+  CHECK(reg.add(&c) == REGISTRY_FULL);
+  CHECK(reg.size() == 2);
+}
+
+// a report pass iterates a snapshot while discover adds devices
+static void snapshot_survives_adds() {
+  hostRegistry_t reg(100);
+  std::vector<hostDev> devs;
+
+  for (uint32_t i = 0; i < 40; i++) {
+    devs.emplace_back(key_at(i));
+  }
+
+  for (uint32_t i = 0; i < 20; i++) {
+    reg.add(&devs[i]);
+  }
+
+  hostRegistry_t::DeviceList_t snap = reg.snapshot();
+  const auto *first = snap->data();
+  uint32_t visited = 0;
+  uint32_t added = 20;
+
+  for (auto item = snap->begin(); item != snap->end(); item++) {
+    // each add builds a new array, the snapshot is untouched
+    CHECK(reg.add(&devs[added++]) == REGISTRY_ADDED);
+    CHECK(item->second->key() == item->first);
+    visited++;
+  }
+
+  CHECK(visited == 20);
+  CHECK(snap->size() == 20);
+  CHECK(snap->data() == first);
+
+  hostRegistry_t::DeviceList_t next = reg.snapshot();
+  CHECK(next->size() == 40);
+  CHECK(next->data() != first);
+
+  // a snapshot is held by its users, the registry moved on
+  CHECK(snap.use_count() == 1);
+}
+
+// the maps a registry would otherwise be, each guarded by a mutex as the
+// registry is since discover adds devices while other tasks look up and iterate
+class lockedMaps {
+public:
+  lockedMaps() { _mutex = xSemaphoreCreateMutex(); }
+  ~lockedMaps() { vSemaphoreDelete(_mutex); }
+
+  void add(hostDev *dev) {
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    _by_key[dev->key()] = dev;
+    _by_id[dev->id()] = dev;
+    xSemaphoreGive(_mutex);
+  }
+
+  hostDev *find(uint64_t key) {
+    hostDev *rc = nullptr;
+
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    auto found = _by_key.find(key);
+
+    if (found != _by_key.end()) {
+      rc = found->second;
+    }
+    xSemaphoreGive(_mutex);
+
+    return rc;
+  }
+
+  hostDev *find(const string_t &id) {
+    hostDev *rc = nullptr;
+
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    auto found = _by_id.find(id);
+
+    if (found != _by_id.end()) {
+      rc = found->second;
+    }
+    xSemaphoreGive(_mutex);
+
+    return rc;
+  }
+
+  // without a snapshot the mutex is held for the whole walk
+  uint64_t walk() {
+    uint64_t sum = 0;
+
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    for (auto &item : _by_key) {
+      sum += item.second->key();
+    }
+    xSemaphoreGive(_mutex);
+
+    return sum;
+  }
+
+private:
+  std::unordered_map<uint64_t, hostDev *> _by_key;
+  std::unordered_map<string_t, hostDev *> _by_id;
+  SemaphoreHandle_t _mutex = nullptr;
+};
+
+static double ns_per(clock_t elapsed, uint32_t count) {
+  return (double)elapsed * 1e9 / CLOCKS_PER_SEC / count;
+}
+
+// not a check:  lookup and iteration at the scale of small and large boards.
+// find by key is only used by discover (once per device found) and find by
+// id by commands while every report pass walks the devices so the walk is
+// what the sorted array is for.  both lookups use a hash index like the maps.
+static void registry_benchmark() {
+  const uint32_t sizes[] = {10, 100, 1000};
+  const uint32_t lookups = 200000;
+
+  for (auto size : sizes) {
+    hostRegistry_t reg(size);
+    lockedMaps maps;
+    std::vector<hostDev> devs;
+    volatile uint64_t sink = 0;
+
+    devs.reserve(size);
+    for (uint32_t i = 0; i < size; i++) {
+      devs.emplace_back(key_at(i));
+    }
+
+    for (auto &dev : devs) {
+      reg.add(&dev);
+      maps.add(&dev);
+    }
+
+    clock_t start = clock();
+    for (uint32_t i = 0; i < lookups; i++) {
+      sink += (uint64_t)reg.find(devs[i % size].key());
+    }
+    clock_t reg_key = clock() - start;
+
+    start = clock();
+    for (uint32_t i = 0; i < lookups; i++) {
+      sink += (uint64_t)maps.find(devs[i % size].key());
+    }
+    clock_t map_key = clock() - start;
+
+    start = clock();
+    for (uint32_t i = 0; i < lookups; i++) {
+      sink += (uint64_t)reg.find(devs[i % size].id());
+    }
+    clock_t reg_id = clock() - start;
+
+    start = clock();
+    for (uint32_t i = 0; i < lookups; i++) {
+      sink += (uint64_t)maps.find(devs[i % size].id());
+    }
+    clock_t map_id = clock() - start;
+
+    const uint32_t passes = lookups / size;
+
+    start = clock();
+    for (uint32_t p = 0; p < passes; p++) {
+      hostRegistry_t::DeviceList_t snap = reg.snapshot();
+
+      for (auto &item : *snap) {
+        sink += item.second->key();
+      }
+    }
+    clock_t reg_walk = clock() - start;
+
+    start = clock();
+    for (uint32_t p = 0; p < passes; p++) {
+      sink += maps.walk();
+    }
+    clock_t map_walk = clock() - start;
+
+    printf("%4u devices (registry / map):  find key %0.1f / %0.1fns, "
+           "find id %0.1f / %0.1fns, walk %0.1f / %0.1fns per device\n",
+           size, ns_per(reg_key, lookups), ns_per(map_key, lookups),
+           ns_per(reg_id, lookups), ns_per(map_id, lookups),
+           ns_per(reg_walk, passes * size), ns_per(map_walk, passes * size));
+  }
+}
+
+int main() {
+  RUN(kept_in_key_order);
+  RUN(known_and_full);
+  RUN(snapshot_survives_adds);
+
+  registry_benchmark();
+
+  return HOST_TEST_RESULT();
+}
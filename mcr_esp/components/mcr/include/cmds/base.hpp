@@ -72,6 +72,8 @@ protected:
 
   virtual void populateInternalDevice(JsonDocument &doc);
   virtual void translateExternalDeviceID(const char *replacement);
+  string_t translateDeviceID(const string_t &external_dev_id,
+                             const char *replacement);
 
 public:
   mcrCmd() = delete; // never create a default cmd
@@ -0,0 +1,90 @@
+/*
+    engine_config.hpp - Master Control Command Engine Config Class
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+#ifndef mcr_cmd_engine_config_hpp
+#define mcr_cmd_engine_config_hpp
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "cmds/base.hpp"
+#include "engines/types.hpp"
+
+using std::unique_ptr;
+
+namespace mcr {
+
+typedef class cmdEngineConfig cmdEngineConfig_t;
+
+// called (by the mqtt task) to apply the cmd to an engine
+typedef bool(EngineConfigFunc_t)(void *engine, const cmdEngineConfig_t &cmd);
+
+typedef struct {
+  string_t name; // the engine name (e.g. mcrDS, mcrI2c1)
+  EngineConfigFunc_t *func;
+  void *engine;
+} engineConfigTarget_t;
+
+// cmdEngineConfig:
+//    adjusts the cadences (and convert, discover enablement) of an engine.
+//    only the values present in the cmd are changed.
+//
+//    {"engine":"mcrDS", "convert_secs":15, "discover_secs":60,
+//     "report_secs":15, "convert":true, "discover":false,
+//     "mtime":1515117138, "cmd":"engine.config"}
+//
+//    the engine "all" applies the cmd to every engine.
+class cmdEngineConfig : public mcrCmd {
+private:
+  string_t _engine;
+  uint32_t _convert_secs = 0; // zero when not present
+  uint32_t _discover_secs = 0;
+  uint32_t _report_secs = 0;
+
+  bool _has_convert = false;
+  bool _convert = true;
+  bool _has_discover = false;
+  bool _discover = true;
+
+  static std::vector<engineConfigTarget_t> _targets;
+
+public:
+  cmdEngineConfig(JsonDocument &doc, elapsedMicros &e);
+  ~cmdEngineConfig(){};
+
+  // merge the values present in the cmd into the config of an engine,
+  // returns false (and leaves config unchanged) when a value is out of range
+  bool apply(EngineConfig_t &config) const;
+
+  bool matchEngine(const string_t &name) const;
+
+  bool process();
+  size_t size() const { return sizeof(cmdEngineConfig_t); };
+  const unique_ptr<char[]> debug();
+
+  static void registerEngine(const string_t &name, EngineConfigFunc_t *func,
+                             void *engine);
+};
+
+} // namespace mcr
+
+#endif // mcr_cmd_engine_config_hpp
@@ -31,13 +31,17 @@
 #include <time.h>
 
 #include "cmds/base.hpp"
+#include "cmds/engine_config.hpp"
+#include "cmds/heap_trace.hpp"
 #include "cmds/network.hpp"
 #include "cmds/ota.hpp"
 #include "cmds/pwm.hpp"
 #include "cmds/switch.hpp"
+#include "cmds/trace_dump.hpp"
 #include "cmds/types.hpp"
 #include "external/ArduinoJson.hpp"
 #include "misc/mcr_types.hpp"
+#include "misc/trace.hpp"
 
 namespace mcr {
 
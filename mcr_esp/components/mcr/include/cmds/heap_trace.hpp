@@ -0,0 +1,56 @@
+/*
+    heap_trace.hpp - Master Control Command Heap Trace Class
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+#ifndef mcr_cmd_heap_trace_hpp
+#define mcr_cmd_heap_trace_hpp
+
+#include <cstdlib>
+#include <memory>
+
+#include "cmds/base.hpp"
+
+using std::unique_ptr;
+
+namespace mcr {
+
+typedef class cmdHeapTrace cmdHeapTrace_t;
+
+// cmdHeapTrace:
+//    publishes the heap trace (see mcrHeapTrace) and, optionally, resets the
+//    counts so the next cmd reports only the allocations since.
+//
+//    {"host":"mcr.xxx", "reset":true, "mtime":1515117138,
+//     "cmd":"heap.trace"}
+class cmdHeapTrace : public mcrCmd {
+private:
+  bool _reset = false;
+
+public:
+  cmdHeapTrace(JsonDocument &doc, elapsedMicros &e);
+  ~cmdHeapTrace(){};
+
+  bool process();
+  size_t size() const { return sizeof(cmdHeapTrace_t); };
+  const unique_ptr<char[]> debug();
+};
+
+} // namespace mcr
+
+#endif // mcr_cmd_heap_trace_hpp
@@ -24,12 +24,14 @@
 #include <cstdlib>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <freertos/FreeRTOS.h>
 #include <sys/time.h>
 #include <time.h>
 
 #include "cmds/base.hpp"
+#include "devs/pwm_dev.hpp"
 #include "misc/elapsedMillis.hpp"
 #include "misc/mcr_types.hpp"
 
@@ -37,19 +39,44 @@ using std::unique_ptr;
 
 namespace mcr {
 
+// another channel (device) started with the device of the cmd
+typedef struct {
+  string_t internal_dev_id;
+  uint32_t duty;
+  uint32_t fade_ms;
+} pwmGroupChannel_t;
+
 typedef class cmdPWM cmdPWM_t;
 class cmdPWM : public mcrCmd {
 private:
   uint32_t _duty;
   uint32_t _fade_ms;
+  pwmProfile_t _profile = {};
+  uint32_t _steps_requested = 0; // rejected when > pwmProfile_t::max_steps
+  std::vector<pwmGroupChannel_t> _group;
+  int64_t _execute_at_us = 0; // unix time (us), zero to execute on receipt
 
 public:
   cmdPWM(JsonDocument &doc, elapsedMicros &parse);
-  cmdPWM(const cmdPWM_t *cmd) : mcrCmd{cmd}, _duty(cmd->_duty){};
+  cmdPWM(const cmdPWM_t *cmd)
+      : mcrCmd{cmd}, _duty(cmd->_duty), _fade_ms(cmd->_fade_ms),
+        _profile(cmd->_profile), _steps_requested(cmd->_steps_requested),
+        _group(cmd->_group),
+        _execute_at_us(cmd->_execute_at_us){};
 
   uint32_t duty() { return _duty; };
   uint32_t fade_ms() { return _fade_ms; };
 
+  // when the cmd includes steps the device executes them as a profile
+  bool hasProfile() { return (_profile.count > 0); };
+  const pwmProfile_t &profile() { return _profile; };
+
+  // when the cmd includes a group the fades of all channels are started
+  // together (optionally at execute_at)
+  bool isGroup() { return (_group.empty() == false); };
+  const std::vector<pwmGroupChannel_t> &group() { return _group; };
+  int64_t executeAtUS() { return _execute_at_us; };
+
   bool IRAM_ATTR process();
 
   size_t size() const { return sizeof(cmdPWM_t); };
@@ -0,0 +1,56 @@
+/*
+    trace_dump.hpp - Master Control Command Trace Dump Class
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+#ifndef mcr_cmd_trace_dump_hpp
+#define mcr_cmd_trace_dump_hpp
+
+#include <cstdlib>
+#include <memory>
+
+#include "cmds/base.hpp"
+
+using std::unique_ptr;
+
+namespace mcr {
+
+typedef class cmdTraceDump cmdTraceDump_t;
+
+// cmdTraceDump:
+//    publishes the event trace ring (see mcrTrace) as a series of chunks
+//    and, optionally, clears the ring.
+//
+//    {"host":"mcr.xxx", "clear":true, "mtime":1515117138,
+//     "cmd":"trace.dump"}
+class cmdTraceDump : public mcrCmd {
+private:
+  bool _clear = false;
+
+public:
+  cmdTraceDump(JsonDocument &doc, elapsedMicros &e);
+  ~cmdTraceDump(){};
+
+  bool process();
+  size_t size() const { return sizeof(cmdTraceDump_t); };
+  const unique_ptr<char[]> debug();
+};
+
+} // namespace mcr
+
+#endif // mcr_cmd_trace_dump_hpp
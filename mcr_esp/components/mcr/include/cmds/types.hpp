@@ -40,7 +40,10 @@ typedef enum class mcrCmdType {
   restart,
   enginesSuspend,
   otaHTTPS,
-  pwm
+  pwm,
+  engineConfig,
+  heapTrace,
+  traceDump
 } mcrCmdType_t;
 
 typedef class mcrCmdTypeMap mcrCmdTypeMap_t;
@@ -66,6 +66,10 @@ public:
   mcrDevAddr_t &addr();
   uint8_t *addrBytes();
 
+  // the address packed into an integer, used by mcrEngine to keep known
+  // devices sorted (addresses longer than eight bytes are truncated)
+  uint64_t key();
+
   void setID(const std::string &new_id);
   void setID(char *new_id);
   const string_t &id() const { return _id; };
@@ -77,6 +81,7 @@ public:
   virtual const char *externalName() const { return _id.c_str(); };
 
   void setReading(Reading_t *reading);
+  void applyMetrics(Reading_t *reading);
   void setReadingCmdAck(uint32_t latency_us, mcrRefID_t &refid);
   Reading_t *reading();
 
@@ -85,6 +90,9 @@ public:
   uint64_t readStop();
   void writeStart();
   uint64_t writeStop();
+  // incremented as each write (e.g. a cmd) starts so a reading taken
+  // before the write can be detected
+  uint32_t writeSeq() const { return _write_seq; }
   uint64_t readUS();
   uint64_t writeUS();
   time_t readTimestamp();
@@ -133,6 +141,7 @@ protected:
 
   elapsedMicros _read_us;
   elapsedMicros _write_us;
+  volatile uint32_t _write_seq = 0;
 
   time_t _read_timestamp = 0;
 
@@ -36,7 +36,6 @@ typedef class std::vector<uint8_t> RawData_t;
 class i2cDev : public mcrDev {
 public:
   i2cDev() {}
-  static const char *i2cDevDesc(uint8_t addr);
 
 private:
   string_t _external_name; // name used to report externally
@@ -46,20 +45,39 @@ private:
   bool _use_multiplexer = false; // is the multiplexer is needed to reach device
   uint8_t _bus = 0; // if using multiplexer then this is the bus number
                     // where the device is hosted
+  uint8_t _port = 0; // i2c controller the device is attached to
+  static const uint8_t _buses_per_port = 8;
   RawData_t _raw_data;
 
+  uint8_t idBus() const;
+
+  // devices that acquire data on their own (e.g. SHT31 periodic mode) have
+  // nothing to read until this time (esp_timer)
+  int64_t _data_ready_at_us = 0;
+
 public:
   // construct a new i2cDev with a known address and compute the id
-  i2cDev(mcrDevAddr_t &addr, bool use_multiplexer = false, uint8_t bus = 0);
+  //  devices on the second controller (port) are identified by buses
+  //  following those of the first (e.g. port 1, bus 0 is bus 0x08)
+  //  desc is provided by the driver for the device (e.g. sht31)
+  i2cDev(mcrDevAddr_t &addr, bool use_multiplexer = false, uint8_t bus = 0,
+         uint8_t port = 0, const char *desc = "unknown");
 
   uint8_t devAddr();
   bool useMultiplexer();
   uint8_t bus() const;
+  uint8_t port() const;
   const RawData_t &rawData();
   uint8_t readAddr();
   void storeRawData(RawData_t &data);
+  int64_t dataReadyAt() const;
+  void dataReadyAt(int64_t at_us);
   uint8_t writeAddr();
 
+  // the same address may be found on each bus so the key includes the port
+  // and bus (see mcrEngine device registry)
+  uint64_t key();
+
   const char *externalName();
 
   // info / debug functions
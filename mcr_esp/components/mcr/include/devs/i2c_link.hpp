@@ -0,0 +1,47 @@
+/*
+    i2c_link.hpp - Master Control Remote I2C Command Links
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+#ifndef mcr_i2c_link_hpp
+#define mcr_i2c_link_hpp
+
+#include <cstdint>
+
+#include <driver/i2c.h>
+
+namespace mcr {
+
+// queue a single i2c transaction on an empty command link:
+//   START, address (write), send bytes     (when send_len > 0 or no recv)
+//   START, address (read), recv bytes      (when recv_len > 0)
+//   STOP
+//
+// NOTE:  the driver queues a pointer to send bytes (and recv) so both must
+//        remain valid for as long as the link is executed
+//
+// NOTE:  a link is executed once.  the IDF v4.0 driver consumes the queued
+//        items as it executes (the byte count and data pointer of each item
+//        are advanced in place) so executing a link again transfers nothing.
+void i2cQueueTransaction(i2c_cmd_handle_t cmd, uint8_t addr,
+                         const uint8_t *send, uint32_t send_len,
+                         uint8_t *recv, uint32_t recv_len);
+
+} // namespace mcr
+
+#endif // mcr_i2c_link_hpp
@@ -28,6 +28,7 @@
 #include <driver/ledc.h>
 
 #include "devs/base.hpp"
+#include "devs/pwm_profile.hpp"
 
 using std::unique_ptr;
 
@@ -64,6 +65,11 @@ private:
   uint32_t duty_ = 0; // default to zero (off)
   esp_err_t last_rc_ = ESP_OK;
 
+  // profile execution (see pwm_profile.hpp)
+  pwmProfileRunner_t profile_;
+
+  bool fadeTo(uint32_t duty, uint32_t fade_ms);
+
 public:
   pwmDev(mcrDevAddr_t &num);
   uint8_t devAddr();
@@ -75,8 +81,17 @@ public:
   uint32_t dutyMin() { return duty_min_; };
   gpio_num_t gpioPin() { return gpio_pin_; };
 
+  // a duty update stops a running profile
   bool updateDuty(uint32_t duty, uint32_t fade_ms);
 
+  bool startProfile(const pwmProfile_t &profile);
+
+  // a fade split into configure then start so the fades of several
+  // channels can be started together (see pwmEngine::updateGroup)
+  bool prepareFade(uint32_t duty, uint32_t fade_ms);
+  bool startFade();
+  void stopProfile();
+
   const char *externalName();
   esp_err_t lastRC() { return last_rc_; };
 
@@ -0,0 +1,95 @@
+/*
+    pwm_profile.hpp - Master Control Remote PWM Profile
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+#ifndef pwm_profile_hpp
+#define pwm_profile_hpp
+
+#include <cstdint>
+
+#include <driver/ledc.h>
+#include <esp_err.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+namespace mcr {
+
+// a step of a profile:  fade to duty over fade_ms then hold for hold_ms
+typedef struct {
+  uint32_t duty;
+  uint32_t fade_ms;
+  uint32_t hold_ms;
+} pwmStep_t;
+
+// a sequence of steps executed by the device without further commands,
+// optionally repeating from the first step once the last step is complete
+typedef struct pwmProfile {
+  static const uint32_t max_steps = 16;
+  pwmStep_t steps[max_steps];
+  uint32_t count;
+  bool loop;
+} pwmProfile_t;
+
+typedef class pwmProfileRunner pwmProfileRunner_t;
+
+// executes a profile on a LEDC channel:  each step is started by a timer at
+// a time relative to the start of the profile so steps do not drift.  the
+// timer and mutex are created when the first profile is started.
+//
+// the timer refers to the runner so a copy (e.g. of a device found by
+// discover) starts stopped and creates its own.
+class pwmProfileRunner {
+public:
+  pwmProfileRunner(){};
+  pwmProfileRunner(const pwmProfileRunner_t &runner){};
+  pwmProfileRunner_t &operator=(const pwmProfileRunner_t &runner) {
+    return *this;
+  };
+  ~pwmProfileRunner();
+
+  // the first step is started before returning.  when specified, duty is
+  // set to the duty of each step as it is started.
+  esp_err_t start(const pwmProfile_t &profile, ledc_mode_t speed_mode,
+                  ledc_channel_t channel, uint32_t *duty = nullptr);
+  void stop();
+
+  bool running() const { return (profile_.count > 0); };
+  uint32_t step() const { return step_; };
+  uint32_t count() const { return profile_.count; };
+  esp_err_t lastRC() const { return last_rc_; };
+
+private:
+  pwmProfile_t profile_ = {};
+  uint32_t step_ = 0;
+  int64_t next_us_ = 0;
+  ledc_mode_t speed_mode_ = LEDC_HIGH_SPEED_MODE;
+  ledc_channel_t channel_ = LEDC_CHANNEL_0;
+  uint32_t *duty_ = nullptr;
+  esp_err_t last_rc_ = ESP_OK;
+
+  esp_timer_handle_t timer_ = nullptr;
+  SemaphoreHandle_t mutex_ = nullptr;
+
+  static void timerCallback(void *runner);
+  void runStep();
+};
+} // namespace mcr
+
+#endif // pwm_profile_hpp
@@ -0,0 +1,118 @@
+/*
+    i2c_sim.h - Master Control Remote Simulated I2C Bus
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define I2C_SIM_MAX_DEVICES   24    // per port
+#define I2C_SIM_PORTS         2
+
+// simulated bus time (microseconds) at 100kHz:  nine clocks per byte
+// (including the ack) plus the start and stop conditions
+#define I2C_SIM_BYTE_US       90
+#define I2C_SIM_START_STOP_US 20
+
+typedef enum
+{
+    I2C_SIM_SHT31 = 0,    ///< humidity and temperature (0x44)
+    I2C_SIM_SEESAW_SOIL,  ///< capacitive soil moisture (0x36)
+    I2C_SIM_MCP23008      ///< eight channel gpio expander (0x20 - 0x27)
+} i2c_sim_type;
+
+typedef struct
+{
+    i2c_sim_type type;
+    uint8_t port;           ///< i2c controller
+    uint8_t bus;            ///< multiplexer bus
+    uint8_t addr;
+
+    float temp_c;           ///< SHT31, seesaw
+    float rh;               ///< SHT31
+    uint16_t moisture;      ///< seesaw
+    uint8_t regs[11];       ///< MCP23008 registers (0x00 - 0x0a)
+
+    // private
+    uint8_t reg;            ///< register (or command) for the next read
+    int64_t ready_at_us;    ///< data requested is not available until
+    uint16_t status;        ///< SHT31 status register
+    int64_t period_us;      ///< SHT31 periodic mode, zero when single shot
+    int64_t periodic_start_us;
+    int64_t fetched;        ///< SHT31 periodic measurement last fetched
+} i2c_sim_device;
+
+typedef struct
+{
+    uint32_t transactions;
+    uint32_t bytes;
+    uint32_t nacks;
+    uint64_t bus_us;        ///< simulated time the bus was occupied
+} i2c_sim_stats;
+
+/**
+ * @brief Initialize (or re-initialize) the simulated bus of a controller
+ *        with no devices.  Each controller (port) is independent.
+ * @param[in] port Controller, zero to I2C_SIM_PORTS - 1
+ * @param[in] multiplexer True if a TCA9548A multiplexer (0x70) is present.
+ *            When present devices only respond when their bus is selected.
+ */
+void i2c_sim_initialize(uint8_t port, bool multiplexer);
+
+/**
+ * @return pointer to the device or NULL if the bus is full
+ */
+i2c_sim_device* i2c_sim_add_device(i2c_sim_type type, uint8_t port, uint8_t bus,
+                                   uint8_t addr);
+
+/**
+ * @brief Model a device reset (e.g. a supply brown out).  Any mode set
+ *        by a command is lost and, for the SHT31, the status register
+ *        reports the reset.
+ */
+void i2c_sim_reset_device(i2c_sim_device *dev);
+
+/**
+ * @brief Transactions equivalent to a queued i2c command link:
+ *        START, address, data, STOP
+ * @return ESP_OK or ESP_FAIL when the device does not acknowledge
+ */
+esp_err_t i2c_sim_write(uint8_t port, uint8_t addr, const uint8_t *data, size_t len);
+esp_err_t i2c_sim_read(uint8_t port, uint8_t addr, uint8_t *data, size_t len);
+
+/**
+ * @brief Write then read using a repeated START (no STOP between)
+ */
+esp_err_t i2c_sim_write_read(uint8_t port, uint8_t addr, const uint8_t *send,
+                             size_t send_len, uint8_t *recv, size_t recv_len);
+
+const i2c_sim_stats* i2c_sim_get_stats(uint8_t port);
+void i2c_sim_clear_stats(uint8_t port);
+
+#ifdef __cplusplus
+}
+#endif
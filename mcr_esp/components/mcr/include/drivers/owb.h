@@ -228,6 +228,16 @@ uint8_t owb_crc8_byte(uint8_t crc, uint8_t data);
  */
 uint8_t owb_crc8_bytes(uint8_t crc, const uint8_t * data, size_t len);
 
+/**
+ * @brief 1-Wire 16-bit CRC lookup with accumulation over a block of bytes.
+ * @param[in] crc Starting CRC value. Pass in prior CRC to accumulate.
+ * @param[in] data Array of bytes to feed into CRC.
+ * @param[in] len Length of data array in bytes.
+ * @return Resultant CRC value.
+ *         Devices (e.g. DS2406, DS2408) transmit the inverted CRC.
+ */
+uint16_t owb_crc16_bytes(uint16_t crc, const uint8_t * data, size_t len);
+
 /**
  * @brief Locates the first device on the 1-Wire bus, if present.
  * @param[in] bus Pointer to initialised bus instance.
@@ -0,0 +1,132 @@
+/*
+    owb_sim.h - Master Control Remote Simulated 1-Wire Bus
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "drivers/owb.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define OWB_SIM_MAX_DEVICES   16
+
+// simulated bus time (microseconds) consumed by each slot type
+#define OWB_SIM_RESET_US      960
+#define OWB_SIM_SLOT_US       70
+
+/**
+ * @brief A single simulated device.  Fields may be changed between bus
+ *        transactions to model changes in the physical world.
+ */
+typedef struct
+{
+    OneWireBus_ROMCode rom_code;
+
+    bool parasite;         ///< device reports parasitic power for Read Power Supply
+    int16_t temp_raw;      ///< temperature devices: celsius in 1/16 degree units
+    uint8_t resolution;    ///< temperature devices: 9 to 12 bits
+    uint8_t pio;           ///< switch devices: PIO output latch (bit per channel)
+
+    int64_t convert_done_us;  ///< time the in-progress temperature convert completes
+} owb_sim_device;
+
+/**
+ * @brief Deterministic error injection, zero disables an error.
+ *        For example, crc_every = 10 corrupts every tenth response buffer.
+ */
+typedef struct
+{
+    uint32_t crc_every;       ///< corrupt one bit of a response buffer
+    uint32_t presence_every;  ///< a reset does not detect presence
+    uint32_t hw_error_every;  ///< read_bits() fails with OWB_STATUS_HW_ERROR
+    uint32_t reset_error_every;  ///< reset() fails with OWB_STATUS_HW_ERROR
+} owb_sim_inject;
+
+/**
+ * @brief Bus activity accumulated since initialization (or owb_sim_clear_stats)
+ */
+typedef struct
+{
+    uint32_t resets;
+    uint32_t bits_written;
+    uint32_t bits_read;
+    uint32_t crc_errors;
+    uint32_t presence_errors;
+    uint32_t hw_errors;
+    uint32_t reset_errors;
+    uint64_t bus_us;          ///< simulated time the bus was occupied
+} owb_sim_stats;
+
+typedef struct
+{
+    owb_sim_device devices[OWB_SIM_MAX_DEVICES];
+    int num_devices;
+
+    owb_sim_inject inject;
+    owb_sim_stats stats;
+
+    // transaction state (private)
+    int state;
+    int bit_count;
+    uint8_t byte_in;
+    int search_step;          ///< search: bit index * 3 + (id, complement, direction)
+    uint8_t rom_in[8];        ///< match: ROM code written by the master
+    uint32_t selected;        ///< bit per device addressed by the ROM command
+    uint8_t cmd[4];           ///< function command and any written parameters
+    int cmd_len;
+    uint8_t out[36];          ///< response buffer shifted out by read slots
+    int out_len;
+    int out_pos;
+    uint8_t out_fill;         ///< value read once the response is exhausted
+    uint32_t crc_counter;
+    uint32_t presence_counter;
+    uint32_t hw_error_counter;
+    uint32_t reset_error_counter;
+
+    OneWireBus bus;
+} owb_sim_driver_info;
+
+/**
+ * @brief Initialize a simulated bus with no devices.
+ * @return OneWireBus*, pass this into the other OneWireBus public API functions
+ */
+OneWireBus* owb_sim_initialize(owb_sim_driver_info *info);
+
+/**
+ * @brief Add a device to the simulated bus.  The ROM code CRC is computed.
+ * @param[in] family Family code (e.g. 0x28 DS18B20, 0x12 DS2406,
+ *            0x29 DS2408, 0x3a DS2413)
+ * @param[in] serial Serial number, the low 48 bits are used
+ * @return pointer to the device or NULL if the bus is full
+ */
+owb_sim_device* owb_sim_add_device(owb_sim_driver_info *info, uint8_t family, uint64_t serial);
+
+/**
+ * @brief Reset the accumulated bus activity
+ */
+void owb_sim_clear_stats(owb_sim_driver_info *info);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,126 @@
+/*
+    bus_sched.hpp - Master Control Remote Engine Bus Scheduler
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+#ifndef mcr_bus_sched_hpp
+#define mcr_bus_sched_hpp
+
+#include <cstdlib>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include "misc/histogram.hpp"
+
+namespace mcr {
+
+// bus job classes in priority order (highest first)
+typedef enum {
+  BUS_COMMAND = 0,
+  BUS_REPORT,
+  BUS_CONVERT,
+  BUS_DISCOVER,
+  BUS_JOB_CLASSES
+} BusJob_t;
+
+typedef class mcrBusScheduler mcrBusScheduler_t;
+
+// a waiter that does not block for the bus (e.g. a pass run by the executor).
+// a take by a busy bus registers the waiter and returns false, once the bus
+// is handed to the waiter notify is called and the next take is granted.
+typedef struct {
+  void (*notify)(void *arg);
+  void *arg;
+  bool waiting; // registered, waiting for the bus
+  bool granted; // the bus was handed to the waiter
+  uint64_t wait_start_us;
+} BusWaiter_t;
+
+// mcrBusScheduler:
+//    arbitrates ownership of a single physical bus between the tasks of an
+//    engine.  when the bus is released it is handed directly to the highest
+//    priority waiting job class.
+//
+//    jobs are not forcibly preempted.  instead, while a job of higher priority
+//    is waiting the yield bit is set in the engine event group so the holder
+//    can release the bus at the next safe transaction boundary.
+//
+//    as with a mutex, the holder inherits the priority of a waiting task of
+//    higher priority until it gives the bus and only the holder may give the
+//    bus.
+//
+//    a take with a waiter never blocks, the waiter is registered instead and
+//    notified when the bus is handed to it (see BusWaiter_t).  within a job
+//    class registered waiters are handed the bus before blocked tasks.
+//
+//    the time each job class waits for the bus is tracked in a histogram.
+class mcrBusScheduler {
+public:
+  mcrBusScheduler(EventGroupHandle_t evg, EventBits_t yield_bit);
+
+  bool take(BusJob_t job, TickType_t wait_ticks = portMAX_DELAY,
+            BusWaiter_t *waiter = nullptr);
+  void give();
+
+  // true when a job of higher priority than the holder is waiting
+  bool yieldRequested() const;
+
+  // copy the wait histograms (one per job class) then reset them
+  void snapshotWaits(mcrHistogram_t *hists);
+
+  static const char *jobName(BusJob_t job);
+
+private:
+  EventGroupHandle_t _evg = nullptr;
+  EventBits_t _yield_bit = 0;
+
+  // guards all members below
+  SemaphoreHandle_t _lock = nullptr;
+
+  bool _busy = false;
+  BusJob_t _holder = BUS_JOB_CLASSES;
+
+  // the task holding the bus, nullptr while the bus is handed to a waiting
+  // job (until the waiting task wakes)
+  TaskHandle_t _holder_task = nullptr;
+  UBaseType_t _holder_priority = 0; // before inheriting a waiter's priority
+  bool _holder_raised = false;
+  volatile uint32_t _waiting[BUS_JOB_CLASSES] = {};
+  UBaseType_t _waiting_priority[BUS_JOB_CLASSES] = {}; // highest of waiters
+
+  // the bus is handed to a waiting job by giving the semaphore of its class
+  SemaphoreHandle_t _grant[BUS_JOB_CLASSES] = {};
+  mcrHistogram_t _wait[BUS_JOB_CLASSES];
+
+  // registered waiters, in the order registered (see BusWaiter_t)
+  static const size_t max_async_waiters = 4;
+  BusWaiter_t *_async[BUS_JOB_CLASSES][max_async_waiters] = {};
+  size_t _async_count[BUS_JOB_CLASSES] = {};
+
+  bool higherPriorityWaiting(BusJob_t job) const;
+  bool registerWaiter(BusJob_t job, BusWaiter_t *waiter);
+  void holderAcquired();
+  void raiseHolder(UBaseType_t priority);
+  void updateYieldBit();
+};
+} // namespace mcr
+
+#endif // mcr_bus_sched_hpp
@@ -36,18 +36,34 @@
 #include "drivers/owb.h"
 // #include "drivers/owb_gpio.h"
 #include "drivers/owb_rmt.h"
+#include "drivers/owb_sim.h"
 #include "engines/engine.hpp"
 
 namespace mcr {
 
+// device data captured on the bus, decoded (then serialized and published)
+// after the bus is released
+typedef struct {
+  dsDev_t *dev;
+  uint32_t write_seq; // of the device when read (see mcrDev::writeSeq())
+  bool ok;
+  uint8_t data[44]; // large enough for a DS2408 channel access read
+  Reading_t *reading;
+  string_t *json;
+} dsRawRead_t;
+
 typedef class mcrDS mcrDS_t;
 class mcrDS : public mcrEngine<dsDev_t> {
 
 private:
-  mcrDS();
+  mcrDS(uint32_t bus);
 
 public:
-  static mcrDS_t *instance();
+  // each 1-Wire bus is managed by an independent engine instance (tasks,
+  // bus mutex and known devices).  bus zero is the default for callers
+  // that pre-date multiple bus support.
+  static mcrDS_t *instance(uint32_t bus = 0);
+  static uint32_t numBuses() { return CONFIG_MCR_W1_BUSES; }
 
   //
   // Tasks
@@ -61,11 +77,30 @@ public:
   void stop();
 
 protected:
+  // host_test/test_ds_engine.cpp drives the passes on the simulated bus
+  friend class mcrDSHostTest;
+
+  void initBus();
   bool resetBus(bool *present = nullptr);
 
+  TickType_t convertPass();
+  TickType_t discoverPass();
+  TickType_t reportPass();
+  bool phaseReady(TaskTypes_t phase);
+
+  bool snapshotDevice(dsDev_t *dev, EngineDevSnap_t &snap);
+  dsDev_t *restoreDevice(const EngineDevSnap_t &snap);
+
 private:
+  uint32_t _bus = 0;
+  string_t _engine_name;
   uint8_t _pin = CONFIG_MCR_W1_PIN;
+  rmt_channel_t _tx_channel = RMT_CHANNEL_0;
+  rmt_channel_t _rx_channel = RMT_CHANNEL_1;
   OneWireBus *_ds = nullptr;
+#ifdef CONFIG_MCR_W1_SIMULATED
+  owb_sim_driver_info *_sim = nullptr;
+#endif
 
   bool _devices_powered = true;
   bool _temp_devices_present = true;
@@ -73,29 +108,60 @@ private:
   // delay times
   const TickType_t _loop_frequency =
       pdMS_TO_TICKS(CONFIG_MCR_DS_ENGINE_FREQUENCY_SECS * 1000);
-  const TickType_t _convert_frequency =
-      pdMS_TO_TICKS(CONFIG_MCR_DS_CONVERT_FREQUENCY_SECS * 1000);
-  const TickType_t _discover_frequency =
-      pdMS_TO_TICKS(CONFIG_MCR_DS_DISCOVER_FREQUENCY_SECS * 1000);
-  const TickType_t _report_frequency =
-      pdMS_TO_TICKS(CONFIG_MCR_DS_REPORT_FREQUENCY_SECS * 1000);
   const TickType_t _temp_convert_wait =
       pdMS_TO_TICKS(CONFIG_MCR_DS_TEMP_CONVERT_POLL_MS);
   const uint64_t _max_temp_convert_us =
       (1000 * 1000); // one second in microsecs
+  const uint64_t _temp_convert_us =
+      (750 * 1000); // worst case (12-bit) conversion in microsecs
+
+  // start of a convert that completes by time (the bus was released)
+  uint64_t _convert_by_time_us = 0;
+  TickType_t convertByTime();
 
   bool checkDevicesPowered();
   bool commandAck(cmdSwitch_t &cmd);
 
   bool devicesPowered() { return _devices_powered; }
 
-  bool readDevice(dsDev_t *dev);
+  // the report phase reads up to this many devices before decoding and
+  // publishing them
+  static const uint32_t _report_batch_max = 8;
+  dsRawRead_t _report_batch[_report_batch_max];
+
+  // a discover pass in progress (see discoverPass())
+  bool _discover_active = false;
+  bool _discover_found = false;
+  bool _discover_temp_devs = false;
+  OneWireBus_SearchState _discover_search = {};
+  TickType_t discoverWaits(TickType_t resume_ticks);
+
+  // a report pass in progress (see reportPass())
+  DeviceList_t _report_devs;
+  uint32_t _report_next = 0;
+  uint32_t _report_batched = 0;
+  uint64_t _report_bus_us = 0;
 
-  // specific methods to read devices
-  bool readDS1820(dsDev_t *dev, celsiusReading_t **reading);
-  bool readDS2408(dsDev_t *dev, positionsReading_t **reading = nullptr);
-  bool readDS2406(dsDev_t *dev, positionsReading_t **reading);
-  bool readDS2413(dsDev_t *dev, positionsReading_t **reading);
+  // guards the readings of the devices (not the bus):  held by a cmd from
+  // the write through the ack and by report to install and publish a batch
+  SemaphoreHandle_t _dev_mutex = nullptr;
+
+  bool readDevice(dsDev_t *dev);
+  bool readRaw(dsRawRead_t &raw, bool reset = true);
+  Reading_t *decodeRaw(dsRawRead_t &raw);
+  void reportBatch(uint32_t count);
+
+  // specific methods to read devices (bus operations only)
+  bool readDS1820(dsDev_t *dev, uint8_t *data);
+  bool readDS2408(dsDev_t *dev, uint8_t *data);
+  bool readDS2406(dsDev_t *dev, uint8_t *data);
+  bool readDS2413(dsDev_t *dev, uint8_t *data);
+
+  // specific methods to decode the data read from devices
+  celsiusReading_t *decodeDS1820(dsDev_t *dev, const uint8_t *data);
+  positionsReading_t *decodeDS2406(dsDev_t *dev, const uint8_t *data);
+  positionsReading_t *decodeDS2408(dsDev_t *dev, const uint8_t *data);
+  positionsReading_t *decodeDS2413(dsDev_t *dev, const uint8_t *data);
 
   bool setDS2406(cmdSwitch_t &cmd, dsDev_t *dev);
   bool setDS2408(cmdSwitch_t &cmd, dsDev_t *dev);
@@ -106,91 +172,35 @@ private:
 
   static bool check_crc16(const uint8_t *input, uint16_t len,
                           const uint8_t *inverted_crc, uint16_t crc = 0);
-  static uint16_t crc16(const uint8_t *input, uint16_t len, uint16_t crc);
 
   void printInvalidDev(dsDev_t *dev);
 
-  EngineTagMap_t &localTags() {
-    static EngineTagMap_t tag_map = {{"engine", "mcrDS"},
-                                     {"discover", "mcrDS discover"},
-                                     {"convert", "mcrDS convert"},
-                                     {"report", "mcrDS report"},
-                                     {"command", "mcrDS command"},
-                                     {"readDevice", "DS readDevice"},
-                                     {"readDS1820", "mcrDS readDS1820"},
-                                     {"readDS2406", "mcrDS readDS2406"},
-                                     {"readDS2408", "mcrDS readDS2408"},
-                                     {"readDS2413", "mcrDS readDS2413"},
-                                     {"setDS2406", "mcrDS setDS2406"},
-                                     {"setDS2408", "mcrDS setDS2408"},
-                                     {"setDS2413", "mcrDS setDS2413"}};
-
-    return tag_map;
-  }
-
-  const char *tagReadDevice() {
-    static const char *tag = nullptr;
-    if (tag == nullptr) {
-      tag = _tags["readDevice"].c_str();
-    }
-    return tag;
-  }
-
-  const char *tagReadDS1820() {
-    static const char *tag = nullptr;
-    if (tag == nullptr) {
-      tag = _tags["readDS1820"].c_str();
-    }
-    return tag;
-  }
-
-  const char *tagReadDS2406() {
-    static const char *tag = nullptr;
-    if (tag == nullptr) {
-      tag = _tags["readDS2406"].c_str();
-    }
-    return tag;
-  }
-
-  const char *tagReadDS2408() {
-    static const char *tag = nullptr;
-    if (tag == nullptr) {
-      tag = _tags["readDS2408"].c_str();
-    }
-    return tag;
-  }
-
-  const char *tagReadDS2413() {
-    static const char *tag = nullptr;
-    if (tag == nullptr) {
-      tag = _tags["readDS2413"].c_str();
-    }
-    return tag;
-  }
-
-  const char *tagSetDS2406() {
-    static const char *tag = nullptr;
-    if (tag == nullptr) {
-      tag = _tags["setDS2406"].c_str();
-    }
-    return tag;
-  }
-
-  const char *tagSetDS2408() {
-    static const char *tag = nullptr;
-    if (tag == nullptr) {
-      tag = _tags["setDS2408"].c_str();
-    }
-    return tag;
-  }
-
-  const char *tagSetDS2413() {
-    static const char *tag = nullptr;
-    if (tag == nullptr) {
-      tag = _tags["setDS2413"].c_str();
-    }
-    return tag;
-  }
+#ifdef CONFIG_MCR_W1_SIMULATED
+  void simulatedDevices();
+#endif
+
+  // tags are prefixed with the engine name so log output identifies the bus
+  typedef enum {
+    DS_TAG_READ_DEVICE = ENGINE_TAG_LOCAL,
+    DS_TAG_READ_DS1820,
+    DS_TAG_READ_DS2406,
+    DS_TAG_READ_DS2408,
+    DS_TAG_READ_DS2413,
+    DS_TAG_SET_DS2406,
+    DS_TAG_SET_DS2408,
+    DS_TAG_SET_DS2413
+  } dsTag_t;
+
+  static const EngineTagDef_t _tag_defs[];
+
+  const char *tagReadDevice() { return tagAt(DS_TAG_READ_DEVICE); }
+  const char *tagReadDS1820() { return tagAt(DS_TAG_READ_DS1820); }
+  const char *tagReadDS2406() { return tagAt(DS_TAG_READ_DS2406); }
+  const char *tagReadDS2408() { return tagAt(DS_TAG_READ_DS2408); }
+  const char *tagReadDS2413() { return tagAt(DS_TAG_READ_DS2413); }
+  const char *tagSetDS2406() { return tagAt(DS_TAG_SET_DS2406); }
+  const char *tagSetDS2408() { return tagAt(DS_TAG_SET_DS2408); }
+  const char *tagSetDS2413() { return tagAt(DS_TAG_SET_DS2413); }
 };
 } // namespace mcr
 
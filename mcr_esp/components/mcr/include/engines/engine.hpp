@@ -23,21 +23,31 @@
 
 #include <algorithm>
 #include <cstdlib>
+#include <cstring>
+#include <memory>
 #include <unordered_map>
+#include <vector>
 
 #include <esp_log.h>
+#include <esp_timer.h>
 #include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 #include <freertos/task.h>
 
+#include "cmds/engine_config.hpp"
 #include "cmds/queues.hpp"
 #include "cmds/switch.hpp"
 #include "devs/base.hpp"
+#include "engines/bus_sched.hpp"
+#include "engines/registry.hpp"
 #include "engines/types.hpp"
 #include "misc/elapsedMillis.hpp"
 #include "misc/hw_config.hpp"
 #include "misc/mcr_nvs.hpp"
 #include "misc/mcr_restart.hpp"
 #include "misc/mcr_types.hpp"
+#include "misc/metrics.hpp"
+#include "misc/trace.hpp"
 #include "net/mcr_net.hpp"
 #include "protocols/mqtt.hpp"
 #include "readings/readings.hpp"
@@ -48,13 +58,37 @@ template <class DEV> class mcrEngine {
 private:
   TaskMap_t _task_map;
 
-  typedef std::unordered_map<string_t, DEV *> DeviceMap_t;
-  DeviceMap_t _devices;
+public:
+  // known devices (see registry.hpp)
+  typedef typename mcrDevRegistry<DEV>::DeviceEntry_t DeviceEntry_t;
+  typedef typename mcrDevRegistry<DEV>::DeviceMap_t DeviceMap_t;
+  typedef typename mcrDevRegistry<DEV>::DeviceList_t DeviceList_t;
+
+private:
+  mcrDevRegistry<DEV> _registry{maxDevices()};
 
   EventGroupHandle_t _evg;
-  SemaphoreHandle_t _bus_mutex = nullptr;
+  mcrBusScheduler_t *_bus_sched = nullptr;
+
+  EngineConfig_t _config = {};
+
+  // warm start (see restoreDevices())
+  bool _devices_changed = false;
+  uint32_t _devices_restored = 0;
+  uint64_t _first_reading_us = 0; // since boot, zero until the first reading
+  bool _first_reading_reported = false;
 
   EngineMetrics_t metrics;
+  portMUX_TYPE _metrics_mux = portMUX_INITIALIZER_UNLOCKED;
+
+  uint8_t _trace_src = 0; // the source of trace events (see mcrTrace)
+
+  // executor mode:  set while a pass waits to continue (see runPass())
+  bool _pass_continues[REPORT + 1] = {};
+
+  // executor mode:  the pass of each bus job class registered as waiting
+  // for the bus (see takePassBus())
+  BusWaiter_t _pass_waiter[BUS_JOB_CLASSES] = {};
 
   engineEventBits_t _event_bits = {.need_bus = BIT0,
                                    .engine_running = BIT1,
@@ -110,6 +144,45 @@ private:
     task->command(data);
   }
 
+  //
+  // Engine Phases (executor mode)
+  //
+  static TickType_t runConvertPass(void *task_instance) {
+    return ((mcrEngine *)task_instance)->runPass(CONVERT);
+  }
+
+  static TickType_t runDiscoverPass(void *task_instance) {
+    return ((mcrEngine *)task_instance)->runPass(DISCOVER);
+  }
+
+  static TickType_t runReportPass(void *task_instance) {
+    return ((mcrEngine *)task_instance)->runPass(REPORT);
+  }
+
+  // a pass is started only when the phase is ready, once started it is
+  // continued (regardless of ready) until complete
+  TickType_t runPass(TaskTypes_t phase) {
+    if ((_pass_continues[phase] == false) && (phaseReady(phase) == false)) {
+      return 0;
+    }
+
+    TickType_t resume_ticks = pass(phase);
+    _pass_continues[phase] = (resume_ticks > 0);
+
+    return resume_ticks;
+  }
+
+  // applies an engine.config cmd (called by the mqtt task)
+  static bool runConfigure(void *engine, const cmdEngineConfig_t &cmd) {
+    return ((mcrEngine *)engine)->configure(cmd);
+  }
+
+  // adds the metrics of the engine to the export of the metrics registry
+  // (called by the timestamp task)
+  static void runCollectMetrics(void *engine, metricsReading_t &reading) {
+    ((mcrEngine *)engine)->collectMetrics(reading);
+  }
+
   //
   // Default Do Nothing Task Implementation
   //
@@ -122,12 +195,19 @@ private:
 public:
   mcrEngine() {
     _evg = xEventGroupCreate();
-    _bus_mutex = xSemaphoreCreateMutex();
+
+    // the bus scheduler signals (via the need bus bit) when a job of higher
+    // priority than the current holder is waiting for the bus
+    _bus_sched = new mcrBusScheduler(_evg, _event_bits.need_bus);
 
     metrics.report.elapsed.freeze(0);
     metrics.discover.elapsed.freeze(0);
     metrics.convert.elapsed.freeze(0);
     metrics.switch_cmd.elapsed.freeze(0);
+
+    for (auto &text : _tag_text) {
+      text = "";
+    }
   };
 
   virtual ~mcrEngine(){};
@@ -161,6 +241,9 @@ public:
 
   const TaskMap_t &taskMap() { return _task_map; }
 
+  // the engine name is the name of the core task (see addTask())
+  const string_t &engineName() { return _task_map[CORE]->_name; }
+
   xTaskHandle taskHandle() {
     auto task = _task_map[CORE];
 
@@ -245,6 +328,32 @@ public:
         subtask = nullptr;
       }
 
+#ifdef CONFIG_MCR_ENGINE_EXECUTOR
+      if ((subtask != nullptr) && (subtask->_interval > 0)) {
+        ExecutorFunc_t *run_pass = nullptr;
+
+        switch (sub_type) {
+        case CONVERT:
+          run_pass = &runConvertPass;
+          break;
+        case DISCOVER:
+          run_pass = &runDiscoverPass;
+          break;
+        case REPORT:
+          run_pass = &runReportPass;
+          break;
+        default:
+          break;
+        }
+
+        if (run_pass != nullptr) {
+          subtask->_job = mcrExecutor::instance()->schedule(
+              subtask->_name.c_str(), run_pass, this, subtask->_interval);
+          subtask = nullptr;
+        }
+      }
+#endif
+
       if (subtask != nullptr) {
         ::xTaskCreate(run_subtask, subtask->_name.c_str(), subtask->_stackSize,
                       this, subtask->_priority, &subtask->_handle);
@@ -270,10 +379,15 @@ public:
   }
 
   // FIXME: move to external config
-  static uint32_t maxDevices() { return 100; };
+  static constexpr uint32_t maxDevices() { return 100; };
 
   bool any_of_devices(bool (*func)(const DEV &)) {
-    return std::any_of(_devices.cbegin(), _devices.cend(), func);
+    DeviceList_t devs = devices();
+
+    return std::any_of(devs->cbegin(), devs->cend(),
+                       [func](const DeviceEntry_t &item) {
+                         return func(*(item.second));
+                       });
   }
 
   // justSeenDevice():
@@ -281,7 +395,7 @@ public:
   //    the device and returns it
   //
   DEV *justSeenDevice(DEV &dev) {
-    auto *found_dev = findDevice(dev.id());
+    auto *found_dev = findDevice(dev.key());
 
     if (LOG_LOCAL_LEVEL >= ESP_LOG_DEBUG) {
       ESP_LOGV(tagEngine(), "just saw: %s", dev.debug().get());
@@ -300,73 +414,349 @@ public:
 
   bool addDevice(DEV *dev) {
     auto rc = false;
-    DEV *found = nullptr;
 
-    if (numKnownDevices() > maxDevices()) {
-      ESP_LOGW(tagEngine(), "attempt to exceed max devices!");
-      return rc;
-    }
+    dev->justSeen();
 
-    if ((found = findDevice(dev->id())) == nullptr) {
-      dev->justSeen();
-      // _devices.push_back(dev);
-      _devices[dev->id()] = dev;
+    switch (_registry.add(dev)) {
+    case REGISTRY_ADDED:
+      _devices_changed = true;
       ESP_LOGV(tagEngine(), "added %s", dev->debug().get());
+      rc = true;
+      break;
+
+    case REGISTRY_FULL:
+      ESP_LOGW(tagEngine(), "attempt to exceed max devices!");
+      break;
+
+    case REGISTRY_KNOWN:
+      break;
     }
 
-    return (found == nullptr) ? true : false;
+    return rc;
   };
 
-  DEV *findDevice(const string_t &dev) {
-    // my first lambda in C++, wow this languge has really evolved
-    // since I used it 15+ years ago
-    // auto found =
-    //     std::find_if(_devices.begin(), _devices.end(),
-    //                  [dev](DEV *search) { return search->id() == dev; });
+  DEV *findDevice(uint64_t key) { return _registry.find(key); }
+  DEV *findDevice(const string_t &dev) { return _registry.find(dev); }
 
-    auto found = _devices.find(dev);
+  // a snapshot of the known devices to iterate, devices added while
+  // iterating are in the next snapshot
+  DeviceList_t devices() { return _registry.snapshot(); }
 
-    if (found != _devices.end()) {
-      return found->second;
-    }
+  uint32_t numKnownDevices() { return devices()->size(); };
+  bool isDeviceKnown(const string_t &id) {
+    bool rc = false;
 
-    return nullptr;
-  }
+    rc = (findDevice(id) == nullptr ? false : true);
+    return rc;
+  };
 
-  auto beginDevices() -> typename DeviceMap_t::iterator {
-    return _devices.begin();
+private:
+  // nvs keys are limited to 15 characters (e.g. mcrI2c1.cfg)
+  string_t nvsKey(const char *suffix) {
+    return engineName().substr(0, 11) + suffix;
   }
 
-  auto endDevices() -> typename DeviceMap_t::iterator { return _devices.end(); }
+  // the intervals of the phases run by the executor
+  void applyIntervals() {
+    const TickType_t intervals[] = {convertFrequency(), discoverFrequency(),
+                                    reportFrequency()};
+    const TaskTypes_t phases[] = {CONVERT, DISCOVER, REPORT};
 
-  auto knownDevices() -> typename DeviceMap_t::iterator {
-    return _devices.begin();
-  }
-  bool endOfDevices(typename DeviceMap_t::iterator it) {
-    return it == _devices.end();
-  };
+    for (auto i = 0; i < 3; i++) {
+      auto found = _task_map.find(phases[i]);
 
-  bool moreDevices(typename DeviceMap_t::iterator it) {
-    return it != _devices.end();
-  };
+      if (found == _task_map.end()) {
+        continue;
+      }
 
-  uint32_t numKnownDevices() { return _devices.size(); };
-  bool isDeviceKnown(const string_t &id) {
-    bool rc = false;
+      EngineTask_t *task = found->second;
+      task->_interval = intervals[i];
 
-    rc = (findDevice(id) == nullptr ? false : true);
-    return rc;
-  };
+#ifdef CONFIG_MCR_ENGINE_EXECUTOR
+      if (task->_job != nullptr) {
+        mcrExecutor::instance()->reschedule(task->_job, task->_interval);
+      }
+#endif
+    }
+  }
 
 protected:
-  typedef std::unordered_map<string_t, string_t> EngineTagMap_t;
-  EngineTagMap_t _tags;
+  string_t _tag_strings[ENGINE_TAG_MAX];
+  const char *_tag_keys[ENGINE_TAG_MAX] = {};
+  const char *_tag_text[ENGINE_TAG_MAX] = {};
 
   virtual void convert(void *data) { doNothing(); };
   virtual void command(void *data) { doNothing(); };
   virtual void discover(void *data) { doNothing(); };
   virtual void report(void *data) { doNothing(); };
 
+  // a single pass of a phase.  the phase tasks (above) loop on the pass
+  // while, in executor mode, the pass is a job run on the interval of the
+  // phase (see EngineTask::_interval).
+  //
+  // a pass returns zero when complete.  a pass that must wait (e.g. for a
+  // device or the bus) returns the ticks to wait and is called again to
+  // continue so, in executor mode, the worker is not held by the wait.
+  virtual TickType_t convertPass() { return 0; };
+  virtual TickType_t discoverPass() { return 0; };
+  virtual TickType_t reportPass() { return 0; };
+
+  TickType_t pass(TaskTypes_t phase) {
+    switch (phase) {
+    case CONVERT:
+      return convertPass();
+    case DISCOVER:
+      return discoverPass();
+    case REPORT:
+      return reportPass();
+    default:
+      return 0;
+    }
+  }
+
+  // the phase tasks simply wait out each continue of the pass
+  void passUntilComplete(TaskTypes_t phase) {
+    TickType_t resume_ticks = pass(phase);
+
+    while (resume_ticks > 0) {
+      vTaskDelay(resume_ticks);
+      resume_ticks = pass(phase);
+    }
+  }
+
+  // executor mode:  a pass waiting for the bus continues as soon as the bus
+  // is handed to it (see takePassBus()), the wait is only a fallback
+  TickType_t busWaitTicks() const { return pdMS_TO_TICKS(1000); }
+
+  // executor mode:  the tasks of the phases block until ready, a job does
+  // not so the pass is skipped until ready
+  virtual bool phaseReady(TaskTypes_t phase) {
+    EventBits_t bits = 0;
+
+    switch (phase) {
+    case CONVERT:
+      bits = devicesOrTempSensorsBit();
+      break;
+    case DISCOVER:
+      bits = engineBit();
+      break;
+    case REPORT:
+      bits = devicesAvailableBit();
+      break;
+    default:
+      return false;
+    }
+
+    if (phaseEnabled(phase) == false) {
+      return false;
+    }
+
+    bool ready = ((xEventGroupGetBits(_evg) & bits) == bits);
+
+    if (phase == REPORT) {
+      ready = ready && Net::waitForNormalOps(0);
+    }
+
+    return ready;
+  }
+
+  // executor mode:  run the pass of a phase now (e.g. report once a
+  // temperature convert is complete)
+  void triggerPhase(TaskTypes_t phase) {
+#ifdef CONFIG_MCR_ENGINE_EXECUTOR
+    auto found = _task_map.find(phase);
+
+    if ((found != _task_map.end()) && (found->second->_job != nullptr)) {
+      mcrExecutor::instance()->trigger(found->second->_job);
+    }
+#endif
+  }
+
+  //
+  // Engine Config
+  //
+  // the cadences are read at each taskDelayUntil() so a change applied by
+  // an engine.config cmd takes effect without restarting the tasks
+  TickType_t convertFrequency() {
+    return pdMS_TO_TICKS(_config.convert_secs * 1000);
+  }
+  TickType_t discoverFrequency() {
+    return pdMS_TO_TICKS(_config.discover_secs * 1000);
+  }
+  TickType_t reportFrequency() {
+    return pdMS_TO_TICKS(_config.report_secs * 1000);
+  }
+  uint32_t discoverSecs() const { return _config.discover_secs; }
+
+  bool phaseEnabled(TaskTypes_t phase) {
+    switch (phase) {
+    case CONVERT:
+      return _config.convert;
+    case DISCOVER:
+      return _config.discover;
+    default:
+      return true;
+    }
+  }
+
+  // called by the subclass once the tasks are added.  the defaults (from
+  // Kconfig) are replaced by the config persisted in NVS, if any.
+  void loadConfig(const EngineConfig_t &defaults) {
+    _config = defaults;
+
+    esp_err_t esp_rc = mcrNVS::getBlob(nvsKey(".cfg").c_str(), &_config,
+                                       sizeof(EngineConfig_t));
+
+    if (esp_rc == ESP_OK) {
+      ESP_LOGI(tagEngine(), "config from nvs convert(%us%s) discover(%us%s) "
+                            "report(%us)",
+               _config.convert_secs, (_config.convert ? "" : " disabled"),
+               _config.discover_secs, (_config.discover ? "" : " disabled"),
+               _config.report_secs);
+    } else {
+      _config = defaults;
+    }
+
+    applyIntervals();
+    cmdEngineConfig::registerEngine(engineName(), &runConfigure, this);
+    _trace_src = mcrTrace::registerSource(engineName().c_str());
+    mcrMetrics::registerCollector(&runCollectMetrics, this);
+  }
+
+  // register a metric of the engine, the name is prefixed by the engine
+  // name (e.g. mcrI2c0.bus_selects)
+  void registerMetric(mcrMetric_t &metric, const char *name) {
+    char full_name[mcrMetric::max_name_len] = {};
+
+    snprintf(full_name, sizeof(full_name), "%s.%s", engineName().c_str(),
+             name);
+    metric.registerAs(full_name);
+  }
+
+  //
+  // Warm Start
+  //
+  // the known devices are persisted so, after a restart, reports begin as
+  // soon as the engine is running.  discover then confirms the restored
+  // devices (and finds new devices) in the background.
+
+  // called by the subclass once the bus is ready, returns the number of
+  // devices restored
+  uint32_t restoreDevices() {
+    std::unique_ptr<EngineDevRegistry_t> reg(new EngineDevRegistry_t());
+    uint32_t restored = 0;
+
+    esp_err_t esp_rc = mcrNVS::getBlob(nvsKey(".dev").c_str(), reg.get(),
+                                       sizeof(EngineDevRegistry_t));
+
+    if (esp_rc != ESP_OK) {
+      return restored;
+    }
+
+    if (reg->count > EngineDevRegistry_t::max_devices) {
+      ESP_LOGW(tagEngine(), "saved device count %u > max %u, truncated",
+               reg->count, EngineDevRegistry_t::max_devices);
+    }
+
+    for (uint32_t i = 0;
+         (i < reg->count) && (i < EngineDevRegistry_t::max_devices); i++) {
+      DEV *dev = restoreDevice(reg->devs[i]);
+
+      if (dev == nullptr) {
+        continue;
+      }
+
+      if (addDevice(dev)) {
+        restored++;
+      } else {
+        delete dev;
+      }
+    }
+
+    // restored devices are not a change to save
+    _devices_changed = false;
+    _devices_restored = restored;
+
+    ESP_LOGI(tagEngine(), "restored %u of %u devices", restored, reg->count);
+
+    return restored;
+  }
+
+  // called by the subclass at the end of discover, the known devices are
+  // saved only when discover found a new device
+  void saveDevices() {
+    static_assert(EngineDevRegistry_t::max_devices >= maxDevices(),
+                  "the persisted registry must hold every device");
+
+    if (_devices_changed == false) {
+      return;
+    }
+
+    _devices_changed = false;
+
+    std::unique_ptr<EngineDevRegistry_t> reg(new EngineDevRegistry_t());
+    DeviceList_t devs = devices();
+    uint32_t not_saved = 0;
+
+    for (auto &item : *devs) {
+      if (reg->count >= EngineDevRegistry_t::max_devices) {
+        not_saved++;
+        continue;
+      }
+
+      if (snapshotDevice(item.second, reg->devs[reg->count])) {
+        reg->count++;
+      }
+    }
+
+    if (not_saved > 0) {
+      ESP_LOGW(tagEngine(), "registry full, %u devices not saved", not_saved);
+    }
+
+    mcrNVS::commitBlob(nvsKey(".dev").c_str(), reg.get(),
+                       sizeof(EngineDevRegistry_t));
+
+    ESP_LOGD(tagEngine(), "saved %u devices", reg->count);
+  }
+
+  // the engine specific translation of a device to (and from) the persisted
+  // form, engines that do not override are not warm started
+  virtual bool snapshotDevice(DEV *dev, EngineDevSnap_t &snap) {
+    return false;
+  }
+  virtual DEV *restoreDevice(const EngineDevSnap_t &snap) { return nullptr; }
+
+  // called as readings of devices are published, the time (since boot) of
+  // the first reading is a startup metric
+  void trackFirstReading() {
+    if (_first_reading_us == 0) {
+      _first_reading_us = esp_timer_get_time();
+
+      ESP_LOGI(tagEngine(), "first reading %0.1fms after boot (%u restored)",
+               (float)(_first_reading_us / 1000.0), _devices_restored);
+    }
+  }
+
+  bool configure(const cmdEngineConfig_t &cmd) {
+    EngineConfig_t config = _config;
+
+    if (cmd.apply(config) == false) {
+      return false;
+    }
+
+    _config = config;
+    mcrNVS::commitBlob(nvsKey(".cfg").c_str(), &_config,
+                       sizeof(EngineConfig_t));
+    applyIntervals();
+
+    // echo the applied config
+    EngineReading reading(tagEngine(), 0, 0, 0, 0);
+    reading.setConfig(_config);
+    publish(&reading);
+
+    return true;
+  }
+
   void logSubTaskStart(void *task_info) {
     logSubTaskStart((EngineTask_ptr_t)task_info);
   }
@@ -402,7 +792,15 @@ protected:
   // event group
   void devicesAvailable(bool available = true) {
     if (available) {
+      EventBits_t prev = xEventGroupGetBits(_evg);
       xEventGroupSetBits(_evg, _event_bits.devices_available);
+
+      // executor mode:  the phases waiting on devices start now rather than
+      // at their next interval
+      if ((prev & _event_bits.devices_available) == 0) {
+        triggerPhase(CONVERT);
+        triggerPhase(REPORT);
+      }
     } else {
       xEventGroupClearBits(_evg, _event_bits.devices_available);
     }
@@ -411,15 +809,26 @@ protected:
     xEventGroupClearBits(_evg, _event_bits.devices_available);
   }
 
-  void engineRunning() { xEventGroupSetBits(_evg, _event_bits.engine_running); }
+  void engineRunning() {
+    EventBits_t prev = xEventGroupGetBits(_evg);
+    xEventGroupSetBits(_evg, _event_bits.engine_running);
+
+    if ((prev & _event_bits.engine_running) == 0) {
+      triggerPhase(DISCOVER);
+    }
+  }
+
+  // set and cleared by the bus scheduler, true when a job of higher priority
+  // than the current holder is waiting for the bus
   bool isBusNeeded() {
     EventBits_t bits = xEventGroupGetBits(_evg);
     return (bits & needBusBit());
   }
 
-  void needBus() { xEventGroupSetBits(_evg, needBusBit()); }
-  void clearNeedBus() { xEventGroupClearBits(_evg, needBusBit()); }
-  void tempAvailable() { xEventGroupSetBits(_evg, _event_bits.temp_available); }
+  void tempAvailable() {
+    xEventGroupSetBits(_evg, _event_bits.temp_available);
+    triggerPhase(REPORT);
+  }
   void tempUnavailable() {
     xEventGroupClearBits(_evg, _event_bits.temp_available);
   }
@@ -454,19 +863,111 @@ protected:
     return (sb & b);
   }
 
-  // semaphore
-  void giveBus() { xSemaphoreGive(_bus_mutex); }
-  bool takeBus(TickType_t wait_ticks = portMAX_DELAY) {
-    // the bus will be in an indeterminate state if we do acquire it so
-    // call resetBus(). said differently, we could have taken the bus
-    // in the middle of some other operation (e.g. discover, device read)
-    if ((xSemaphoreTake(_bus_mutex, wait_ticks) == pdTRUE) && resetBus()) {
+  // bus scheduler
+  void giveBus() {
+    mcrTrace::record(TRACE_BUS_GIVE, mcrTrace::arg(_trace_src, 0));
+    _bus_sched->give();
+  }
+
+  // returns true only when the bus is held
+  bool takeBus(BusJob_t job, TickType_t wait_ticks = portMAX_DELAY) {
+    if (_bus_sched->take(job, wait_ticks) == false) {
+      return false;
+    }
+
+    return busTaken(job);
+  }
+
+  // takePassBus():
+  //    the take of the bus by a pass.  returns true when the bus is held
+  //    otherwise the pass returns resume_ticks:
+  //      non zero when the bus is busy so the pass continues later
+  //      zero when the bus reset failed so the pass ends
+  //
+  //    a phase task waits for the bus.  in executor mode the pass is
+  //    registered as waiting instead and continues once the bus is handed
+  //    to it.
+  bool takePassBus(BusJob_t job, TickType_t &resume_ticks) {
+#ifdef CONFIG_MCR_ENGINE_EXECUTOR
+    BusWaiter_t *waiter = &(_pass_waiter[job]);
+
+    if (waiter->notify == nullptr) {
+      waiter->notify = &resumePass;
+      waiter->arg = _task_map[passPhase(job)];
+    }
+
+    resume_ticks = busWaitTicks();
+    if (_bus_sched->take(job, 0, waiter) == false) {
+      return false;
+    }
+#else
+    _bus_sched->take(job, portMAX_DELAY);
+#endif
+
+    resume_ticks = 0;
+    return busTaken(job);
+  }
+
+  // yieldPassBus():
+  //    called by a pass holding the bus at a safe transaction boundary.  if a
+  //    job of higher priority is waiting the bus is given to it then taken
+  //    again (see takePassBus()).  returns true when the bus is not held so
+  //    the pass returns resume_ticks, false to continue holding the bus (the
+  //    bus is reset when it was yielded).
+  bool yieldPassBus(BusJob_t job, TickType_t &resume_ticks) {
+    if (isBusNeeded() == false) {
+      return false;
+    }
+
+    giveBus();
+
+    return (takePassBus(job, resume_ticks) == false);
+  }
+
+private:
+  static TaskTypes_t passPhase(BusJob_t job) {
+    switch (job) {
+    case BUS_CONVERT:
+      return CONVERT;
+    case BUS_DISCOVER:
+      return DISCOVER;
+    default:
+      return REPORT;
+    }
+  }
+
+  // executor mode:  called by the bus scheduler once the bus is handed to
+  // the waiting pass
+  static void resumePass(void *task) {
+#ifdef CONFIG_MCR_ENGINE_EXECUTOR
+    ExecutorJob_t *job =
+        (task != nullptr) ? ((EngineTask_t *)task)->_job : nullptr;
+
+    if (job != nullptr) {
+      mcrExecutor::instance()->resumeNow(job);
+    }
+#endif
+  }
+
+  // the bus will be in an indeterminate state if we do acquire it so
+  // call resetBus(). said differently, we could have taken the bus
+  // in the middle of some other operation (e.g. discover, device read).
+  // when the reset fails the bus is given back.
+  bool busTaken(BusJob_t job) {
+    mcrTrace::record(TRACE_BUS_TAKE, mcrTrace::arg(_trace_src, job));
+
+    if (resetBus()) {
       return true;
     }
 
+    ESP_LOGW(tagEngine(), "bus reset failed (%s), giving bus",
+             mcrBusScheduler::jobName(job));
+    giveBus();
+
     return false;
   }
 
+protected:
   bool publish(mcrCmd_t &cmd) { return publish(cmd.internalDevID()); };
   bool publish(const string_t &dev_id) {
     DEV *search = findDevice(dev_id);
@@ -485,6 +986,7 @@ protected:
       Reading_t *reading = dev->reading();
 
       if (reading != nullptr) {
+        trackFirstReading();
         publish(reading);
         rc = true;
       }
@@ -548,35 +1050,37 @@ protected:
     return text;
   }
 
-  // definition of an entry in the EngineTagMap:
-  //  key:    identifier (e.g. 'engine', 'discover')
-  //  entry:  text displayed by ESP_LOG* when logging level matches
-  typedef std::pair<string_t, string_t> EngineTagItem_t;
   void setLoggingLevel(esp_log_level_t level) {
-    for_each(_tags.begin(), _tags.end(), [this, level](EngineTagItem_t item) {
-      string_t &key = item.first;
-      string_t &tag_text = item.second;
+    for (uint32_t i = 0; i < ENGINE_TAG_MAX; i++) {
+      if (_tag_keys[i] == nullptr) {
+        continue;
+      }
 
-      ESP_LOGD(_tags["engine"].c_str(), "key(%s) tag(%s) %s logging",
-               key.c_str(), tag_text.c_str(), logLevelAsText(level));
-      esp_log_level_set(tag_text.c_str(), level);
-    });
+      ESP_LOGD(tagEngine(), "key(%s) tag(%s) %s logging", _tag_keys[i],
+               _tag_text[i], logLevelAsText(level));
+      esp_log_level_set(_tag_text[i], level);
+    }
+  }
 
-    elapsedMicros find;
-    const char *tag = _tags["engine"].c_str();
+  // the text of each tag is created once, tags not in the table are empty
+  void setTags(const EngineTagDef_t *defs, const string_t &prefix = "") {
+    for (uint32_t i = 0; i < ENGINE_TAG_MAX; i++) {
+      _tag_keys[i] = nullptr;
+      _tag_text[i] = "";
+    }
 
-    auto elapsed = (uint64_t)find;
-    auto load = _tags.load_factor();
-    auto buckets = _tags.bucket_count();
+    for (; defs->key != nullptr; defs++) {
+      if (defs->index >= ENGINE_TAG_MAX) {
+        ESP_LOGE(prefix.c_str(), "tag %s exceeds max tags", defs->key);
+        continue;
+      }
 
-    ESP_LOGV(tag,
-             "_tags us(%llu) sizeof(%zu) size(%u) load(%0.2f) "
-             "buckets(%u)",
-             elapsed, sizeof(_tags), _tags.size(), load, buckets);
+      _tag_strings[defs->index] = prefix + defs->text;
+      _tag_keys[defs->index] = defs->key;
+      _tag_text[defs->index] = _tag_strings[defs->index].c_str();
+    }
   }
 
-  void setTags(EngineTagMap_t &map) { _tags = map; }
-
   //
   // Command Queue
   //
@@ -585,47 +1089,89 @@ protected:
   QueueHandle_t _cmd_q = nullptr;
 
 public:
-  const char *tagCommand() { return tagGeneric("command"); }
+  const char *tagCommand() { return tagAt(ENGINE_TAG_COMMAND); }
 
-  const char *tagConvert() { return tagGeneric("convert"); }
+  const char *tagConvert() { return tagAt(ENGINE_TAG_CONVERT); }
 
-  const char *tagDiscover() { return tagGeneric("discover"); }
+  const char *tagDiscover() { return tagAt(ENGINE_TAG_DISCOVER); }
 
-  const char *tagGeneric(const char *tag) { return _tags[tag].c_str(); }
+  // by key (e.g. 'discover'), a search so prefer tagAt()
+  const char *tagGeneric(const char *tag) {
+    for (uint32_t i = 0; i < ENGINE_TAG_MAX; i++) {
+      if ((_tag_keys[i] != nullptr) && (strcmp(_tag_keys[i], tag) == 0)) {
+        return _tag_text[i];
+      }
+    }
+
+    return "";
+  }
+
+  const char *tagAt(uint32_t index) const { return _tag_text[index]; }
 
-  const char *tagEngine() { return tagGeneric("engine"); }
+  const char *tagEngine() { return tagAt(ENGINE_TAG_ENGINE); }
 
-  const char *tagPhase() { return tagGeneric("phase"); }
+  const char *tagPhase() { return tagAt(ENGINE_TAG_PHASE); }
 
-  const char *tagReport() { return tagGeneric("report"); }
+  const char *tagReport() { return tagAt(ENGINE_TAG_REPORT); }
 
   // misc metrics tracking
 protected:
-  void trackPhase(const char *lTAG, EngineMetric_t &phase, bool start) {
+  void trackPhase(const char *lTAG, TaskTypes_t type, EngineMetric_t &phase,
+                  bool start) {
     if (start) {
+      mcrTrace::record(TRACE_PHASE_START, mcrTrace::arg(_trace_src, type));
       phase.elapsed.reset();
     } else {
+      mcrTrace::record(TRACE_PHASE_STOP, mcrTrace::arg(_trace_src, type));
       ESP_LOGD(lTAG, "phase ended, took %0.1fms",
                (float)((uint64_t)phase.elapsed / 1000.0));
       phase.elapsed.freeze();
       phase.last_time = time(nullptr);
+
+      // the histogram is copied and reset by the report task
+      portENTER_CRITICAL(&_metrics_mux);
+      phase.hist.record(phase.elapsed);
+      portEXIT_CRITICAL(&_metrics_mux);
     }
   };
 
+  // copy then reset the histogram of a phase
+  mcrHistogram_t snapshotPhase(EngineMetric_t &phase) {
+    portENTER_CRITICAL(&_metrics_mux);
+    mcrHistogram_t hist = phase.hist;
+    phase.hist.reset();
+    portEXIT_CRITICAL(&_metrics_mux);
+
+    return hist;
+  };
+
   void trackConvert(bool start = false) {
-    trackPhase(tagConvert(), metrics.convert, start);
+    trackPhase(tagConvert(), CONVERT, metrics.convert, start);
   };
 
   void trackDiscover(bool start = false) {
-    trackPhase(tagDiscover(), metrics.discover, start);
+    if (start) {
+      metrics.discover_max_hold_us = 0;
+    }
+
+    trackPhase(tagDiscover(), DISCOVER, metrics.discover, start);
   };
 
+  // engines that release the bus during discover record each hold
+  void trackDiscoverBusHold(uint64_t hold_us) {
+    if (hold_us > metrics.discover_max_hold_us) {
+      metrics.discover_max_hold_us = hold_us;
+    }
+  };
+
+  uint64_t maxDiscoverBusHold() { return metrics.discover_max_hold_us; };
+
   void trackReport(bool start = false) {
-    trackPhase(tagReport(), metrics.report, start);
+    trackPhase(tagReport(), REPORT, metrics.report, start);
   };
 
   void trackSwitchCmd(bool start = false) {
-    trackPhase(tagCommand(), metrics.switch_cmd, start);
+    trackPhase(tagCommand(), COMMAND, metrics.switch_cmd, start);
   };
 
   time_t lastConvertTimestamp() { return metrics.convert.last_time; };
@@ -633,15 +1179,82 @@ protected:
   time_t lastReportTimestamp() { return metrics.report.last_time; };
   time_t lastSwitchCmdTimestamp() { return metrics.switch_cmd.last_time; };
 
+  void collectMetrics(metricsReading_t &reading) {
+    const string_t &prefix = engineName();
+
+    reading.addHistogram((prefix + ".discover").c_str(),
+                         snapshotPhase(metrics.discover));
+    reading.addHistogram((prefix + ".convert").c_str(),
+                         snapshotPhase(metrics.convert));
+    reading.addHistogram((prefix + ".report").c_str(),
+                         snapshotPhase(metrics.report));
+    reading.addHistogram((prefix + ".switch_cmd").c_str(),
+                         snapshotPhase(metrics.switch_cmd));
+
+    mcrHistogram_t bus_waits[BUS_JOB_CLASSES];
+    _bus_sched->snapshotWaits(bus_waits);
+
+    for (auto job = 0; job < BUS_JOB_CLASSES; job++) {
+      const string_t name =
+          prefix + ".wait." + mcrBusScheduler::jobName((BusJob_t)job);
+
+      reading.addHistogram(name.c_str(), bus_waits[job]);
+    }
+
+    if (metrics.discover_max_hold_us > 0) {
+      reading.addGauge((prefix + ".discover_hold_us").c_str(),
+                       metrics.discover_max_hold_us);
+    }
+  }
+
+#ifdef CONFIG_MCR_METRICS
+  // the periodic metrics are exported by the metrics registry (see
+  // collectMetrics()) so only the startup metric is reported by the engine
+  void reportMetrics() {
+    if ((_first_reading_us == 0) || _first_reading_reported) {
+      return;
+    }
+
+    EngineReading reading(tagEngine(), 0, 0, 0, 0);
+    reading.setFirstReading(_first_reading_us, _devices_restored);
+    _first_reading_reported = true;
+
+    publish(&reading);
+  }
+#else
   void reportMetrics() {
     EngineReading reading(tagEngine(), metrics.discover.elapsed,
                           metrics.convert.elapsed, metrics.report.elapsed,
                           metrics.switch_cmd.elapsed);
 
+    reading.setDiscoverMaxHold(metrics.discover_max_hold_us);
+
+    // the startup metric is reported once
+    if ((_first_reading_us > 0) && (_first_reading_reported == false)) {
+      reading.setFirstReading(_first_reading_us, _devices_restored);
+      _first_reading_reported = true;
+    }
+
+    // include the phase time histograms (since the previous report)
+    reading.addPhase("discover", snapshotPhase(metrics.discover));
+    reading.addPhase("convert", snapshotPhase(metrics.convert));
+    reading.addPhase("report", snapshotPhase(metrics.report));
+    reading.addPhase("switch_cmd", snapshotPhase(metrics.switch_cmd));
+
+    // include the bus wait time histograms (since the previous report)
+    mcrHistogram_t bus_waits[BUS_JOB_CLASSES];
+    _bus_sched->snapshotWaits(bus_waits);
+
+    for (auto job = 0; job < BUS_JOB_CLASSES; job++) {
+      reading.addBusWait(mcrBusScheduler::jobName((BusJob_t)job),
+                         bus_waits[job]);
+    }
+
     if (reading.hasNonZeroValues()) {
       publish(&reading);
     }
   }
+#endif
 };
 } // namespace mcr
 
@@ -0,0 +1,111 @@
+/*
+    executor.hpp - Master Control Remote Engine Executor
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+#ifndef mcr_executor_hpp
+#define mcr_executor_hpp
+
+#include <cstdint>
+#include <cstdlib>
+
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+
+namespace mcr {
+
+// a job returns zero when complete or, rather than block the worker (e.g.
+// waiting for a device), the ticks to wait before the job continues.  the
+// worker is free to run other jobs during the wait.
+typedef TickType_t(ExecutorFunc_t)(void *);
+
+// a phase of an engine (e.g. discover) run by the executor on an interval
+typedef struct {
+  const char *name;
+  ExecutorFunc_t *func;
+  void *arg;
+  esp_timer_handle_t timer;
+  esp_timer_handle_t resume_timer; // one shot, queues a job that continues
+
+  // set while the job is queued, running or waiting to continue, an interval
+  // that elapses while set is skipped (a job never runs concurrently with
+  // itself)
+  bool pending;
+  bool running;
+  bool resume_now; // see resumeNow(), set while running
+  uint32_t skipped;
+  uint32_t resumed;
+} ExecutorJob_t;
+
+typedef class mcrExecutor mcrExecutor_t;
+
+// mcrExecutor:
+//    a small pool of worker tasks shared by all engines
+//    (CONFIG_MCR_ENGINE_EXECUTOR).  the periodic phases of an engine are
+//    jobs queued by a timer (or triggered) rather than tasks that spend most
+//    of their life in vTaskDelayUntil() so their stacks are not reserved.
+//    likewise, a job that must wait returns rather than block a worker and
+//    is queued again (by a one shot timer) once the wait has passed.
+class mcrExecutor {
+public:
+  static mcrExecutor_t *instance();
+
+  // the job runs once as soon as a worker is available then every interval
+  ExecutorJob_t *schedule(const char *name, ExecutorFunc_t *func, void *arg,
+                          TickType_t interval);
+
+  // run the job as soon as a worker is available
+  void trigger(ExecutorJob_t *job);
+
+  // a job waiting to continue (e.g. for the bus) continues as soon as a
+  // worker is available rather than once the wait has passed
+  void resumeNow(ExecutorJob_t *job);
+
+  // change the interval of a scheduled job, the next run is one interval
+  // from now
+  void reschedule(ExecutorJob_t *job, TickType_t interval);
+
+  uint32_t numWorkers() const { return _num_workers; }
+  uint32_t minStackHighWater();
+
+private:
+  mcrExecutor();
+
+  static void runWorker(void *executor);
+  static void timerCallback(void *job);
+  static void resumeCallback(void *job);
+  void resume(ExecutorJob_t *job, TickType_t ticks);
+  void resumeEarly(ExecutorJob_t *job);
+  void worker();
+
+private:
+  static const uint32_t _max_workers = 4;
+  static const uint32_t _max_jobs = 24;
+
+  QueueHandle_t _q = nullptr;
+  portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+
+  TaskHandle_t _workers[_max_workers] = {};
+  uint32_t _num_workers = 0;
+};
+
+} // namespace mcr
+
+#endif // mcr_executor_hpp
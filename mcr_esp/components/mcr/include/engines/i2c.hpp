@@ -33,6 +33,17 @@
 
 #include "devs/i2c_dev.hpp"
 #include "engines/engine.hpp"
+#include "engines/i2c_driver.hpp"
+#include "engines/i2c_job.hpp"
+
+#ifdef CONFIG_MCR_I2C_SIMULATED
+#include "drivers/i2c_sim.h"
+#endif
+
+// ESP-IDF v4.4 and later can build command links in a caller provided buffer
+#ifdef I2C_LINK_RECOMMENDED_SIZE
+#define MCR_I2C_STATIC_CMD_LINK 1
+#endif
 
 namespace mcr {
 
@@ -58,12 +69,16 @@ typedef class mcrI2c mcrI2c_t;
 class mcrI2c : public mcrEngine<i2cDev_t> {
 
 private:
-  mcrI2c();
+  mcrI2c(uint32_t port);
 
   bool commandAck(cmdSwitch_t &cmd);
 
 public:
-  static mcrI2c_t *instance();
+  // each i2c controller (port) is managed by an independent engine instance
+  // (tasks, bus scheduler and known devices).  port zero is the default for
+  // callers that pre-date multiple port support.
+  static mcrI2c_t *instance(uint32_t port = 0);
+  static uint32_t numPorts() { return CONFIG_MCR_I2C_PORTS; }
 
   //
   // Tasks
@@ -75,47 +90,100 @@ public:
 
   void stop();
 
+protected:
+  // host_test/test_i2c_engine.cpp drives the passes on the simulated bus
+  friend class mcrI2cHostTest;
+
+  void initBus();
+
+  TickType_t discoverPass();
+  TickType_t discoverWaits(TickType_t resume_ticks);
+  TickType_t reportPass();
+
+  // persisted registry flags (see EngineDevSnap_t)
+  static const uint8_t _snap_multiplexer = 0x01;
+
+  bool snapshotDevice(i2cDev_t *dev, EngineDevSnap_t &snap);
+  i2cDev_t *restoreDevice(const EngineDevSnap_t &snap);
+
 private:
+  i2c_port_t _port = I2C_NUM_0;
+  string_t _engine_name;
+  gpio_num_t _sda_pin = (gpio_num_t)CONFIG_MCR_I2C_SDA_PIN;
+  gpio_num_t _scl_pin = (gpio_num_t)CONFIG_MCR_I2C_SCL_PIN;
   i2c_config_t _conf;
   const TickType_t _loop_frequency =
       pdMS_TO_TICKS(CONFIG_MCR_I2C_ENGINE_FREQUENCY_SECS * 1000);
-  const TickType_t _discover_frequency =
-      pdMS_TO_TICKS(CONFIG_MCR_I2C_DISCOVER_FREQUENCY_SECS * 1000);
-  const TickType_t _report_frequency =
-      pdMS_TO_TICKS(CONFIG_MCR_I2C_REPORT_FREQUENCY_SECS * 1000);
   static const uint32_t _max_buses = 8;
   bool _use_multiplexer = false;
   i2cLastWakeTime_t _last_wake;
 
-  uint32_t _bus_selects = 0;
-  uint32_t _bus_select_errors = 0;
+  // the multiplexer bus currently selected, -1 when unknown
+  int32_t _selected_bus = -1;
+  mcrMetric_t _bus_selects_issued{METRIC_COUNTER};
+  mcrMetric_t _bus_selects_skipped{METRIC_COUNTER};
+  mcrMetric_t _bus_select_errors{METRIC_COUNTER};
+  uint32_t _sht31_resets = 0;
   const TickType_t _cmd_timeout = pdMS_TO_TICKS(1000);
 
+#ifdef MCR_I2C_STATIC_CMD_LINK
+  // largest transaction is a write then read (two START, one STOP)
+  uint8_t _cmd_link_buff[I2C_LINK_RECOMMENDED_SIZE(2)] = {};
+#endif
+  mcrMetric_t _cmd_link_allocs{METRIC_COUNTER};
+
+  // the jobs of a report pass, one per available device
+  i2cJob_t _jobs[maxDevices()];
+  uint32_t _jobs_count = 0;
+  uint32_t _jobs_active = 0; // non-zero while a report pass continues
+
+  // discover is split into presence checks of known devices and a sweep for
+  // new devices that resumes from _sweep_bus
+  typedef enum {
+    DISCOVER_START = 0,
+    DISCOVER_CHECK,
+    DISCOVER_SWEEP,
+    DISCOVER_SETTLE
+  } i2cDiscoverStage_t;
+
+  i2cDiscoverStage_t _discover_stage = DISCOVER_START;
+  uint32_t _sweep_bus = 0;
+  elapsedMicros _discover_hold;
+
   mcrDevAddr_t _mplex_addr = mcrDevAddr(0x70);
   i2cDev_t _multiplexer_dev = i2cDev(_mplex_addr);
   int _reset_pin_level = 0;
 
 private:
-  // array is zero terminated
-  mcrDevAddr_t _search_addrs[12] = {
-      {mcrDevAddr(0x44)}, {mcrDevAddr(0x5C)}, {mcrDevAddr(0x20)},
-      {mcrDevAddr(0x21)}, {mcrDevAddr(0x22)}, {mcrDevAddr(0x23)},
-      {mcrDevAddr(0x24)}, {mcrDevAddr(0x25)}, {mcrDevAddr(0x26)},
-      {mcrDevAddr(0x27)}, {mcrDevAddr(0x36)}, {mcrDevAddr(0x00)}};
-
-  mcrDevAddr_t *search_addrs() { return _search_addrs; };
-  inline uint32_t search_addrs_count() {
-    return sizeof(_search_addrs) / sizeof(mcrDevAddr_t);
-  };
-
-  // generic read device that will call the specific methods
+  // supported devices, the table ends with an entry without a desc
+  static const i2cDriver_t _drivers[];
+  static const i2cDriver_t *findDriver(uint8_t addr);
+
+  // generic read device that runs the steps for the device to completion
   bool readDevice(i2cDev_t *dev);
 
-  // specific methods to read devices
-  bool readMCP23008(i2cDev_t *dev);
+  // device reads are a sequence of steps (see i2c_job.hpp)
+  //  readSteps() returns nullptr for an unhandled device
+  const i2cStep_t *readSteps(i2cDev_t *dev);
+  void runStep(i2cJob_t &job);
+  esp_err_t stepTransaction(i2cJob_t &job);
+  bool runJob(i2cJob_t &job);
+  bool finishJob(i2cJob_t &job);
+  void planJobs();
+  TickType_t runJobs();
+
+  // specific methods to decode the data read from devices
+  bool decodeMCP23008(i2cDev_t *dev, const uint8_t *buff);
   bool setMCP23008(cmdSwitch_t &cmd, i2cDev_t *dev);
-  bool readSeesawSoil(i2cDev_t *dev);
-  bool readSHT31(i2cDev_t *dev);
+  bool decodeSeesawSoil(i2cDev_t *dev, const uint8_t *buff);
+  bool decodeSHT31(i2cDev_t *dev, const uint8_t *buff);
+  bool probeAM2315(i2cDev_t *dev);
+  bool decodeAM2315(i2cDev_t *dev, const uint8_t *buff);
+
+#ifdef CONFIG_MCR_I2C_SHT31_PERIODIC
+  bool startSHT31(i2cDev_t *dev);
+  void recoverSHT31(i2cDev_t *dev);
+#endif
 
   // request data by sending command bytes and then reading the result
   // NOTE:  send and recv are executed as a single i2c transaction
@@ -123,7 +191,15 @@ private:
                         uint8_t send_len, uint8_t *recv, uint8_t recv_len,
                         esp_err_t prev_esp_rc = ESP_OK, int timeout = 0);
 
+  // discover
+  bool checkKnownDevices(TickType_t &resume_ticks);
+  bool sweepForNewDevices(bool complete_round, TickType_t &resume_ticks);
+  bool takeDiscoverBus(TickType_t &resume_ticks);
+  void giveDiscoverBus();
+
   // utility methods
+  esp_err_t busTransaction(i2cDev_t *dev, const uint8_t *send,
+                           uint32_t send_len, uint8_t *recv, uint32_t recv_len);
   esp_err_t busRead(i2cDev_t *dev, uint8_t *buff, uint32_t len,
                     esp_err_t prev_esp_rc = ESP_OK);
   esp_err_t busWrite(i2cDev_t *dev, uint8_t *buff, uint32_t len,
@@ -131,6 +207,7 @@ private:
   bool crcSHT31(const uint8_t *data);
   bool detectDevice(i2cDev_t *dev);
   bool detectDevicesOnBus(int bus);
+  bool detectAddressOnBus(const i2cDriver_t &driver, uint8_t addr, int bus);
 
   bool detectMultiplexer(const int max_attempts = 1);
   bool pinReset();
@@ -141,62 +218,28 @@ private:
   bool selectBus(uint32_t bus);
   void printUnhandledDev(i2cDev_t *dev);
 
-  EngineTagMap_t &localTags() {
-    static std::unordered_map<string_t, string_t> tag_map = {
-        {"engine", "mcrI2c"},
-        {"discover", "mcrI2c discover"},
-        {"convert", "mcrI2c convert"},
-        {"report", "mcrI2c report"},
-        {"command", "mcrI2c command"},
-        {"detect", "mcrI2c detectDev"},
-        {"readMCP23008", "mcrI2c readMCP23008"},
-        {"setMCP23008", "mcrI2c setMCP23008"},
-        {"readSHT31", "mcrI2c readSHT31"},
-        {"selectbus", "mcrI2c selectBus"}};
-
-    ESP_LOGD(tag_map["engine"].c_str(), "tag_map sizeof=%u", sizeof(tag_map));
-    return tag_map;
-  }
-
-  const char *tagSelectBus() {
-    static const char *tag = nullptr;
-    if (tag == nullptr) {
-      tag = _tags["selectbus"].c_str();
-    }
-    return tag;
-  }
-
-  const char *tagDetectDev() {
-    static const char *tag = nullptr;
-    if (tag == nullptr) {
-      tag = _tags["detect"].c_str();
-    }
-    return tag;
-  }
-
-  const char *tagReadMCP23008() {
-    static const char *tag = nullptr;
-    if (tag == nullptr) {
-      tag = _tags["readMCP23008"].c_str();
-    }
-    return tag;
-  }
-
-  const char *tagSetMCP23008() {
-    static const char *tag = nullptr;
-    if (tag == nullptr) {
-      tag = _tags["setMCP23008"].c_str();
-    }
-    return tag;
-  }
-
-  const char *tagReadSHT31() {
-    static const char *tag = nullptr;
-    if (tag == nullptr) {
-      tag = _tags["readSHT31"].c_str();
-    }
-    return tag;
-  }
+#ifdef CONFIG_MCR_I2C_SIMULATED
+  void simulatedDevices();
+#endif
+
+  // tags are prefixed with the engine name so log output identifies the port
+  typedef enum {
+    I2C_TAG_DETECT = ENGINE_TAG_LOCAL,
+    I2C_TAG_READ_MCP23008,
+    I2C_TAG_SET_MCP23008,
+    I2C_TAG_READ_SHT31,
+    I2C_TAG_READ_AM2315,
+    I2C_TAG_SELECT_BUS
+  } i2cTag_t;
+
+  static const EngineTagDef_t _tag_defs[];
+
+  const char *tagSelectBus() { return tagAt(I2C_TAG_SELECT_BUS); }
+  const char *tagDetectDev() { return tagAt(I2C_TAG_DETECT); }
+  const char *tagReadMCP23008() { return tagAt(I2C_TAG_READ_MCP23008); }
+  const char *tagSetMCP23008() { return tagAt(I2C_TAG_SET_MCP23008); }
+  const char *tagReadSHT31() { return tagAt(I2C_TAG_READ_SHT31); }
+  const char *tagReadAM2315() { return tagAt(I2C_TAG_READ_AM2315); }
 
   const char *espError(esp_err_t esp_rc) {
     static char catch_all[25] = {0x00};
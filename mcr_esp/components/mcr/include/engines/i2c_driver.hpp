@@ -0,0 +1,72 @@
+/*
+    i2c_driver.hpp - Master Control Remote I2C Device Drivers
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+#ifndef mcr_i2c_driver_hpp
+#define mcr_i2c_driver_hpp
+
+#include <cstdint>
+
+#include "cmds/switch.hpp"
+#include "devs/i2c_dev.hpp"
+#include "engines/i2c_job.hpp"
+
+namespace mcr {
+
+class mcrI2c;
+
+typedef bool (mcrI2c::*i2cProbe_t)(i2cDev_t *dev);
+typedef bool (mcrI2c::*i2cDecode_t)(i2cDev_t *dev, const uint8_t *buff);
+typedef bool (mcrI2c::*i2cWrite_t)(cmdSwitch_t &cmd, i2cDev_t *dev);
+typedef void (mcrI2c::*i2cRecover_t)(i2cDev_t *dev);
+
+// everything the engine knows about a type of device.  the table of drivers
+// (see i2c.cpp) is the only place device addresses are known so supporting
+// a new device is adding an entry.
+typedef struct {
+  uint8_t first_addr; // addresses claimed by the driver (inclusive)
+  uint8_t last_addr;
+  const char *desc; // used in the device id (e.g. i2c/self.00.sht31)
+
+  const i2cStep_t *read_steps;
+  i2cProbe_t probe;     // nullptr to detect by writing a byte (address)
+  i2cDecode_t decode;   // create the reading from the bytes read
+  i2cWrite_t write;     // nullptr when the device does not accept commands
+  i2cProbe_t start;     // once a new device is found, nullptr when not needed
+  i2cRecover_t recover; // after a failed read, nullptr when not needed
+
+  uint32_t convert_us; // time the device is busy during a read (WAIT steps)
+} i2cDriver_t;
+
+// the total of the WAIT steps of a read
+static constexpr uint32_t i2cStepsWaitUs(const i2cStep_t *steps) {
+  uint32_t wait_us = 0;
+
+  for (; steps->type != I2C_STEP_END; steps++) {
+    if (steps->type == I2C_STEP_WAIT) {
+      wait_us += steps->wait_us;
+    }
+  }
+
+  return wait_us;
+}
+
+} // namespace mcr
+
+#endif // mcr_i2c_driver_hpp
@@ -0,0 +1,103 @@
+/*
+    i2c_job.hpp - Master Control Remote I2C Transaction Jobs
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+#ifndef mcr_i2c_job_hpp
+#define mcr_i2c_job_hpp
+
+#include <cstdint>
+
+#include <esp_err.h>
+
+#include "devs/i2c_dev.hpp"
+
+namespace mcr {
+
+typedef enum {
+  I2C_STEP_WRITE = 0, // START, address, send bytes, STOP
+  I2C_STEP_READ,      // START, address, recv bytes, STOP
+  I2C_STEP_REQUEST,   // send bytes, repeated START, recv bytes, STOP
+  I2C_STEP_WAIT,      // device is busy, the bus is free for others
+  I2C_STEP_WAKE,      // START, address, STOP (a NACK is expected)
+  I2C_STEP_END
+} i2cStepType_t;
+
+// a single step of a device read.  steps are static tables (one per device
+// type) so creating a job never allocates.
+typedef struct {
+  i2cStepType_t type;
+  uint8_t send[3];
+  uint8_t send_len;
+  uint8_t recv_offset; // where in the job buffer received bytes are placed
+  uint8_t recv_len;
+  uint32_t wait_us;
+} i2cStep_t;
+
+typedef class i2cJob i2cJob_t;
+
+// the progress of reading a single device.  a job is advanced one step at a
+// time so, while a device is busy (e.g. converting a temperature), steps of
+// other jobs can use the bus.
+class i2cJob {
+public:
+  i2cJob(){};
+
+  // a job does not start before the device has data available
+  i2cJob(i2cDev_t *dev, const i2cStep_t *steps)
+      : _dev(dev), _steps(steps), _step(steps),
+        _ready_at_us(dev->dataReadyAt()){};
+
+  i2cDev_t *dev() const { return _dev; }
+  const i2cStep_t &step() const { return *_step; }
+  uint32_t stepIndex() const { return _step - _steps; }
+  uint8_t *buff() { return _buff; }
+  static const uint32_t buff_len = 16;
+
+  void next() {
+    if (_step->type != I2C_STEP_END) {
+      _step++;
+    }
+  }
+
+  // a job is done when all steps are complete or a step failed
+  bool done() const { return (_step->type == I2C_STEP_END) || (_rc != ESP_OK); }
+  esp_err_t rc() const { return _rc; }
+  void setRC(esp_err_t rc) { _rc = rc; }
+
+  bool ready(int64_t now) const { return now >= _ready_at_us; }
+  int64_t readyAt() const { return _ready_at_us; }
+  void waitUntil(int64_t ready_at_us) { _ready_at_us = ready_at_us; }
+
+  // set once the result of a done job has been handled
+  bool finished() const { return _finished; }
+  void finish() { _finished = true; }
+
+private:
+  i2cDev_t *_dev = nullptr;
+  const i2cStep_t *_steps = nullptr;
+  const i2cStep_t *_step = nullptr;
+  esp_err_t _rc = ESP_OK;
+  int64_t _ready_at_us = 0;
+  bool _finished = false;
+  uint8_t _buff[buff_len] = {};
+};
+
+} // namespace mcr
+
+#endif // mcr_i2c_job_hpp
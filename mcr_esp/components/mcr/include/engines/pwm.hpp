@@ -50,6 +50,8 @@ private:
   pwmEngine();
 
   bool commandAck(cmdPWM_t &cmd);
+  bool updateGroup(cmdPWM_t &cmd, pwmDev_t *dev);
+  void waitUntil(int64_t unix_us);
 
 public:
   static pwmEngine_t *instance();
@@ -66,13 +68,23 @@ public:
 
   void stop();
 
+protected:
+  TickType_t discoverPass();
+  TickType_t reportPass();
+
 private:
   const TickType_t _loop_frequency = pdMS_TO_TICKS(10000);
-  const TickType_t _discover_frequency = pdMS_TO_TICKS(59000);
-  const TickType_t _report_frequency = pdMS_TO_TICKS(10000);
 
   pwmLastWakeTime_t _last_wake;
 
+  // results of the most recent group update (included in the ack)
+  uint32_t _group_channels = 0;
+  uint32_t _group_skew_us = 0;
+  int32_t _group_late_us = 0;
+
+  // an execute_at further in the future is ignored (executed on receipt)
+  static const int64_t _max_execute_wait_us = 10 * 1000 * 1000;
+
 private:
   // generic read device that will call the specific methods
   bool readDevice(pwmDev_t *dev);
@@ -82,25 +94,13 @@ private:
 
   void printUnhandledDev(pwmDev_t *dev);
 
-  EngineTagMap_t &localTags() {
-    static std::unordered_map<string_t, string_t> tag_map = {
-        {"engine", "mPWM"},      {"discover", "mPWM_dis"},
-        {"convert", "mPWM_cvt"}, {"report", "mPWM_rep"},
-        {"command", "mPWM_cmd"}, {"detect", "mPWM_det"}};
+  typedef enum { PWM_TAG_DETECT = ENGINE_TAG_LOCAL } pwmTag_t;
 
-    ESP_LOGD(tag_map["engine"].c_str(), "tag_map sizeof=%u", sizeof(tag_map));
-    return tag_map;
-  }
+  static const EngineTagDef_t _tag_defs[];
 
   ledc_channel_t mapToChannel(uint8_t num);
 
-  const char *tagDetectDev() {
-    static const char *tag = nullptr;
-    if (tag == nullptr) {
-      tag = _tags["detect"].c_str();
-    }
-    return tag;
-  }
+  const char *tagDetectDev() { return tagAt(PWM_TAG_DETECT); }
 
   const char *espError(esp_err_t esp_rc) {
     static char catch_all[25] = {0x00};
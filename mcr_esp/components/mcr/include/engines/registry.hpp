@@ -0,0 +1,158 @@
+/*
+    registry.hpp - Master Control Remote Engine Device Registry
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+#ifndef mcr_registry_hpp
+#define mcr_registry_hpp
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#include "misc/mcr_types.hpp"
+
+namespace mcr {
+
+typedef enum {
+  REGISTRY_ADDED = 0,
+  REGISTRY_KNOWN, // a device with the same key is already known
+  REGISTRY_FULL
+} RegistryAdd_t;
+
+// the known devices of an engine (see mcrEngine) kept in a contiguous array
+// sorted by the binary key of the device (see mcrDev::key()) so the discover
+// and report passes walk memory in order.  lookups use the indexes:  by key
+// for discover (a hash beats a binary search of the array) and by id for
+// commands (the device of a command is a string).
+//
+// the array is copy on write:  add() (discover) builds a new array and swaps
+// it in so the tasks iterating a snapshot are never invalidated.  devices are
+// never removed so the pointers of a snapshot remain valid.
+//
+// DEV provides key() and id()
+template <class DEV> class mcrDevRegistry {
+public:
+  typedef std::pair<uint64_t, DEV *> DeviceEntry_t;
+  typedef std::vector<DeviceEntry_t> DeviceMap_t;
+  typedef std::shared_ptr<const DeviceMap_t> DeviceList_t;
+
+  mcrDevRegistry(uint32_t max_devices) : _max_devices(max_devices) {
+    _devices = std::make_shared<const DeviceMap_t>();
+    _mutex = xSemaphoreCreateMutex();
+  }
+
+  ~mcrDevRegistry() { vSemaphoreDelete(_mutex); }
+
+  RegistryAdd_t add(DEV *dev) {
+    RegistryAdd_t rc = REGISTRY_KNOWN;
+    const uint64_t key = dev->key();
+    DeviceList_t prev; // released after the mutex is given
+
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+
+    auto pos = lowerBound(*_devices, key);
+
+    if (_devices->size() >= _max_devices) {
+      rc = REGISTRY_FULL;
+    } else if ((pos == _devices->end()) || (pos->first != key)) {
+      auto next = std::make_shared<DeviceMap_t>();
+      next->reserve(_devices->size() + 1);
+      next->insert(next->end(), _devices->cbegin(), pos);
+      next->push_back(DeviceEntry_t(key, dev));
+      next->insert(next->end(), pos, _devices->cend());
+
+      prev = _devices;
+      _devices = next;
+      _by_key[key] = dev;
+      _by_id[dev->id()] = dev;
+      rc = REGISTRY_ADDED;
+    }
+
+    xSemaphoreGive(_mutex);
+
+    return rc;
+  }
+
+  // the lookup is brief so it is done holding the mutex rather than paying
+  // for a snapshot (shared_ptr copy) per lookup
+  DEV *find(uint64_t key) {
+    DEV *rc = nullptr;
+
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    auto found = _by_key.find(key);
+
+    if (found != _by_key.end()) {
+      rc = found->second;
+    }
+    xSemaphoreGive(_mutex);
+
+    return rc;
+  }
+
+  DEV *find(const string_t &id) {
+    DEV *rc = nullptr;
+
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    auto found = _by_id.find(id);
+
+    if (found != _by_id.end()) {
+      rc = found->second;
+    }
+    xSemaphoreGive(_mutex);
+
+    return rc;
+  }
+
+  // the known devices to iterate, devices added while iterating are in the
+  // next snapshot
+  DeviceList_t snapshot() {
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    DeviceList_t devs = _devices;
+    xSemaphoreGive(_mutex);
+
+    return devs;
+  }
+
+  uint32_t size() { return snapshot()->size(); }
+  uint32_t maxDevices() const { return _max_devices; }
+
+private:
+  const uint32_t _max_devices;
+  DeviceList_t _devices;
+  std::unordered_map<uint64_t, DEV *> _by_key;
+  std::unordered_map<string_t, DEV *> _by_id;
+  SemaphoreHandle_t _mutex = nullptr; // guards all of the above
+
+  static auto lowerBound(const DeviceMap_t &devs, uint64_t key) ->
+      typename DeviceMap_t::const_iterator {
+    return std::lower_bound(
+        devs.cbegin(), devs.cend(), key,
+        [](const DeviceEntry_t &item, uint64_t k) { return item.first < k; });
+  }
+};
+
+} // namespace mcr
+
+#endif // mcr_registry_hpp
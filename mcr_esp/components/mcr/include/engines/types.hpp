@@ -29,7 +29,9 @@
 #include <freertos/event_groups.h>
 #include <freertos/task.h>
 
+#include "engines/executor.hpp"
 #include "misc/elapsedMillis.hpp"
+#include "misc/histogram.hpp"
 #include "misc/mcr_types.hpp"
 
 namespace mcr {
@@ -66,11 +68,70 @@ public:
   UBaseType_t _priority = 1;
   UBaseType_t _stackSize = 1024;
   void *_data = nullptr;
+
+  // executor mode (CONFIG_MCR_ENGINE_EXECUTOR):  phases with an interval
+  // are a job of the shared executor instead of a task
+  TickType_t _interval = 0;
+  ExecutorJob_t *_job = nullptr;
 };
 
+// log tags of an engine are resolved once (see mcrEngine::setTags()) into an
+// array indexed by the tag.  the tags common to all engines are first,
+// engine specific tags begin at ENGINE_TAG_LOCAL.
+typedef enum {
+  ENGINE_TAG_ENGINE = 0,
+  ENGINE_TAG_DISCOVER,
+  ENGINE_TAG_CONVERT,
+  ENGINE_TAG_REPORT,
+  ENGINE_TAG_COMMAND,
+  ENGINE_TAG_PHASE,
+  ENGINE_TAG_LOCAL,
+  ENGINE_TAG_MAX = 16
+} EngineTag_t;
+
+// an entry of the (static) tag table of an engine, the table ends with an
+// entry with a nullptr key
+//  key:   identifier (e.g. 'discover')
+//  text:  appended to the prefix (e.g. the engine name) to create the text
+//         displayed by ESP_LOG*
+typedef struct {
+  uint32_t index;
+  const char *key;
+  const char *text;
+} EngineTagDef_t;
+
+// the cadences of an engine, initially from Kconfig then adjusted at runtime
+// by the engine.config cmd and persisted in NVS (see mcrEngine::loadConfig())
+typedef struct {
+  uint32_t convert_secs;
+  uint32_t discover_secs;
+  uint32_t report_secs;
+  bool convert;  // false to skip the convert phase
+  bool discover; // false to skip the discover phase (e.g. a fixed set of devs)
+} EngineConfig_t;
+
+// a known device as persisted in NVS (see mcrEngine::saveDevices()) so,
+// after a restart, the engine reports before discover completes
+typedef struct {
+  uint8_t addr[8]; // the device address (e.g. rom code, i2c address)
+  uint8_t addr_len;
+  uint8_t bus;   // multiplexer bus (i2c)
+  uint8_t flags; // engine specific
+} EngineDevSnap_t;
+
+// sized to hold every device an engine tracks (mcrEngine::maxDevices()), at
+// eleven bytes per device the blob is about 1.1k which NVS stores across pages
+typedef struct EngineDevRegistry {
+  static const uint32_t max_devices = 100;
+
+  uint32_t count;
+  EngineDevSnap_t devs[max_devices];
+} EngineDevRegistry_t;
+
 typedef struct EngineMetric {
   elapsedMicros elapsed;
   time_t last_time = 0;
+  mcrHistogram_t hist; // of elapsed, since the previous report
 } EngineMetric_t;
 
 typedef struct EngineMetrics {
@@ -79,6 +140,7 @@ typedef struct EngineMetrics {
   EngineMetric_t report;
   EngineMetric_t switch_cmd;
   EngineMetric_t switch_cmdack;
+  uint64_t discover_max_hold_us = 0; // longest single bus hold by discover
 } EngineMetrics_t;
 
 typedef std::pair<string_t, EngineMetric_t *> metricEntry_t;
@@ -0,0 +1,114 @@
+/*
+    heap_trace.hpp -- MCR Heap Allocation Tracing
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+#ifndef mcr_heap_trace_hpp
+#define mcr_heap_trace_hpp
+
+#include <cstdint>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+namespace mcr {
+
+// the call sites attributed by the heap trace, allocations outside of a
+// tagged scope are counted as HEAP_TAG_OTHER
+typedef enum {
+  HEAP_TAG_OTHER = 0,
+  HEAP_TAG_READING_JSON,
+  HEAP_TAG_INCOMING_MSG,
+  HEAP_TAG_CMD_FACTORY,
+  HEAP_TAG_I2C_CMD_LINK,
+  HEAP_TAG_MAX
+} HeapTag_t;
+
+typedef struct {
+  uint32_t allocs = 0;
+  uint32_t frees = 0;
+  uint64_t bytes = 0;      // total allocated
+  uint32_t live_bytes = 0; // allocated and not yet freed
+  uint32_t peak_bytes = 0; // high water of live_bytes
+} HeapTagStats_t;
+
+typedef class mcrHeapTrace mcrHeapTrace_t;
+
+// mcrHeapTrace:
+//    counts allocations (and the bytes allocated) by call site when
+//    CONFIG_MCR_HEAP_TRACE is enabled.  the global operator new / delete are
+//    replaced to prefix each allocation with its size and tag.  malloc()
+//    (e.g. ArduinoJson, the i2c driver) is not hooked, those call sites
+//    record explicitly via recordAlloc() and recordFree().
+//
+//    when disabled every member is an empty inline and the allocators are
+//    untouched.
+class mcrHeapTrace {
+public:
+  static const uint32_t max_scopes = 8; // tasks concurrently in a scope
+
+#ifdef CONFIG_MCR_HEAP_TRACE
+  static bool enabled() { return true; }
+
+  static HeapTag_t currentTag();
+  static void setTag(HeapTag_t tag);
+
+  static void recordAlloc(HeapTag_t tag, uint32_t bytes);
+  static void recordFree(HeapTag_t tag, uint32_t bytes);
+
+  // copy the table (under the lock), optionally zeroing the counts.
+  // live_bytes is never reset since those allocations are still outstanding.
+  static void snapshot(HeapTagStats_t (&stats)[HEAP_TAG_MAX],
+                       bool reset = false);
+#else
+  static bool enabled() { return false; }
+
+  static HeapTag_t currentTag() { return HEAP_TAG_OTHER; }
+  static void setTag(HeapTag_t tag) {}
+
+  static void recordAlloc(HeapTag_t tag, uint32_t bytes) {}
+  static void recordFree(HeapTag_t tag, uint32_t bytes) {}
+
+  static void snapshot(HeapTagStats_t (&stats)[HEAP_TAG_MAX],
+                       bool reset = false) {}
+#endif
+
+  static const char *tagName(HeapTag_t tag);
+};
+
+// mcrHeapScope:
+//    attributes the allocations of the calling task to a tag for the
+//    lifetime of the object, nested scopes restore the previous tag
+class mcrHeapScope {
+public:
+#ifdef CONFIG_MCR_HEAP_TRACE
+  mcrHeapScope(HeapTag_t tag) : _prev(mcrHeapTrace::currentTag()) {
+    mcrHeapTrace::setTag(tag);
+  }
+  ~mcrHeapScope() { mcrHeapTrace::setTag(_prev); }
+
+private:
+  HeapTag_t _prev;
+#else
+  mcrHeapScope(HeapTag_t tag) {}
+#endif
+};
+
+} // namespace mcr
+
+#endif // mcr_heap_trace_hpp
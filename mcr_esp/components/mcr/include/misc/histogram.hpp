@@ -0,0 +1,108 @@
+/*
+    histogram.hpp -- MCR Log Scale Histogram
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+#ifndef mcr_histogram_hpp
+#define mcr_histogram_hpp
+
+#include <cstdint>
+
+namespace mcr {
+
+typedef class mcrHistogram mcrHistogram_t;
+
+// fixed size, log2 scaled histogram of elapsed microseconds
+//  bucket 0 counts values below 2us and bucket n counts [2^n, 2^(n+1)).
+//  the final bucket also counts any value beyond the range of the histogram.
+//  recording is constant time and never allocates.
+class mcrHistogram {
+public:
+  static const uint32_t num_buckets = 24; // final bucket begins at ~8.4s
+
+  void record(uint64_t us) {
+    uint32_t idx = (us == 0) ? 0 : (63 - __builtin_clzll(us));
+
+    if (idx >= num_buckets) {
+      idx = num_buckets - 1;
+    }
+
+    _buckets[idx]++;
+
+    if ((_count == 0) || (us < _min)) {
+      _min = us;
+    }
+
+    if (us > _max) {
+      _max = us;
+    }
+
+    _count++;
+  }
+
+  void reset() { *this = mcrHistogram(); }
+
+  uint32_t bucket(uint32_t idx) const { return _buckets[idx]; }
+  uint32_t count() const { return _count; }
+  uint64_t max() const { return _max; }
+  uint64_t min() const { return _min; }
+
+  // the upper bound of the bucket containing the percentile (e.g. 99) of the
+  // values recorded, limited to the max recorded
+  uint64_t percentile(uint32_t pct) const {
+    const uint64_t rank = (((uint64_t)_count * pct) + 99) / 100;
+    uint64_t seen = 0;
+
+    if (_count == 0) {
+      return 0;
+    }
+
+    for (uint32_t idx = 0; idx < num_buckets; idx++) {
+      seen += _buckets[idx];
+
+      if (seen >= rank) {
+        const uint64_t upper = (2ULL << idx) - 1;
+
+        return (upper < _max) ? upper : _max;
+      }
+    }
+
+    return _max;
+  }
+
+  // number of buckets through the last non-empty bucket, useful to
+  // avoid publishing the (typically empty) upper buckets
+  uint32_t usedBuckets() const {
+    uint32_t used = num_buckets;
+
+    while ((used > 0) && (_buckets[used - 1] == 0)) {
+      used--;
+    }
+
+    return used;
+  }
+
+private:
+  uint32_t _buckets[num_buckets] = {};
+  uint32_t _count = 0;
+  uint64_t _min = 0;
+  uint64_t _max = 0;
+};
+} // namespace mcr
+
+#endif // mcr_histogram_hpp
@@ -58,9 +58,9 @@ private:
   size_t _time_str_max_len = 25;
   size_t _msg_len = 0;
 
-  const char *_possible_keys[7] = {"BOOT",    "mcrNet",  "mcrNet-connection",
-                                   "mcrI2c",  "mcrMQTT", "hostname",
-                                   "END_KEYS"};
+  const char *_possible_keys[8] = {"BOOT",    "mcrNet",  "mcrNet-connection",
+                                   "mcrI2c",  "mcrI2c1", "mcrMQTT",
+                                   "hostname", "END_KEYS"};
 
   bool _committed_msgs_processed = false;
 
@@ -75,6 +75,8 @@ private:
   // available static functions
   esp_err_t __commitMsg(const char *key, const char *msg);
   esp_err_t __processCommittedMsgs();
+  esp_err_t __commitBlob(const char *key, const void *blob, size_t len);
+  esp_err_t __getBlob(const char *key, void *blob, size_t len);
 
 public:
   static mcrNVS_t *init();
@@ -82,6 +84,11 @@ public:
 
   static esp_err_t commitMsg(const char *key, const char *msg);
   static esp_err_t processCommittedMsgs();
+
+  // persisted settings (e.g. engine config), a blob is only returned when
+  // the stored length matches (a blob of an older layout is not found)
+  static esp_err_t commitBlob(const char *key, const void *blob, size_t len);
+  static esp_err_t getBlob(const char *key, void *blob, size_t len);
   // static esp_err_t processCommittedMsgs();
 };
 } // namespace mcr
@@ -0,0 +1,140 @@
+/*
+    metrics.hpp -- MCR Metrics Registry
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+#ifndef mcr_metrics_hpp
+#define mcr_metrics_hpp
+
+#include <cstdint>
+
+#include <freertos/FreeRTOS.h>
+
+#include "misc/histogram.hpp"
+#include "misc/mcr_types.hpp"
+
+namespace mcr {
+
+typedef enum {
+  METRIC_COUNTER = 0,
+  METRIC_GAUGE,
+  METRIC_HISTOGRAM
+} MetricKind_t;
+
+typedef class metricsReading metricsReading_t;
+
+// called at export to add metrics kept elsewhere (e.g. the phase histograms
+// of an engine) to the reading
+typedef void(MetricsCollectFunc_t)(void *ctx, metricsReading_t &reading);
+
+typedef class mcrMetric mcrMetric_t;
+
+// mcrMetric:
+//    a counter or gauge of the metrics registry (see mcrMetrics).  a metric
+//    registers itself when named so a module may declare its metrics
+//    statically:
+//
+//      static mcrMetric_t _msgs_in("mqtt.msgs_in", METRIC_COUNTER);
+//
+//    or, when the name is known only at runtime (e.g. the engine name), as
+//    a member then call registerAs().
+//
+//    counters are exported as the change since the previous export, gauges
+//    only when changed since the previous export.
+class mcrMetric {
+public:
+  static const uint32_t max_name_len = 32;
+
+  mcrMetric(MetricKind_t kind) : _kind(kind){};
+  mcrMetric(const char *name, MetricKind_t kind);
+  virtual ~mcrMetric();
+
+  void registerAs(const char *name);
+
+  void add(uint32_t n = 1) {
+    __atomic_fetch_add(&_value, n, __ATOMIC_RELAXED);
+  }
+  void set(uint32_t value) { _value = value; }
+
+  MetricKind_t kind() const { return _kind; }
+  const char *name() const { return _name; }
+  uint32_t value() const { return _value; }
+
+private:
+  friend class mcrMetrics;
+
+  char _name[max_name_len] = {};
+  MetricKind_t _kind;
+  uint32_t _value = 0;
+
+  // export state (see mcrMetrics::collect())
+  uint32_t _exported = 0;
+  bool _ever_exported = false;
+
+  mcrMetric_t *_next = nullptr;
+};
+
+typedef class mcrMetricHistogram mcrMetricHistogram_t;
+
+// mcrMetricHistogram:
+//    a histogram (of elapsed microseconds) of the metrics registry, exported
+//    then reset at each export
+class mcrMetricHistogram : public mcrMetric {
+public:
+  mcrMetricHistogram() : mcrMetric(METRIC_HISTOGRAM){};
+  mcrMetricHistogram(const char *name) : mcrMetric(name, METRIC_HISTOGRAM){};
+
+  void record(uint64_t us);
+
+  // copy then reset the histogram
+  mcrHistogram_t snapshot();
+
+private:
+  mcrHistogram_t _hist;
+};
+
+typedef class mcrMetrics mcrMetrics_t;
+
+// mcrMetrics:
+//    the registry of metrics, exported as a single reading (see
+//    metricsReading) every CONFIG_MCR_METRICS_INTERVAL_SECS by
+//    TimestampTask.  only the metrics that changed since the previous
+//    export are included.
+class mcrMetrics {
+public:
+  static const uint32_t max_collectors = 8;
+
+  static void registerCollector(MetricsCollectFunc_t *func, void *ctx);
+
+  // add the registry (and collectors) to the reading, returns false when
+  // nothing changed since the previous export
+  static bool collect(metricsReading_t &reading);
+
+  static void publish(uint32_t interval_ms);
+
+private:
+  friend class mcrMetric;
+  friend class mcrMetricHistogram;
+
+  static void link(mcrMetric_t *metric);
+  static void unlink(mcrMetric_t *metric);
+};
+
+} // namespace mcr
+
+#endif // mcr_metrics_hpp
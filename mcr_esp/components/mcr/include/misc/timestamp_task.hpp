@@ -75,6 +75,19 @@ private:
   unordered_map<string_t, TaskStat_ptr_t> _task_map;
   bool _tasks_ongoing_report = false;
 
+  // task stats (CONFIG_MCR_TASK_STATS), key(task name) entry(run time counter
+  // at the previous report)
+  unordered_map<string_t, uint32_t> _task_run_time;
+  uint32_t _total_run_time = 0;
+  TickType_t _task_stats_last = 0;
+
+#ifdef CONFIG_MCR_METRICS
+  // export of the metrics registry
+  const TickType_t _metrics_interval =
+      pdMS_TO_TICKS(CONFIG_MCR_METRICS_INTERVAL_SECS * 1000);
+  TickType_t _metrics_last = 0;
+#endif
+
   // Task implementation
   void delay(int ms) { ::vTaskDelay(pdMS_TO_TICKS(ms)); }
   static void runEngine(void *task_instance) {
@@ -83,6 +96,7 @@ private:
   }
 
   void reportTaskStacks();
+  void reportTaskStats();
   void updateTaskData();
 
   void stop() {
@@ -0,0 +1,132 @@
+/*
+    trace.hpp -- MCR Event Trace Ring
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+#ifndef mcr_trace_hpp
+#define mcr_trace_hpp
+
+#include <cstdint>
+
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+namespace mcr {
+
+// the events recorded in the trace ring.  the meaning of the arg of each
+// event is noted, src is a source (e.g. an engine) from registerSource().
+typedef enum {
+  TRACE_NONE = 0,
+  TRACE_BUS_TAKE,     // (src, bus job)
+  TRACE_BUS_GIVE,     // (src, 0)
+  TRACE_PHASE_START,  // (src, phase)
+  TRACE_PHASE_STOP,   // (src, phase)
+  TRACE_MSG_IN_SEND,  // mqtt inbound queue, payload length
+  TRACE_MSG_IN_RECV,  // payload length
+  TRACE_MSG_OUT_SEND, // mqtt outbound queue, payload length
+  TRACE_MSG_OUT_RECV, // payload length
+  TRACE_PUBLISH,      // payload length
+  TRACE_CMD_PARSE,    // cmd type
+  TRACE_CMD_PROCESS,  // cmd type
+  TRACE_CMD_DONE,     // cmd type
+  TRACE_EVENT_MAX
+} TraceEvent_t;
+
+// an entry of the ring, eight bytes
+typedef struct {
+  uint32_t us; // low 32 bits of esp_timer_get_time() (wraps every ~71m)
+  uint8_t event;
+  uint8_t core;
+  uint16_t arg;
+} TraceEntry_t;
+
+typedef class mcrTrace mcrTrace_t;
+
+// mcrTrace:
+//    a fixed size ring of compact binary events (e.g. bus take and give,
+//    phase start and stop, queue send and receive) for debugging contention
+//    and stalls without the timing perturbation of raising the log level.
+//
+//    record() is lock free (an atomic increment of the ring index) and does
+//    not allocate.  an entry being overwritten while snapshot() copies the
+//    ring may be torn, an acceptable trade for a debugging aid.
+//
+//    the ring is published by the trace.dump cmd (see cmdTraceDump).  when
+//    CONFIG_MCR_TRACE is disabled every member is an empty inline.
+class mcrTrace {
+public:
+  static const uint32_t max_sources = 16;
+  static const uint32_t max_source_len = 12;
+
+#ifdef CONFIG_MCR_TRACE
+  static const uint32_t max_entries = CONFIG_MCR_TRACE_ENTRIES;
+
+  static bool enabled() { return true; }
+
+  static inline void record(TraceEvent_t event, uint16_t arg = 0) {
+    uint32_t idx = __atomic_fetch_add(&_next, 1, __ATOMIC_RELAXED);
+    TraceEntry_t &entry = _ring[idx % max_entries];
+
+    entry.us = (uint32_t)esp_timer_get_time();
+    entry.event = event;
+    entry.core = xPortGetCoreID();
+    entry.arg = arg;
+  }
+
+  // returns the id of the source (e.g. an engine), zero when the table of
+  // sources is full
+  static uint8_t registerSource(const char *name);
+
+  // copy the ring, oldest first, and returns the number of entries copied.
+  // entries must have room for max_entries.
+  static uint32_t snapshot(TraceEntry_t *entries, bool clear = false);
+#else
+  static const uint32_t max_entries = 0;
+
+  static bool enabled() { return false; }
+
+  static inline void record(TraceEvent_t event, uint16_t arg = 0) {}
+  static uint8_t registerSource(const char *name) { return 0; }
+  static uint32_t snapshot(TraceEntry_t *entries, bool clear = false) {
+    return 0;
+  }
+#endif
+
+  static uint16_t arg(uint8_t src, uint8_t detail) {
+    return (uint16_t)((src << 8) | detail);
+  }
+
+  static uint16_t len(size_t len) {
+    return (len > UINT16_MAX) ? UINT16_MAX : (uint16_t)len;
+  }
+
+  // the name of a source, an empty string when unknown
+  static const char *sourceName(uint8_t src);
+  static uint32_t numSources();
+
+private:
+#ifdef CONFIG_MCR_TRACE
+  static TraceEntry_t _ring[max_entries];
+  static uint32_t _next;
+#endif
+};
+
+} // namespace mcr
+
+#endif // mcr_trace_hpp
@@ -33,7 +33,9 @@
 #include <sdkconfig.h>
 
 #include "external/mongoose.h"
+#include "misc/elapsedMillis.hpp"
 #include "protocols/mqtt_in.hpp"
+#include "protocols/mqtt_store.hpp"
 #include "readings/readings.hpp"
 
 namespace mcr {
@@ -57,6 +59,8 @@ public:
   void publish(Reading_t *reading);
   void publish(Reading_t &reading);
   void publish(std::unique_ptr<Reading_t> reading);
+  // publish an already serialized reading (takes ownership of json)
+  void publish(string_t *json);
   void core(void *data);
   void subACK(struct mg_mqtt_message *msg);
   void subscribeCommandFeed(struct mg_connection *nc);
@@ -122,6 +126,11 @@ private:
 
   mcrMQTTin_t *_mqtt_in = nullptr;
 
+  // store and forward of readings while the connection is unavailable
+  mcrMQTTStore_t _store;
+  elapsedMillis _replay_elapsed;
+  const uint64_t _replay_interval_ms = CONFIG_MCR_MQTT_REPLAY_INTERVAL_MS;
+
   // const char *_dns_server = CONFIG_MCR_DNS_SERVER;
   const string_t _host = CONFIG_MCR_MQTT_HOST;
   const int _port = CONFIG_MCR_MQTT_PORT;
@@ -136,9 +145,10 @@ private:
   uint16_t _cmd_feed_msg_id = 1;
 
   void announceStartup();
+  void holdOutbound();
   void outboundMsg();
+  void replayMsg();
 
-  void publish(string_t *json);
 
   // Task implementation
   static void runEngine(void *task_instance) {
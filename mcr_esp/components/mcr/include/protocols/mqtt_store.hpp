@@ -0,0 +1,97 @@
+/*
+    mqtt_store.hpp - Master Control Remote MQTT Store and Forward
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+#ifndef mcr_mqtt_store_h
+#define mcr_mqtt_store_h
+
+#include <cstdlib>
+#include <deque>
+#include <string>
+
+#include <esp_partition.h>
+#include <sdkconfig.h>
+
+#include "misc/mcr_types.hpp"
+
+namespace mcr {
+
+typedef class mcrMQTTStore mcrMQTTStore_t;
+
+// mcrMQTTStore:
+//    holds serialized readings while the connection to the IoT endpoint is
+//    unavailable so the outbound queue never fills.  the readings are
+//    replayed (see mcrMQTT::replayMsg()) with their original mtime once the
+//    connection is reestablished.
+//
+//    readings are held in RAM (a FIFO bounded by bytes).  when full the
+//    oldest are spilled to the mcr_store partition (CONFIG_MCR_MQTT_STORE_FLASH)
+//    or discarded.  since the readings spilled are always older than those
+//    in RAM, flash is replayed first.
+//
+//    the store is only used by the mqtt task so there is no locking.
+class mcrMQTTStore {
+public:
+  mcrMQTTStore();
+
+  // hold a serialized reading (takes ownership of msg)
+  void hold(string_t *msg);
+
+  // the oldest reading held, marked as a replay, or nullptr when the store
+  // is empty (the caller owns the reading)
+  string_t *next();
+
+  bool empty() const;
+  size_t ramBytes() const { return _ram_bytes; }
+
+  // add "replay": true to a MsgPack map (the serialized reading)
+  static void markReplay(string_t &msg);
+
+private:
+  std::deque<string_t *> _ram;
+  size_t _ram_bytes = 0;
+  const size_t _max_ram_bytes = CONFIG_MCR_MQTT_STORE_RAM_BYTES;
+  bool _discard_logged = false;
+
+  void discardOldest();
+
+#ifdef CONFIG_MCR_MQTT_STORE_FLASH
+  // the partition is an append only log of records (a header followed by
+  // the reading) erased a sector at a time as the log grows and reset once
+  // replayed
+  typedef struct {
+    uint16_t magic;
+    uint16_t len;
+  } StoreRecord_t;
+
+  static const uint16_t _record_magic = 0x4d53;
+
+  const esp_partition_t *_part = nullptr;
+  uint32_t _write_off = 0;
+  uint32_t _read_off = 0;
+  uint32_t _erased_to = 0;
+
+  bool spill(string_t *msg);
+  string_t *unspill();
+#endif
+};
+
+} // namespace mcr
+
+#endif // mcr_mqtt_store_h
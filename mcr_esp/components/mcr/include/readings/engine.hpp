@@ -27,6 +27,8 @@
 #include <sys/time.h>
 #include <time.h>
 
+#include "engines/types.hpp"
+#include "misc/histogram.hpp"
 #include "readings/reading.hpp"
 
 namespace mcr {
@@ -39,11 +41,49 @@ private:
   uint32_t convert_us_;
   uint32_t report_us_;
   uint32_t switch_cmd_us_;
+  uint32_t discover_max_hold_us_ = 0;
+
+  // bus wait time histograms (by bus job class)
+  static const uint32_t max_bus_waits_ = 4;
+  uint32_t bus_waits_count_ = 0;
+  const char *bus_wait_jobs_[max_bus_waits_] = {};
+  mcrHistogram_t bus_waits_[max_bus_waits_];
+
+  // phase elapsed time histograms (by phase)
+  static const uint32_t max_phases_ = 4;
+  uint32_t phases_count_ = 0;
+  const char *phase_names_[max_phases_] = {};
+  mcrHistogram_t phases_[max_phases_];
+
+  // startup metric (reported once):  time since boot of the first reading
+  // and the devices restored from the persisted registry (warm start)
+  uint64_t first_reading_us_ = 0;
+  uint32_t restored_devs_ = 0;
+
+  // the config applied by an engine.config cmd
+  bool has_config_ = false;
+  EngineConfig_t config_ = {};
 
 public:
+  // also used by metricsReading
+  static void histogramJSON(JsonObject &obj, const mcrHistogram_t &hist);
+
   EngineReading(const std::string &engine, uint64_t discover_us,
                 uint64_t convert_us, uint64_t report_us,
                 uint64_t switch_cmd_us_);
+  void addBusWait(const char *job, const mcrHistogram_t &hist);
+  void addPhase(const char *phase, const mcrHistogram_t &hist);
+  void setDiscoverMaxHold(uint64_t hold_us) {
+    discover_max_hold_us_ = hold_us;
+  }
+  void setFirstReading(uint64_t first_reading_us, uint32_t restored_devs) {
+    first_reading_us_ = first_reading_us;
+    restored_devs_ = restored_devs;
+  }
+  void setConfig(const EngineConfig_t &config) {
+    config_ = config;
+    has_config_ = true;
+  }
   bool hasNonZeroValues();
 
 protected:
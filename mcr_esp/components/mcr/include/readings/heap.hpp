@@ -0,0 +1,54 @@
+/*
+    heap.hpp - Master Control Remote Heap Trace Reading
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+#ifndef heap_reading_hpp
+#define heap_reading_hpp
+
+#include <memory>
+
+#include "misc/heap_trace.hpp"
+#include "readings/reading.hpp"
+
+namespace mcr {
+
+typedef class heapTraceReading heapTraceReading_t;
+typedef std::unique_ptr<heapTraceReading_t> heapTraceReading_ptr_t;
+
+// heapTraceReading:
+//    the allocations by call site (see mcrHeapTrace) since the previous
+//    reset.  tags are published compactly as an array of arrays:
+//      {"enabled": true, "free_heap": 123456, "min_free_heap": 100000,
+//       "tags": [[tag, allocs, frees, bytes, live bytes, peak bytes], ...]}
+class heapTraceReading : public Reading {
+private:
+  bool enabled_;
+  uint32_t free_heap_;
+  uint32_t min_free_heap_;
+  HeapTagStats_t stats_[HEAP_TAG_MAX];
+
+public:
+  heapTraceReading(bool reset = false);
+
+protected:
+  virtual void populateJSON(JsonDocument &doc);
+};
+} // namespace mcr
+
+#endif // heap_reading_hpp
@@ -0,0 +1,70 @@
+/*
+    metrics.hpp - Master Control Remote Metrics Reading
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+#ifndef metrics_reading_hpp
+#define metrics_reading_hpp
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "misc/histogram.hpp"
+#include "misc/metrics.hpp"
+#include "readings/reading.hpp"
+
+namespace mcr {
+
+typedef std::unique_ptr<metricsReading_t> metricsReading_ptr_t;
+
+// metricsReading:
+//    the export of the metrics registry (see mcrMetrics), only the metrics
+//    changed since the previous export are included:
+//      {"interval_ms": 60000,
+//       "counters": {"mqtt.msgs_in": 12, ...},     (change since previous)
+//       "gauges": {"heap.free": 123456, ...},
+//       "histograms": {"mcrDS.convert":
+//                        {"count": 4, "min_us": 10, "max_us": 900,
+//                         "buckets": [0, 1, ...]}, ...}}
+class metricsReading : public Reading {
+private:
+  typedef std::pair<std::string, uint32_t> value_t;
+  typedef std::pair<std::string, mcrHistogram_t> hist_t;
+
+  uint32_t interval_ms_;
+  std::vector<value_t> counters_;
+  std::vector<value_t> gauges_;
+  std::vector<hist_t> histograms_;
+
+public:
+  metricsReading(uint32_t interval_ms);
+
+  void addCounter(const char *name, uint32_t delta);
+  void addGauge(const char *name, uint32_t value);
+  void addHistogram(const char *name, const mcrHistogram_t &hist);
+
+  bool hasMetrics() const;
+
+protected:
+  virtual void populateJSON(JsonDocument &doc);
+};
+} // namespace mcr
+
+#endif // metrics_reading_hpp
@@ -37,10 +37,24 @@ private:
   uint32_t duty_min_ = 1;
   uint32_t duty_ = 0;
 
+  // group update (see cmdPWM) results
+  uint32_t group_channels_ = 0;
+  uint32_t group_skew_us_ = 0;
+  int32_t group_late_us_ = 0;
+
 public:
   pwmReading(const std::string &id, time_t mtime, uint32_t duty_max,
              uint32_t duty_min, uint32_t duty);
 
+  // channels:  number of channels started together
+  // skew_us:   between starting the first and last channel
+  // late_us:   start of the first channel relative to execute_at
+  void setGroup(uint32_t channels, uint32_t skew_us, int32_t late_us) {
+    group_channels_ = channels;
+    group_skew_us_ = skew_us;
+    group_late_us_ = late_us;
+  }
+
 protected:
   virtual void populateJSON(JsonDocument &doc);
 };
@@ -48,7 +48,11 @@ typedef enum {
   SWITCH,
   TEMP,
   TEXT,
-  PWM
+  PWM,
+  TASKS,
+  HEAP,
+  TRACE,
+  METRICS
 } ReadingType_t;
 
 typedef class Reading Reading_t;
@@ -77,6 +81,7 @@ private:
 
 protected:
   ReadingType_t _type = BASE;
+  size_t _json_capacity = 2048; // readings with many fields may need more
 
   void commonJSON(JsonDocument &doc);
   virtual void populateJSON(JsonDocument &doc){};
@@ -20,7 +20,9 @@
 
 #include "readings/celsius.hpp"
 #include "readings/engine.hpp"
+#include "readings/heap.hpp"
 #include "readings/humidity.hpp"
+#include "readings/metrics.hpp"
 #include "readings/positions.hpp"
 #include "readings/pwm.hpp"
 #include "readings/ramutil.hpp"
@@ -28,3 +30,5 @@
 #include "readings/simple_text.hpp"
 #include "readings/soil.hpp"
 #include "readings/startup.hpp"
+#include "readings/tasks.hpp"
+#include "readings/trace.hpp"
@@ -46,6 +46,11 @@ private:
   uint32_t heap_min_;
   uint64_t uptime_us_;
 
+  // tasks and the total of their unused stack (high water) to compare the
+  // engine task and executor modes (CONFIG_MCR_ENGINE_EXECUTOR)
+  uint32_t tasks_;
+  uint32_t stack_free_;
+
 public:
   remoteReading(uint32_t batt_mv);
 
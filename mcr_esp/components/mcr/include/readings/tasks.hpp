@@ -0,0 +1,69 @@
+/*
+    tasks.hpp - Master Control Remote Task Statistics Reading
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+#ifndef tasks_reading_hpp
+#define tasks_reading_hpp
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include "readings/reading.hpp"
+
+namespace mcr {
+
+typedef struct {
+  std::string name;
+  uint32_t cpu_pm;     // cpu of a single core (per mille) since the previous
+  uint32_t stack_free; // stack high water
+  char state;          // as vTaskList():  X, R, B, S or D
+} taskStat_t;
+
+typedef class taskStatsReading taskStatsReading_t;
+typedef std::unique_ptr<taskStatsReading_t> taskStatsReading_ptr_t;
+
+// taskStatsReading:
+//    the utilization of every task (from the FreeRTOS run time stats) over
+//    the interval since the previous reading.  tasks are published compactly
+//    as an array of arrays:
+//      {"interval_ms": 60000,
+//       "tasks": [[name, cpu per mille, stack free, state], ...]}
+class taskStatsReading : public Reading {
+private:
+  uint32_t interval_ms_;
+  std::vector<taskStat_t> tasks_;
+
+public:
+  taskStatsReading(uint32_t interval_ms, uint32_t num_tasks);
+
+  void add(const char *name, uint32_t cpu_pm, uint32_t stack_free,
+           eTaskState state);
+
+  static char stateChar(eTaskState state);
+
+protected:
+  virtual void populateJSON(JsonDocument &doc);
+};
+} // namespace mcr
+
+#endif // tasks_reading_hpp
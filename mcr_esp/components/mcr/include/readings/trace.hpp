@@ -0,0 +1,61 @@
+/*
+    trace.hpp - Master Control Remote Event Trace Reading
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+#ifndef trace_reading_hpp
+#define trace_reading_hpp
+
+#include <memory>
+
+#include "misc/trace.hpp"
+#include "readings/reading.hpp"
+
+namespace mcr {
+
+typedef class traceReading traceReading_t;
+typedef std::unique_ptr<traceReading_t> traceReading_ptr_t;
+
+// traceReading:
+//    a chunk of the event trace ring (see mcrTrace), the ring is published
+//    as several readings to bound the size of each msg.  events are
+//    published compactly as an array of arrays:
+//      {"chunk": 0, "chunks": 8, "now_us": 123456789,
+//       "sources": ["mcr", "mcrDS", ...],
+//       "events": [[us, event, core, arg], ...]}
+class traceReading : public Reading {
+private:
+  bool enabled_;
+  uint32_t chunk_;
+  uint32_t chunks_;
+  uint32_t now_us_;
+  const TraceEntry_t *entries_;
+  uint32_t count_;
+
+public:
+  static const uint32_t max_events = 64; // per chunk
+
+  traceReading(uint32_t chunk, uint32_t chunks, uint32_t now_us,
+               const TraceEntry_t *entries, uint32_t count);
+
+protected:
+  virtual void populateJSON(JsonDocument &doc);
+};
+} // namespace mcr
+
+#endif // trace_reading_hpp
@@ -144,16 +144,24 @@ bool mcrCmd::sendToQueue(cmdQueue_t &cmd_q, mcrCmd_t *cmd) {
 }
 
 void mcrCmd::translateExternalDeviceID(const char *replacement) {
+  // update the internal dev ID (originally external ID)
+  _internal_dev_id = translateDeviceID(_internal_dev_id, replacement);
+}
+
+string_t mcrCmd::translateDeviceID(const string_t &external_dev_id,
+                                   const char *replacement) {
   const string_t &mcr_name = Net::getName();
+  string_t internal_dev_id = external_dev_id;
 
-  // update the internal dev ID (originally external ID)
-  auto pos = _internal_dev_id.find(mcr_name);
+  auto pos = internal_dev_id.find(mcr_name);
 
   if (pos == string::npos) {
     // didn't find the name of this host, not for us
   } else {
-    _internal_dev_id.replace(pos, mcr_name.length(), replacement);
+    internal_dev_id.replace(pos, mcr_name.length(), replacement);
   }
+
+  return internal_dev_id;
 }
 
 const unique_ptr<char[]> mcrCmd::debug() {
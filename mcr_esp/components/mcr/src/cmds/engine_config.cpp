@@ -0,0 +1,106 @@
+#include "cmds/engine_config.hpp"
+
+namespace mcr {
+
+static const char *TAG = "cmdEngineConfig";
+
+// the same range as the Kconfig frequencies
+static const uint32_t _min_secs = 3;
+static const uint32_t _max_secs = 600;
+
+std::vector<engineConfigTarget_t> cmdEngineConfig::_targets;
+
+cmdEngineConfig::cmdEngineConfig(JsonDocument &doc, elapsedMicros &e)
+    : mcrCmd{doc, e} {
+  _engine = doc["engine"] | "";
+  _convert_secs = doc["convert_secs"] | 0;
+  _discover_secs = doc["discover_secs"] | 0;
+  _report_secs = doc["report_secs"] | 0;
+
+  _has_convert = doc.containsKey("convert");
+  _convert = doc["convert"] | true;
+  _has_discover = doc.containsKey("discover");
+  _discover = doc["discover"] | true;
+
+  _create_elapsed.freeze();
+}
+
+bool cmdEngineConfig::apply(EngineConfig_t &config) const {
+  const uint32_t secs[] = {_convert_secs, _discover_secs, _report_secs};
+
+  for (auto s : secs) {
+    if ((s != 0) && ((s < _min_secs) || (s > _max_secs))) {
+      ESP_LOGW(TAG, "%usecs out of range (%u-%u), ignoring %s", s, _min_secs,
+               _max_secs, _engine.c_str());
+      return false;
+    }
+  }
+
+  if (_convert_secs > 0) {
+    config.convert_secs = _convert_secs;
+  }
+
+  if (_discover_secs > 0) {
+    config.discover_secs = _discover_secs;
+  }
+
+  if (_report_secs > 0) {
+    config.report_secs = _report_secs;
+  }
+
+  if (_has_convert) {
+    config.convert = _convert;
+  }
+
+  if (_has_discover) {
+    config.discover = _discover;
+  }
+
+  return true;
+}
+
+bool cmdEngineConfig::matchEngine(const string_t &name) const {
+  return (_engine == name) || (_engine == "all");
+}
+
+bool cmdEngineConfig::process() {
+  bool rc = false;
+
+  if (forThisHost() == false) {
+    return rc;
+  }
+
+  for (auto &target : _targets) {
+    if (matchEngine(target.name)) {
+      rc = target.func(target.engine, *this);
+    }
+  }
+
+  if (rc == false) {
+    ESP_LOGW(TAG, "engine %s not found or config invalid", _engine.c_str());
+  }
+
+  return rc;
+}
+
+// STATIC
+void cmdEngineConfig::registerEngine(const string_t &name,
+                                     EngineConfigFunc_t *func, void *engine) {
+  ESP_LOGI(TAG, "registering engine %s", name.c_str());
+
+  _targets.push_back({name, func, engine});
+}
+
+const unique_ptr<char[]> cmdEngineConfig::debug() {
+  const auto max_buf = 128;
+  unique_ptr<char[]> debug_str(new char[max_buf]);
+
+  snprintf(debug_str.get(), max_buf,
+           "cmdEngineConfig(%s convert(%us) discover(%us) report(%us)) "
+           "parse(%lldus)",
+           _engine.c_str(), _convert_secs, _discover_secs, _report_secs,
+           (uint64_t)_parse_elapsed);
+
+  return move(debug_str);
+}
+} // namespace mcr
@@ -17,6 +17,7 @@ mcrCmdFactory::mcrCmdFactory() {
 }
 
 mcrCmd_t *mcrCmdFactory::fromRaw(JsonDocument &doc, rawMsg_t *raw) {
+  mcrHeapScope heap_scope(HEAP_TAG_CMD_FACTORY);
   mcrCmd_t *cmd = nullptr;
   elapsedMicros parse_elapsed;
 
@@ -51,6 +52,10 @@ mcrCmd_t *mcrCmdFactory::fromRaw(JsonDocument &doc, rawMsg_t *raw) {
   } else {
     // deserialization success, manufacture the derived cmd
     cmd = manufacture(doc, parse_elapsed);
+
+    if (cmd != nullptr) {
+      mcrTrace::record(TRACE_CMD_PARSE, (uint16_t)cmd->type());
+    }
   }
 
   return cmd;
@@ -95,6 +100,18 @@ mcrCmd_t *mcrCmdFactory::manufacture(JsonDocument &doc,
   case mcrCmdType::pwm:
     cmd = new cmdPWM(doc, parse_elapsed);
     break;
+
+  case mcrCmdType::engineConfig:
+    cmd = new cmdEngineConfig(doc, parse_elapsed);
+    break;
+
+  case mcrCmdType::heapTrace:
+    cmd = new cmdHeapTrace(doc, parse_elapsed);
+    break;
+
+  case mcrCmdType::traceDump:
+    cmd = new cmdTraceDump(doc, parse_elapsed);
+    break;
   }
 
   return cmd;
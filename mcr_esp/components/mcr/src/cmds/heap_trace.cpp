@@ -0,0 +1,39 @@
+#include "cmds/heap_trace.hpp"
+#include "readings/heap.hpp"
+
+namespace mcr {
+
+static const char *TAG = "cmdHeapTrace";
+
+cmdHeapTrace::cmdHeapTrace(JsonDocument &doc, elapsedMicros &e)
+    : mcrCmd{doc, e} {
+  _reset = doc["reset"] | false;
+
+  _create_elapsed.freeze();
+}
+
+bool cmdHeapTrace::process() {
+  if (forThisHost() == false) {
+    return false;
+  }
+
+  if (mcrHeapTrace::enabled() == false) {
+    ESP_LOGW(TAG, "heap trace not enabled (CONFIG_MCR_HEAP_TRACE)");
+  }
+
+  heapTraceReading_ptr_t reading(new heapTraceReading(_reset));
+  reading->publish();
+
+  return true;
+}
+
+const unique_ptr<char[]> cmdHeapTrace::debug() {
+  const auto max_buf = 64;
+  unique_ptr<char[]> debug_str(new char[max_buf]);
+
+  snprintf(debug_str.get(), max_buf, "cmdHeapTrace(reset=%s) parse(%lldus)",
+           _reset ? "true" : "false", (uint64_t)_parse_elapsed);
+
+  return move(debug_str);
+}
+} // namespace mcr
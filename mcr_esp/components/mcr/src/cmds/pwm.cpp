@@ -4,6 +4,8 @@
 
 namespace mcr {
 
+static const char *TAG = "cmdPWM";
+
 cmdPWM::cmdPWM(JsonDocument &doc, elapsedMicros &e) : mcrCmd(doc, e, "device") {
   // json format of states command:
   // {"device":"pwm/mcr.xxx.pin:n",
@@ -11,6 +13,15 @@ cmdPWM::cmdPWM(JsonDocument &doc, elapsedMicros &e) : mcrCmd(doc, e, "device") {
   //   "refid":"0fc4417c-f1bb-11e7-86bd-6cf049e7139f",
   //   "mtime":1515117138,
   //   "cmd":"pwm"}
+  //
+  // optionally, a profile of steps executed by the device:
+  //   "steps":[{"duty":4095,"fade_ms":1000,"hold_ms":500},
+  //            {"duty":0,"fade_ms":1000,"hold_ms":500}],
+  //   "loop":true
+  //
+  // or, other channels to start together with the device:
+  //   "group":[{"device":"pwm/mcr.xxx.pin:2","duty":1024,"fade_ms":500}],
+  //   "execute_at":1515117139250    (unix time in ms, optional)
 
   // overrides the default of internal name == external name
   translateExternalDeviceID("self");
@@ -18,10 +29,49 @@ cmdPWM::cmdPWM(JsonDocument &doc, elapsedMicros &e) : mcrCmd(doc, e, "device") {
   _duty = doc["duty"].as<uint32_t>();
   _fade_ms = doc["fade_ms"].as<uint32_t>();
 
+  const JsonArray steps = doc["steps"].as<JsonArray>();
+
+  // a profile with more steps than the device supports is rejected by
+  // process() rather than executed truncated
+  _steps_requested = steps.size();
+
+  if (_steps_requested <= pwmProfile_t::max_steps) {
+    for (auto element : steps) {
+      const JsonObject &step = element.as<JsonObject>();
+      pwmStep_t &profile_step = _profile.steps[_profile.count];
+
+      profile_step.duty = step["duty"].as<uint32_t>();
+      profile_step.fade_ms = step["fade_ms"].as<uint32_t>();
+      profile_step.hold_ms = step["hold_ms"].as<uint32_t>();
+      _profile.count++;
+    }
+  }
+
+  _profile.loop = doc["loop"].as<bool>();
+
+  const JsonArray group = doc["group"].as<JsonArray>();
+
+  for (auto element : group) {
+    const JsonObject &channel = element.as<JsonObject>();
+    const string_t external_dev_id = channel["device"] | "";
+
+    _group.push_back(
+        {translateDeviceID(external_dev_id, "self"),
+         channel["duty"].as<uint32_t>(), channel["fade_ms"].as<uint32_t>()});
+  }
+
+  _execute_at_us = (int64_t)doc["execute_at"].as<uint64_t>() * 1000;
+
   _create_elapsed.freeze();
 }
 
 bool cmdPWM::process() {
+  if (_steps_requested > pwmProfile_t::max_steps) {
+    ESP_LOGW(TAG, "%u steps > max %u, ignoring %s", _steps_requested,
+             pwmProfile_t::max_steps, _external_dev_id.c_str());
+    return false;
+  }
+
   for (auto cmd_q : mcrCmdQueues::all()) {
     auto *fresh_cmd = new cmdPWM(this);
     sendToQueue(cmd_q, fresh_cmd);
@@ -34,8 +84,11 @@ const unique_ptr<char[]> cmdPWM::debug() {
   const auto max_len = 127;
   unique_ptr<char[]> debug_str(new char[max_len + 1]);
 
-  snprintf(debug_str.get(), max_len, "cmdPWM(%s duty(%d) %s)",
-           _external_dev_id.c_str(), _duty, ((_ack) ? "ACK" : ""));
+  snprintf(debug_str.get(), max_len,
+           "cmdPWM(%s duty(%d) steps(%d%s) group(%d) %s)",
+           _external_dev_id.c_str(), _duty, _profile.count,
+           ((_profile.loop) ? " loop" : ""), _group.size(),
+           ((_ack) ? "ACK" : ""));
 
   return move(debug_str);
 }
@@ -0,0 +1,65 @@
+#include <algorithm>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include "cmds/trace_dump.hpp"
+#include "readings/trace.hpp"
+
+namespace mcr {
+
+static const char *TAG = "cmdTraceDump";
+
+cmdTraceDump::cmdTraceDump(JsonDocument &doc, elapsedMicros &e)
+    : mcrCmd{doc, e} {
+  _clear = doc["clear"] | false;
+
+  _create_elapsed.freeze();
+}
+
+bool cmdTraceDump::process() {
+  if (forThisHost() == false) {
+    return false;
+  }
+
+  // the snapshot precedes the publishing of the chunks so the events of
+  // the dump itself are not included
+  const uint32_t now_us = (uint32_t)esp_timer_get_time();
+  unique_ptr<TraceEntry_t[]> entries(new TraceEntry_t[mcrTrace::max_entries]);
+  const uint32_t count = mcrTrace::snapshot(entries.get(), _clear);
+
+  if (mcrTrace::enabled() == false) {
+    ESP_LOGW(TAG, "trace not enabled (CONFIG_MCR_TRACE)");
+  }
+
+  const uint32_t per_chunk = traceReading::max_events;
+  const uint32_t chunks =
+      (count == 0) ? 1 : ((count + per_chunk - 1) / per_chunk);
+
+  for (uint32_t chunk = 0; chunk < chunks; chunk++) {
+    const uint32_t first = chunk * per_chunk;
+    const uint32_t num = std::min(per_chunk, count - first);
+
+    traceReading_ptr_t reading(
+        new traceReading(chunk, chunks, now_us, &(entries[first]), num));
+    reading->publish();
+
+    // pace the chunks so the outbound queue drains between them
+    vTaskDelay(pdMS_TO_TICKS(20));
+  }
+
+  ESP_LOGI(TAG, "published %u events in %u chunks", count, chunks);
+
+  return true;
+}
+
+const unique_ptr<char[]> cmdTraceDump::debug() {
+  const auto max_buf = 64;
+  unique_ptr<char[]> debug_str(new char[max_buf]);
+
+  snprintf(debug_str.get(), max_buf, "cmdTraceDump(clear=%s) parse(%lldus)",
+           _clear ? "true" : "false", (uint64_t)_parse_elapsed);
+
+  return move(debug_str);
+}
+} // namespace mcr
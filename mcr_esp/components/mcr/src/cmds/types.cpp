@@ -15,7 +15,10 @@ static const std::map<string_t, mcrCmdType> _cmd_map = {
     {string_t("restart"), mcrCmdType::restart},
     {string_t("engines.suspend"), mcrCmdType::enginesSuspend},
     {string_t("ota.https"), mcrCmdType::otaHTTPS},
-    {string_t("pwm"), mcrCmdType::pwm}};
+    {string_t("pwm"), mcrCmdType::pwm},
+    {string_t("engine.config"), mcrCmdType::engineConfig},
+    {string_t("heap.trace"), mcrCmdType::heapTrace},
+    {string_t("trace.dump"), mcrCmdType::traceDump}};
 
 static mcrCmdTypeMap_t *__singleton;
 
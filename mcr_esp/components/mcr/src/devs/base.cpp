@@ -35,6 +35,7 @@
 #include "devs/addr.hpp"
 #include "devs/base.hpp"
 #include "misc/mcr_types.hpp"
+#include "misc/metrics.hpp"
 #include "readings/readings.hpp"
 
 using std::move;
@@ -42,6 +43,12 @@ using std::unique_ptr;
 
 namespace mcr {
 
+// the errors of all devices, the errors of each device are included in
+// its readings
+static mcrMetric_t _dev_crc_mismatches("dev.crc_mismatches", METRIC_COUNTER);
+static mcrMetric_t _dev_read_errors("dev.read_errors", METRIC_COUNTER);
+static mcrMetric_t _dev_write_errors("dev.write_errors", METRIC_COUNTER);
+
 // construct a new mcrDev with only an address
 mcrDev::mcrDev(mcrDevAddr_t &addr) { _addr = addr; }
 
@@ -70,16 +77,20 @@ void mcrDev::setReading(Reading_t *reading) {
   }
 
   if (reading) {
-    reading->setCRCMismatches(_crc_mismatches);
-    reading->setReadErrors(_read_errors);
-    reading->setReadUS(_read_us);
-    reading->setWriteErrors(_write_errors);
-    reading->setWriteUS(_write_us);
+    applyMetrics(reading);
   }
 
   _reading = reading;
 };
 
+void mcrDev::applyMetrics(Reading_t *reading) {
+  reading->setCRCMismatches(_crc_mismatches);
+  reading->setReadErrors(_read_errors);
+  reading->setReadUS(_read_us);
+  reading->setWriteErrors(_write_errors);
+  reading->setWriteUS(_write_us);
+}
+
 void mcrDev::setReadingCmdAck(uint32_t latency_us, mcrRefID_t &refid) {
   if (_reading != nullptr) {
     _reading->setCmdAck(latency_us, refid);
@@ -90,6 +101,17 @@ uint8_t mcrDev::firstAddressByte() { return _addr.firstAddressByte(); };
 uint8_t mcrDev::lastAddressByte() { return _addr.lastAddressByte(); };
 mcrDevAddr_t &mcrDev::addr() { return _addr; }
 uint8_t *mcrDev::addrBytes() { return (uint8_t *)_addr; }
+
+uint64_t mcrDev::key() {
+  uint64_t key = 0;
+  uint8_t *bytes = (uint8_t *)_addr;
+
+  for (uint32_t i = 0; (i < _addr.len()) && (i < sizeof(key)); i++) {
+    key = (key << 8) | bytes[i];
+  }
+
+  return key;
+}
 Reading_t *mcrDev::reading() { return _reading; }
 uint32_t mcrDev::idMaxLen() { return _id_len; };
 bool mcrDev::isValid() { return firstAddressByte() != 0x00 ? true : false; };
@@ -111,7 +133,10 @@ time_t mcrDev::secondsSinceLastSeen() { return (time(nullptr) - _last_seen); }
 bool mcrDev::available() { return (secondsSinceLastSeen() <= _missing_secs); }
 bool mcrDev::missing() { return (!available()); }
 
-void mcrDev::writeStart() { _write_us.reset(); }
+void mcrDev::writeStart() {
+  _write_seq++;
+  _write_us.reset();
+}
 uint64_t mcrDev::writeStop() {
   _write_us.freeze();
 
@@ -119,9 +144,20 @@ uint64_t mcrDev::writeStop() {
 }
 uint64_t mcrDev::writeUS() { return _write_us; }
 
-void mcrDev::crcMismatch() { _crc_mismatches++; }
-void mcrDev::readFailure() { _read_errors++; }
-void mcrDev::writeFailure() { _write_errors++; }
+void mcrDev::crcMismatch() {
+  _crc_mismatches++;
+  _dev_crc_mismatches.add();
+}
+
+void mcrDev::readFailure() {
+  _read_errors++;
+  _dev_read_errors.add();
+}
+
+void mcrDev::writeFailure() {
+  _write_errors++;
+  _dev_write_errors.add();
+}
 
 // this is a fairly expensive method, avoid production use
 const unique_ptr<char[]> mcrDev::debug() {
@@ -37,45 +37,20 @@ using std::unique_ptr;
 
 namespace mcr {
 
-const char *i2cDev::i2cDevDesc(uint8_t addr) {
-  switch (addr) {
-  case 0x44:
-    return (const char *)"sht31";
-    break;
-
-  case 0x20:
-  case 0x21:
-  case 0x22:
-  case 0x23:
-  case 0x24:
-  case 0x25:
-  case 0x26:
-  case 0x27:
-    return (const char *)"mcp23008";
-    break;
-
-  case 0x36:
-    return (const char *)"soil";
-    break;
-
-  default:
-    return (const char *)"unknown";
-    break;
-  }
-}
-
 // construct a new i2cDev with a known address and compute the id
-i2cDev::i2cDev(mcrDevAddr_t &addr, bool use_multiplexer, uint8_t bus)
+i2cDev::i2cDev(mcrDevAddr_t &addr, bool use_multiplexer, uint8_t bus,
+               uint8_t port, const char *desc)
     : mcrDev(addr) {
   _use_multiplexer = use_multiplexer;
   _bus = bus;
+  _port = port;
 
   auto const max_id_len = 63;
   unique_ptr<char[]> id(new char[max_id_len + 1]);
 
-  setDescription(i2cDevDesc(firstAddressByte()));
+  setDescription(desc);
 
-  snprintf(id.get(), max_id_len, "i2c/self.%02x.%s", this->bus(),
+  snprintf(id.get(), max_id_len, "i2c/self.%02x.%s", idBus(),
            description().c_str());
 
   setID(id.get());
@@ -93,7 +68,7 @@ const char *i2cDev::externalName() {
     unique_ptr<char[]> name(new char[name_max + 1]);
 
     snprintf(name.get(), name_max, "i2c/%s.%02x.%s", Net::getName().c_str(),
-             this->bus(), description().c_str());
+             idBus(), description().c_str());
 
     _external_name = name.get();
   }
@@ -105,6 +80,12 @@ uint8_t i2cDev::devAddr() { return firstAddressByte(); };
 bool i2cDev::useMultiplexer() { return _use_multiplexer; };
 uint8_t i2cDev::bus() const { return _bus; };
 
+uint64_t i2cDev::key() {
+  return ((uint64_t)_port << 16) | ((uint64_t)_bus << 8) | devAddr();
+}
+uint8_t i2cDev::port() const { return _port; };
+uint8_t i2cDev::idBus() const { return (_port * _buses_per_port) + _bus; };
+
 const RawData_t &i2cDev::rawData() { return _raw_data; }
 
 uint8_t i2cDev::readAddr() {
@@ -113,6 +94,9 @@ uint8_t i2cDev::readAddr() {
 
 void i2cDev::storeRawData(RawData_t &data) { _raw_data = data; }
 
+int64_t i2cDev::dataReadyAt() const { return _data_ready_at_us; }
+void i2cDev::dataReadyAt(int64_t at_us) { _data_ready_at_us = at_us; }
+
 uint8_t i2cDev::writeAddr() {
   return (firstAddressByte() << 1) | I2C_MASTER_WRITE;
 };
@@ -121,8 +105,8 @@ const unique_ptr<char[]> i2cDev::debug() {
   const auto max_len = 127;
   unique_ptr<char[]> debug_str(new char[max_len + 1]);
 
-  snprintf(debug_str.get(), max_len, "i2cDev(%s bus=%d use_mplex=%s)",
-           externalName(), _bus, (_use_multiplexer) ? "true" : "false");
+  snprintf(debug_str.get(), max_len, "i2cDev(%s port=%d bus=%d use_mplex=%s)",
+           externalName(), _port, _bus, (_use_multiplexer) ? "true" : "false");
 
   return move(debug_str);
 }
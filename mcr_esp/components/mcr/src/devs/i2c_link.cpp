@@ -0,0 +1,58 @@
+/*
+    i2c_link.cpp - Master Control Remote I2C Command Links
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+#include <cstdint>
+
+#include <driver/i2c.h>
+
+#include "devs/i2c_link.hpp"
+
+namespace mcr {
+
+void i2cQueueTransaction(i2c_cmd_handle_t cmd, uint8_t addr,
+                         const uint8_t *send, uint32_t send_len,
+                         uint8_t *recv, uint32_t recv_len) {
+  // with nothing to send or receive only the address is written (e.g. to
+  // wake or detect a device)
+  if ((send_len > 0) || (recv_len == 0)) {
+    i2c_master_start(cmd); // queue i2c START
+    i2c_master_write_byte(cmd, (addr << 1) | I2C_MASTER_WRITE,
+                          true); // queue the device address (with WRITE)
+                                 // and check for ACK
+
+    if (send_len > 0) {
+      i2c_master_write(cmd, (uint8_t *)send, send_len,
+                       true); // queue bytes to send (with ACK check)
+    }
+  }
+
+  if (recv_len > 0) {
+    // when bytes were sent this is a repeated START (no STOP)
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, (addr << 1) | I2C_MASTER_READ,
+                          true); // queue the READ for device and check for ACK
+    i2c_master_read(cmd, recv, recv_len,
+                    I2C_MASTER_LAST_NACK); // queue the READ of number of bytes
+  }
+
+  i2c_master_stop(cmd); // queue i2c STOP
+}
+
+} // namespace mcr
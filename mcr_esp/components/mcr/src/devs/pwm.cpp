@@ -101,9 +101,20 @@ void pwmDev::configureChannel() {
 }
 
 bool pwmDev::updateDuty(uint32_t duty, uint32_t fade_ms) {
-  auto esp_rc = ESP_OK;
+  auto rc = false;
+
+  stopProfile();
 
   writeStart();
+  rc = fadeTo(duty, fade_ms);
+  writeStop();
+
+  return rc;
+}
+
+bool pwmDev::fadeTo(uint32_t duty, uint32_t fade_ms) {
+  auto esp_rc = ESP_OK;
+
   // esp_rc = ledc_set_duty_and_update(ledc_channel_.speed_mode,
   // ledc_channel_.channel, duty_, 0);
 
@@ -118,13 +129,41 @@ bool pwmDev::updateDuty(uint32_t duty, uint32_t fade_ms) {
                                         ledc_channel_.channel, duty, fade_ms,
                                         LEDC_FADE_NO_WAIT);
 
-  writeStop();
-
   duty_ = duty;
 
   return (esp_rc == ESP_OK) ? true : false;
 }
 
+bool pwmDev::prepareFade(uint32_t duty, uint32_t fade_ms) {
+  stopProfile();
+
+  last_rc_ = ledc_set_fade_with_time(ledc_channel_.speed_mode,
+                                     ledc_channel_.channel, duty, fade_ms);
+
+  if (last_rc_ == ESP_OK) {
+    duty_ = duty;
+  }
+
+  return (last_rc_ == ESP_OK);
+}
+
+bool pwmDev::startFade() {
+  last_rc_ = ledc_fade_start(ledc_channel_.speed_mode, ledc_channel_.channel,
+                             LEDC_FADE_NO_WAIT);
+
+  return (last_rc_ == ESP_OK);
+}
+
+bool pwmDev::startProfile(const pwmProfile_t &profile) {
+  // the duty is updated by each step so it is current while the profile runs
+  last_rc_ = profile_.start(profile, ledc_channel_.speed_mode,
+                            ledc_channel_.channel, &duty_);
+
+  return (last_rc_ == ESP_OK);
+}
+
+void pwmDev::stopProfile() { profile_.stop(); }
+
 // STATIC
 void pwmDev::allOff() {
   gpio_num_t pins[4] = {GPIO_NUM_32, GPIO_NUM_15, GPIO_NUM_33, GPIO_NUM_27};
@@ -191,8 +230,9 @@ const unique_ptr<char[]> pwmDev::debug() {
   unique_ptr<char[]> debug_str(new char[max_len + 1]);
 
   snprintf(debug_str.get(), max_len,
-           "pwmDev(%s duty=%d channel=%d pin=%d last_rc=%s)", externalName(),
-           duty_, ledc_channel_.channel, gpio_pin_, esp_err_to_name(last_rc_));
+           "pwmDev(%s duty=%d channel=%d pin=%d profile=%d/%d last_rc=%s)",
+           externalName(), duty_, ledc_channel_.channel, gpio_pin_,
+           profile_.step(), profile_.count(), esp_err_to_name(last_rc_));
 
   return move(debug_str);
 }
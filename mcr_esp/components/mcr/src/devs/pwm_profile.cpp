@@ -0,0 +1,143 @@
+/*
+    pwm_profile.cpp - Master Control Remote PWM Profile
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+#include <driver/ledc.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#include "devs/pwm_profile.hpp"
+
+namespace mcr {
+
+pwmProfileRunner::~pwmProfileRunner() {
+  if (timer_ == nullptr) {
+    return;
+  }
+
+  stop();
+  esp_timer_delete(timer_);
+  vSemaphoreDelete(mutex_);
+}
+
+esp_err_t pwmProfileRunner::start(const pwmProfile_t &profile,
+                                  ledc_mode_t speed_mode,
+                                  ledc_channel_t channel, uint32_t *duty) {
+  uint64_t period_ms = 0;
+
+  for (uint32_t i = 0; i < profile.count; i++) {
+    period_ms += profile.steps[i].fade_ms + profile.steps[i].hold_ms;
+  }
+
+  // a looping profile must take some time or the timer would never rest
+  if ((profile.count == 0) || (profile.count > pwmProfile_t::max_steps) ||
+      (profile.loop && (period_ms == 0))) {
+    last_rc_ = ESP_ERR_INVALID_ARG;
+    return last_rc_;
+  }
+
+  if (timer_ == nullptr) {
+    esp_timer_create_args_t timer_args = {.callback = &timerCallback,
+                                          .arg = this,
+                                          .dispatch_method = ESP_TIMER_TASK,
+                                          .name = "pwm_profile"};
+
+    last_rc_ = esp_timer_create(&timer_args, &timer_);
+
+    if (last_rc_ != ESP_OK) {
+      timer_ = nullptr;
+      return last_rc_;
+    }
+
+    mutex_ = xSemaphoreCreateMutex();
+  }
+
+  stop();
+
+  xSemaphoreTake(mutex_, portMAX_DELAY);
+  profile_ = profile;
+  step_ = 0;
+  next_us_ = esp_timer_get_time();
+  speed_mode_ = speed_mode;
+  channel_ = channel;
+  duty_ = duty;
+  xSemaphoreGive(mutex_);
+
+  // the first step is started now, the timer starts the rest
+  runStep();
+
+  return last_rc_;
+}
+
+void pwmProfileRunner::stop() {
+  if (timer_ == nullptr) {
+    return;
+  }
+
+  xSemaphoreTake(mutex_, portMAX_DELAY);
+  esp_timer_stop(timer_);
+  profile_.count = 0;
+  xSemaphoreGive(mutex_);
+}
+
+// STATIC
+void pwmProfileRunner::timerCallback(void *runner) {
+  ((pwmProfileRunner_t *)runner)->runStep();
+}
+
+void pwmProfileRunner::runStep() {
+  xSemaphoreTake(mutex_, portMAX_DELAY);
+
+  // the profile was stopped while this step was pending
+  if (profile_.count == 0) {
+    xSemaphoreGive(mutex_);
+    return;
+  }
+
+  const pwmStep_t &step = profile_.steps[step_];
+
+  last_rc_ = ledc_set_fade_time_and_start(speed_mode_, channel_, step.duty,
+                                          step.fade_ms, LEDC_FADE_NO_WAIT);
+
+  if ((last_rc_ == ESP_OK) && (duty_ != nullptr)) {
+    *duty_ = step.duty;
+  }
+
+  next_us_ += (int64_t)(step.fade_ms + step.hold_ms) * 1000;
+  step_++;
+
+  if (step_ >= profile_.count) {
+    step_ = 0;
+
+    if (profile_.loop == false) {
+      profile_.count = 0;
+    }
+  }
+
+  if (profile_.count > 0) {
+    int64_t delay_us = next_us_ - esp_timer_get_time();
+
+    esp_timer_start_once(timer_, (delay_us > 0) ? delay_us : 1);
+  }
+
+  xSemaphoreGive(mutex_);
+}
+
+} // namespace mcr
@@ -0,0 +1,455 @@
+/*
+    i2c_sim.c - Master Control Remote Simulated I2C Bus
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+// Models the devices supported by mcrI2c at the transaction level,
+// including the time each device needs before requested data is available.
+// A read issued too early is not acknowledged, just like the real devices.
+//
+// Like owb_sim, there is no dependency on the ESP32 hardware (only esp_log,
+// esp_timer and vTaskDelay) so it may be built on a host with trivial shims.
+
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "drivers/i2c_sim.h"
+
+static const char * TAG = "i2c_sim";
+
+#define MUX_ADDR 0x70
+
+// time each device needs to produce requested data
+#define SHT31_MEASURE_US      15000   // high repeatability
+#define SHT31_STATUS_RESET    0x0010  // system reset detected
+#define SEESAW_TEMP_US        1000
+#define SEESAW_TOUCH_US       3000
+
+// each port (controller) is independent and only used by the engine for
+// that port so no locking is required
+typedef struct
+{
+    i2c_sim_device devices[I2C_SIM_MAX_DEVICES];
+    int num_devices;
+    bool multiplexer;
+    uint8_t mux_select;
+    i2c_sim_stats stats;
+} i2c_sim_port;
+
+static i2c_sim_port _ports[I2C_SIM_PORTS];
+
+static void _account(i2c_sim_port *port, size_t bytes, bool repeated_start)
+{
+    port->stats.transactions++;
+    port->stats.bytes += bytes;
+    port->stats.bus_us += I2C_SIM_START_STOP_US + (bytes * I2C_SIM_BYTE_US);
+
+    if (repeated_start)
+    {
+        port->stats.bus_us += I2C_SIM_START_STOP_US;
+    }
+}
+
+static esp_err_t _nack(i2c_sim_port *port)
+{
+    port->stats.nacks++;
+    return ESP_FAIL;
+}
+
+static i2c_sim_device* _find(i2c_sim_port *port, uint8_t addr)
+{
+    for (int i = 0; i < port->num_devices; i++)
+    {
+        i2c_sim_device *dev = &(port->devices[i]);
+
+        if (dev->addr != addr)
+        {
+            continue;
+        }
+
+        if (!port->multiplexer || (port->mux_select & (1 << dev->bus)))
+        {
+            return dev;
+        }
+    }
+
+    return NULL;
+}
+
+static uint8_t _crc_sht31(const uint8_t *data)
+{
+    uint8_t crc = 0xff;
+
+    for (int j = 0; j < 2; j++)
+    {
+        crc ^= data[j];
+
+        for (int i = 0; i < 8; i++)
+        {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x31 : (crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+// periodic acquisition (datasheet table 10) MSB determines the rate
+static int64_t _sht31_period_us(uint8_t msb)
+{
+    switch (msb)
+    {
+    case 0x20: return 2000000;
+    case 0x21: return 1000000;
+    case 0x22: return 500000;
+    case 0x23: return 250000;
+    case 0x27: return 100000;
+    }
+
+    return 0;
+}
+
+static void _write_sht31(i2c_sim_device *dev, const uint8_t *data, size_t len, int64_t now)
+{
+    if (len != 2)
+    {
+        return;
+    }
+
+    uint16_t cmd = (data[0] << 8) | data[1];
+
+    switch (cmd)
+    {
+    case 0x3093: // break (stop periodic acquisition)
+        dev->period_us = 0;
+        break;
+
+    case 0x30a2: // soft reset
+        i2c_sim_reset_device(dev);
+        break;
+
+    case 0x3041: // clear status
+        dev->status = 0x0000;
+        break;
+
+    case 0xe000: // fetch data (periodic mode)
+    case 0xf32d: // read status
+        dev->reg = data[0];
+        break;
+
+    default:
+        if ((data[0] == 0x24) || (data[0] == 0x2c))
+        {
+            // single shot measurement (with clock stretching when 0x2c
+            // which is accounted for when the data is read)
+            dev->reg = data[0];
+            dev->ready_at_us = now + SHT31_MEASURE_US;
+        }
+        else if (_sht31_period_us(data[0]) > 0)
+        {
+            dev->period_us = _sht31_period_us(data[0]);
+            dev->periodic_start_us = now;
+            dev->fetched = 0;
+        }
+        break;
+    }
+}
+
+static void _write_device(i2c_sim_device *dev, const uint8_t *data, size_t len)
+{
+    int64_t now = esp_timer_get_time();
+
+    if (len == 0)
+    {
+        return;
+    }
+
+    switch (dev->type)
+    {
+    case I2C_SIM_SHT31:
+        _write_sht31(dev, data, len, now);
+        break;
+
+    case I2C_SIM_SEESAW_SOIL:
+        if (len == 2)
+        {
+            dev->reg = data[1];
+            dev->ready_at_us = now + ((data[0] == 0x0f) ? SEESAW_TOUCH_US : SEESAW_TEMP_US);
+        }
+        break;
+
+    case I2C_SIM_MCP23008:
+        // first byte is the register, any others are written sequentially
+        dev->reg = data[0] % sizeof(dev->regs);
+        for (size_t i = 1; i < len; i++)
+        {
+            dev->regs[dev->reg] = data[i];
+            dev->reg = (dev->reg + 1) % sizeof(dev->regs);
+        }
+        break;
+    }
+}
+
+static esp_err_t _read_device(i2c_sim_port *port, i2c_sim_device *dev,
+                              uint8_t *data, size_t len)
+{
+    int64_t now = esp_timer_get_time();
+    uint8_t buff[6] = {0};
+
+    switch (dev->type)
+    {
+    case I2C_SIM_SHT31:
+    {
+        if (dev->reg == 0xf3)
+        {
+            buff[0] = dev->status >> 8;
+            buff[1] = dev->status & 0xff;
+            buff[2] = _crc_sht31(&(buff[0]));
+
+            memcpy(data, buff, (len < 3) ? len : 3);
+            break;
+        }
+
+        if (dev->reg == 0xe0)
+        {
+            // a fetch is only acknowledged once per completed measurement
+            int64_t measurement = (dev->period_us > 0) ?
+                                  ((now - dev->periodic_start_us) / dev->period_us) : 0;
+
+            if ((measurement == 0) || (measurement == dev->fetched))
+            {
+                return _nack(port);
+            }
+
+            dev->fetched = measurement;
+        }
+        else if (dev->reg == 0x2c)
+        {
+            // clock stretching, the bus (and caller) is held until the
+            // data is ready
+            if (now < dev->ready_at_us)
+            {
+                int64_t stretch_us = dev->ready_at_us - now;
+
+                port->stats.bus_us += stretch_us;
+                vTaskDelay(((stretch_us / 1000) / portTICK_PERIOD_MS) + 1);
+            }
+        }
+        else if ((dev->reg != 0x24) || (now < dev->ready_at_us))
+        {
+            return _nack(port);
+        }
+
+        uint16_t stc = (uint16_t)(((dev->temp_c + 45.0) * 0xffff) / 175.0);
+        uint16_t srh = (uint16_t)((dev->rh * 0xffff) / 100.0);
+
+        buff[0] = stc >> 8;
+        buff[1] = stc & 0xff;
+        buff[2] = _crc_sht31(&(buff[0]));
+        buff[3] = srh >> 8;
+        buff[4] = srh & 0xff;
+        buff[5] = _crc_sht31(&(buff[3]));
+
+        if (dev->reg != 0xe0)
+        {
+            dev->reg = 0x00;
+        }
+
+        memcpy(data, buff, (len < sizeof(buff)) ? len : sizeof(buff));
+        break;
+    }
+
+    case I2C_SIM_SEESAW_SOIL:
+    {
+        if (now < dev->ready_at_us)
+        {
+            return _nack(port);
+        }
+
+        if (dev->reg == 0x04) // SEESAW_STATUS_TEMP (16.16 fixed point)
+        {
+            uint32_t temp = (uint32_t)(dev->temp_c * (1UL << 16));
+
+            buff[0] = temp >> 24;
+            buff[1] = (temp >> 16) & 0xff;
+            buff[2] = (temp >> 8) & 0xff;
+            buff[3] = temp & 0xff;
+        }
+        else // SEESAW_TOUCH_CHANNEL_OFFSET
+        {
+            buff[0] = dev->moisture >> 8;
+            buff[1] = dev->moisture & 0xff;
+        }
+
+        memcpy(data, buff, (len < sizeof(buff)) ? len : sizeof(buff));
+        break;
+    }
+
+    case I2C_SIM_MCP23008:
+        // sequential reads wrap to the first register
+        for (size_t i = 0; i < len; i++)
+        {
+            data[i] = dev->regs[dev->reg];
+            dev->reg = (dev->reg + 1) % sizeof(dev->regs);
+        }
+        break;
+    }
+
+    return ESP_OK;
+}
+
+void i2c_sim_initialize(uint8_t port, bool multiplexer)
+{
+    i2c_sim_port *p = &(_ports[port]);
+
+    memset(p, 0, sizeof(i2c_sim_port));
+    p->multiplexer = multiplexer;
+
+    ESP_LOGI(TAG, "port %u simulated bus initialized (multiplexer=%s)", port,
+             multiplexer ? "yes" : "no");
+}
+
+i2c_sim_device* i2c_sim_add_device(i2c_sim_type type, uint8_t port, uint8_t bus,
+                                   uint8_t addr)
+{
+    i2c_sim_port *p = &(_ports[port]);
+
+    if (p->num_devices >= I2C_SIM_MAX_DEVICES)
+    {
+        ESP_LOGW(TAG, "port %u bus full, device not added", port);
+        return NULL;
+    }
+
+    i2c_sim_device *dev = &(p->devices[p->num_devices++]);
+    memset(dev, 0, sizeof(i2c_sim_device));
+
+    dev->type = type;
+    dev->port = port;
+    dev->bus = bus;
+    dev->addr = addr;
+    dev->temp_c = 20.0;
+    dev->rh = 50.0;
+    dev->moisture = 500;
+    dev->regs[0x00] = 0xff;   // IODIR: all inputs at power on
+    dev->status = SHT31_STATUS_RESET;
+
+    return dev;
+}
+
+void i2c_sim_reset_device(i2c_sim_device *dev)
+{
+    dev->reg = 0x00;
+    dev->ready_at_us = 0;
+    dev->period_us = 0;
+    dev->status |= SHT31_STATUS_RESET;
+}
+
+esp_err_t i2c_sim_write(uint8_t port, uint8_t addr, const uint8_t *data, size_t len)
+{
+    i2c_sim_port *p = &(_ports[port]);
+
+    _account(p, len + 1, false);
+
+    if (addr == MUX_ADDR)
+    {
+        if (!p->multiplexer)
+        {
+            return _nack(p);
+        }
+
+        if (len > 0)
+        {
+            p->mux_select = data[len - 1];
+        }
+        return ESP_OK;
+    }
+
+    i2c_sim_device *dev = _find(p, addr);
+
+    if (dev == NULL)
+    {
+        return _nack(p);
+    }
+
+    _write_device(dev, data, len);
+    return ESP_OK;
+}
+
+esp_err_t i2c_sim_read(uint8_t port, uint8_t addr, uint8_t *data, size_t len)
+{
+    i2c_sim_port *p = &(_ports[port]);
+
+    _account(p, len + 1, false);
+
+    if (addr == MUX_ADDR)
+    {
+        if (!p->multiplexer)
+        {
+            return _nack(p);
+        }
+
+        memset(data, p->mux_select, len);
+        return ESP_OK;
+    }
+
+    i2c_sim_device *dev = _find(p, addr);
+
+    if (dev == NULL)
+    {
+        return _nack(p);
+    }
+
+    return _read_device(p, dev, data, len);
+}
+
+esp_err_t i2c_sim_write_read(uint8_t port, uint8_t addr, const uint8_t *send,
+                             size_t send_len, uint8_t *recv, size_t recv_len)
+{
+    i2c_sim_port *p = &(_ports[port]);
+    i2c_sim_device *dev = _find(p, addr);
+
+    _account(p, send_len + recv_len + 2, true);
+
+    if (dev == NULL)
+    {
+        return _nack(p);
+    }
+
+    _write_device(dev, send, send_len);
+
+    if (dev->type == I2C_SIM_SEESAW_SOIL)
+    {
+        // the seesaw requires a delay between the write and read
+        return _nack(p);
+    }
+
+    return _read_device(p, dev, recv, recv_len);
+}
+
+const i2c_sim_stats* i2c_sim_get_stats(uint8_t port)
+{
+    return &(_ports[port].stats);
+}
+
+void i2c_sim_clear_stats(uint8_t port)
+{
+    memset(&(_ports[port].stats), 0, sizeof(i2c_sim_stats));
+}
@@ -0,0 +1,659 @@
+/*
+    owb_sim.c - Master Control Remote Simulated 1-Wire Bus
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+// Models a population of DS18x20, DS2406, DS2408 and DS2413 devices at the
+// bit slot level so the owb public API (and everything above it) runs
+// unchanged.  Only the commands used by mcrDS are modeled.
+//
+// The simulation has no dependency on the ESP32 hardware, only on esp_log
+// and esp_timer, so it may also be built on a host with trivial shims.
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "drivers/owb.h"
+#include "drivers/owb_sim.h"
+
+static const char * TAG = "owb_sim";
+
+typedef enum
+{
+    SIM_IDLE = 0,   ///< not addressed, reads are 1 (bus pulled up)
+    SIM_ROM_CMD,    ///< receiving the ROM command
+    SIM_SEARCH,     ///< ROM search in progress
+    SIM_MATCH,      ///< receiving the ROM code of a Match ROM
+    SIM_FUNC_CMD,   ///< receiving the function command (and parameters)
+    SIM_RESPOND,    ///< shifting out the response buffer
+    SIM_CONVERT     ///< temperature convert in progress
+} sim_state;
+
+#define info_of_driver(owb) container_of(owb, owb_sim_driver_info, bus)
+
+static bool _is_temp_family(uint8_t family)
+{
+    return (family == 0x10) || (family == 0x22) || (family == 0x28);
+}
+
+static int _rom_bit(const owb_sim_device *dev, int bit)
+{
+    return (dev->rom_code.bytes[bit / 8] >> (bit % 8)) & 0x01;
+}
+
+static int64_t _convert_us(const owb_sim_device *dev)
+{
+    if (dev->rom_code.fields.family[0] == 0x10)
+    {
+        return 750000;
+    }
+
+    switch (dev->resolution)
+    {
+    case 9:
+        return 93750;
+    case 10:
+        return 187500;
+    case 11:
+        return 375000;
+    default:
+        return 750000;
+    }
+}
+
+/**
+ * @return the single device addressed by the ROM command or NULL
+ */
+static owb_sim_device* _single(owb_sim_driver_info *info)
+{
+    owb_sim_device *dev = NULL;
+
+    for (int i = 0; i < info->num_devices; i++)
+    {
+        if (info->selected & (1 << i))
+        {
+            if (dev)
+            {
+                return NULL;
+            }
+            dev = &(info->devices[i]);
+        }
+    }
+
+    return dev;
+}
+
+static void _respond(owb_sim_driver_info *info, int len, uint8_t fill)
+{
+    info->out_len = len;
+    info->out_pos = 0;
+    info->out_fill = fill;
+    info->state = SIM_RESPOND;
+
+    if ((len > 0) && info->inject.crc_every &&
+        ((++info->crc_counter % info->inject.crc_every) == 0))
+    {
+        info->out[0] ^= 0x01;
+        info->stats.crc_errors++;
+    }
+}
+
+static void _respond_crc16(owb_sim_driver_info *info, int len)
+{
+    // the crc16 covers the function command, any parameters and the data
+    uint16_t crc = owb_crc16_bytes(0, info->cmd, info->cmd_len);
+    crc = ~owb_crc16_bytes(crc, info->out, len);
+
+    info->out[len] = crc & 0xff;
+    info->out[len + 1] = crc >> 8;
+
+    _respond(info, len + 2, 0xff);
+}
+
+static uint8_t _ds2413_status(const owb_sim_device *dev)
+{
+    // b0: PIOA state, b1: PIOA latch, b2: PIOB state, b3: PIOB latch
+    // b4-b7: complement of b0-b3
+    uint8_t a = dev->pio & 0x01;
+    uint8_t b = (dev->pio >> 1) & 0x01;
+    uint8_t status = a | (a << 1) | (b << 2) | (b << 3);
+
+    return (status & 0x0f) | ((~status & 0x0f) << 4);
+}
+
+static void _scratchpad(owb_sim_driver_info *info, const owb_sim_device *dev)
+{
+    int16_t raw = dev->temp_raw;
+    uint8_t *out = info->out;
+
+    if (dev->rom_code.fields.family[0] == 0x10)
+    {
+        // DS18S20 reports half degrees and "count remain" for the fraction
+        int count_remain = 12 - (raw & 0x0f);
+        raw = raw >> 3;
+
+        out[4] = 0xff;
+        out[6] = (count_remain < 0) ? 0 : count_remain;
+    }
+    else
+    {
+        int unused_bits = 12 - dev->resolution;
+        raw = raw & ~((1 << unused_bits) - 1);
+
+        out[4] = ((dev->resolution - 9) << 5) | 0x1f;
+        out[6] = 0x0c;
+    }
+
+    out[0] = raw & 0xff;
+    out[1] = (raw >> 8) & 0xff;
+    out[2] = 0x4b;  // TH
+    out[3] = 0x46;  // TL
+    out[5] = 0xff;
+    out[7] = 0x10;
+    out[8] = owb_crc8_bytes(0, out, 8);
+
+    _respond(info, 9, 0xff);
+}
+
+static void _function(owb_sim_driver_info *info)
+{
+    owb_sim_device *dev = _single(info);
+    uint8_t family = dev ? dev->rom_code.fields.family[0] : 0x00;
+
+    switch (info->cmd[0])
+    {
+    case 0x44: // convert temperature (all addressed temperature devices)
+    {
+        int64_t now = esp_timer_get_time();
+
+        for (int i = 0; i < info->num_devices; i++)
+        {
+            owb_sim_device *d = &(info->devices[i]);
+
+            if ((info->selected & (1 << i)) && _is_temp_family(d->rom_code.fields.family[0]))
+            {
+                d->convert_done_us = now + _convert_us(d);
+            }
+        }
+
+        info->state = SIM_CONVERT;
+        break;
+    }
+
+    case 0xb4: // read power supply, parasitic devices pull the bus low
+    {
+        uint8_t powered = 0xff;
+
+        for (int i = 0; i < info->num_devices; i++)
+        {
+            if ((info->selected & (1 << i)) && info->devices[i].parasite)
+            {
+                powered = 0x00;
+            }
+        }
+
+        _respond(info, 0, powered);
+        break;
+    }
+
+    case 0xbe: // read scratchpad
+        if (dev && _is_temp_family(family))
+        {
+            _scratchpad(info, dev);
+        }
+        else
+        {
+            info->state = SIM_IDLE;
+        }
+        break;
+
+    case 0xaa: // DS2406 read status memory (from a two byte address)
+        if (family != 0x12)
+        {
+            info->state = SIM_IDLE;
+        }
+        else if (info->cmd_len == 3)
+        {
+            uint8_t status[8] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00};
+            int addr = info->cmd[1] & 0x07;
+            int len = 8 - addr;
+
+            // byte 7: supply indication, PIO flip-flops and channel config
+            status[7] = 0x80 | ((dev->pio & 0x03) << 5) | 0x1f;
+
+            memcpy(info->out, &(status[addr]), len);
+            _respond_crc16(info, len);
+        }
+        break;
+
+    case 0x55: // DS2406 write status (two byte address, one data byte)
+        if (family != 0x12)
+        {
+            info->state = SIM_IDLE;
+        }
+        else if (info->cmd_len == 4)
+        {
+            _respond_crc16(info, 0);
+        }
+        break;
+
+    case 0xf5: // DS2408 channel access read, DS2413 PIO access read
+        if (family == 0x29)
+        {
+            memset(info->out, dev->pio, 32);
+            _respond_crc16(info, 32);
+        }
+        else if (family == 0x3a)
+        {
+            info->out[0] = _ds2413_status(dev);
+            _respond(info, 1, info->out[0]);
+        }
+        else
+        {
+            info->state = SIM_IDLE;
+        }
+        break;
+
+    case 0x5a: // DS2408 channel access write, DS2413 PIO access write
+        if ((family != 0x29) && (family != 0x3a))
+        {
+            info->state = SIM_IDLE;
+        }
+        else if (info->cmd_len == 3)
+        {
+            if ((info->cmd[1] ^ info->cmd[2]) != 0xff)
+            {
+                // the inverted byte did not match, the device ignores the write
+                _respond(info, 0, 0xff);
+                break;
+            }
+
+            dev->pio = (family == 0x3a) ? (info->cmd[1] & 0x03) : info->cmd[1];
+
+            info->out[0] = 0xaa;
+            info->out[1] = (family == 0x3a) ? _ds2413_status(dev) : dev->pio;
+            _respond(info, 2, 0xff);
+        }
+        break;
+
+    default:
+        ESP_LOGD(TAG, "unsupported function cmd 0x%02x", info->cmd[0]);
+        info->state = SIM_IDLE;
+    }
+}
+
+static void _rom_command(owb_sim_driver_info *info, uint8_t rom_cmd)
+{
+    uint32_t all = (1 << info->num_devices) - 1;
+
+    switch (rom_cmd)
+    {
+    case OWB_ROM_SEARCH:
+        info->selected = all;
+        info->search_step = 0;
+        info->state = SIM_SEARCH;
+        break;
+
+    case OWB_ROM_SEARCH_ALARM: // no simulated device is ever in alarm
+        info->selected = 0;
+        info->search_step = 0;
+        info->state = SIM_SEARCH;
+        break;
+
+    case OWB_ROM_MATCH:
+        memset(info->rom_in, 0, sizeof(info->rom_in));
+        info->bit_count = 0;
+        info->state = SIM_MATCH;
+        break;
+
+    case OWB_ROM_SKIP:
+        info->selected = all;
+        info->state = SIM_FUNC_CMD;
+        break;
+
+    case OWB_ROM_READ:
+        // with more than one device the ROM codes collide (wired AND)
+        memset(info->out, 0xff, 8);
+        for (int i = 0; i < info->num_devices; i++)
+        {
+            for (int b = 0; b < 8; b++)
+            {
+                info->out[b] &= info->devices[i].rom_code.bytes[b];
+            }
+        }
+
+        _respond(info, 8, 0xff);
+        break;
+
+    default:
+        info->state = SIM_IDLE;
+    }
+}
+
+static void _write_bit(owb_sim_driver_info *info, int bit)
+{
+    info->stats.bits_written++;
+    info->stats.bus_us += OWB_SIM_SLOT_US;
+
+    switch (info->state)
+    {
+    case SIM_SEARCH:
+        if ((info->search_step % 3) != 2)
+        {
+            // master wrote when the search expected a read
+            info->state = SIM_IDLE;
+            return;
+        }
+
+        // devices that don't match the search direction stop participating
+        for (int i = 0; i < info->num_devices; i++)
+        {
+            if (_rom_bit(&(info->devices[i]), info->search_step / 3) != bit)
+            {
+                info->selected &= ~(1 << i);
+            }
+        }
+
+        if (++info->search_step == (64 * 3))
+        {
+            info->state = SIM_IDLE;
+        }
+        return;
+
+    case SIM_MATCH:
+        info->rom_in[info->bit_count / 8] |= (bit << (info->bit_count % 8));
+
+        if (++info->bit_count == 64)
+        {
+            info->selected = 0;
+            for (int i = 0; i < info->num_devices; i++)
+            {
+                if (memcmp(info->rom_in, info->devices[i].rom_code.bytes, 8) == 0)
+                {
+                    info->selected = (1 << i);
+                }
+            }
+
+            info->bit_count = 0;
+            info->byte_in = 0;
+            info->cmd_len = 0;
+            info->state = info->selected ? SIM_FUNC_CMD : SIM_IDLE;
+        }
+        return;
+
+    case SIM_ROM_CMD:
+    case SIM_FUNC_CMD:
+    case SIM_RESPOND:
+        break;
+
+    default:
+        return;
+    }
+
+    // the remaining states are byte oriented
+    info->byte_in |= (bit << info->bit_count);
+
+    if (++info->bit_count < 8)
+    {
+        return;
+    }
+
+    uint8_t byte = info->byte_in;
+    info->bit_count = 0;
+    info->byte_in = 0;
+
+    if (info->state == SIM_ROM_CMD)
+    {
+        info->cmd_len = 0;
+        _rom_command(info, byte);
+    }
+    else if (info->state == SIM_FUNC_CMD)
+    {
+        if (info->cmd_len < (int)sizeof(info->cmd))
+        {
+            info->cmd[info->cmd_len++] = byte;
+        }
+        _function(info);
+    }
+    else if ((info->cmd[0] == 0x55) && (byte == 0xff))
+    {
+        // DS2406 copy scratchpad to status memory, only the PIO flip-flops
+        // (address 7, bits 5 and 6) are modeled
+        owb_sim_device *dev = _single(info);
+
+        if (dev && (info->cmd[1] == 0x07))
+        {
+            dev->pio = (info->cmd[3] >> 5) & 0x03;
+        }
+
+        info->state = SIM_IDLE;
+    }
+}
+
+static int _read_bit(owb_sim_driver_info *info)
+{
+    int bit = 1;
+
+    info->stats.bits_read++;
+    info->stats.bus_us += OWB_SIM_SLOT_US;
+
+    switch (info->state)
+    {
+    case SIM_SEARCH:
+    {
+        int phase = info->search_step % 3;
+
+        if (phase == 2)
+        {
+            // master read when the search expected a direction
+            info->state = SIM_IDLE;
+            break;
+        }
+
+        // participating devices send the bit (then its complement), the
+        // bus is the wired AND of everything sent
+        for (int i = 0; i < info->num_devices; i++)
+        {
+            if (info->selected & (1 << i))
+            {
+                int rom_bit = _rom_bit(&(info->devices[i]), info->search_step / 3);
+                bit &= (phase == 0) ? rom_bit : !rom_bit;
+            }
+        }
+
+        info->search_step++;
+        break;
+    }
+
+    case SIM_RESPOND:
+    {
+        int pos = info->out_pos++;
+
+        if (pos < (info->out_len * 8))
+        {
+            bit = (info->out[pos / 8] >> (pos % 8)) & 0x01;
+        }
+        else
+        {
+            bit = (info->out_fill >> (pos % 8)) & 0x01;
+        }
+        break;
+    }
+
+    case SIM_CONVERT:
+    {
+        int64_t now = esp_timer_get_time();
+
+        // devices hold the bus low until their conversion is complete
+        for (int i = 0; i < info->num_devices; i++)
+        {
+            if ((info->selected & (1 << i)) && (now < info->devices[i].convert_done_us))
+            {
+                bit = 0;
+            }
+        }
+        break;
+    }
+
+    default:
+        break;
+    }
+
+    return bit;
+}
+
+static owb_status _reset(const OneWireBus *bus, bool *is_present)
+{
+    owb_sim_driver_info *info = info_of_driver(bus);
+    bool present = (info->num_devices > 0);
+
+    info->stats.resets++;
+    info->stats.bus_us += OWB_SIM_RESET_US;
+
+    // as the rmt driver when the receive of the reset times out
+    if (info->inject.reset_error_every &&
+        ((++info->reset_error_counter % info->inject.reset_error_every) == 0))
+    {
+        info->stats.reset_errors++;
+        info->state = SIM_IDLE;
+
+        *is_present = false;
+        return OWB_STATUS_HW_ERROR;
+    }
+
+    if (present && info->inject.presence_every &&
+        ((++info->presence_counter % info->inject.presence_every) == 0))
+    {
+        present = false;
+        info->stats.presence_errors++;
+    }
+
+    info->selected = 0;
+    info->bit_count = 0;
+    info->byte_in = 0;
+    info->cmd_len = 0;
+    info->state = present ? SIM_ROM_CMD : SIM_IDLE;
+
+    *is_present = present;
+    return OWB_STATUS_OK;
+}
+
+static owb_status _write_bits(const OneWireBus *bus, uint8_t out, int number_of_bits_to_write)
+{
+    owb_sim_driver_info *info = info_of_driver(bus);
+
+    if (number_of_bits_to_write > 8)
+    {
+        return OWB_STATUS_TOO_MANY_BITS;
+    }
+
+    for (int i = 0; i < number_of_bits_to_write; i++)
+    {
+        _write_bit(info, (out >> i) & 0x01);
+    }
+
+    return OWB_STATUS_OK;
+}
+
+static owb_status _read_bits(const OneWireBus *bus, uint8_t *in, int number_of_bits_to_read)
+{
+    owb_sim_driver_info *info = info_of_driver(bus);
+    uint8_t read_data = 0;
+
+    if (number_of_bits_to_read > 8)
+    {
+        return OWB_STATUS_TOO_MANY_BITS;
+    }
+
+    if (info->inject.hw_error_every &&
+        ((++info->hw_error_counter % info->inject.hw_error_every) == 0))
+    {
+        info->stats.hw_errors++;
+        info->state = SIM_IDLE;
+        *in = 0;
+        return OWB_STATUS_HW_ERROR;
+    }
+
+    // data is returned in the low bits, first bit read in bit 0
+    for (int i = 0; i < number_of_bits_to_read; i++)
+    {
+        read_data |= (_read_bit(info) << i);
+    }
+
+    *in = read_data;
+    return OWB_STATUS_OK;
+}
+
+static owb_status _uninitialize(const OneWireBus *bus)
+{
+    // nothing to do
+    return OWB_STATUS_OK;
+}
+
+static const struct owb_driver sim_function_table =
+{
+    .name = "owb_sim",
+    .uninitialize = _uninitialize,
+    .reset = _reset,
+    .write_bits = _write_bits,
+    .read_bits = _read_bits
+};
+
+OneWireBus* owb_sim_initialize(owb_sim_driver_info *info)
+{
+    memset(info, 0, sizeof(owb_sim_driver_info));
+    info->bus.driver = &sim_function_table;
+
+    ESP_LOGI(TAG, "simulated bus initialized");
+
+    return &(info->bus);
+}
+
+owb_sim_device* owb_sim_add_device(owb_sim_driver_info *info, uint8_t family, uint64_t serial)
+{
+    if (info->num_devices >= OWB_SIM_MAX_DEVICES)
+    {
+        ESP_LOGW(TAG, "bus full, device not added");
+        return NULL;
+    }
+
+    owb_sim_device *dev = &(info->devices[info->num_devices++]);
+    memset(dev, 0, sizeof(owb_sim_device));
+
+    dev->rom_code.fields.family[0] = family;
+    for (int i = 0; i < 6; i++)
+    {
+        dev->rom_code.fields.serial_number[i] = (serial >> (i * 8)) & 0xff;
+    }
+    dev->rom_code.fields.crc[0] = owb_crc8_bytes(0, dev->rom_code.bytes, 7);
+
+    dev->temp_raw = 20 * 16;  // 20C
+    dev->resolution = 12;
+    dev->pio = 0xff;          // switches power up with outputs off
+
+    return dev;
+}
+
+void owb_sim_clear_stats(owb_sim_driver_info *info)
+{
+    memset(&(info->stats), 0, sizeof(owb_sim_stats));
+}
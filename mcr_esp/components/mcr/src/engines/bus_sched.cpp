@@ -0,0 +1,275 @@
+/*
+    bus_sched.cpp - Master Control Remote Engine Bus Scheduler
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+
+#include "engines/bus_sched.hpp"
+#include "misc/elapsedMillis.hpp"
+
+namespace mcr {
+
+static const char *TAG = "mcrBusScheduler";
+
+// max tasks that may wait concurrently within a single job class
+static const UBaseType_t max_waiters = 8;
+
+mcrBusScheduler::mcrBusScheduler(EventGroupHandle_t evg, EventBits_t yield_bit)
+    : _evg(evg), _yield_bit(yield_bit) {
+  _lock = xSemaphoreCreateMutex();
+
+  for (auto job = 0; job < BUS_JOB_CLASSES; job++) {
+    _grant[job] = xSemaphoreCreateCounting(max_waiters, 0);
+  }
+}
+
+bool mcrBusScheduler::take(BusJob_t job, TickType_t wait_ticks,
+                           BusWaiter_t *waiter) {
+  elapsedMicros waited;
+  bool granted = false;
+
+  xSemaphoreTake(_lock, portMAX_DELAY);
+
+  // the bus was handed to the waiter by give()
+  if ((waiter != nullptr) && waiter->granted) {
+    waiter->granted = false;
+    holderAcquired();
+    _wait[job].record(esp_timer_get_time() - waiter->wait_start_us);
+
+    xSemaphoreGive(_lock);
+    return true;
+  }
+
+  if (_busy == false) {
+    _busy = true;
+    _holder = job;
+    holderAcquired();
+    _wait[job].record(waited);
+
+    xSemaphoreGive(_lock);
+    return true;
+  }
+
+  const UBaseType_t priority = uxTaskPriorityGet(nullptr);
+
+  if (waiter != nullptr) {
+    if ((waiter->waiting == false) && registerWaiter(job, waiter)) {
+      if (priority > _waiting_priority[job]) {
+        _waiting_priority[job] = priority;
+      }
+
+      updateYieldBit();
+      raiseHolder(priority);
+    }
+
+    xSemaphoreGive(_lock);
+    return false;
+  }
+
+  _waiting[job]++;
+  if (priority > _waiting_priority[job]) {
+    _waiting_priority[job] = priority;
+  }
+
+  updateYieldBit();
+  raiseHolder(priority);
+  xSemaphoreGive(_lock);
+
+  granted = (xSemaphoreTake(_grant[job], wait_ticks) == pdTRUE);
+
+  xSemaphoreTake(_lock, portMAX_DELAY);
+
+  if (granted == false) {
+    // the bus may have been handed to this job class between the timeout
+    // and acquiring the lock, if so accept it
+    granted = (xSemaphoreTake(_grant[job], 0) == pdTRUE);
+
+    if (granted == false) {
+      _waiting[job]--;
+      if (_waiting[job] == 0) {
+        _waiting_priority[job] = 0;
+      }
+
+      updateYieldBit();
+    }
+  }
+
+  if (granted) {
+    holderAcquired();
+    _wait[job].record(waited);
+  }
+
+  xSemaphoreGive(_lock);
+
+  return granted;
+}
+
+void mcrBusScheduler::give() {
+  TaskHandle_t self = xTaskGetCurrentTaskHandle();
+  BusWaiter_t *notify = nullptr;
+
+  xSemaphoreTake(_lock, portMAX_DELAY);
+
+  // a give by a task other than the holder (e.g. a double give) must not
+  // hand the bus to a second owner
+  if ((_busy == false) || (_holder_task != self)) {
+    xSemaphoreGive(_lock);
+
+    ESP_LOGW(TAG, "ignoring give by non holder (%s)",
+             pcTaskGetTaskName(nullptr));
+    return;
+  }
+
+  // drop the inherited priority before handing off the bus
+  if (_holder_raised) {
+    vTaskPrioritySet(nullptr, _holder_priority);
+    _holder_raised = false;
+  }
+
+  _busy = false;
+  _holder = BUS_JOB_CLASSES;
+  _holder_task = nullptr;
+
+  // hand the bus directly to the highest priority waiting job class
+  for (auto job = 0; job < BUS_JOB_CLASSES; job++) {
+    if (_waiting[job] > 0) {
+      _waiting[job]--;
+      if (_waiting[job] == 0) {
+        _waiting_priority[job] = 0;
+      }
+
+      _busy = true;
+      _holder = (BusJob_t)job;
+
+      if (_async_count[job] > 0) {
+        notify = _async[job][0];
+
+        _async_count[job]--;
+        for (size_t i = 0; i < _async_count[job]; i++) {
+          _async[job][i] = _async[job][i + 1];
+        }
+
+        notify->waiting = false;
+        notify->granted = true;
+      } else {
+        xSemaphoreGive(_grant[job]);
+      }
+
+      break;
+    }
+  }
+
+  updateYieldBit();
+  xSemaphoreGive(_lock);
+
+  // the waiter takes the bus when it runs, not while the lock is held
+  if (notify != nullptr) {
+    notify->notify(notify->arg);
+  }
+}
+
+bool mcrBusScheduler::yieldRequested() const {
+  return _busy && higherPriorityWaiting(_holder);
+}
+
+void mcrBusScheduler::snapshotWaits(mcrHistogram_t *hists) {
+  xSemaphoreTake(_lock, portMAX_DELAY);
+
+  for (auto job = 0; job < BUS_JOB_CLASSES; job++) {
+    hists[job] = _wait[job];
+    _wait[job].reset();
+  }
+
+  xSemaphoreGive(_lock);
+}
+
+const char *mcrBusScheduler::jobName(BusJob_t job) {
+  static const char *names[BUS_JOB_CLASSES] = {"command", "report", "convert",
+                                               "discover"};
+
+  return (job < BUS_JOB_CLASSES) ? names[job] : "unknown";
+}
+
+//
+// private
+//
+
+bool mcrBusScheduler::higherPriorityWaiting(BusJob_t job) const {
+  for (auto waiting = 0; waiting < job; waiting++) {
+    if (_waiting[waiting] > 0) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// NOTE: must be called with _lock held
+bool mcrBusScheduler::registerWaiter(BusJob_t job, BusWaiter_t *waiter) {
+  if (_async_count[job] >= max_async_waiters) {
+    ESP_LOGW(TAG, "too many %s waiters", jobName(job));
+    return false;
+  }
+
+  _async[job][_async_count[job]++] = waiter;
+  _waiting[job]++;
+
+  waiter->waiting = true;
+  waiter->wait_start_us = esp_timer_get_time();
+
+  return true;
+}
+
+// NOTE: must be called with _lock held
+void mcrBusScheduler::holderAcquired() {
+  _holder_task = xTaskGetCurrentTaskHandle();
+  _holder_priority = uxTaskPriorityGet(nullptr);
+  _holder_raised = false;
+
+  // inherit the priority of the tasks that began waiting while the bus was
+  // being handed to this task
+  for (auto job = 0; job < BUS_JOB_CLASSES; job++) {
+    if (_waiting[job] > 0) {
+      raiseHolder(_waiting_priority[job]);
+    }
+  }
+}
+
+// NOTE: must be called with _lock held
+void mcrBusScheduler::raiseHolder(UBaseType_t priority) {
+  if ((_holder_task == nullptr) ||
+      (priority <= uxTaskPriorityGet(_holder_task))) {
+    return;
+  }
+
+  vTaskPrioritySet(_holder_task, priority);
+  _holder_raised = true;
+}
+
+// NOTE: must be called with _lock held
+void mcrBusScheduler::updateYieldBit() {
+  if (yieldRequested()) {
+    xEventGroupSetBits(_evg, _yield_bit);
+  } else {
+    xEventGroupClearBits(_evg, _yield_bit);
+  }
+}
+} // namespace mcr
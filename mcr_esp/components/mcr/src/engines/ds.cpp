@@ -35,11 +35,57 @@
 
 namespace mcr {
 
-mcrDS_t *__singleton__ = nullptr;
-static const string_t engine_name = "mcrDS";
+static mcrDS_t *__singletons__[CONFIG_MCR_W1_BUSES] = {nullptr};
+
+// gpio pin and rmt channel pair (tx, rx) used by each bus
+typedef struct {
+  uint8_t pin;
+  rmt_channel_t tx_channel;
+  rmt_channel_t rx_channel;
+} dsBusConfig_t;
+
+static const dsBusConfig_t bus_configs[] = {
+    {CONFIG_MCR_W1_PIN, RMT_CHANNEL_0, RMT_CHANNEL_1},
+#if CONFIG_MCR_W1_BUSES > 1
+    {CONFIG_MCR_W1_PIN_BUS1, RMT_CHANNEL_2, RMT_CHANNEL_3},
+#endif
+#if CONFIG_MCR_W1_BUSES > 2
+    {CONFIG_MCR_W1_PIN_BUS2, RMT_CHANNEL_4, RMT_CHANNEL_5},
+#endif
+};
+
+const EngineTagDef_t mcrDS::_tag_defs[] = {
+    {ENGINE_TAG_ENGINE, "engine", ""},
+    {ENGINE_TAG_DISCOVER, "discover", " discover"},
+    {ENGINE_TAG_CONVERT, "convert", " convert"},
+    {ENGINE_TAG_REPORT, "report", " report"},
+    {ENGINE_TAG_COMMAND, "command", " command"},
+    {DS_TAG_READ_DEVICE, "readDevice", " readDevice"},
+    {DS_TAG_READ_DS1820, "readDS1820", " readDS1820"},
+    {DS_TAG_READ_DS2406, "readDS2406", " readDS2406"},
+    {DS_TAG_READ_DS2408, "readDS2408", " readDS2408"},
+    {DS_TAG_READ_DS2413, "readDS2413", " readDS2413"},
+    {DS_TAG_SET_DS2406, "setDS2406", " setDS2406"},
+    {DS_TAG_SET_DS2408, "setDS2408", " setDS2408"},
+    {DS_TAG_SET_DS2413, "setDS2413", " setDS2413"},
+    {ENGINE_TAG_MAX, nullptr, nullptr}};
+
+mcrDS::mcrDS(uint32_t bus) : _bus(bus) {
+  const dsBusConfig_t &bus_config = bus_configs[_bus];
+
+  _pin = bus_config.pin;
+  _tx_channel = bus_config.tx_channel;
+  _rx_channel = bus_config.rx_channel;
+
+  // bus zero keeps the original engine name so existing tags and metrics
+  // are unchanged, additional buses are suffixed with the bus number
+  _engine_name = "mcrDS";
+  if (_bus > 0) {
+    _engine_name.append(std::to_string(_bus));
+  }
 
-mcrDS::mcrDS() {
-  setTags(localTags());
+  setTags(_tag_defs, _engine_name);
+  _dev_mutex = xSemaphoreCreateMutex();
   // setLoggingLevel(ESP_LOG_DEBUG);
   setLoggingLevel(ESP_LOG_INFO);
   // setLoggingLevel(ESP_LOG_WARN);
@@ -55,11 +101,27 @@ mcrDS::mcrDS() {
   EngineTask_t discover("dis", CONFIG_MCR_DS_DISCOVER_TASK_PRIORITY, 4096);
   EngineTask_t report("rpt", CONFIG_MCR_DS_REPORT_TASK_PRIORITY, 3072);
 
-  addTask(engine_name, CORE, core);
-  addTask(engine_name, CONVERT, convert);
-  addTask(engine_name, COMMAND, command);
-  addTask(engine_name, DISCOVER, discover);
-  addTask(engine_name, REPORT, report);
+  addTask(_engine_name, CORE, core);
+  addTask(_engine_name, CONVERT, convert);
+  addTask(_engine_name, COMMAND, command);
+  addTask(_engine_name, DISCOVER, discover);
+  addTask(_engine_name, REPORT, report);
+
+  // the cadences of the phases (may be adjusted by the engine.config cmd)
+  loadConfig({.convert_secs = CONFIG_MCR_DS_CONVERT_FREQUENCY_SECS,
+              .discover_secs = CONFIG_MCR_DS_DISCOVER_FREQUENCY_SECS,
+              .report_secs = CONFIG_MCR_DS_REPORT_FREQUENCY_SECS,
+              .convert = true,
+              .discover = true});
+
+  // the command queue is created and registered here (rather than by the
+  // command task) so registration of each bus instance is serialized.
+  // commands are delivered to every bus, the command task ignores commands
+  // for devices it doesn't know.
+  _cmd_q = xQueueCreate(_max_queue_depth, sizeof(cmdSwitch_t *));
+  cmdQueue_t cmd_q = {"", "ds", _cmd_q};
+  strncpy(cmd_q.id, _engine_name.c_str(), sizeof(cmd_q.id) - 1);
+  mcrCmdQueues::registerQ(cmd_q);
 }
 
 bool mcrDS::checkDevicesPowered() {
@@ -91,17 +153,12 @@ bool mcrDS::checkDevicesPowered() {
 void mcrDS::command(void *data) {
   logSubTaskStart(data);
 
-  _cmd_q = xQueueCreate(_max_queue_depth, sizeof(cmdSwitch_t *));
-  cmdQueue_t cmd_q = {"mcrDS", "ds", _cmd_q};
-  mcrCmdQueues::registerQ(cmd_q);
-
   // no setup required before jumping into task loop
 
   for (;;) {
     BaseType_t queue_rc = pdFALSE;
     cmdSwitch_t *cmd = nullptr;
 
-    clearNeedBus();
     queue_rc = xQueueReceive(_cmd_q, &cmd, portMAX_DELAY);
     elapsedMicros process_cmd;
 
@@ -119,10 +176,15 @@ void mcrDS::command(void *data) {
 
       trackSwitchCmd(true);
 
-      needBus();
-      ESP_LOGV(tagCommand(), "attempting to aquire bux mutex...");
+      ESP_LOGV(tagCommand(), "attempting to aquire bus...");
       elapsedMicros bus_wait;
-      takeBus();
+      if (takeBus(BUS_COMMAND) == false) {
+        ESP_LOGW(tagCommand(), "bus reset failed, dropping %s",
+                 cmd->debug().get());
+        trackSwitchCmd(false);
+        delete cmd;
+        continue;
+      }
 
       if (bus_wait < 500) {
         ESP_LOGV(tagCommand(), "acquired bus mutex (%lluus)",
@@ -132,6 +194,10 @@ void mcrDS::command(void *data) {
                  (float)(bus_wait / 1000.0));
       }
 
+      // the readings are not installed by report while the cmd is in
+      // progress (see reportBatch())
+      xSemaphoreTake(_dev_mutex, portMAX_DELAY);
+
       // the device write time is the total duration of all processing
       // of the write -- not just the duration on the bus
       dev->writeStart();
@@ -152,6 +218,8 @@ void mcrDS::command(void *data) {
         commandAck(*cmd);
       }
 
+      xSemaphoreGive(_dev_mutex);
+
       trackSwitchCmd(false);
 
       // we create a textReading then wrap in textReading_ptr_t (aka unique_ptr)
@@ -226,18 +294,12 @@ bool mcrDS::commandAck(cmdSwitch_t &cmd) {
 
 // SubTasks receive their task config via the void *data
 void mcrDS::convert(void *data) {
-  uint8_t temp_convert_cmd[] = {0xcc, 0x44};
-
   logSubTaskStart(data);
 
   // ensure the temp available bit is cleared at task startup
   tempUnavailable();
 
   for (;;) {
-    bool present = false;
-    uint8_t data = 0x00;
-    owb_status owb_s;
-
     // wait here for devices available bit
     waitFor(devicesOrTempSensorsBit());
 
@@ -245,109 +307,171 @@ void mcrDS::convert(void *data) {
     // this is important to avoid performing the convert too frequently
     saveTaskLastWake(CONVERT);
 
-    // use event bits to signal when there are temperatures available
-    // start by clearing the bit to signal there isn't a temperature available
-    tempUnavailable();
+    if (phaseEnabled(CONVERT)) {
+      passUntilComplete(CONVERT);
+    }
+
+    taskDelayUntil(CONVERT, convertFrequency());
+  }
+}
+
+TickType_t mcrDS::convertPass() {
+  uint8_t temp_convert_cmd[] = {0xcc, 0x44};
+  bool present = false;
+  uint8_t data = 0x00;
+  owb_status owb_s;
 
-    trackConvert(true);
+  // the bus was released during the convert (see below)
+  if (_convert_by_time_us > 0) {
+    return convertByTime();
+  }
 
-    if (!devicesPowered() && !tempDevicesPresent()) {
-      ESP_LOGW(tagConvert(),
-               "devices not powered or no temperature devices present");
+  // use event bits to signal when there are temperatures available
+  // start by clearing the bit to signal there isn't a temperature available
+  tempUnavailable();
+
+  trackConvert(true);
+
+  if (!devicesPowered() && !tempDevicesPresent()) {
+    ESP_LOGW(tagConvert(),
+             "devices not powered or no temperature devices present");
+    trackConvert(false);
+    return 0;
+  }
+
+  TickType_t resume_ticks = 0;
+  if (takePassBus(BUS_CONVERT, resume_ticks) == false) {
+    if (resume_ticks == 0) {
       trackConvert(false);
-      taskDelayUntil(CONVERT, _convert_frequency);
-      continue;
     }
 
-    takeBus();
+    return resume_ticks;
+  }
 
-    if (resetBus(&present) && (present == false)) {
-      ESP_LOGW(tagConvert(), "no devices present (but there should be)");
-      giveBus();
-      taskDelayUntil(CONVERT, _convert_frequency);
-      continue;
+  if (resetBus(&present) && (present == false)) {
+    ESP_LOGW(tagConvert(), "no devices present (but there should be)");
+    giveBus();
+    return 0;
+  }
+
+  resetBus();
+  owb_s = owb_write_bytes(_ds, temp_convert_cmd, sizeof(temp_convert_cmd));
+  owb_s = owb_read_byte(_ds, &data);
+
+  // before dropping into waiting for the temperature conversion to
+  // complete let's double check there weren't any errors after initiating
+  // the convert.  additionally, we should see zeroes on the bus since
+  // devices will hold the bus low during the convert
+  if ((owb_s != OWB_STATUS_OK) || (data != 0x00)) {
+    trackConvert(false);
+    if (owb_s != OWB_STATUS_OK) {
+      ESP_LOGW(tagConvert(), "cmd failed owb_s=%d data=0x%x", owb_s, data);
     }
 
-    resetBus();
-    owb_s = owb_write_bytes(_ds, temp_convert_cmd, sizeof(temp_convert_cmd));
-    owb_s = owb_read_byte(_ds, &data);
+    if (data == 0xff) {
+      ESP_LOGW(tagConvert(), "appears no temperature devices on bus");
+    }
 
-    // before dropping into waiting for the temperature conversion to
-    // complete let's double check there weren't any errors after initiating
-    // the convert.  additionally, we should see zeroes on the bus since
-    // devices will hold the bus low during the convert
-    if ((owb_s != OWB_STATUS_OK) || (data != 0x00)) {
-      trackConvert(false);
-      if (owb_s != OWB_STATUS_OK) {
-        ESP_LOGW(tagConvert(), "cmd failed owb_s=%d data=0x%x", owb_s, data);
-      }
+    giveBus();
+    return 0;
+  }
 
-      if (data == 0xff) {
-        ESP_LOGW(tagConvert(), "appears no temperature devices on bus");
-      }
+  ESP_LOGD(tagConvert(), "in-progress");
 
-      giveBus();
-      taskDelayUntil(CONVERT, _convert_frequency);
-      continue;
-    }
+  bool in_progress = true;
+  bool temp_available = false;
+  uint64_t _wait_start = esp_timer_get_time();
 
-    ESP_LOGD(tagConvert(), "in-progress");
+#ifdef CONFIG_MCR_ENGINE_EXECUTOR
+  // executor mode:  a worker is not held for the convert of powered devices
+  bool release_bus = devicesPowered();
+#else
+  bool release_bus = false;
+#endif
 
-    bool in_progress = true;
-    bool temp_available = false;
-    uint64_t _wait_start = esp_timer_get_time();
-    while ((owb_s == OWB_STATUS_OK) && in_progress) {
-      owb_s = owb_read_byte(_ds, &data);
+  while ((owb_s == OWB_STATUS_OK) && in_progress && !release_bus) {
+    owb_s = owb_read_byte(_ds, &data);
 
-      if (owb_s != OWB_STATUS_OK) {
-        ESP_LOGW(tagConvert(), "temp convert failed (0x%02x)", owb_s);
-        break;
-      }
+    if (owb_s != OWB_STATUS_OK) {
+      ESP_LOGW(tagConvert(), "temp convert failed (0x%02x)", owb_s);
+      break;
+    }
 
-      // if the bus isn't low then the convert is finished
-      if (data > 0x00) {
-        // NOTE: use a flag here so we can exit the while loop before
-        // setting the event group bit since tasks waiting for the bit
-        // will immediately wake up.  this allows for clean tracking of
-        // the temp convert elapsed time.
-        temp_available = true;
-        in_progress = false;
-      }
+    // if the bus isn't low then the convert is finished
+    if (data > 0x00) {
+      // NOTE: use a flag here so we can exit the while loop before
+      // setting the event group bit since tasks waiting for the bit
+      // will immediately wake up.  this allows for clean tracking of
+      // the temp convert elapsed time.
+      temp_available = true;
+      in_progress = false;
+    }
 
-      if (in_progress) {
-        BaseType_t notified = pdFALSE;
+    if (in_progress) {
+      BaseType_t notified = pdFALSE;
 
-        // wait for time to pass or to be notified that another
-        // task needs the bus
-        // if the bit was set then clear it
-        EventBits_t bits = waitFor(needBusBit(), _temp_convert_wait, true);
+      // wait for time to pass or, when the devices are powered, to be
+      // notified that a job of higher priority is waiting for the bus.  the
+      // bus scheduler owns the bit so it is not cleared here.
+      //
+      // parasite powered devices convert using the bus itself, releasing
+      // the bus aborts the convert so the bus (and, in executor mode, the
+      // worker) is held until complete.
+      if (devicesPowered()) {
+        EventBits_t bits = waitFor(needBusBit(), _temp_convert_wait, false);
         notified = (bits & needBusBit());
+      } else {
+        vTaskDelay(_temp_convert_wait);
+      }
 
-        // another task needs the bus so break out of the loop
-        if (notified) {
-          resetBus();          // abort the temperature convert
-          in_progress = false; // signal to break from loop
-          ESP_LOGW(tagConvert(), "another task needs the bus, convert aborted");
-        }
-
-        if ((esp_timer_get_time() - _wait_start) >= _max_temp_convert_us) {
-          ESP_LOGW(tagConvert(), "temp convert timed out");
-          resetBus();
-          in_progress = false; // signal to break from loop
-        }
+      if (notified) {
+        release_bus = true; // signal to break from loop
+      } else if ((esp_timer_get_time() - _wait_start) >=
+                 _max_temp_convert_us) {
+        ESP_LOGW(tagConvert(), "temp convert timed out");
+        resetBus();
+        in_progress = false; // signal to break from loop
       }
     }
+  }
 
+  // a job of higher priority needs the bus (or, in executor mode, the worker
+  // is not held).  the conversion continues within the powered devices
+  // however the bus can no longer be polled for completion once released.
+  // so, release the bus and wait out the worst case conversion time.
+  if (release_bus) {
+    ESP_LOGD(tagConvert(), "releasing bus, convert will complete by time");
     giveBus();
-    trackConvert(false);
 
-    // signal to other tasks if temperatures are available
-    if (temp_available) {
-      tempAvailable();
-    }
+    _convert_by_time_us = _wait_start;
+    return convertByTime();
+  }
+
+  giveBus();
+  trackConvert(false);
 
-    taskDelayUntil(CONVERT, _convert_frequency);
+  // signal to other tasks if temperatures are available
+  if (temp_available) {
+    tempAvailable();
   }
+
+  return 0;
+}
+
+// the ticks until the worst case conversion time has passed, once passed the
+// temperatures are available
+TickType_t mcrDS::convertByTime() {
+  uint64_t elapsed_us = esp_timer_get_time() - _convert_by_time_us;
+
+  if (elapsed_us < _temp_convert_us) {
+    return pdMS_TO_TICKS((_temp_convert_us - elapsed_us) / 1000) + 1;
+  }
+
+  _convert_by_time_us = 0;
+  trackConvert(false);
+  tempAvailable();
+
+  return 0;
 }
 
 void mcrDS::discover(void *data) {
@@ -355,20 +479,39 @@ void mcrDS::discover(void *data) {
   saveTaskLastWake(DISCOVER);
 
   while (waitForEngine()) {
-    owb_status owb_s;
+    if (phaseEnabled(DISCOVER)) {
+      passUntilComplete(DISCOVER);
+    }
 
-    bool found = false;
-    auto device_found = false;
-    auto have_temperature_devs = false;
-    bool bus_needed = false;
-    OneWireBus_SearchState search_state;
+    // to avoid including the execution time of the discover phase
+    saveTaskLastWake(DISCOVER);
+    taskDelayUntil(DISCOVER, discoverFrequency());
+  }
+}
 
-    bzero(&search_state, sizeof(OneWireBus_SearchState));
+// discover continues from the saved search state when the bus was yielded
+// to a job of higher priority between devices
+TickType_t mcrDS::discoverPass() {
+  owb_status owb_s;
+  bool found = false;
 
-    // take the bus before beginning time tracking to avoid
-    // artificially inflating discover elapsed time
-    takeBus();
+  // take the bus before beginning time tracking to avoid
+  // artificially inflating discover elapsed time
+  TickType_t resume_ticks = 0;
+  if (takePassBus(BUS_DISCOVER, resume_ticks) == false) {
+    return discoverWaits(resume_ticks);
+  }
+
+  if (_discover_active) {
+    // each search begins with a bus reset so the search resumes from the
+    // saved search state
+    ESP_LOGD(tagDiscover(), "resuming search");
+    owb_s = owb_search_next(_ds, &_discover_search, &found);
 
+    if (owb_s != OWB_STATUS_OK) {
+      ESP_LOGW(tagDiscover(), "search next failed owb_s=%d", owb_s);
+    }
+  } else {
     trackDiscover(true);
 
     bool present = false;
@@ -376,88 +519,102 @@ void mcrDS::discover(void *data) {
       ESP_LOGV(tagDiscover(), "no devices present");
       giveBus();
       trackDiscover(false);
-      taskDelayUntil(DISCOVER, _discover_frequency);
-      continue;
+      return 0;
     }
 
-    owb_s = owb_search_first(_ds, &search_state, &found);
+    bzero(&_discover_search, sizeof(OneWireBus_SearchState));
+    owb_s = owb_search_first(_ds, &_discover_search, &found);
 
     if (owb_s != OWB_STATUS_OK) {
       ESP_LOGW(tagDiscover(), "search first failed owb_s=%d", owb_s);
       giveBus();
       trackDiscover(false);
-      taskDelayUntil(DISCOVER, _discover_frequency);
-      continue;
+      return 0;
     }
 
-    bool hold_bus = true;
-    while ((owb_s == OWB_STATUS_OK) && found && hold_bus) {
-      device_found = true;
+    _discover_active = true;
+    _discover_found = false;
+    _discover_temp_devs = false;
+  }
 
-      mcrDevAddr_t found_addr(search_state.rom_code.bytes, 8);
-      dsDev_t dev(found_addr, true);
+  while ((owb_s == OWB_STATUS_OK) && found) {
+    _discover_found = true;
 
-      if (justSeenDevice(dev)) {
-        ESP_LOGV(tagDiscover(), "previously seen %s", dev.debug().get());
-      } else {
-        dsDev_t *new_dev = new dsDev(dev);
-        ESP_LOGD(tagDiscover(), "%s is new (%p)", dev.debug().get(),
-                 (void *)new_dev);
-        addDevice(new_dev);
-      }
+    mcrDevAddr_t found_addr(_discover_search.rom_code.bytes, 8);
+    dsDev_t dev(found_addr, true);
 
-      if (dev.hasTemperature()) {
-        have_temperature_devs = true;
-      }
+    if (justSeenDevice(dev)) {
+      ESP_LOGV(tagDiscover(), "previously seen %s", dev.debug().get());
+    } else {
+      dsDev_t *new_dev = new dsDev(dev);
+      ESP_LOGD(tagDiscover(), "%s is new (%p)", dev.debug().get(),
+               (void *)new_dev);
+      addDevice(new_dev);
+    }
 
-      bus_needed = isBusNeeded();
+    if (dev.hasTemperature()) {
+      _discover_temp_devs = true;
+    }
 
-      // another task needs the bus so break out of the loop
-      if (bus_needed) {
-        ESP_LOGW(tagConvert(), "another task needs the bus, discover aborted");
+    // between devices is a safe point to hand the bus to a job of higher
+    // priority
+    if (yieldPassBus(BUS_DISCOVER, resume_ticks)) {
+      return discoverWaits(resume_ticks);
+    }
 
-        resetBus();       // abort the search
-        hold_bus = false; // signal to break from loop
-      } else {
-        // keeping searching
-        owb_s = owb_search_next(_ds, &search_state, &found);
+    // keeping searching
+    owb_s = owb_search_next(_ds, &_discover_search, &found);
 
-        if (owb_s != OWB_STATUS_OK) {
-          ESP_LOGW(tagDiscover(), "search next failed owb_s=%d", owb_s);
-        }
-      }
+    if (owb_s != OWB_STATUS_OK) {
+      ESP_LOGW(tagDiscover(), "search next failed owb_s=%d", owb_s);
     }
+  }
 
-    // TODO: create specific logic to detect pwr status of each family code
-    // ds->reset();
-    // ds->select(addr);
-    // ds->write(0xB4); // Read Power Supply
-    // uint8_t pwr = ds->read_bit();
+  // TODO: create specific logic to detect pwr status of each family code
+  // ds->reset();
+  // ds->select(addr);
+  // ds->write(0xB4); // Read Power Supply
+  // uint8_t pwr = ds->read_bit();
 
-    _devices_powered = checkDevicesPowered();
+  _devices_powered = checkDevicesPowered();
 
-    trackDiscover(false);
-    giveBus();
+  _discover_active = false;
+  trackDiscover(false);
+  giveBus();
 
-    // must set before setting devices_available
-    _temp_devices_present = have_temperature_devs;
-    temperatureSensors(have_temperature_devs);
+  saveDevices();
 
-    // signal to other tasks if there are devices available
-    devicesAvailable(device_found);
+  // must set before setting devices_available
+  _temp_devices_present = _discover_temp_devs;
+  temperatureSensors(_discover_temp_devs);
 
-    // to avoid including the execution time of the discover phase
-    saveTaskLastWake(DISCOVER);
-    taskDelayUntil(DISCOVER, _discover_frequency);
+  // signal to other tasks if there are devices available
+  devicesAvailable(_discover_found);
+
+  return 0;
+}
+
+// the bus is busy so discover continues later or the bus reset failed and
+// discover ends (the devices found are seen again next discover)
+TickType_t mcrDS::discoverWaits(TickType_t resume_ticks) {
+  if ((resume_ticks == 0) && _discover_active) {
+    _discover_active = false;
+    trackDiscover(false);
   }
+
+  return resume_ticks;
 }
 
-mcrDS_t *mcrDS::instance() {
-  if (__singleton__ == nullptr) {
-    __singleton__ = new mcrDS();
+mcrDS_t *mcrDS::instance(uint32_t bus) {
+  if (bus >= numBuses()) {
+    return nullptr;
   }
 
-  return __singleton__;
+  if (__singletons__[bus] == nullptr) {
+    __singletons__[bus] = new mcrDS(bus);
+  }
+
+  return __singletons__[bus];
 }
 
 void mcrDS::report(void *data) {
@@ -474,64 +631,236 @@ void mcrDS::report(void *data) {
     //  a. wait for a temperature if there are temperature devices
     //  b. wait a preset duration
 
+    // when convert is disabled the temperature is never available
+    bool wait_temp = _temp_devices_present && phaseEnabled(CONVERT);
+
     // case a:  wait for temperature to be available
-    if (_temp_devices_present) {
+    if (wait_temp) {
       // let's wait here for the temperature available bit
       // once we see it then clear it to ensure we don't run again until
       // it's available again
       ESP_LOGD(tagReport(), "standing by for temperature");
-      waitFor(temperatureAvailableBit(), _report_frequency, true);
+      waitFor(temperatureAvailableBit(), reportFrequency(), true);
     }
 
     // last wake is after the event group has been satisified
     saveTaskLastWake(REPORT);
 
+    passUntilComplete(REPORT);
+
+    // case b:  wait a present duration (no temp devices)
+    if (!wait_temp) {
+      ESP_LOGV(tagReport(), "no temperature devices, sleeping for %u ticks",
+               reportFrequency());
+      taskDelayUntil(REPORT, reportFrequency());
+    }
+  }
+}
+
+// the report is pipelined:  the bus is held only for the wire time of each
+// device read.  a batch of raw reads is then decoded, serialized and published
+// without the bus.
+//
+// a pass that finds the bus busy continues from the next device to read.
+TickType_t mcrDS::reportPass() {
+  if (_report_devs == nullptr) {
     trackReport(true);
     ESP_LOGV(tagReport(), "will attempt to report %d device%s",
              numKnownDevices(), (numKnownDevices() > 1) ? "s" : "");
 
-    for_each(beginDevices(), endDevices(),
-             [this](std::pair<string_t, dsDev_t *> item) {
-               auto dev = item.second;
-
-               if (dev->available()) {
-                 ESP_LOGV(tagReport(), "reading device %s", dev->debug().get());
-
-                 takeBus();
-                 auto rc = readDevice(dev);
-
-                 if (rc) {
-                   ESP_LOGV(tagReport(), "publishing reading for %s",
-                            dev->debug().get());
-                   publish(dev);
-                   dev->justSeen();
-                 }
-                 // hold onto the bus mutex to ensure that the device publih
-                 // succeds (another task doesn't change the device just read)
-                 giveBus();
-               } else {
-                 if (dev->missing()) {
-                   ESP_LOGW(tagReport(), "device missing: %s",
-                            dev->debug().get());
-                 }
-               }
-             });
-
-    trackReport(false);
-    reportMetrics();
+    _report_devs = devices();
+    _report_next = 0;
+    _report_batched = 0;
+    _report_bus_us = 0;
+  }
 
-    // case b:  wait a present duration (no temp devices)
-    if (!_temp_devices_present) {
-      ESP_LOGV(tagReport(), "no temperature devices, sleeping for %u ticks",
-               _report_frequency);
-      taskDelayUntil(REPORT, _report_frequency);
+  TickType_t resume_ticks = 0;
+  bool bus_held = false;
+
+  for (; _report_next < _report_devs->size(); _report_next++) {
+    dsDev_t *dev = (*_report_devs)[_report_next].second;
+
+    if (dev->available() == false) {
+      if (dev->missing()) {
+        ESP_LOGW(tagReport(), "device missing: %s", dev->debug().get());
+      }
+
+      continue;
+    }
+
+    // the bus is taken once per pass and yielded between devices so jobs of
+    // higher priority (e.g. commands) wait for at most one device.  a take
+    // resets the bus so the read that follows does not reset it again.
+    bool reset = true;
+
+    if (bus_held == false) {
+      bus_held = takePassBus(BUS_REPORT, resume_ticks);
+      reset = false;
+    } else if (yieldPassBus(BUS_REPORT, resume_ticks)) {
+      bus_held = false;
+    }
+
+    if (bus_held == false) {
+      if (resume_ticks > 0) {
+        return resume_ticks;
+      }
+
+      // the bus reset failed, the pass ends with the devices read
+      break;
+    }
+
+    ESP_LOGV(tagReport(), "reading device %s", dev->debug().get());
+    dsRawRead_t &raw = _report_batch[_report_batched++];
+    raw = {};
+    raw.dev = dev;
+
+    elapsedMicros bus_hold;
+    raw.write_seq = dev->writeSeq();
+    raw.ok = readRaw(raw, reset);
+    _report_bus_us += bus_hold;
+
+    if (_report_batched == _report_batch_max) {
+      // a job of higher priority does not wait for the batch to publish
+      if (isBusNeeded()) {
+        giveBus();
+        bus_held = false;
+      }
+
+      reportBatch(_report_batched);
+      _report_batched = 0;
     }
   }
+
+  if (bus_held) {
+    giveBus();
+  }
+
+  reportBatch(_report_batched);
+  ESP_LOGD(tagReport(), "bus held %lluus for %d device%s", _report_bus_us,
+           numKnownDevices(), (numKnownDevices() > 1) ? "s" : "");
+
+  _report_devs.reset();
+  trackReport(false);
+  reportMetrics();
+
+  return 0;
+}
+
+// executor mode:  when there are temperature devices report is triggered once
+// the convert is complete (see tempAvailable()) so the periodic pass is
+// skipped unless a temperature is available
+bool mcrDS::phaseReady(TaskTypes_t phase) {
+  if (mcrEngine::phaseReady(phase) == false) {
+    return false;
+  }
+
+  if ((phase == REPORT) && _temp_devices_present && phaseEnabled(CONVERT)) {
+    EventBits_t bits = temperatureAvailableBit();
+
+    return (waitFor(bits, 0, true) & bits);
+  }
+
+  return true;
+}
+
+bool mcrDS::snapshotDevice(dsDev_t *dev, EngineDevSnap_t &snap) {
+  mcrDevAddr_t &addr = dev->addr();
+
+  if (addr.len() > sizeof(snap.addr)) {
+    return false;
+  }
+
+  memcpy(snap.addr, (uint8_t *)addr, addr.len());
+  snap.addr_len = addr.len();
+
+  return true;
+}
+
+dsDev_t *mcrDS::restoreDevice(const EngineDevSnap_t &snap) {
+  mcrDevAddr_t addr((uint8_t *)snap.addr, snap.addr_len);
+
+  if (addr.isValid() == false) {
+    return nullptr;
+  }
+
+  // discover assumes found devices are powered, do the same
+  return new dsDev(addr, true);
 }
 
 bool mcrDS::readDevice(dsDev_t *dev) {
-  celsiusReading_t *celsius = nullptr;
-  positionsReading_t *positions = nullptr;
+  dsRawRead_t raw = {};
+  raw.dev = dev;
+
+  if (readRaw(raw) == false) {
+    return false;
+  }
+
+  Reading_t *reading = decodeRaw(raw);
+
+  if (reading == nullptr) {
+    return false;
+  }
+
+  dev->setReading(reading);
+  return true;
+}
+
+void mcrDS::reportBatch(uint32_t count) {
+  if (count == 0) {
+    return;
+  }
+
+  // decoding and serializing (the bulk of the cpu time) is apart from the
+  // bus reads, the bus is given first when another job is waiting for it
+  for (uint32_t i = 0; i < count; i++) {
+    dsRawRead_t &raw = _report_batch[i];
+
+    if (raw.ok) {
+      raw.reading = decodeRaw(raw);
+    }
+
+    if (raw.reading) {
+      raw.dev->applyMetrics(raw.reading);
+      raw.json = raw.reading->json();
+    }
+  }
+
+  // the readings are installed and published holding the device mutex (not
+  // the bus) so a cmd never sees a device reading change underneath it.  a
+  // reading taken before a cmd wrote to the device is stale (the cmd
+  // installed and published the new state) so it is dropped.
+  xSemaphoreTake(_dev_mutex, portMAX_DELAY);
+  for (uint32_t i = 0; i < count; i++) {
+    dsRawRead_t &raw = _report_batch[i];
+
+    if (raw.reading && (raw.write_seq != raw.dev->writeSeq())) {
+      ESP_LOGD(tagReport(), "dropping reading (before cmd) for %s",
+               raw.dev->debug().get());
+
+      delete raw.reading;
+      delete raw.json;
+      raw.reading = nullptr;
+      raw.json = nullptr;
+    }
+
+    if (raw.reading) {
+      raw.dev->setReading(raw.reading);
+      raw.dev->justSeen();
+    }
+
+    if (raw.json) {
+      ESP_LOGV(tagReport(), "publishing reading for %s", raw.dev->debug().get());
+      trackFirstReading();
+      mcrMQTT::instance()->publish(raw.json);
+    }
+
+    raw = {};
+  }
+  xSemaphoreGive(_dev_mutex);
+}
+
+bool mcrDS::readRaw(dsRawRead_t &raw, bool reset) {
+  dsDev_t *dev = raw.dev;
   auto rc = false;
 
   if (dev->isNotValid()) {
@@ -539,11 +868,11 @@ bool mcrDS::readDevice(dsDev_t *dev) {
     return false;
   }
 
-  // before attempting to read any device reset the bus.
-  // if the reset fails then something has gone wrong with the bus
-  // perform this check here so the specialized read methods can assume
+  // before attempting to read any device reset the bus (unless the caller
+  // just did).  if the reset fails then something has gone wrong with the
+  // bus perform this check here so the specialized read methods can assume
   // the bus is operational and eliminate redundant code
-  if (resetBus() == false) {
+  if (reset && (resetBus() == false)) {
     ESP_LOGW(tagReadDevice(), "%s bus reset failed before read",
              dev->debug().get());
     return rc;
@@ -553,30 +882,19 @@ bool mcrDS::readDevice(dsDev_t *dev) {
   case 0x10: // DS1820 (temperature sensors)
   case 0x22:
   case 0x28:
-    dev->readStart();
-    rc = readDS1820(dev, &celsius);
-    dev->readStop();
-    if (rc)
-      dev->setReading(celsius);
+    rc = readDS1820(dev, raw.data);
     break;
 
   case 0x29: // DS2408 (8-channel switch)
-    rc = readDS2408(dev, &positions);
-    if (rc)
-      dev->setReading(positions);
+    rc = readDS2408(dev, raw.data);
     break;
 
   case 0x12: // DS2406 (2-channel switch with 1k EPROM)
-    rc = readDS2406(dev, &positions);
-    if (rc)
-      dev->setReading(positions);
+    rc = readDS2406(dev, raw.data);
     break;
 
   case 0x3a: // DS2413 (Dual-Channel Addressable Switch)
-    rc = readDS2413(dev, &positions);
-    if (rc) {
-      dev->setReading(positions);
-    }
+    rc = readDS2413(dev, raw.data);
     break;
 
   case 0x26: // DS2438 (Smart Battery Monitor)
@@ -590,21 +908,33 @@ bool mcrDS::readDevice(dsDev_t *dev) {
   return rc;
 }
 
-// specific device scratchpad methods
-bool mcrDS::readDS1820(dsDev_t *dev, celsiusReading_t **reading) {
-  owb_status owb_s;
-  uint8_t data[9] = {0x00};
-  bool type_s = false;
-  bool rc = false;
+Reading_t *mcrDS::decodeRaw(dsRawRead_t &raw) {
+  dsDev_t *dev = raw.dev;
 
   switch (dev->family()) {
   case 0x10:
-    type_s = true;
-    break;
-  default:
-    type_s = false;
+  case 0x22:
+  case 0x28:
+    return decodeDS1820(dev, raw.data);
+
+  case 0x29:
+    return decodeDS2408(dev, raw.data);
+
+  case 0x12:
+    return decodeDS2406(dev, raw.data);
+
+  case 0x3a:
+    return decodeDS2413(dev, raw.data);
   }
 
+  return nullptr;
+}
+
+// specific device scratchpad methods
+bool mcrDS::readDS1820(dsDev_t *dev, uint8_t *data) {
+  owb_status owb_s;
+  bool rc = false;
+
   dev->readStart();
   uint8_t cmd[] = {0x55, // match rom_code
                    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // rom
@@ -612,15 +942,31 @@ bool mcrDS::readDS1820(dsDev_t *dev, celsiusReading_t **reading) {
 
   dev->copyAddrToCmd(cmd);
 
+  // data: the nine byte scratchpad (byte 8 is the crc8)
   owb_s = owb_write_bytes(_ds, cmd, sizeof(cmd));
-  owb_s = owb_read_bytes(_ds, data, sizeof(data));
-  resetBus();
+  owb_s = owb_read_bytes(_ds, data, 9);
+  dev->readStop();
 
   if (owb_s != OWB_STATUS_OK) {
     ESP_LOGW(tagReadDS1820(), "failed to read scratchpad owb_s=%d", owb_s);
     return rc;
   }
 
+  rc = true;
+  return rc;
+}
+
+celsiusReading_t *mcrDS::decodeDS1820(dsDev_t *dev, const uint8_t *data) {
+  bool type_s = false;
+
+  switch (dev->family()) {
+  case 0x10:
+    type_s = true;
+    break;
+  default:
+    type_s = false;
+  }
+
   // Convert the data to actual temperature
   // because the result is a 16 bit signed integer, it should
   // be stored to an "int16_t" type, which is always 16 bits
@@ -645,23 +991,20 @@ bool mcrDS::readDS1820(dsDev_t *dev, celsiusReading_t **reading) {
   }
 
   // calculate the crc of the received scratchpad
-  uint16_t crc8 = owb_crc8_bytes(0x00, data, sizeof(data));
+  uint16_t crc8 = owb_crc8_bytes(0x00, data, 9);
 
   if (crc8 != 0x00) {
     ESP_LOGW(tagReadDS1820(), "crc FAILED (0x%02x) for %s", crc8,
              dev->debug().get());
-    return rc;
+    return nullptr;
   }
 
   float celsius = (float)raw / 16.0;
 
-  rc = true;
-  *reading = new celsiusReading(dev->id(), lastConvertTimestamp(), celsius);
-
-  return rc;
+  return new celsiusReading(dev->id(), lastConvertTimestamp(), celsius);
 }
 
-bool mcrDS::readDS2406(dsDev_t *dev, positionsReading_t **reading) {
+bool mcrDS::readDS2406(dsDev_t *dev, uint8_t *data) {
   owb_status owb_s;
   bool rc = false;
 
@@ -697,9 +1040,15 @@ bool mcrDS::readDS2406(dsDev_t *dev, positionsReading_t **reading) {
     return rc;
   }
 
-  resetBus();
+  memcpy(data, buff, sizeof(buff));
+  rc = true;
+
+  return rc;
+}
 
-  uint32_t raw = buff[sizeof(buff) - 3];
+positionsReading_t *mcrDS::decodeDS2406(dsDev_t *dev, const uint8_t *data) {
+  // data: the ten bytes of status memory and crc16 (see readDS2406)
+  uint32_t raw = data[7];
 
   uint32_t positions = 0x00;  // translate raw status to 0b000000xx
   if ((raw & 0x20) == 0x00) { // to represent PIO.A as bit 0
@@ -710,14 +1059,10 @@ bool mcrDS::readDS2406(dsDev_t *dev, positionsReading_t **reading) {
     positions = (positions | 0x02);
   }
 
-  rc = true;
-  *reading =
-      new positionsReading(dev->id(), time(nullptr), positions, (uint8_t)2);
-
-  return rc;
+  return new positionsReading(dev->id(), time(nullptr), positions, (uint8_t)2);
 }
 
-bool mcrDS::readDS2408(dsDev_t *dev, positionsReading_t **reading) {
+bool mcrDS::readDS2408(dsDev_t *dev, uint8_t *data) {
   owb_status owb_s;
   bool rc = false;
 
@@ -764,35 +1109,33 @@ bool mcrDS::readDS2408(dsDev_t *dev, positionsReading_t **reading) {
     return rc;
   }
 
-  resetBus();
+  memcpy(data, dev_cmd, sizeof(dev_cmd));
+  rc = true;
+
+  return rc;
+}
+
+positionsReading_t *mcrDS::decodeDS2408(dsDev_t *dev, const uint8_t *data) {
+  // data: the entire 44 byte dev_cmd (see readDS2408)
+  const size_t dev_cmd_len = 44;
 
   // compute the crc16 over the Channel Access command through channel state
   // data (excluding the crc16 bytes)
-  uint16_t crc16 =
-      check_crc16((dev_cmd + 9), 33, &(dev_cmd[sizeof(dev_cmd) - 2]));
+  uint16_t crc16 = check_crc16((data + 9), 33, &(data[dev_cmd_len - 2]));
 
   if (!crc16) {
     ESP_LOGW(tagReadDS2408(), "crc FAILED (0x%02x) for %s", crc16,
              dev->debug().get());
-    return rc;
+    return nullptr;
   }
 
   // negate positions since device sees on/off opposite of true/false
-  // uint32_t positions = (~buff[sizeof(buff) - 3]) & 0xFF; // constrain to
-  // 8bits
-  uint32_t positions =
-      ~(dev_cmd[sizeof(dev_cmd) - 3]) & 0xFF; // constrain to 8bits
-
-  if (reading != nullptr) {
-    *reading =
-        new positionsReading(dev->id(), time(nullptr), positions, (uint32_t)8);
-  }
-  rc = true;
+  uint32_t positions = ~(data[dev_cmd_len - 3]) & 0xFF; // constrain to 8bits
 
-  return rc;
+  return new positionsReading(dev->id(), time(nullptr), positions, (uint32_t)8);
 }
 
-bool mcrDS::readDS2413(dsDev_t *dev, positionsReading_t **reading) {
+bool mcrDS::readDS2413(dsDev_t *dev, uint8_t *data) {
   owb_status owb_s;
   bool rc = false;
 
@@ -823,16 +1166,21 @@ bool mcrDS::readDS2413(dsDev_t *dev, positionsReading_t **reading) {
     return rc;
   }
 
-  resetBus();
+  memcpy(data, buff, sizeof(buff));
+  rc = true;
 
+  return rc;
+}
+
+positionsReading_t *mcrDS::decodeDS2413(dsDev_t *dev, const uint8_t *data) {
   // both bytes should be the same
-  if (buff[0] != buff[1]) {
+  if (data[0] != data[1]) {
     ESP_LOGW(tagReadDS2413(), "state bytes don't match (0x%02x != 0x%02x ",
-             buff[0], buff[1]);
-    return rc;
+             data[0], data[1]);
+    return nullptr;
   }
 
-  uint32_t raw = buff[0];
+  uint32_t raw = data[0];
 
   // NOTE: pio states are inverted at the device
   // PIO Status Bits:
@@ -850,11 +1198,7 @@ bool mcrDS::readDS2413(dsDev_t *dev, positionsReading_t **reading) {
     positions = (positions | 0x02);
   }
 
-  rc = true;
-  *reading =
-      new positionsReading(dev->id(), time(nullptr), positions, (uint8_t)2);
-
-  return rc;
+  return new positionsReading(dev->id(), time(nullptr), positions, (uint8_t)2);
 }
 
 bool mcrDS::resetBus(bool *present) {
@@ -874,16 +1218,40 @@ bool mcrDS::resetBus(bool *present) {
   return false;
 }
 
-void mcrDS::core(void *data) {
+void mcrDS::initBus() {
+#ifdef CONFIG_MCR_W1_SIMULATED
+  _sim = new owb_sim_driver_info;
+  _ds = owb_sim_initialize(_sim);
+  simulatedDevices();
+  ESP_LOGI(tagEngine(), "bus %u simulated with %d devices", _bus,
+           _sim->num_devices);
+#else
   owb_rmt_driver_info *rmt_driver = new owb_rmt_driver_info;
-  _ds = owb_rmt_initialize(rmt_driver, _pin, RMT_CHANNEL_0, RMT_CHANNEL_1);
+  _ds = owb_rmt_initialize(rmt_driver, _pin, _tx_channel, _rx_channel);
+  ESP_LOGI(tagEngine(), "bus %u using pin %u rmt tx/rx %d/%d", _bus, _pin,
+           _tx_channel, _rx_channel);
+#endif
 
   owb_use_crc(_ds, true);
+}
+
+void mcrDS::core(void *data) {
+  initBus();
 
   ESP_LOGV(tagEngine(), "waiting for normal ops...");
   mcr::Net::waitForNormalOps();
   ESP_LOGV(tagEngine(), "normal ops, proceeding to task loop");
 
+  // warm start:  the devices known before the restart are reported without
+  // waiting for discover
+  if (restoreDevices() > 0) {
+    _temp_devices_present = any_of_devices([](const dsDev_t &dev) {
+      return const_cast<dsDev_t &>(dev).hasTemperature();
+    });
+    temperatureSensors(_temp_devices_present);
+    devicesAvailable();
+  }
+
   saveTaskLastWake(CORE);
 
   for (;;) {
@@ -892,6 +1260,15 @@ void mcrDS::core(void *data) {
     engineRunning();
 
     // do high-level engine actions here (e.g. general housekeeping)
+#ifdef CONFIG_MCR_W1_SIMULATED
+    const owb_sim_stats &stats = _sim->stats;
+    ESP_LOGI(tagEngine(),
+             "simulated bus_us=%llu resets=%u bits w=%u r=%u crc_errors=%u",
+             stats.bus_us, stats.resets, stats.bits_written, stats.bits_read,
+             stats.crc_errors);
+    owb_sim_clear_stats(_sim);
+#endif
+
     taskDelayUntil(CORE, _loop_frequency);
   }
 }
@@ -1154,32 +1531,29 @@ bool mcrDS::setDS2413(cmdSwitch_t &cmd, dsDev_t *dev) {
 
 bool mcrDS::check_crc16(const uint8_t *input, uint16_t len,
                         const uint8_t *inverted_crc, uint16_t crc) {
-  crc = ~crc16(input, len, crc);
+  crc = ~owb_crc16_bytes(crc, input, len);
   return (crc & 0xFF) == inverted_crc[0] && (crc >> 8) == inverted_crc[1];
 }
 
-uint16_t mcrDS::crc16(const uint8_t *input, uint16_t len, uint16_t crc) {
-  static const uint8_t oddparity[16] = {0, 1, 1, 0, 1, 0, 0, 1,
-                                        1, 0, 0, 1, 0, 1, 1, 0};
+#ifdef CONFIG_MCR_W1_SIMULATED
+void mcrDS::simulatedDevices() {
+  // include the bus in the serial so device ids are unique across buses
+  uint64_t serial = (uint64_t)(_bus + 1) << 32;
 
-  for (uint16_t i = 0; i < len; i++) {
-    // Even though we're just copying a byte from the input,
-    // we'll be doing 16-bit computation with it.
-    uint16_t cdata = input[i];
-    cdata = (cdata ^ crc) & 0xff;
-    crc >>= 8;
-
-    if (oddparity[cdata & 0x0F] ^ oddparity[cdata >> 4])
-      crc ^= 0xC001;
+  for (auto i = 0; i < CONFIG_MCR_W1_SIM_TEMP_DEVICES; i++) {
+    owb_sim_device *dev = owb_sim_add_device(_sim, 0x28, serial++);
+    dev->temp_raw += (i * 8); // spread the temperatures by half a degree
+  }
 
-    cdata <<= 6;
-    crc ^= cdata;
-    cdata <<= 1;
-    crc ^= cdata;
+  for (auto i = 0; i < CONFIG_MCR_W1_SIM_SWITCH_DEVICES; i++) {
+    owb_sim_add_device(_sim, 0x12, serial++); // DS2406
+    owb_sim_add_device(_sim, 0x29, serial++); // DS2408
+    owb_sim_add_device(_sim, 0x3a, serial++); // DS2413
   }
 
-  return crc;
+  _sim->inject.crc_every = CONFIG_MCR_W1_SIM_CRC_ERROR_EVERY;
 }
+#endif
 
 void mcrDS::printInvalidDev(dsDev_t *dev) {
   if (dev == nullptr) {
@@ -0,0 +1,262 @@
+/*
+    executor.cpp - Master Control Remote Engine Executor
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+#include <esp_log.h>
+#include <freertos/FreeRTOS.h>
+
+#include "engines/executor.hpp"
+#include "misc/elapsedMillis.hpp"
+
+#ifdef CONFIG_MCR_ENGINE_EXECUTOR
+
+namespace mcr {
+
+static const char *TAG = "mcrExec";
+static mcrExecutor_t *__singleton__ = nullptr;
+
+mcrExecutor::mcrExecutor() {
+  _q = xQueueCreate(_max_jobs, sizeof(ExecutorJob_t *));
+
+  _num_workers = CONFIG_MCR_ENGINE_EXECUTOR_WORKERS;
+  if (_num_workers > _max_workers) {
+    _num_workers = _max_workers;
+  }
+
+  for (uint32_t i = 0; i < _num_workers; i++) {
+    char name[] = "mcrExec0";
+
+    name[sizeof(name) - 2] = '0' + i;
+
+    ::xTaskCreate(&runWorker, name, CONFIG_MCR_ENGINE_EXECUTOR_STACK, this,
+                  CONFIG_MCR_ENGINE_EXECUTOR_PRIORITY, &(_workers[i]));
+  }
+
+  ESP_LOGI(TAG, "%u workers, stack(%d) priority(%d)", _num_workers,
+           CONFIG_MCR_ENGINE_EXECUTOR_STACK,
+           CONFIG_MCR_ENGINE_EXECUTOR_PRIORITY);
+}
+
+mcrExecutor_t *mcrExecutor::instance() {
+  if (__singleton__ == nullptr) {
+    __singleton__ = new mcrExecutor();
+  }
+
+  return __singleton__;
+}
+
+ExecutorJob_t *mcrExecutor::schedule(const char *name, ExecutorFunc_t *func,
+                                     void *arg, TickType_t interval) {
+  ExecutorJob_t *job = new ExecutorJob_t();
+
+  job->name = name;
+  job->func = func;
+  job->arg = arg;
+
+  esp_timer_create_args_t timer_args = {.callback = &timerCallback,
+                                        .arg = job,
+                                        .dispatch_method = ESP_TIMER_TASK,
+                                        .name = name};
+
+  esp_timer_create_args_t resume_args = {.callback = &resumeCallback,
+                                         .arg = job,
+                                         .dispatch_method = ESP_TIMER_TASK,
+                                         .name = name};
+
+  esp_err_t esp_rc = esp_timer_create(&timer_args, &(job->timer));
+
+  if (esp_rc == ESP_OK) {
+    esp_rc = esp_timer_create(&resume_args, &(job->resume_timer));
+  }
+
+  if (esp_rc == ESP_OK) {
+    uint64_t interval_us = (uint64_t)interval * portTICK_PERIOD_MS * 1000;
+    esp_rc = esp_timer_start_periodic(job->timer, interval_us);
+  }
+
+  if (esp_rc != ESP_OK) {
+    ESP_LOGE(TAG, "[%s] timer for %s", esp_err_to_name(esp_rc), name);
+  }
+
+  ESP_LOGD(TAG, "scheduled %s every %ums", name, interval * portTICK_PERIOD_MS);
+
+  trigger(job);
+
+  return job;
+}
+
+void mcrExecutor::trigger(ExecutorJob_t *job) {
+  bool queue = false;
+
+  portENTER_CRITICAL(&_mux);
+  if (job->pending) {
+    // the previous run has not finished (or a worker is not yet available)
+    job->skipped++;
+  } else {
+    job->pending = true;
+    queue = true;
+  }
+  portEXIT_CRITICAL(&_mux);
+
+  if (queue && (xQueueSendToBack(_q, &job, 0) != pdTRUE)) {
+    ESP_LOGW(TAG, "queue full, %s skipped", job->name);
+
+    portENTER_CRITICAL(&_mux);
+    job->pending = false;
+    job->skipped++;
+    portEXIT_CRITICAL(&_mux);
+  }
+}
+
+void mcrExecutor::resumeNow(ExecutorJob_t *job) {
+  bool running = false;
+
+  portENTER_CRITICAL(&_mux);
+  running = job->running;
+  if (running) {
+    // the resume timer is not yet started, the worker resumes the job
+    job->resume_now = true;
+  }
+  portEXIT_CRITICAL(&_mux);
+
+  if (running == false) {
+    resumeEarly(job);
+  }
+}
+
+void mcrExecutor::reschedule(ExecutorJob_t *job, TickType_t interval) {
+  uint64_t interval_us = (uint64_t)interval * portTICK_PERIOD_MS * 1000;
+
+  // stop fails when the timer is not running, that's fine
+  esp_timer_stop(job->timer);
+  esp_err_t esp_rc = esp_timer_start_periodic(job->timer, interval_us);
+
+  if (esp_rc != ESP_OK) {
+    ESP_LOGE(TAG, "[%s] reschedule %s", esp_err_to_name(esp_rc), job->name);
+  }
+
+  ESP_LOGD(TAG, "rescheduled %s every %ums", job->name,
+           interval * portTICK_PERIOD_MS);
+}
+
+uint32_t mcrExecutor::minStackHighWater() {
+  uint32_t min_high_water = UINT32_MAX;
+
+  for (uint32_t i = 0; i < _num_workers; i++) {
+    uint32_t high_water = uxTaskGetStackHighWaterMark(_workers[i]);
+
+    if (high_water < min_high_water) {
+      min_high_water = high_water;
+    }
+  }
+
+  return min_high_water;
+}
+
+void mcrExecutor::runWorker(void *executor) {
+  ((mcrExecutor_t *)executor)->worker();
+}
+
+void mcrExecutor::timerCallback(void *job) {
+  instance()->trigger((ExecutorJob_t *)job);
+}
+
+// a job that continues is queued directly (it is still pending) so it is not
+// skipped as a trigger would be
+void mcrExecutor::resumeCallback(void *job) {
+  mcrExecutor_t *executor = instance();
+  ExecutorJob_t *resume_job = (ExecutorJob_t *)job;
+
+  if (xQueueSendToBack(executor->_q, &resume_job, 0) != pdTRUE) {
+    // the queue is full, try again next tick
+    executor->resume(resume_job, 1);
+  }
+}
+
+void mcrExecutor::resume(ExecutorJob_t *job, TickType_t ticks) {
+  uint64_t wait_us = (uint64_t)ticks * portTICK_PERIOD_MS * 1000;
+  esp_err_t esp_rc = esp_timer_start_once(job->resume_timer, wait_us);
+
+  if (esp_rc != ESP_OK) {
+    ESP_LOGE(TAG, "[%s] resume %s", esp_err_to_name(esp_rc), job->name);
+
+    // the job can not continue, allow the next interval to run it
+    portENTER_CRITICAL(&_mux);
+    job->pending = false;
+    portEXIT_CRITICAL(&_mux);
+  }
+}
+
+// the job is queued only when the resume timer is stopped before it fires so
+// the job is never queued twice.  the stop fails when the timer has fired
+// (the job is already queued by resumeCallback()) or the job is not waiting.
+void mcrExecutor::resumeEarly(ExecutorJob_t *job) {
+  if (esp_timer_stop(job->resume_timer) == ESP_OK) {
+    resumeCallback(job);
+  }
+}
+
+void mcrExecutor::worker() {
+  for (;;) {
+    ExecutorJob_t *job = nullptr;
+
+    if (xQueueReceive(_q, &job, portMAX_DELAY) != pdTRUE) {
+      continue;
+    }
+
+    portENTER_CRITICAL(&_mux);
+    job->running = true;
+    job->resume_now = false;
+    portEXIT_CRITICAL(&_mux);
+
+    elapsedMicros run_us;
+    TickType_t resume_ticks = job->func(job->arg);
+
+    ESP_LOGV(TAG, "%s took %0.1fms%s", job->name, (float)(run_us / 1000.0),
+             (resume_ticks > 0) ? " (continues)" : "");
+
+    if (resume_ticks > 0) {
+      bool resume_now = false;
+
+      job->resumed++;
+      resume(job, resume_ticks);
+
+      // running is cleared once the resume timer is started, see resumeNow()
+      portENTER_CRITICAL(&_mux);
+      job->running = false;
+      resume_now = job->resume_now;
+      portEXIT_CRITICAL(&_mux);
+
+      if (resume_now) {
+        resumeEarly(job);
+      }
+
+      continue;
+    }
+
+    portENTER_CRITICAL(&_mux);
+    job->running = false;
+    job->pending = false;
+    portEXIT_CRITICAL(&_mux);
+  }
+}
+
+} // namespace mcr
+
+#endif // CONFIG_MCR_ENGINE_EXECUTOR
@@ -20,25 +20,177 @@
 
 // #define VERBOSE 1
 
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include <string>
 
 #include <driver/i2c.h>
 #include <driver/periph_ctrl.h>
 #include <esp_log.h>
+#include <esp_timer.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/event_groups.h>
 #include <freertos/task.h>
 
+#include "devs/i2c_link.hpp"
 #include "engines/i2c.hpp"
+#include "misc/heap_trace.hpp"
 
 namespace mcr {
 
-static mcrI2c_t *__singleton__ = nullptr;
-static const string_t engine_name = "mcrI2c";
+static mcrI2c_t *__singletons__[CONFIG_MCR_I2C_PORTS] = {nullptr};
+
+// gpio pins used by each controller (port)
+typedef struct {
+  gpio_num_t sda_pin;
+  gpio_num_t scl_pin;
+} i2cPortConfig_t;
+
+static const i2cPortConfig_t port_configs[] = {
+    {(gpio_num_t)CONFIG_MCR_I2C_SDA_PIN, (gpio_num_t)CONFIG_MCR_I2C_SCL_PIN},
+#if CONFIG_MCR_I2C_PORTS > 1
+    {(gpio_num_t)CONFIG_MCR_I2C_SDA_PIN_PORT1,
+     (gpio_num_t)CONFIG_MCR_I2C_SCL_PIN_PORT1},
+#endif
+};
+
+const EngineTagDef_t mcrI2c::_tag_defs[] = {
+    {ENGINE_TAG_ENGINE, "engine", ""},
+    {ENGINE_TAG_DISCOVER, "discover", " discover"},
+    {ENGINE_TAG_CONVERT, "convert", " convert"},
+    {ENGINE_TAG_REPORT, "report", " report"},
+    {ENGINE_TAG_COMMAND, "command", " command"},
+    {I2C_TAG_DETECT, "detect", " detectDev"},
+    {I2C_TAG_READ_MCP23008, "readMCP23008", " readMCP23008"},
+    {I2C_TAG_SET_MCP23008, "setMCP23008", " setMCP23008"},
+    {I2C_TAG_READ_SHT31, "readSHT31", " readSHT31"},
+    {I2C_TAG_READ_AM2315, "readAM2315", " readAM2315"},
+    {I2C_TAG_SELECT_BUS, "selectbus", " selectBus"},
+    {ENGINE_TAG_MAX, nullptr, nullptr}};
+
+// device reads as a sequence of steps.  a WAIT step is the time the device
+// needs to prepare the data requested, during which the bus is available for
+// the steps of other devices.
+//
+//    type              send          send_len  recv_offset recv_len  wait_us
+
+// SHT31 commands (datasheet tables 9 and 10) by repeatability (high, medium,
+// low) and, for periodic acquisition, measurements per second
+static constexpr uint32_t sht31_rep = CONFIG_MCR_I2C_SHT31_REPEATABILITY;
+static constexpr uint8_t sht31_single_shot_lsb[] = {0x00, 0x0b, 0x16};
+static constexpr uint32_t sht31_measure_us[] = {15000, 6000, 4000};
+
+#ifdef CONFIG_MCR_I2C_SHT31_PERIODIC
+static constexpr uint32_t sht31_rate = CONFIG_MCR_I2C_SHT31_RATE;
+static constexpr uint8_t sht31_periodic_cmd[][4] = {
+    {0x20, 0x32, 0x24, 0x2f},  // 0.5 mps
+    {0x21, 0x30, 0x26, 0x2d},  // 1 mps
+    {0x22, 0x36, 0x20, 0x2b},  // 2 mps
+    {0x23, 0x34, 0x22, 0x29},  // 4 mps
+    {0x27, 0x37, 0x21, 0x2a}}; // 10 mps
+static constexpr int64_t sht31_period_us[] = {2000000, 1000000, 500000,
+                                              250000, 100000};
+
+// SHT31: periodic acquisition is started at discovery so reading is
+// only a fetch of the latest measurement
+static constexpr i2cStep_t sht31_steps[] = {
+    {I2C_STEP_WRITE,    {0xe0, 0x00}, 2,        0,          0,        0},
+    {I2C_STEP_READ,     {},           0,        0,          6,        0},
+    {I2C_STEP_END,      {},           0,        0,          0,        0}};
+#else
+// SHT31: single shot measurement WITHOUT clock stretching so the bus is not
+// held during the measurement
+static constexpr i2cStep_t sht31_steps[] = {
+    {I2C_STEP_WRITE,    {0x24, sht31_single_shot_lsb[sht31_rep]},
+                                      2,        0,          0,        0},
+    {I2C_STEP_WAIT,     {},           0,        0,          0,
+                                                      sht31_measure_us[sht31_rep]},
+    {I2C_STEP_READ,     {},           0,        0,          6,        0},
+    {I2C_STEP_END,      {},           0,        0,          0,        0}};
+#endif
+
+// MCP23008: at POR the device operates in sequential mode where continued
+// reads automatically increment the address (register).  all registers are
+// read (12 bytes) in one shot starting at IODIR (0x00).
+static constexpr i2cStep_t mcp23008_steps[] = {
+    {I2C_STEP_REQUEST,  {0x00},       1,        0,          12,       0},
+    {I2C_STEP_END,      {},           0,        0,          0,        0}};
+
+// seesaw: data queries are two bytes (module, register) followed by a
+// delay before the response is available
+//  1. SEESAW_STATUS_BASE, SEESAW_STATUS_TEMP (4 bytes, 16.16 fixed point)
+//  2. SEESAW_TOUCH_BASE, SEESAW_TOUCH_CHANNEL_OFFSET (2 bytes, capacitance)
+static constexpr i2cStep_t seesaw_soil_steps[] = {
+    {I2C_STEP_WRITE,    {0x00, 0x04}, 2,        0,          0,        0},
+    {I2C_STEP_WAIT,     {},           0,        0,          0,        20000},
+    {I2C_STEP_READ,     {},           0,        0,          4,        0},
+    {I2C_STEP_WRITE,    {0x0f, 0x10}, 2,        0,          0,        0},
+    {I2C_STEP_WAIT,     {},           0,        0,          0,        20000},
+    {I2C_STEP_READ,     {},           0,        4,          2,        0},
+    {I2C_STEP_END,      {},           0,        0,          0,        0}};
+
+// AM2315: the device sleeps between reads and NACKs the address that wakes
+// it.  once awake the read registers function (0x03) is sent for four bytes
+// starting at 0x00 (relh, tempC) and the response is available after at
+// least 1.5ms.  the response is the function, byte count, four data bytes
+// and the crc (low byte first).
+static constexpr i2cStep_t am2315_steps[] = {
+    {I2C_STEP_WAKE,     {},           0,        0,          0,        0},
+    {I2C_STEP_WAIT,     {},           0,        0,          0,        2000},
+    {I2C_STEP_WRITE,    {0x03, 0x00, 0x04},
+                                      3,        0,          0,        0},
+    {I2C_STEP_WAIT,     {},           0,        0,          0,        2000},
+    {I2C_STEP_READ,     {},           0,        0,          8,        0},
+    {I2C_STEP_END,      {},           0,        0,          0,        0}};
+
+// the supported devices (see i2c_driver.hpp).  discover searches for the
+// addresses in table order.
+//
+// none of the devices stretch the clock (the SHT31 single shot command
+// used is the one without clock stretching) so the command timeout of the
+// engine is the same for every device
+const i2cDriver_t mcrI2c::_drivers[] = {
+    {0x44, 0x44, "sht31", sht31_steps, nullptr, &mcrI2c::decodeSHT31, nullptr,
+#ifdef CONFIG_MCR_I2C_SHT31_PERIODIC
+     &mcrI2c::startSHT31, &mcrI2c::recoverSHT31,
+#else
+     nullptr, nullptr,
+#endif
+     i2cStepsWaitUs(sht31_steps)},
+    {0x5c, 0x5c, "am2315", am2315_steps, &mcrI2c::probeAM2315,
+     &mcrI2c::decodeAM2315, nullptr, nullptr, nullptr,
+     i2cStepsWaitUs(am2315_steps)},
+    {0x20, 0x27, "mcp23008", mcp23008_steps, nullptr, &mcrI2c::decodeMCP23008,
+     &mcrI2c::setMCP23008, nullptr, nullptr, i2cStepsWaitUs(mcp23008_steps)},
+    {0x36, 0x36, "soil", seesaw_soil_steps, nullptr, &mcrI2c::decodeSeesawSoil,
+     nullptr, nullptr, nullptr, i2cStepsWaitUs(seesaw_soil_steps)},
+    // end of table
+    {0x00, 0x00, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+     0}};
+
+// the ticks (at least one) until the time specified
+static TickType_t ticksUntil(int64_t at_us) {
+  int64_t wait_us = at_us - esp_timer_get_time();
+  TickType_t ticks = (wait_us > 0) ? pdMS_TO_TICKS((wait_us + 999) / 1000) : 0;
+
+  return (ticks > 0) ? ticks : 1;
+}
+
+mcrI2c::mcrI2c(uint32_t port) : _port((i2c_port_t)port) {
+  const i2cPortConfig_t &port_config = port_configs[_port];
+
+  _sda_pin = port_config.sda_pin;
+  _scl_pin = port_config.scl_pin;
+
+  // port zero keeps the original engine name so existing tags and metrics
+  // are unchanged, additional ports are suffixed with the port number
+  _engine_name = "mcrI2c";
+  if (_port > 0) {
+    _engine_name.append(std::to_string(_port));
+  }
 
-mcrI2c::mcrI2c() {
-  setTags(localTags());
+  setTags(_tag_defs, _engine_name);
   // setLoggingLevel(ESP_LOG_DEBUG);
   // setLoggingLevel(ESP_LOG_DEBUG);
   setLoggingLevel(ESP_LOG_INFO);
@@ -54,10 +206,37 @@ mcrI2c::mcrI2c() {
   EngineTask_t discover("dis", CONFIG_MCR_I2C_DISCOVER_TASK_PRIORITY, 4096);
   EngineTask_t report("rpt", CONFIG_MCR_I2C_REPORT_TASK_PRIORITY, 3072);
 
-  addTask(engine_name, CORE, core);
-  addTask(engine_name, COMMAND, command);
-  addTask(engine_name, DISCOVER, discover);
-  addTask(engine_name, REPORT, report);
+  addTask(_engine_name, CORE, core);
+  addTask(_engine_name, COMMAND, command);
+  addTask(_engine_name, DISCOVER, discover);
+  addTask(_engine_name, REPORT, report);
+
+  // the cadences of the phases (may be adjusted by the engine.config cmd),
+  // there is no convert phase
+  loadConfig({.convert_secs = 0,
+              .discover_secs = CONFIG_MCR_I2C_DISCOVER_FREQUENCY_SECS,
+              .report_secs = CONFIG_MCR_I2C_REPORT_FREQUENCY_SECS,
+              .convert = false,
+              .discover = true});
+
+  registerMetric(_bus_selects_issued, "bus_selects");
+  registerMetric(_bus_selects_skipped, "bus_selects_skipped");
+  registerMetric(_bus_select_errors, "bus_select_errors");
+  registerMetric(_cmd_link_allocs, "cmd_links");
+
+  // the command queue is created and registered here (rather than by the
+  // command task) so registration of each port instance is serialized.
+  // commands are delivered to every port, the command task ignores commands
+  // for devices it doesn't know.
+  _cmd_q = xQueueCreate(_max_queue_depth, sizeof(cmdSwitch_t *));
+  cmdQueue_t cmd_q = {"", "i2c", _cmd_q};
+  strncpy(cmd_q.id, _engine_name.c_str(), sizeof(cmd_q.id) - 1);
+  mcrCmdQueues::registerQ(cmd_q);
+
+  // the reset pin is wired to the devices (and multiplexer) of port zero
+  if (_port != I2C_NUM_0) {
+    return;
+  }
 
   gpio_config_t rst_pin_cfg;
 
@@ -77,10 +256,6 @@ mcrI2c::mcrI2c() {
 void mcrI2c::command(void *data) {
   logSubTaskStart(data);
 
-  _cmd_q = xQueueCreate(_max_queue_depth, sizeof(cmdSwitch_t *));
-  cmdQueue_t cmd_q = {"mcrI2c", "i2c", _cmd_q};
-  mcrCmdQueues::registerQ(cmd_q);
-
   while (true) {
     BaseType_t queue_rc = pdFALSE;
     cmdSwitch_t *cmd = nullptr;
@@ -109,10 +284,14 @@ void mcrI2c::command(void *data) {
 
       trackSwitchCmd(true);
 
-      needBus();
-      ESP_LOGV(tagCommand(), "attempting to aquire bux mutex...");
+      ESP_LOGV(tagCommand(), "attempting to aquire bus...");
       elapsedMicros bus_wait;
-      takeBus();
+      if (takeBus(BUS_COMMAND) == false) {
+        ESP_LOGW(tagCommand(), "bus reset failed, dropping %s",
+                 cmd->debug().get());
+        trackSwitchCmd(false);
+        continue;
+      }
 
       if (bus_wait < 500) {
         ESP_LOGV(tagCommand(), "acquired bus mutex (%lluus)",
@@ -127,7 +306,15 @@ void mcrI2c::command(void *data) {
       dev->writeStart();
 
       ESP_LOGD(tagCommand(), "received cmd for %s", dev->id().c_str());
-      set_rc = setMCP23008(*cmd, dev);
+
+      const i2cDriver_t *driver = findDriver(dev->devAddr());
+
+      if ((driver != nullptr) && (driver->write != nullptr)) {
+        set_rc = (this->*(driver->write))(*cmd, dev);
+      } else {
+        ESP_LOGW(tagCommand(), "%s does not accept commands",
+                 dev->id().c_str());
+      }
 
       dev->writeStop();
 
@@ -137,12 +324,11 @@ void mcrI2c::command(void *data) {
 
       trackSwitchCmd(false);
 
-      clearNeedBus();
       giveBus();
 
       ESP_LOGV(tagCommand(), "released bus mutex");
     } else {
-      ESP_LOGW(tagCommand(), "device %s not available",
+      ESP_LOGV(tagCommand(), "device %s not available",
                (const char *)cmd->internalDevID().c_str());
     }
 
@@ -181,15 +367,9 @@ bool mcrI2c::commandAck(cmdSwitch_t &cmd) {
 }
 
 void mcrI2c::core(void *task_data) {
-  bool driver_ready = false;
   bool net_name = false;
 
-  while (!driver_ready) {
-    driver_ready = installDriver();
-    delay(1000); // prevent busy loop if i2c driver fails to install
-  }
-
-  pinReset();
+  initBus();
 
   ESP_LOGV(tagEngine(), "waiting for normal ops...");
   Net::waitForNormalOps();
@@ -209,6 +389,12 @@ void mcrI2c::core(void *task_data) {
 
   ESP_LOGV(tagEngine(), "normal ops, proceeding to task loop");
 
+  // warm start:  the devices known before the restart are reported without
+  // waiting for discover (device names require the network name)
+  if (restoreDevices() > 0) {
+    devicesAvailable();
+  }
+
   saveTaskLastWake(CORE);
   for (;;) {
     // signal to other tasks the dsEngine task is in it's run loop
@@ -216,45 +402,207 @@ void mcrI2c::core(void *task_data) {
     engineRunning();
 
     // do high-level engine actions here (e.g. general housekeeping)
+#ifdef CONFIG_MCR_I2C_SIMULATED
+    const i2c_sim_stats *stats = i2c_sim_get_stats(_port);
+    ESP_LOGI(tagEngine(),
+             "simulated bus_us=%llu transactions=%u bytes=%u nacks=%u",
+             stats->bus_us, stats->transactions, stats->bytes, stats->nacks);
+    i2c_sim_clear_stats(_port);
+#endif
+
+    ESP_LOGD(tagEngine(), "bus selects issued=%u skipped=%u errors=%u",
+             _bus_selects_issued.value(), _bus_selects_skipped.value(),
+             _bus_select_errors.value());
+    ESP_LOGD(tagEngine(), "cmd link allocations=%u", _cmd_link_allocs.value());
+
     taskDelayUntil(CORE, _loop_frequency);
   }
 }
 
+void mcrI2c::initBus() {
+#ifdef CONFIG_MCR_I2C_SIMULATED
+  i2c_sim_initialize(_port, true);
+  simulatedDevices();
+  ESP_LOGI(tagEngine(), "port %d simulated bus", _port);
+#else
+  bool driver_ready = false;
+
+  while (!driver_ready) {
+    driver_ready = installDriver();
+    delay(1000); // prevent busy loop if i2c driver fails to install
+  }
+
+  pinReset();
+  ESP_LOGI(tagEngine(), "port %d using sda/scl pins %d/%d", _port, _sda_pin,
+           _scl_pin);
+#endif
+}
+
 void mcrI2c::discover(void *data) {
   logSubTaskStart(data);
   saveTaskLastWake(DISCOVER);
-  bool detect_rc = true;
 
   while (waitForEngine()) {
+    if (phaseEnabled(DISCOVER)) {
+      passUntilComplete(DISCOVER);
+    }
+
+    // we want to discover
+    saveTaskLastWake(DISCOVER);
+    taskDelayUntil(DISCOVER, discoverFrequency());
+  }
+}
 
-    takeBus();
+// discover continues from the stage in progress when the bus is busy and
+// after the pause that follows the sweep
+TickType_t mcrI2c::discoverPass() {
+  TickType_t resume_ticks = 0;
+
+  if (_discover_stage == DISCOVER_START) {
     trackDiscover(true);
-    detectMultiplexer();
+    _discover_stage = DISCOVER_CHECK;
+  }
 
-    if (useMultiplexer()) {
-      for (uint32_t bus = 0; (detect_rc && (bus < maxBuses())); bus++) {
-        ESP_LOGV(tagDetectDev(), "scanning bus %#02x", bus);
-        detect_rc = detectDevicesOnBus(bus);
-      }
-    } else { // multiplexer not available, just search bus 0
-      detect_rc = detectDevicesOnBus(0x00);
+  if (_discover_stage == DISCOVER_CHECK) {
+    if (checkKnownDevices(resume_ticks) == false) {
+      return discoverWaits(resume_ticks);
     }
 
-    giveBus();
+    _discover_stage = DISCOVER_SWEEP;
+  }
+
+  if (_discover_stage == DISCOVER_SWEEP) {
+    // until devices are known (e.g. at startup) sweep every bus so readings
+    // begin as soon as possible
+    if (sweepForNewDevices(numKnownDevices() == 0, resume_ticks) == false) {
+      return discoverWaits(resume_ticks);
+    }
 
     // signal to other tasks if there are devices available
     // after delaying a bit (to improve i2c bus stability)
-    delay(100);
+    _discover_stage = DISCOVER_SETTLE;
+    return pdMS_TO_TICKS(100);
+  }
+
+  _discover_stage = DISCOVER_START;
+  trackDiscover(false);
+
+  ESP_LOGD(tagDiscover(), "max bus hold %0.1fms",
+           (float)(maxDiscoverBusHold() / 1000.0));
+
+  if (numKnownDevices() > 0) {
+    devicesAvailable();
+  }
+
+  saveDevices();
+
+  return 0;
+}
+
+// the bus is busy so discover continues later or the bus reset failed and
+// discover ends
+TickType_t mcrI2c::discoverWaits(TickType_t resume_ticks) {
+  if (resume_ticks == 0) {
+    _discover_stage = DISCOVER_START;
     trackDiscover(false);
+  }
+
+  return resume_ticks;
+}
+
+// known devices not seen (read) since the previous discover are confirmed
+// present with a single address write.  the bus is held per device.
+//
+// returns false when the bus is not taken (see takePassBus()), confirmed
+// devices were just seen so the check continues with the devices remaining.
+bool mcrI2c::checkKnownDevices(TickType_t &resume_ticks) {
+  DeviceList_t devs = devices();
+
+  for (auto &item : *devs) {
+    auto dev = item.second;
 
-    if (numKnownDevices() > 0) {
-      devicesAvailable();
+    if (dev->secondsSinceLastSeen() < (time_t)discoverSecs()) {
+      continue;
     }
 
-    // we want to discover
-    saveTaskLastWake(DISCOVER);
-    taskDelayUntil(DISCOVER, _discover_frequency);
+    if (takeDiscoverBus(resume_ticks) == false) {
+      return false;
+    }
+
+    if (selectBus(dev->bus()) && detectDevice(dev)) {
+      dev->justSeen();
+    } else {
+      ESP_LOGD(tagDiscover(), "presence check failed %s", dev->debug().get());
+    }
+
+    giveDiscoverBus();
+  }
+
+  return true;
+}
+
+// sweep the next multiplexer buses (round robin) for devices not yet known.
+// the bus is held per multiplexer bus swept and only a few are swept each
+// discover so a complete sweep is spread across discover cycles.
+//
+// returns false when the bus is not taken (see takePassBus()), the sweep
+// continues from _sweep_bus.
+bool mcrI2c::sweepForNewDevices(bool complete_round,
+                                TickType_t &resume_ticks) {
+  uint32_t swept = 0;
+
+  do {
+    // the multiplexer is detected at the start of each round
+    if (_sweep_bus == 0) {
+      if (takeDiscoverBus(resume_ticks) == false) {
+        return false;
+      }
+
+      detectMultiplexer();
+      giveDiscoverBus();
+    }
+
+    const uint32_t buses = useMultiplexer() ? maxBuses() : 1;
+
+    ESP_LOGV(tagDetectDev(), "sweeping bus %#02x", _sweep_bus);
+
+    if (takeDiscoverBus(resume_ticks) == false) {
+      return false;
+    }
+
+    auto rc = detectDevicesOnBus(_sweep_bus);
+    giveDiscoverBus();
+
+    swept++;
+
+    if (rc == false) {
+      // start over (including multiplexer detection) next time
+      _sweep_bus = 0;
+      break;
+    }
+
+    _sweep_bus = (_sweep_bus + 1) % buses;
+
+  } while ((_sweep_bus != 0) &&
+           (complete_round || (swept < CONFIG_MCR_I2C_SWEEP_BUSES)));
+
+  return true;
+}
+
+bool mcrI2c::takeDiscoverBus(TickType_t &resume_ticks) {
+  if (takePassBus(BUS_DISCOVER, resume_ticks) == false) {
+    return false;
   }
+
+  _discover_hold.reset();
+  return true;
+}
+
+void mcrI2c::giveDiscoverBus() {
+  uint64_t hold_us = _discover_hold;
+
+  giveBus();
+  trackDiscoverBusHold(hold_us);
 }
 
 void mcrI2c::report(void *data) {
@@ -264,49 +612,43 @@ void mcrI2c::report(void *data) {
 
   while (waitFor(devicesAvailableBit())) {
     if (numKnownDevices() == 0) {
-      taskDelayUntil(REPORT, _report_frequency);
+      taskDelayUntil(REPORT, reportFrequency());
       continue;
     }
 
     Net::waitForNormalOps();
 
-    trackReport(true);
+    passUntilComplete(REPORT);
 
-    for_each(beginDevices(), endDevices(),
-             [this](std::pair<string_t, i2cDev_t *> item) {
-               auto dev = item.second;
+    taskDelayUntil(REPORT, reportFrequency());
+  }
+}
 
-               if (dev->available()) {
-                 takeBus();
+// a pass continues while the jobs planned at the start are active
+TickType_t mcrI2c::reportPass() {
+  if (_jobs_active == 0) {
+    if (numKnownDevices() == 0) {
+      return 0;
+    }
 
-                 if (readDevice(dev)) {
-                   publish(dev);
-                   ESP_LOGV(tagReport(), "%s success", dev->debug().get());
-                 } else {
-                   ESP_LOGE(tagReport(), "%s failed", dev->debug().get());
-                   // hardReset();
-                 }
+    trackReport(true);
+    planJobs();
+  }
 
-                 giveBus();
+  TickType_t resume_ticks = runJobs();
 
-               } else {
-                 if (dev->missing()) {
-                   ESP_LOGW(tagReport(), "device missing: %s",
-                            dev->debug().get());
-                 }
-               }
-             });
+  if (resume_ticks > 0) {
+    return resume_ticks;
+  }
 
-    trackReport(false);
-    reportMetrics();
+  trackReport(false);
+  reportMetrics();
 
-    taskDelayUntil(REPORT, _report_frequency);
-  }
+  return 0;
 }
 
 esp_err_t mcrI2c::busRead(i2cDev_t *dev, uint8_t *buff, uint32_t len,
                           esp_err_t prev_esp_rc) {
-  i2c_cmd_handle_t cmd = nullptr;
   esp_err_t esp_rc;
 
   if (prev_esp_rc != ESP_OK) {
@@ -316,23 +658,7 @@ esp_err_t mcrI2c::busRead(i2cDev_t *dev, uint8_t *buff, uint32_t len,
     return prev_esp_rc;
   }
 
-  int timeout = 0;
-  i2c_get_timeout(I2C_NUM_0, &timeout);
-  ESP_LOGV(tagEngine(), "i2c timeout: %d", timeout);
-
-  cmd = i2c_cmd_link_create(); // allocate i2c cmd queue
-  i2c_master_start(cmd);       // queue i2c START
-
-  i2c_master_write_byte(cmd, dev->readAddr(),
-                        true); // queue the READ for device and check for ACK
-
-  i2c_master_read(cmd, buff, len,
-                  I2C_MASTER_LAST_NACK); // queue the READ of number of bytes
-  i2c_master_stop(cmd);                  // queue i2c STOP
-
-  // execute queued i2c cmd
-  esp_rc = i2c_master_cmd_begin(I2C_NUM_0, cmd, _cmd_timeout);
-  i2c_cmd_link_delete(cmd);
+  esp_rc = busTransaction(dev, nullptr, 0, buff, len);
 
   if (esp_rc == ESP_OK) {
     // TODO: set to debug for production release
@@ -348,9 +674,56 @@ esp_err_t mcrI2c::busRead(i2cDev_t *dev, uint8_t *buff, uint32_t len,
   return esp_rc;
 }
 
+// a single i2c transaction (see i2cQueueTransaction) with a link built for
+// this transaction only.
+//
+// when ESP-IDF supports it (v4.4 and later) the command link is built in a
+// buffer owned by the engine so a transaction does not allocate from the
+// heap.  reusing the buffer is safe since the caller holds the bus.
+esp_err_t mcrI2c::busTransaction(i2cDev_t *dev, const uint8_t *send,
+                                 uint32_t send_len, uint8_t *recv,
+                                 uint32_t recv_len) {
+  esp_err_t esp_rc = ESP_OK;
+
+#ifdef CONFIG_MCR_I2C_SIMULATED
+  if ((send_len > 0) && (recv_len > 0)) {
+    esp_rc = i2c_sim_write_read(_port, dev->devAddr(), send, send_len, recv,
+                                recv_len);
+  } else if (recv_len > 0) {
+    esp_rc = i2c_sim_read(_port, dev->devAddr(), recv, recv_len);
+  } else {
+    esp_rc = i2c_sim_write(_port, dev->devAddr(), send, send_len);
+  }
+#else
+#ifdef MCR_I2C_STATIC_CMD_LINK
+  i2c_cmd_handle_t cmd =
+      i2c_cmd_link_create_static(_cmd_link_buff, sizeof(_cmd_link_buff));
+#else
+  i2c_cmd_handle_t cmd = i2c_cmd_link_create(); // allocate i2c cmd queue
+  _cmd_link_allocs.add();
+
+  // the driver uses malloc() so the link is counted (not sized) by the trace
+  mcrHeapTrace::recordAlloc(HEAP_TAG_I2C_CMD_LINK, 0);
+#endif
+
+  i2cQueueTransaction(cmd, dev->devAddr(), send, send_len, recv, recv_len);
+
+  // execute queued i2c cmd
+  esp_rc = i2c_master_cmd_begin(_port, cmd, _cmd_timeout);
+
+#ifdef MCR_I2C_STATIC_CMD_LINK
+  i2c_cmd_link_delete_static(cmd);
+#else
+  i2c_cmd_link_delete(cmd);
+  mcrHeapTrace::recordFree(HEAP_TAG_I2C_CMD_LINK, 0);
+#endif
+#endif
+
+  return esp_rc;
+}
+
 esp_err_t mcrI2c::busWrite(i2cDev_t *dev, uint8_t *bytes, uint32_t len,
                            esp_err_t prev_esp_rc) {
-  i2c_cmd_handle_t cmd = nullptr;
   esp_err_t esp_rc;
 
   if (prev_esp_rc != ESP_OK) {
@@ -360,19 +733,7 @@ esp_err_t mcrI2c::busWrite(i2cDev_t *dev, uint8_t *bytes, uint32_t len,
     return prev_esp_rc;
   }
 
-  cmd = i2c_cmd_link_create(); // allocate i2c cmd queue
-  i2c_master_start(cmd);       // queue i2c START
-
-  i2c_master_write_byte(cmd, dev->writeAddr(),
-                        true); // queue the device address (with WRITE)
-                               // and check for ACK
-  i2c_master_write(cmd, bytes, len,
-                   true); // queue bytes to send (with ACK check)
-  i2c_master_stop(cmd);   // queue i2c STOP
-
-  // execute queued i2c cmd
-  esp_rc = i2c_master_cmd_begin(I2C_NUM_0, cmd, _cmd_timeout);
-  i2c_cmd_link_delete(cmd);
+  esp_rc = busTransaction(dev, bytes, len, nullptr, 0);
 
   if (esp_rc == ESP_OK) {
     ESP_LOGV(tagEngine(), "ESP_OK: bus_write(%s, %p, %d, %s)",
@@ -410,23 +771,17 @@ bool mcrI2c::detectDevice(i2cDev_t *dev) {
   //                             0xa2};
   uint8_t detect_cmd[] = {dev->devAddr()};
 
+  const i2cDriver_t *driver = findDriver(dev->devAddr());
+
   ESP_LOGV(tagDetectDev(), "looking for %s", dev->debug().get());
 
-  switch (dev->devAddr()) {
-
-  case 0x70: // TCA9548B - TI i2c bus multiplexer
-  case 0x44: // SHT-31 humidity sensor
-  case 0x20: // MCP23008 0x20 - 0x27
-  case 0x21:
-  case 0x22:
-  case 0x23:
-  case 0x24:
-  case 0x25:
-  case 0x26:
-  case 0x27:
-  case 0x36: // STEMMA (seesaw based soil moisture sensor)
+  if ((driver != nullptr) && (driver->probe != nullptr)) {
+    esp_rc = (this->*(driver->probe))(dev) ? ESP_OK : ESP_FAIL;
+  } else if ((driver != nullptr) ||
+             (dev->devAddr() == _multiplexer_dev.devAddr())) {
+    // the multiplexer (TCA9548B) and most devices are detected by writing a
+    // byte and checking for the ACK
     esp_rc = busWrite(dev, detect_cmd, sizeof(detect_cmd));
-    break;
   }
 
   if (esp_rc == ESP_OK) {
@@ -443,36 +798,93 @@ bool mcrI2c::detectDevice(i2cDev_t *dev) {
 bool mcrI2c::detectDevicesOnBus(int bus) {
   bool rc = true;
 
-  mcrDevAddr_t *addrs = search_addrs();
+  for (uint32_t i = 0; rc && (_drivers[i].desc != nullptr); i++) {
+    const i2cDriver_t &driver = _drivers[i];
 
-  for (uint8_t i = 0; addrs[i].isValid(); i++) {
-    mcrDevAddr_t &search_addr = addrs[i];
-    i2cDev_t dev(search_addr, useMultiplexer(), bus);
+    for (uint32_t addr = driver.first_addr; addr <= driver.last_addr;
+         addr++) {
+      rc = detectAddressOnBus(driver, addr, bus);
 
-    if (selectBus(bus)) {
-      if (detectDevice(&dev)) {
+      if (rc == false) {
+        break;
+      }
+    }
+  }
 
-        if (i2cDev_t *found = (i2cDev_t *)justSeenDevice(dev)) {
-          ESP_LOGV(tagDiscover(), "already know %s", found->debug().get());
-        } else { // device was not known, must add
-          i2cDev_t *new_dev = new i2cDev(dev);
+  return rc;
+}
 
-          ESP_LOGD(tagDiscover(), "new (%p) %s", (void *)new_dev,
-                   dev.debug().get());
-          addDevice(new_dev);
-        }
+bool mcrI2c::detectAddressOnBus(const i2cDriver_t &driver, uint8_t addr,
+                                int bus) {
+  mcrDevAddr_t search_addr(addr);
+  i2cDev_t dev(search_addr, useMultiplexer(), bus, _port, driver.desc);
 
-        devicesAvailable();
+  if (selectBus(bus) == false) {
+    ESP_LOGW(tagDiscover(), "bus select failed, aborting detectDevicesOnBus()");
+    return false;
+  }
+
+  if (detectDevice(&dev)) {
+
+    if (i2cDev_t *found = (i2cDev_t *)justSeenDevice(dev)) {
+      ESP_LOGV(tagDiscover(), "already know %s", found->debug().get());
+    } else { // device was not known, must add
+      i2cDev_t *new_dev = new i2cDev(dev);
+
+      ESP_LOGD(tagDiscover(), "new (%p) %s", (void *)new_dev,
+               dev.debug().get());
+      addDevice(new_dev);
+
+      if (driver.start != nullptr) {
+        (this->*(driver.start))(new_dev);
       }
-    } else {
-      ESP_LOGW(tagDiscover(),
-               "bus select failed, aborting detectDevicesOnBus()");
-      rc = false;
-      break;
     }
+
+    devicesAvailable();
   }
 
-  return rc;
+  return true;
+}
+
+bool mcrI2c::snapshotDevice(i2cDev_t *dev, EngineDevSnap_t &snap) {
+  snap.addr[0] = dev->devAddr();
+  snap.addr_len = 1;
+  snap.bus = dev->bus();
+  snap.flags = dev->useMultiplexer() ? _snap_multiplexer : 0x00;
+
+  return true;
+}
+
+i2cDev_t *mcrI2c::restoreDevice(const EngineDevSnap_t &snap) {
+  const i2cDriver_t *driver = findDriver(snap.addr[0]);
+
+  if ((driver == nullptr) || (snap.addr_len != 1)) {
+    return nullptr;
+  }
+
+  // as when found by discover, some devices must be started.  when the bus
+  // is unavailable the device is not restored, discover will find it.
+  if ((driver->start != nullptr) && (takeBus(BUS_DISCOVER) == false)) {
+    ESP_LOGW(tagEngine(), "bus unavailable, not restoring %s", driver->desc);
+    return nullptr;
+  }
+
+  mcrDevAddr_t addr(snap.addr[0]);
+  bool use_multiplexer = (snap.flags & _snap_multiplexer);
+  i2cDev_t *dev = new i2cDev(addr, use_multiplexer, snap.bus, _port,
+                             driver->desc);
+
+  // the multiplexer is confirmed by the first discover
+  if (use_multiplexer) {
+    _use_multiplexer = true;
+  }
+
+  if (driver->start != nullptr) {
+    (this->*(driver->start))(dev);
+    giveBus();
+  }
+
+  return dev;
 }
 
 bool mcrI2c::detectMultiplexer(const int max_attempts) {
@@ -481,7 +893,22 @@ bool mcrI2c::detectMultiplexer(const int max_attempts) {
 
   // _use_multiplexer initially set to hardware configuration
   // however is updated based on actual multiplexer detection
-  _use_multiplexer = hwConfig::legacy() | hwConfig::haveMultiplexer();
+#ifdef CONFIG_MCR_I2C_SIMULATED
+  _use_multiplexer = true;
+#else
+  // the hardware configuration jumpers describe the devices on port zero,
+  // the multiplexer on other ports is found by detection alone
+  if (_port == I2C_NUM_0) {
+    _use_multiplexer = hwConfig::legacy() | hwConfig::haveMultiplexer();
+  } else {
+    _use_multiplexer = true;
+  }
+#endif
+
+  // detection writes to the multiplexer control register (changing the
+  // selected bus) and discover is infrequent so it is a convenient point
+  // to force the next select to be issued
+  _selected_bus = -1;
 
   if (_use_multiplexer && detectDevice(&_multiplexer_dev)) {
     ESP_LOGD(tagEngine(), "will use TCA9548A i2c multiplexer");
@@ -499,11 +926,15 @@ bool mcrI2c::hardReset() {
 
   delay(1000);
 
-  rc = i2c_driver_delete(I2C_NUM_0);
+  rc = i2c_driver_delete(_port);
   ESP_LOGV(tagEngine(), "i2c_driver_delete() == %s", espError(rc));
 
-  periph_module_disable(PERIPH_I2C0_MODULE);
-  periph_module_enable(PERIPH_I2C0_MODULE);
+  periph_module_t module =
+      (_port == I2C_NUM_0) ? PERIPH_I2C0_MODULE : PERIPH_I2C1_MODULE;
+  periph_module_disable(module);
+  periph_module_enable(module);
+
+  _selected_bus = -1;
 
   return installDriver();
 }
@@ -514,17 +945,17 @@ bool mcrI2c::installDriver() {
   bzero(&_conf, sizeof(_conf));
 
   _conf.mode = I2C_MODE_MASTER;
-  _conf.sda_io_num = (gpio_num_t)23;
-  _conf.scl_io_num = (gpio_num_t)22;
+  _conf.sda_io_num = _sda_pin;
+  _conf.scl_io_num = _scl_pin;
   _conf.sda_pullup_en = GPIO_PULLUP_ENABLE;
   _conf.scl_pullup_en = GPIO_PULLUP_ENABLE;
   _conf.master.clk_speed = 100000;
 
-  esp_err = i2c_param_config(I2C_NUM_0, &_conf);
+  esp_err = i2c_param_config(_port, &_conf);
   ESP_LOGV(tagEngine(), "%s i2c_param_config()", esp_err_to_name(esp_err));
 
   if (esp_err == ESP_OK) {
-    esp_err = i2c_driver_install(I2C_NUM_0, _conf.mode, 0, 0, 0);
+    esp_err = i2c_driver_install(_port, _conf.mode, 0, 0, 0);
     ESP_LOGV(tagEngine(), "%s i2c_driver_install()", esp_err_to_name(esp_err));
   }
 
@@ -533,21 +964,29 @@ bool mcrI2c::installDriver() {
   return (esp_err == ESP_OK) ? true : false;
 }
 
-mcrI2c_t *mcrI2c::instance() {
-  if (__singleton__ == nullptr) {
-    __singleton__ = new mcrI2c();
+mcrI2c_t *mcrI2c::instance(uint32_t port) {
+  if (port >= numPorts()) {
+    return nullptr;
   }
 
-  return __singleton__;
+  if (__singletons__[port] == nullptr) {
+    __singletons__[port] = new mcrI2c(port);
+  }
+
+  return __singletons__[port];
 }
 
 uint32_t mcrI2c::maxBuses() { return _max_buses; }
 bool mcrI2c::pinReset() {
+  if (_port != I2C_NUM_0) {
+    return false;
+  }
 
   ESP_LOGD(tagEngine(), "pulling reset pin low");
   gpio_set_level(RST_PIN, 0); // pull the pin low to reset i2c devices
   delay(250);                 // give plenty of time for all devices to reset
   gpio_set_level(RST_PIN, 1); // bring all devices online
+  _selected_bus = -1;         // multiplexer powers up with no bus selected
   ESP_LOGD(tagEngine(), "pulling reset pin high");
 
   return true;
@@ -557,209 +996,466 @@ void mcrI2c::printUnhandledDev(i2cDev_t *dev) {
   ESP_LOGW(tagEngine(), "unhandled dev %s", dev->debug().get());
 }
 
+#ifdef CONFIG_MCR_I2C_SIMULATED
+void mcrI2c::simulatedDevices() {
+  // each device type is placed on consecutive multiplexer buses
+  for (auto bus = 0; bus < CONFIG_MCR_I2C_SIM_SHT31_DEVICES; bus++) {
+    i2c_sim_device *dev = i2c_sim_add_device(I2C_SIM_SHT31, _port, bus, 0x44);
+    dev->temp_c += bus; // spread the temperatures by a degree
+  }
+
+  for (auto bus = 0; bus < CONFIG_MCR_I2C_SIM_SOIL_DEVICES; bus++) {
+    i2c_sim_add_device(I2C_SIM_SEESAW_SOIL, _port, bus, 0x36);
+  }
+
+  for (auto bus = 0; bus < CONFIG_MCR_I2C_SIM_MCP23008_DEVICES; bus++) {
+    i2c_sim_add_device(I2C_SIM_MCP23008, _port, bus, 0x20);
+  }
+}
+#endif
+
 bool mcrI2c::useMultiplexer() { return _use_multiplexer; }
 
 bool mcrI2c::readDevice(i2cDev_t *dev) {
-  auto rc = false;
+  const i2cStep_t *steps = readSteps(dev);
 
-  if (selectBus(dev->bus())) {
-    switch (dev->devAddr()) {
+  if (steps == nullptr) {
+    printUnhandledDev(dev);
+    return true;
+  }
 
-    case 0x44:
-      rc = readSHT31(dev);
-      break;
+  i2cJob_t job(dev, steps);
 
-    case 0x20: // MCP23008 can be user configured to 0x20 + three bits
-    case 0x21:
-    case 0x22:
-    case 0x23:
-    case 0x24:
-    case 0x25:
-    case 0x26:
-    case 0x27:
-      rc = readMCP23008(dev);
-      break;
+  return runJob(job);
+}
 
-    case 0x36: // Seesaw Soil Probe
-      rc = readSeesawSoil(dev);
-      break;
+const i2cDriver_t *mcrI2c::findDriver(uint8_t addr) {
+  for (const i2cDriver_t *driver = _drivers; driver->desc != nullptr;
+       driver++) {
+    if ((addr >= driver->first_addr) && (addr <= driver->last_addr)) {
+      return driver;
+    }
+  }
 
-    default:
-      printUnhandledDev(dev);
-      rc = true;
-      break;
+  return nullptr;
+}
+
+const i2cStep_t *mcrI2c::readSteps(i2cDev_t *dev) {
+  const i2cDriver_t *driver = findDriver(dev->devAddr());
+
+  return (driver != nullptr) ? driver->read_steps : nullptr;
+}
+
+void mcrI2c::runStep(i2cJob_t &job) {
+  const i2cStep_t &step = job.step();
+  i2cDev_t *dev = job.dev();
+  esp_err_t esp_rc = ESP_OK;
+
+  switch (step.type) {
+  case I2C_STEP_WRITE:
+  case I2C_STEP_READ:
+  case I2C_STEP_REQUEST:
+  case I2C_STEP_WAKE:
+    // steps of jobs for devices on other buses may have run since the
+    // previous step of this job so always select the bus
+    if (selectBus(dev->bus()) == false) {
+      job.setRC(ESP_FAIL);
+      return;
     }
+    break;
+
+  default:
+    break;
   }
 
-  return rc;
+  switch (step.type) {
+  case I2C_STEP_WRITE:
+  case I2C_STEP_READ:
+  case I2C_STEP_REQUEST:
+    esp_rc = stepTransaction(job);
+
+    if (esp_rc != ESP_OK) {
+      ESP_LOGD(tagEngine(), "%s: step %u %s", esp_err_to_name(esp_rc),
+               job.stepIndex(), dev->debug().get());
+
+      if (step.recv_len > 0) {
+        dev->readFailure();
+      } else {
+        dev->writeFailure();
+      }
+    }
+    break;
+
+  case I2C_STEP_WAIT:
+    job.waitUntil(esp_timer_get_time() + step.wait_us);
+    break;
+
+  case I2C_STEP_WAKE:
+    // the device acknowledges (or not) while waking so the result is ignored
+    stepTransaction(job);
+    break;
+
+  case I2C_STEP_END:
+    break;
+  }
+
+  job.setRC(esp_rc);
+  job.next();
+}
+
+// each step is a single transaction with a link built for the step only.
+// the driver consumes the items of a link as it executes so a link is never
+// reused (see i2c_link.hpp).
+esp_err_t mcrI2c::stepTransaction(i2cJob_t &job) {
+  const i2cStep_t &step = job.step();
+
+  return busTransaction(job.dev(), step.send, step.send_len,
+                        job.buff() + step.recv_offset, step.recv_len);
 }
 
-bool mcrI2c::readMCP23008(i2cDev_t *dev) {
+// run all steps of a job, waiting as needed, then decode the result
+//  the caller holds the bus so waits are simply delays
+bool mcrI2c::runJob(i2cJob_t &job) {
+  job.dev()->readStart();
+
+  while (job.done() == false) {
+    if (job.ready(esp_timer_get_time()) == false) {
+      vTaskDelay(ticksUntil(job.readyAt()));
+      continue;
+    }
+
+    runStep(job);
+  }
+
+  return finishJob(job);
+}
+
+bool mcrI2c::finishJob(i2cJob_t &job) {
   auto rc = false;
-  auto positions = 0b00000000;
-  esp_err_t esp_rc;
+  i2cDev_t *dev = job.dev();
+  const i2cDriver_t *driver = findDriver(dev->devAddr());
+
+  dev->readStop();
+  job.finish();
+
+  if (job.rc() != ESP_OK) {
+    ESP_LOGW(tagEngine(), "[%s] %s read", esp_err_to_name(job.rc()),
+             dev->id().c_str());
+
+    if (driver->recover != nullptr) {
+      (this->*(driver->recover))(dev);
+    }
+
+    return rc;
+  }
+
+  rc = (this->*(driver->decode))(dev, job.buff());
+
+  return rc;
+}
+
+// read all available devices with their steps interleaved:  a single step
+// of each job that is ready is run per pass.  the bus is taken per step so
+// higher priority jobs (e.g. a command) are never blocked by a device that
+// is busy.  when all remaining jobs are waiting on their device the report
+// continues once the earliest is ready (see runJobs()).
+void mcrI2c::planJobs() {
+  uint32_t count = 0;
+
+  DeviceList_t devs = devices();
+
+  for_each(devs->begin(), devs->end(),
+           [this, &count](DeviceEntry_t item) {
+             auto dev = item.second;
+
+             if (dev->available()) {
+               const i2cStep_t *steps = readSteps(dev);
+
+               if (steps == nullptr) {
+                 printUnhandledDev(dev);
+                 return;
+               }
+
+               // the registry never holds more than maxDevices()
+               dev->readStart();
+               _jobs[count++] = i2cJob(dev, steps);
+             } else {
+               if (dev->missing()) {
+                 ESP_LOGW(tagReport(), "device missing: %s",
+                          dev->debug().get());
+               }
+             }
+           });
+
+  // plan the pass from the driver timing:  jobs for devices that are busy
+  // the longest (convert) start first so their waits overlap the steps of
+  // the other jobs.  jobs that are busy equally long are ordered by
+  // multiplexer bus so each sweep selects each bus once (more when a job
+  // for a bus is waiting on its device).
+  //
+  // the key (bus then address) orders the rest so std::sort, which sorts
+  // in place unlike std::stable_sort, gives the same order each pass.
+  std::sort(_jobs, _jobs + count, [](const i2cJob_t &a, const i2cJob_t &b) {
+    uint32_t a_us = findDriver(a.dev()->devAddr())->convert_us;
+    uint32_t b_us = findDriver(b.dev()->devAddr())->convert_us;
+
+    if (a_us != b_us) {
+      return a_us > b_us;
+    }
 
-  RawData_t request{0x00}; // IODIR Register (address 0x00)
+    return a.dev()->key() < b.dev()->key();
+  });
+
+  _jobs_count = count;
+  _jobs_active = count;
+}
+
+// returns zero once all jobs are finished otherwise the ticks until a job is
+// ready (or the bus may be available)
+TickType_t mcrI2c::runJobs() {
+  while (_jobs_active > 0) {
+    int64_t next_ready = INT64_MAX;
+    bool ran = false;
+
+    for (uint32_t i = 0; i < _jobs_count; i++) {
+      i2cJob_t &job = _jobs[i];
+
+      if (job.finished()) {
+        continue;
+      }
+
+      if (job.ready(esp_timer_get_time()) == false) {
+        next_ready = std::min(next_ready, job.readyAt());
+        continue;
+      }
+
+      TickType_t resume_ticks = 0;
+
+      if (takePassBus(BUS_REPORT, resume_ticks) == false) {
+        return resume_ticks;
+      }
+
+      runStep(job);
+
+      // a failed read may recover the device so the job is finished
+      // holding the bus, the reading is published once the bus is given
+      i2cDev_t *dev = job.dev();
+      const bool done = job.done();
+      const bool read = done && finishJob(job);
+
+      giveBus();
+      ran = true;
+
+      if (done) {
+        if (read) {
+          publish(dev);
+          ESP_LOGV(tagReport(), "%s success", dev->debug().get());
+        } else {
+          ESP_LOGE(tagReport(), "%s failed", dev->debug().get());
+        }
+
+        _jobs_active--;
+      }
+    }
+
+    if ((ran == false) && (_jobs_active > 0)) {
+      return ticksUntil(next_ready);
+    }
+  }
+
+  return 0;
+}
+
+bool mcrI2c::decodeMCP23008(i2cDev_t *dev, const uint8_t *buff) {
+  auto positions = 0b00000000;
 
   // register       register      register          register
   // 0x00 - IODIR   0x01 - IPOL   0x02 - GPINTEN    0x03 - DEFVAL
   // 0x04 - INTCON  0x05 - IOCON  0x06 - GPPU       0x07 - INTF
   // 0x08 - INTCAP  0x09 - GPIO   0x0a - OLAT
+  RawData_t all_registers(buff, buff + 12); // 12 bytes (0x00-0x0a)
 
-  // at POR the MCP2x008 operates in sequential mode where continued reads
-  // automatically increment the address (register).  we read all registers
-  // (12 bytes) in one shot.
-  RawData_t all_registers;
-  all_registers.resize(12); // 12 bytes (0x00-0x0a)
-
-  esp_rc = requestData(tagReadMCP23008(), dev, request.data(), request.size(),
-                       all_registers.data(), all_registers.capacity());
+  // GPIO register is little endian so no conversion is required
+  positions = all_registers[0x0a]; // OLAT register (address 0x0a)
 
-  if (esp_rc == ESP_OK) {
-    // GPIO register is little endian so no conversion is required
-    positions = all_registers[0x0a]; // OLAT register (address 0x0a)
+  dev->storeRawData(all_registers);
 
-    dev->storeRawData(all_registers);
+  dev->justSeen();
 
-    dev->justSeen();
+  positionsReading_t *reading = new positionsReading(
+      dev->externalName(), time(nullptr), positions, (uint8_t)8);
 
-    positionsReading_t *reading = new positionsReading(
-        dev->externalName(), time(nullptr), positions, (uint8_t)8);
-
-    reading->setLogReading();
-    dev->setReading(reading);
-    rc = true;
-  } else {
-    ESP_LOGW(tagReadMCP23008(), "[%s] %s read", esp_err_to_name(esp_rc),
-             dev->id().c_str());
-  }
+  reading->setLogReading();
+  dev->setReading(reading);
 
-  return rc;
+  return true;
 }
 
-bool mcrI2c::readSeesawSoil(i2cDev_t *dev) {
-  auto rc = false;
-  esp_err_t esp_rc;
+bool mcrI2c::decodeSeesawSoil(i2cDev_t *dev, const uint8_t *buff) {
   float tempC = 0.0;
   int soil_moisture;
-  // int sw_version;
-
-  // seesaw data queries are two bytes that describe:
-  //   1. module
-  //   2. register
-  // NOTE: array is ONLY for the transmit since the response varies
-  //       by module and register
-  uint8_t data_request[] = {0x00,  // MSB: module
-                            0x00}; // LSB: register
-
-  // seesaw responses to data queries vary in length.  this buffer will be
-  // reused for all queries so it must be the max of all response lengths
-  //   1. capacitance - 16bit integer (two bytes)
-  //   2. temperature - 32bit float (four bytes)
-  uint8_t buff[] = {
-      0x00, 0x00, // capactive: (int)16bit, temperature: (float)32 bits
-      0x00, 0x00  // capactive: not used, temperature: (float)32 bits
-  };
-
-  // address i2c device
-  // write request to read module and register
-  //  temperture: SEESAW_STATUS_BASE, SEEWSAW_STATUS_TEMP  (4 bytes)
-  //     consider other status: SEESAW_STATUS_HW_ID, *VERSION, *OPTIONS
-  //  capacitance:  SEESAW_TOUCH_BASE, SEESAW_TOUCH_CHANNEL_OFFSET (2 bytes)
-  // delay (maybe?)
-  // write request to read bytes of the register
-
-  dev->readStart();
-
-  // first, request and receive the onboard temperature
-  data_request[0] = 0x00; // SEESAW_STATUS_BASE
-  data_request[1] = 0x04; // SEESAW_STATUS_TEMP
-  esp_rc = busWrite(dev, data_request, 2);
-  delay(20);
-  esp_rc = busRead(dev, buff, 4, esp_rc);
 
   // conversion copied from AdaFruit Seesaw library
   tempC = (1.0 / (1UL << 16)) *
           (float)(((uint32_t)buff[0] << 24) | ((uint32_t)buff[1] << 16) |
                   ((uint32_t)buff[2] << 8) | (uint32_t)buff[3]);
 
-  // second, request and receive the touch capacitance (soil moisture)
-  data_request[0] = 0x0f; // SEESAW_TOUCH_BASE
-  data_request[1] = 0x10; // SEESAW_TOUCH_CHANNEL_OFFSET
+  soil_moisture = ((uint16_t)buff[4] << 8) | buff[5];
 
-  esp_rc = busWrite(dev, data_request, 2);
-  delay(20);
-  esp_rc = busRead(dev, buff, 2, esp_rc);
+  dev->justSeen();
 
-  soil_moisture = ((uint16_t)buff[0] << 8) | buff[1];
+  soilReading_t *reading = new soilReading(
+      dev->externalName(), dev->readTimestamp(), tempC, soil_moisture);
 
-  // third, request and receive the board version
-  // data_request[0] = 0x00; // SEESAW_STATUS_BASE
-  // data_request[1] = 0x02; // SEESAW_STATUS_VERSION
-  //
-  // esp_rc = bus_write(dev, data_request, 2);
-  // esp_rc = bus_read(dev, buff, 4, esp_rc);
-  //
-  // sw_version = ((uint32_t)buff[0] << 24) | ((uint32_t)buff[1] << 16) |
-  //              ((uint32_t)buff[2] << 8) | (uint32_t)buff[3];
+  dev->setReading(reading);
 
-  dev->readStop();
+  return true;
+}
 
-  if (esp_rc == ESP_OK) {
-    dev->justSeen();
+#ifdef CONFIG_MCR_I2C_SHT31_PERIODIC
+bool mcrI2c::startSHT31(i2cDev_t *dev) {
+  uint8_t break_cmd[] = {0x30, 0x93};
+  uint8_t clear_cmd[] = {0x30, 0x41};
+  uint8_t periodic_cmd[] = {sht31_periodic_cmd[sht31_rate][0],
+                            sht31_periodic_cmd[sht31_rate][1 + sht31_rep]};
+  esp_err_t esp_rc = ESP_OK;
+
+  if (selectBus(dev->bus()) == false) {
+    return false;
+  }
+
+  // stop any periodic acquisition in progress (few commands are accepted
+  // while acquiring) then clear the status register so a subsequent reset
+  // of the sensor can be detected
+  busWrite(dev, break_cmd, sizeof(break_cmd));
+  delay(1);
+  esp_rc = busWrite(dev, clear_cmd, sizeof(clear_cmd));
+  esp_rc = busWrite(dev, periodic_cmd, sizeof(periodic_cmd), esp_rc);
+
+  // the first measurement is available after one period
+  dev->dataReadyAt(esp_timer_get_time() + sht31_period_us[sht31_rate]);
+
+  if (esp_rc != ESP_OK) {
+    ESP_LOGW(tagReadSHT31(), "[%s] start periodic %s", esp_err_to_name(esp_rc),
+             dev->debug().get());
+    return false;
+  }
+
+  return true;
+}
+
+// reads are paced by the report frequency (slower than the measurement
+// rate) so a fetch that is not acknowledged indicates the sensor is not
+// acquiring, most likely due to a reset (returning it to single shot mode)
+void mcrI2c::recoverSHT31(i2cDev_t *dev) {
+  uint8_t break_cmd[] = {0x30, 0x93};
+  uint8_t status_cmd[] = {0xf3, 0x2d};
+  uint8_t status[] = {0x00, 0x00, // status high byte, low byte
+                      0x00};      // crc8 of status
+  esp_err_t esp_rc = ESP_OK;
+
+  if (selectBus(dev->bus()) == false) {
+    return;
+  }
+
+  busWrite(dev, break_cmd, sizeof(break_cmd));
+  delay(1);
+  esp_rc = requestData(tagReadSHT31(), dev, status_cmd, sizeof(status_cmd),
+                       status, sizeof(status));
+
+  // status bit 4: system reset detected
+  if ((esp_rc == ESP_OK) && crcSHT31(status) && (status[1] & 0x10)) {
+    _sht31_resets++;
+    ESP_LOGW(tagReadSHT31(), "reset detected (resets=%u) %s", _sht31_resets,
+             dev->debug().get());
+  }
+
+  startSHT31(dev);
+}
+#endif
+
+bool mcrI2c::decodeSHT31(i2cDev_t *dev, const uint8_t *buff) {
+  auto rc = false;
 
-    soilReading_t *reading = new soilReading(
-        dev->externalName(), dev->readTimestamp(), tempC, soil_moisture);
+  // buff:  tempC high byte, low byte, crc8 of temp
+  //        relh high byte, low byte, crc8 of relh
+  dev->justSeen();
+
+  if (crcSHT31(buff) && crcSHT31(&(buff[3]))) {
+    // conversion from SHT31 datasheet
+    uint16_t stc = (buff[0] << 8) | buff[1];
+    uint16_t srh = (buff[3] << 8) | buff[4];
+
+    float tc = (float)((stc * 175) / 0xffff) - 45;
+    float rh = (float)((srh * 100) / 0xffff);
+
+    humidityReading_t *reading = new humidityReading(
+        dev->externalName(), dev->readTimestamp(), tc, rh);
 
     dev->setReading(reading);
+
     rc = true;
+  } else { // crc did not match
+    ESP_LOGW(tagReadSHT31(), "crc mismatch for %s", dev->debug().get());
+    dev->crcMismatch();
   }
-  // ESP_LOGI(tagEngine(), "soil => sw_version=0x%04x tempC=%3.1f
-  // moisture=%d",
-  //          sw_version, tempC, soil_moisture);
+
+#ifdef CONFIG_MCR_I2C_SHT31_PERIODIC
+  // the next measurement is not available for another period
+  dev->dataReadyAt(esp_timer_get_time() + sht31_period_us[sht31_rate]);
+#endif
 
   return rc;
 }
 
-bool mcrI2c::readSHT31(i2cDev_t *dev) {
+// the device NACKs the address while waking up so, to detect the device,
+// wake it up then write the address
+bool mcrI2c::probeAM2315(i2cDev_t *dev) {
+  busTransaction(dev, nullptr, 0, nullptr, 0);
+  delay(2);
+
+  return (busTransaction(dev, nullptr, 0, nullptr, 0) == ESP_OK);
+}
+
+bool mcrI2c::decodeAM2315(i2cDev_t *dev, const uint8_t *buff) {
   auto rc = false;
-  esp_err_t esp_rc;
+  uint16_t crc = ((uint16_t)buff[7] << 8) | buff[6];
+  uint16_t crc_calc = 0xffff;
 
-  uint8_t request[] = {
-      0x2c, // single-shot measurement, with clock stretching
-      0x06  // high-repeatability measurement (max duration 15ms)
-  };
-  uint8_t buff[] = {
-      0x00, 0x00, // tempC high byte, low byte
-      0x00,       // crc8 of temp
-      0x00, 0x00, // relh high byte, low byte
-      0x00        // crc8 of relh
-  };
+  // buff:  function code, byte count
+  //        relh high byte, low byte, tempC high byte, low byte
+  //        crc low byte, high byte
+  dev->justSeen();
 
-  esp_rc = requestData(tagReadSHT31(), dev, request, sizeof(request), buff,
-                       sizeof(buff));
+  // crc16 (modbus) of the function code, byte count and data
+  for (uint32_t i = 0; i < 6; i++) {
+    crc_calc ^= buff[i];
 
-  if (esp_rc == ESP_OK) {
-    dev->justSeen();
+    for (uint32_t j = 0; j < 8; j++) {
+      crc_calc =
+          (crc_calc & 0x01) ? ((crc_calc >> 1) ^ 0xa001) : (crc_calc >> 1);
+    }
+  }
 
-    if (crcSHT31(buff) && crcSHT31(&(buff[3]))) {
-      // conversion from SHT31 datasheet
-      uint16_t stc = (buff[0] << 8) | buff[1];
-      uint16_t srh = (buff[3] << 8) | buff[4];
+  if (crc == crc_calc) {
+    // conversion from the AM2315 datasheet, the high bit of the temperature
+    // is the sign
+    float rh = (float)(((uint16_t)buff[2] << 8) | buff[3]) / 10.0;
+    float tc = (float)(((uint16_t)(buff[4] & 0x7f) << 8) | buff[5]) / 10.0;
 
-      float tc = (float)((stc * 175) / 0xffff) - 45;
-      float rh = (float)((srh * 100) / 0xffff);
+    if (buff[4] & 0x80) {
+      tc = -tc;
+    }
 
-      humidityReading_t *reading = new humidityReading(
-          dev->externalName(), dev->readTimestamp(), tc, rh);
+    humidityReading_t *reading = new humidityReading(
+        dev->externalName(), dev->readTimestamp(), tc, rh);
 
-      dev->setReading(reading);
+    dev->setReading(reading);
 
-      rc = true;
-    } else { // crc did not match
-      ESP_LOGW(tagReadSHT31(), "crc mismatch for %s", dev->debug().get());
-      dev->crcMismatch();
-    }
+    rc = true;
+  } else {
+    ESP_LOGW(tagReadAM2315(), "crc mismatch for %s", dev->debug().get());
+    dev->crcMismatch();
   }
 
   return rc;
@@ -768,7 +1464,6 @@ bool mcrI2c::readSHT31(i2cDev_t *dev) {
 esp_err_t mcrI2c::requestData(const char *TAG, i2cDev_t *dev, uint8_t *send,
                               uint8_t send_len, uint8_t *recv, uint8_t recv_len,
                               esp_err_t prev_esp_rc, int timeout) {
-  i2c_cmd_handle_t cmd = nullptr;
   esp_err_t esp_rc;
 
   dev->readStart();
@@ -780,39 +1475,19 @@ esp_err_t mcrI2c::requestData(const char *TAG, i2cDev_t *dev, uint8_t *send,
   }
 
   int _save_timeout = 0;
-  if (timeout > 0) {
-    i2c_get_timeout(I2C_NUM_0, &_save_timeout);
-    ESP_LOGV(TAG, "saving previous i2c timeout: %d", _save_timeout);
-    i2c_set_timeout(I2C_NUM_0, timeout);
-  }
-
-  cmd = i2c_cmd_link_create(); // allocate i2c cmd queue
-  i2c_master_start(cmd);       // queue i2c START
-
-  i2c_master_write_byte(cmd, dev->writeAddr(),
-                        true); // queue the WRITE for device and check for ACK
-
-  i2c_master_write(cmd, send, send_len,
-                   I2C_MASTER_ACK); // queue the device command bytes
 
   // clock stretching is leveraged in the event the device requires time
   // to execute the command (e.g. temperature conversion)
   // use timeout to adjust time to wait for clock, if needed
-
-  if ((recv != nullptr) && (recv_len > 0)) {
-    // start a new command sequence without sending a stop
-    i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, dev->readAddr(),
-                          true); // queue the READ for device and check for ACK
-
-    i2c_master_read(cmd, recv, recv_len,
-                    I2C_MASTER_LAST_NACK); // queue the READ of number of bytes
-    i2c_master_stop(cmd);                  // queue i2c STOP
+  if (timeout > 0) {
+    i2c_get_timeout(_port, &_save_timeout);
+    ESP_LOGV(TAG, "saving previous i2c timeout: %d", _save_timeout);
+    i2c_set_timeout(_port, timeout);
   }
 
-  // execute queued i2c cmd
-  esp_rc = i2c_master_cmd_begin(I2C_NUM_0, cmd, _cmd_timeout);
-  i2c_cmd_link_delete(cmd);
+  // send and recv are a single transaction (repeated START, no STOP between)
+  esp_rc = busTransaction(dev, send, send_len, recv,
+                          (recv != nullptr) ? recv_len : 0);
 
   if (esp_rc == ESP_OK) {
     // TODO: set to debug for production release
@@ -828,7 +1503,7 @@ esp_err_t mcrI2c::requestData(const char *TAG, i2cDev_t *dev, uint8_t *send,
 
   // if the timeout was changed restore it
   if (_save_timeout > 0) {
-    i2c_set_timeout(I2C_NUM_0, _save_timeout);
+    i2c_set_timeout(_port, _save_timeout);
   }
 
   dev->readStop();
@@ -841,8 +1516,6 @@ bool mcrI2c::selectBus(uint32_t bus) {
   i2cDev_t multiplexer = i2cDev(_multiplexer_dev);
   esp_err_t esp_rc = ESP_FAIL;
 
-  _bus_selects++;
-
   if (bus >= _max_buses) {
     ESP_LOGW(tagEngine(), "attempt to select bus %d >= %d, bus not changed",
              bus, _max_buses);
@@ -850,23 +1523,35 @@ bool mcrI2c::selectBus(uint32_t bus) {
   }
 
   if (useMultiplexer() && (bus < _max_buses)) {
+    // the multiplexer retains the selected bus so there is nothing to do
+    // when the bus is already selected
+    if ((int32_t)bus == _selected_bus) {
+      _bus_selects_skipped.add();
+      return rc;
+    }
+
     // the bus is selected by sending a single byte to the multiplexer
     // device with the bit for the bus select
     uint8_t bus_cmd[1] = {(uint8_t)(0x01 << bus)};
 
+    _bus_selects_issued.add();
     esp_rc = busWrite(&multiplexer, bus_cmd, 1);
 
     if (esp_rc == ESP_OK) {
+      _selected_bus = bus;
       rc = true;
     } else {
-      _bus_select_errors++;
+      // the state of the multiplexer is unknown
+      _selected_bus = -1;
+      _bus_select_errors.add();
       ESP_LOGW(tagSelectBus(),
-               "unable to select bus %d (selects=%u errors=%u) %s", bus,
-               _bus_selects, _bus_select_errors, espError(esp_rc));
+               "unable to select bus %d (issued=%u skipped=%u errors=%u) %s",
+               bus, _bus_selects_issued.value(), _bus_selects_skipped.value(),
+               _bus_select_errors.value(), espError(esp_rc));
       rc = false;
     }
 
-    if (_bus_select_errors > 50) {
+    if (_bus_select_errors.value() > 50) {
       const char *msg = "BUS SELECT ERRORS EXCEEDED";
       ESP_LOGE(tagEngine(), "bus select errors exceeded, JUMP!");
       mcrNVS::commitMsg(tagEngine(), msg);
@@ -18,6 +18,9 @@
       https://www.wisslanding.com
   */
 
+#include <esp_timer.h>
+#include <sys/time.h>
+
 #include "engines/pwm.hpp"
 
 using std::unique_ptr;
@@ -27,10 +30,19 @@ namespace mcr {
 static pwmEngine_t *__singleton__ = nullptr;
 static const string_t engine_name = "mcrPWM";
 
+const EngineTagDef_t pwmEngine::_tag_defs[] = {
+    {ENGINE_TAG_ENGINE, "engine", "mPWM"},
+    {ENGINE_TAG_DISCOVER, "discover", "mPWM_dis"},
+    {ENGINE_TAG_CONVERT, "convert", "mPWM_cvt"},
+    {ENGINE_TAG_REPORT, "report", "mPWM_rep"},
+    {ENGINE_TAG_COMMAND, "command", "mPWM_cmd"},
+    {PWM_TAG_DETECT, "detect", "mPWM_det"},
+    {ENGINE_TAG_MAX, nullptr, nullptr}};
+
 pwmEngine::pwmEngine() {
   pwmDev::allOff(); // ensure all pins are off at initialization
 
-  setTags(localTags());
+  setTags(_tag_defs);
 
   setLoggingLevel(ESP_LOG_INFO);
 
@@ -43,6 +55,14 @@ pwmEngine::pwmEngine() {
   addTask(engine_name, COMMAND, command);
   addTask(engine_name, DISCOVER, discover);
   addTask(engine_name, REPORT, report);
+
+  // the cadences of the phases (may be adjusted by the engine.config cmd),
+  // there is no convert phase
+  loadConfig({.convert_secs = 0,
+              .discover_secs = 59,
+              .report_secs = 10,
+              .convert = false,
+              .discover = true});
 }
 
 //
@@ -88,7 +108,15 @@ void pwmEngine::command(void *data) {
       ESP_LOGD(tagCommand(), "processing cmd for: %s", dev->id().c_str());
 
       dev->writeStart();
-      set_rc = dev->updateDuty(cmd->duty(), cmd->fade_ms());
+
+      if (cmd->isGroup()) {
+        set_rc = updateGroup(*cmd, dev);
+      } else if (cmd->hasProfile()) {
+        set_rc = dev->startProfile(cmd->profile());
+      } else {
+        set_rc = dev->updateDuty(cmd->duty(), cmd->fade_ms());
+      }
+
       dev->writeStop();
 
       if (set_rc) {
@@ -118,6 +146,20 @@ bool pwmEngine::commandAck(cmdPWM_t &cmd) {
   if (dev != nullptr) {
     rc = readDevice(dev);
 
+    if (rc && cmd.isGroup()) {
+      ((pwmReading_t *)dev->reading())
+          ->setGroup(_group_channels, _group_skew_us, _group_late_us);
+
+      // the other channels of the group report their new duty
+      for (auto &channel : cmd.group()) {
+        pwmDev_t *member = findDevice(channel.internal_dev_id);
+
+        if ((member != nullptr) && readDevice(member)) {
+          publish(member);
+        }
+      }
+    }
+
     if (rc && cmd.ack()) {
       setCmdAck(cmd);
       publish(cmd);
@@ -138,6 +180,90 @@ bool pwmEngine::commandAck(cmdPWM_t &cmd) {
   return rc;
 }
 
+// start the fades of the device of the cmd and the group channels together.
+// each fade is configured first so starting a channel is only the start of
+// the fade.  the measured skew (first to last start) is included in the ack.
+bool pwmEngine::updateGroup(cmdPWM_t &cmd, pwmDev_t *dev) {
+  static const uint32_t max_channels = 4;
+  pwmDev_t *devs[max_channels] = {dev};
+  int64_t started_us[max_channels] = {};
+  uint32_t count = 1;
+  auto rc = dev->prepareFade(cmd.duty(), cmd.fade_ms());
+
+  for (auto &channel : cmd.group()) {
+    pwmDev_t *member = findDevice(channel.internal_dev_id);
+
+    if ((member == nullptr) || (count >= max_channels)) {
+      ESP_LOGW(tagCommand(), "group channel %s not available",
+               channel.internal_dev_id.c_str());
+      rc = false;
+      continue;
+    }
+
+    rc = member->prepareFade(channel.duty, channel.fade_ms) && rc;
+    devs[count++] = member;
+  }
+
+  // prepared fades are not started so nothing changes on failure
+  if (rc == false) {
+    return rc;
+  }
+
+  waitUntil(cmd.executeAtUS());
+
+  struct timeval first_start;
+  gettimeofday(&first_start, nullptr);
+
+  for (uint32_t i = 0; i < count; i++) {
+    rc = devs[i]->startFade() && rc;
+    started_us[i] = esp_timer_get_time();
+  }
+
+  _group_channels = count;
+  _group_skew_us = started_us[count - 1] - started_us[0];
+  _group_late_us = 0;
+
+  if (cmd.executeAtUS() > 0) {
+    _group_late_us = ((int64_t)first_start.tv_sec * 1000000 +
+                      first_start.tv_usec) -
+                     cmd.executeAtUS();
+  }
+
+  ESP_LOGD(tagCommand(), "group of %u started, skew %uus late %dus",
+           _group_channels, _group_skew_us, _group_late_us);
+
+  return rc;
+}
+
+// wait until the unix time (in microseconds) by sleeping for all but the
+// final tick then spinning for the remainder
+void pwmEngine::waitUntil(int64_t unix_us) {
+  struct timeval now;
+
+  if (unix_us == 0) {
+    return;
+  }
+
+  gettimeofday(&now, nullptr);
+  int64_t wait_us = unix_us - ((int64_t)now.tv_sec * 1000000 + now.tv_usec);
+
+  if (wait_us > _max_execute_wait_us) {
+    ESP_LOGW(tagCommand(), "execute_at is %0.1fs away, executing now",
+             (float)(wait_us / 1000000.0));
+    return;
+  }
+
+  TickType_t ticks = (wait_us > 0) ? pdMS_TO_TICKS(wait_us / 1000) : 0;
+
+  if (ticks > 1) {
+    vTaskDelay(ticks - 1);
+  }
+
+  do {
+    gettimeofday(&now, nullptr);
+  } while (((int64_t)now.tv_sec * 1000000 + now.tv_usec) < unix_us);
+}
+
 void pwmEngine::core(void *task_data) {
   bool net_name = false;
 
@@ -181,42 +307,49 @@ void pwmEngine::discover(void *data) {
   saveTaskLastWake(DISCOVER);
 
   while (waitForEngine()) {
+    if (phaseEnabled(DISCOVER)) {
+      passUntilComplete(DISCOVER);
+    }
 
-    trackDiscover(true);
+    // we want to discover
+    saveTaskLastWake(DISCOVER);
+    taskDelayUntil(DISCOVER, discoverFrequency());
+  }
+}
 
-    for (uint8_t i = 1; i <= 4; i++) {
-      mcrDevAddr_t addr(i);
-      pwmDev_t dev(addr);
+TickType_t pwmEngine::discoverPass() {
+  trackDiscover(true);
 
-      if (pwmDev_t *found = (pwmDev_t *)justSeenDevice(dev)) {
-        ESP_LOGV(tagDiscover(), "already know %s", found->debug().get());
-      } else {
-        pwmDev_t *new_dev = new pwmDev(dev);
-        ESP_LOGD(tagDiscover(), "new (%p) %s", (void *)new_dev,
-                 dev.debug().get());
+  for (uint8_t i = 1; i <= 4; i++) {
+    mcrDevAddr_t addr(i);
+    pwmDev_t dev(addr);
 
-        new_dev->setMissingSeconds(60);
-        new_dev->configureChannel();
+    if (pwmDev_t *found = (pwmDev_t *)justSeenDevice(dev)) {
+      ESP_LOGV(tagDiscover(), "already know %s", found->debug().get());
+    } else {
+      pwmDev_t *new_dev = new pwmDev(dev);
+      ESP_LOGD(tagDiscover(), "new (%p) %s", (void *)new_dev,
+               dev.debug().get());
 
-        if (new_dev->lastRC() == ESP_OK) {
+      new_dev->setMissingSeconds(60);
+      new_dev->configureChannel();
 
-          addDevice(new_dev);
-        } else {
-          ESP_LOGE(tagDiscover(), "%s", new_dev->debug().get());
-        }
+      if (new_dev->lastRC() == ESP_OK) {
+
+        addDevice(new_dev);
+      } else {
+        ESP_LOGE(tagDiscover(), "%s", new_dev->debug().get());
       }
     }
+  }
 
-    trackDiscover(false);
-
-    if (numKnownDevices() > 0) {
-      devicesAvailable();
-    }
+  trackDiscover(false);
 
-    // we want to discover
-    saveTaskLastWake(DISCOVER);
-    taskDelayUntil(DISCOVER, _discover_frequency);
+  if (numKnownDevices() > 0) {
+    devicesAvailable();
   }
+
+  return 0;
 }
 
 void pwmEngine::report(void *data) {
@@ -226,40 +359,52 @@ void pwmEngine::report(void *data) {
 
   while (waitFor(devicesAvailableBit())) {
     if (numKnownDevices() == 0) {
-      taskDelayUntil(REPORT, _report_frequency);
+      taskDelayUntil(REPORT, reportFrequency());
       continue;
     }
 
     Net::waitForNormalOps();
 
-    trackReport(true);
+    passUntilComplete(REPORT);
 
-    for_each(beginDevices(), endDevices(),
-             [this](std::pair<string_t, pwmDev_t *> item) {
-               auto dev = item.second;
+    taskDelayUntil(REPORT, reportFrequency());
+  }
+}
+
+TickType_t pwmEngine::reportPass() {
+  if (numKnownDevices() == 0) {
+    return 0;
+  }
+
+  trackReport(true);
 
-               if (dev->available()) {
+  DeviceList_t devs = devices();
 
-                 if (readDevice(dev)) {
-                   publish(dev);
-                   ESP_LOGV(tagReport(), "%s success", dev->debug().get());
-                 } else {
-                   ESP_LOGE(tagReport(), "%s failed", dev->debug().get());
-                 }
+  for_each(devs->begin(), devs->end(),
+           [this](DeviceEntry_t item) {
+             auto dev = item.second;
 
+             if (dev->available()) {
+
+               if (readDevice(dev)) {
+                 publish(dev);
+                 ESP_LOGV(tagReport(), "%s success", dev->debug().get());
                } else {
-                 if (dev->missing()) {
-                   ESP_LOGW(tagReport(), "device missing: %s",
-                            dev->debug().get());
-                 }
+                 ESP_LOGE(tagReport(), "%s failed", dev->debug().get());
+               }
+
+             } else {
+               if (dev->missing()) {
+                 ESP_LOGW(tagReport(), "device missing: %s",
+                          dev->debug().get());
                }
-             });
+             }
+           });
 
-    trackReport(false);
-    reportMetrics();
+  trackReport(false);
+  reportMetrics();
 
-    taskDelayUntil(REPORT, _report_frequency);
-  }
+  return 0;
 }
 
 bool pwmEngine::configureTimer() {
@@ -0,0 +1,213 @@
+/*
+    heap_trace.cpp -- MCR Heap Allocation Tracing
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+#include <cstdlib>
+#include <new>
+
+#include "misc/heap_trace.hpp"
+
+namespace mcr {
+
+static const char *_tag_names[HEAP_TAG_MAX] = {
+    "other", "reading_json", "incoming_msg", "cmd_factory", "i2c_cmd_link"};
+
+const char *mcrHeapTrace::tagName(HeapTag_t tag) {
+  return (tag < HEAP_TAG_MAX) ? _tag_names[tag] : "unknown";
+}
+
+#ifdef CONFIG_MCR_HEAP_TRACE
+
+// the tasks within a scope and their tag.  the table is small and only
+// populated while a task is within a scope so a linear search is cheap.
+typedef struct {
+  TaskHandle_t task;
+  HeapTag_t tag;
+} HeapScope_t;
+
+static portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+static HeapScope_t _scopes[mcrHeapTrace::max_scopes] = {};
+static HeapTagStats_t _stats[HEAP_TAG_MAX];
+
+HeapTag_t mcrHeapTrace::currentTag() {
+  HeapTag_t tag = HEAP_TAG_OTHER;
+
+  // before the scheduler starts there is no current task (or scope)
+  if (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED) {
+    return tag;
+  }
+
+  TaskHandle_t task = xTaskGetCurrentTaskHandle();
+
+  portENTER_CRITICAL(&_mux);
+  for (const auto &scope : _scopes) {
+    if (scope.task == task) {
+      tag = scope.tag;
+      break;
+    }
+  }
+  portEXIT_CRITICAL(&_mux);
+
+  return tag;
+}
+
+void mcrHeapTrace::setTag(HeapTag_t tag) {
+  TaskHandle_t task = xTaskGetCurrentTaskHandle();
+  HeapScope_t *slot = nullptr;
+
+  portENTER_CRITICAL(&_mux);
+  for (auto &scope : _scopes) {
+    if (scope.task == task) {
+      slot = &scope;
+      break;
+    }
+
+    if ((slot == nullptr) && (scope.task == nullptr)) {
+      slot = &scope;
+    }
+  }
+
+  // when the table is full the allocations are counted as other
+  if (slot != nullptr) {
+    if (tag == HEAP_TAG_OTHER) {
+      slot->task = nullptr;
+    } else {
+      slot->task = task;
+    }
+
+    slot->tag = tag;
+  }
+  portEXIT_CRITICAL(&_mux);
+}
+
+void mcrHeapTrace::recordAlloc(HeapTag_t tag, uint32_t bytes) {
+  portENTER_CRITICAL(&_mux);
+  HeapTagStats_t &s = _stats[tag];
+
+  s.allocs++;
+  s.bytes += bytes;
+  s.live_bytes += bytes;
+
+  if (s.live_bytes > s.peak_bytes) {
+    s.peak_bytes = s.live_bytes;
+  }
+  portEXIT_CRITICAL(&_mux);
+}
+
+void mcrHeapTrace::recordFree(HeapTag_t tag, uint32_t bytes) {
+  portENTER_CRITICAL(&_mux);
+  HeapTagStats_t &s = _stats[tag];
+
+  s.frees++;
+  s.live_bytes = (bytes > s.live_bytes) ? 0 : (s.live_bytes - bytes);
+  portEXIT_CRITICAL(&_mux);
+}
+
+void mcrHeapTrace::snapshot(HeapTagStats_t (&stats)[HEAP_TAG_MAX],
+                            bool reset) {
+  portENTER_CRITICAL(&_mux);
+  for (uint32_t i = 0; i < HEAP_TAG_MAX; i++) {
+    stats[i] = _stats[i];
+
+    if (reset) {
+      HeapTagStats_t &s = _stats[i];
+
+      s.allocs = 0;
+      s.frees = 0;
+      s.bytes = 0;
+      s.peak_bytes = s.live_bytes;
+    }
+  }
+  portEXIT_CRITICAL(&_mux);
+}
+
+#endif // CONFIG_MCR_HEAP_TRACE
+} // namespace mcr
+
+#ifdef CONFIG_MCR_HEAP_TRACE
+
+// each allocation is prefixed by a header recording the size and tag so the
+// free is attributed to the tag of the allocation.  the header is eight
+// bytes to preserve the alignment of malloc().
+typedef struct {
+  uint32_t size;
+  uint32_t tag;
+} HeapTraceHeader_t;
+
+static void *traceAlloc(size_t size) {
+  mcr::HeapTag_t tag = mcr::mcrHeapTrace::currentTag();
+  auto *hdr = (HeapTraceHeader_t *)malloc(sizeof(HeapTraceHeader_t) + size);
+
+  if (hdr == nullptr) {
+    return nullptr;
+  }
+
+  hdr->size = size;
+  hdr->tag = tag;
+  mcr::mcrHeapTrace::recordAlloc(tag, size);
+
+  return hdr + 1;
+}
+
+static void traceFree(void *ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+
+  auto *hdr = (HeapTraceHeader_t *)ptr - 1;
+  mcr::mcrHeapTrace::recordFree((mcr::HeapTag_t)hdr->tag, hdr->size);
+
+  free(hdr);
+}
+
+// exceptions are disabled, as the default operator new abort on failure
+void *operator new(size_t size) {
+  void *ptr = traceAlloc(size);
+
+  if (ptr == nullptr) {
+    abort();
+  }
+
+  return ptr;
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+  return traceAlloc(size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+  return traceAlloc(size);
+}
+
+void operator delete(void *ptr) noexcept { traceFree(ptr); }
+void operator delete[](void *ptr) noexcept { traceFree(ptr); }
+void operator delete(void *ptr, size_t) noexcept { traceFree(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { traceFree(ptr); }
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept {
+  traceFree(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept {
+  traceFree(ptr);
+}
+
+#endif // CONFIG_MCR_HEAP_TRACE
@@ -131,6 +131,56 @@ esp_err_t mcrNVS::__commitMsg(const char *key, const char *msg) {
   return _esp_rc;
 }
 
+// STATIC
+esp_err_t mcrNVS::commitBlob(const char *key, const void *blob, size_t len) {
+  return instance()->__commitBlob(key, blob, len);
+}
+
+// STATIC
+esp_err_t mcrNVS::getBlob(const char *key, void *blob, size_t len) {
+  return instance()->__getBlob(key, blob, len);
+}
+
+// PRIVATE
+esp_err_t mcrNVS::__commitBlob(const char *key, const void *blob, size_t len) {
+  if (notOpen()) {
+    return _nvs_open_rc;
+  }
+
+  esp_err_t esp_rc = nvs_set_blob(_handle, key, blob, len);
+
+  if (esp_rc == ESP_OK) {
+    esp_rc = nvs_commit(_handle);
+  }
+
+  if (esp_rc != ESP_OK) {
+    ESP_LOGW(TAG, "[%s] commit blob key(%s)", esp_err_to_name(esp_rc), key);
+  }
+
+  return esp_rc;
+}
+
+// PRIVATE
+esp_err_t mcrNVS::__getBlob(const char *key, void *blob, size_t len) {
+  if (notOpen()) {
+    return _nvs_open_rc;
+  }
+
+  size_t stored_len = 0;
+  esp_err_t esp_rc = nvs_get_blob(_handle, key, nullptr, &stored_len);
+
+  if ((esp_rc == ESP_OK) && (stored_len != len)) {
+    ESP_LOGW(TAG, "key(%s) length %u != %u, ignored", key, stored_len, len);
+    return ESP_ERR_NVS_INVALID_LENGTH;
+  }
+
+  if (esp_rc == ESP_OK) {
+    esp_rc = nvs_get_blob(_handle, key, blob, &stored_len);
+  }
+
+  return esp_rc;
+}
+
 // STATIC
 esp_err_t mcrNVS::processCommittedMsgs() {
   if (instance()->_committed_msgs_processed == false) {
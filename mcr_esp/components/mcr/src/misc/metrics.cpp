@@ -0,0 +1,135 @@
+/*
+    metrics.cpp -- MCR Metrics Registry
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+#include <cstring>
+
+#include "misc/metrics.hpp"
+#include "readings/metrics.hpp"
+
+namespace mcr {
+
+typedef struct {
+  MetricsCollectFunc_t *func;
+  void *ctx;
+} MetricsCollector_t;
+
+// the registry is constant initialized so metrics declared statically (in
+// any translation unit) may register regardless of initialization order
+static portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+static mcrMetric_t *_head = nullptr;
+static MetricsCollector_t _collectors[mcrMetrics::max_collectors] = {};
+static uint32_t _num_collectors = 0;
+
+mcrMetric::mcrMetric(const char *name, MetricKind_t kind) : _kind(kind) {
+  registerAs(name);
+}
+
+mcrMetric::~mcrMetric() { mcrMetrics::unlink(this); }
+
+void mcrMetric::registerAs(const char *name) {
+  strncpy(_name, name, max_name_len - 1);
+  mcrMetrics::link(this);
+}
+
+void mcrMetricHistogram::record(uint64_t us) {
+  portENTER_CRITICAL(&_mux);
+  _hist.record(us);
+  portEXIT_CRITICAL(&_mux);
+}
+
+mcrHistogram_t mcrMetricHistogram::snapshot() {
+  portENTER_CRITICAL(&_mux);
+  mcrHistogram_t hist = _hist;
+  _hist.reset();
+  portEXIT_CRITICAL(&_mux);
+
+  return hist;
+}
+
+void mcrMetrics::link(mcrMetric_t *metric) {
+  portENTER_CRITICAL(&_mux);
+  metric->_next = _head;
+  _head = metric;
+  portEXIT_CRITICAL(&_mux);
+}
+
+void mcrMetrics::unlink(mcrMetric_t *metric) {
+  portENTER_CRITICAL(&_mux);
+  for (mcrMetric_t **m = &_head; *m != nullptr; m = &((*m)->_next)) {
+    if (*m == metric) {
+      *m = metric->_next;
+      break;
+    }
+  }
+  portEXIT_CRITICAL(&_mux);
+}
+
+void mcrMetrics::registerCollector(MetricsCollectFunc_t *func, void *ctx) {
+  portENTER_CRITICAL(&_mux);
+  if (_num_collectors < max_collectors) {
+    _collectors[_num_collectors++] = {func, ctx};
+  }
+  portEXIT_CRITICAL(&_mux);
+}
+
+bool mcrMetrics::collect(metricsReading_t &reading) {
+  // metrics are only linked, never freed, while the registry is walked
+  // (engines and static metrics live for the life of the app)
+  for (mcrMetric_t *m = _head; m != nullptr; m = m->_next) {
+    const uint32_t value = m->_value;
+
+    switch (m->_kind) {
+    case METRIC_COUNTER:
+      if (value != m->_exported) {
+        reading.addCounter(m->_name, value - m->_exported);
+      }
+      break;
+
+    case METRIC_GAUGE:
+      if ((value != m->_exported) || (m->_ever_exported == false)) {
+        reading.addGauge(m->_name, value);
+      }
+      break;
+
+    case METRIC_HISTOGRAM:
+      reading.addHistogram(m->_name,
+                           static_cast<mcrMetricHistogram_t *>(m)->snapshot());
+      break;
+    }
+
+    m->_exported = value;
+    m->_ever_exported = true;
+  }
+
+  for (uint32_t i = 0; i < _num_collectors; i++) {
+    _collectors[i].func(_collectors[i].ctx, reading);
+  }
+
+  return reading.hasMetrics();
+}
+
+void mcrMetrics::publish(uint32_t interval_ms) {
+  metricsReading_t reading(interval_ms);
+
+  if (collect(reading)) {
+    reading.publish();
+  }
+}
+} // namespace mcr
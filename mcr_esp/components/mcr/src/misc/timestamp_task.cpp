@@ -16,6 +16,7 @@
 #include <time.h>
 
 #include "misc/mcr_restart.hpp"
+#include "misc/metrics.hpp"
 #include "misc/timestamp_task.hpp"
 #include "net/mcr_net.hpp"
 #include "protocols/mqtt.hpp"
@@ -29,6 +30,10 @@ using std::move;
 
 namespace mcr {
 
+static mcrMetric_t _heap_free("heap.free", METRIC_GAUGE);
+static mcrMetric_t _heap_min_free("heap.min_free", METRIC_GAUGE);
+static mcrMetric_t _heap_max_alloc("heap.max_alloc", METRIC_GAUGE);
+
 TimestampTask::TimestampTask() {
   _engTAG = tTAG;
   _engine_task_name = tTAG;
@@ -78,6 +83,10 @@ void TimestampTask::core(void *data) {
 
     max_alloc = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
 
+    _heap_free.set(curr_heap);
+    _heap_min_free.set(esp_get_minimum_free_heap_size());
+    _heap_max_alloc.set(max_alloc);
+
     if ((time(nullptr) - last_timestamp) >= _timestamp_freq_secs) {
       const char *name = Net::getName().c_str();
       char delta_str[13] = {};
@@ -108,9 +117,31 @@ void TimestampTask::core(void *data) {
                                       __PRETTY_FUNCTION__, 0);
     }
 
+#ifdef CONFIG_MCR_TASK_STATS
+    if ((xTaskGetTickCount() - _task_stats_last) >=
+        pdMS_TO_TICKS(CONFIG_MCR_TASK_STATS_FREQUENCY_SECS * 1000)) {
+      reportTaskStats();
+    }
+#endif
+
+#ifdef CONFIG_MCR_METRICS
+    if ((xTaskGetTickCount() - _metrics_last) >= _metrics_interval) {
+      const TickType_t now = xTaskGetTickCount();
+
+      if (Net::waitForReady(0) == true) {
+        mcrMetrics::publish((now - _metrics_last) * portTICK_PERIOD_MS);
+      }
+
+      _metrics_last = now;
+    }
+#endif
+
     if (Net::waitForReady(0) == true) {
+#ifndef CONFIG_MCR_METRICS
+      // with the metrics registry the heap is exported by the heap gauges
       ramUtilReading_t_ptr ram(new ramUtilReading());
       ram->publish();
+#endif
 
       // ramUtilReading_t replacement
       remoteReading_ptr_t remote(new remoteReading(batt_mv));
@@ -143,6 +174,52 @@ void TimestampTask::reportTaskStacks() {
   updateTaskData();
 }
 
+// the cpu of each task is the change of its run time counter relative to the
+// change of the total run time.  the total is of a single core so the tasks of
+// both cores total 200%.
+void TimestampTask::reportTaskStats() {
+  // allow for tasks created between getting the count and the state
+  const UBaseType_t max_tasks = uxTaskGetNumberOfTasks() + 2;
+  unique_ptr<TaskStatus_t[]> status(new TaskStatus_t[max_tasks]);
+  uint32_t total_run_time = 0;
+
+  UBaseType_t num_tasks =
+      uxTaskGetSystemState(status.get(), max_tasks, &total_run_time);
+
+  // the run time counter is microseconds (esp_timer)
+  uint32_t elapsed = total_run_time - _total_run_time;
+  bool first_report = (_total_run_time == 0);
+
+  _total_run_time = total_run_time;
+  _task_stats_last = xTaskGetTickCount();
+
+  taskStatsReading_ptr_t reading(
+      new taskStatsReading(elapsed / 1000, num_tasks));
+
+  for (UBaseType_t i = 0; i < num_tasks; i++) {
+    const TaskStatus_t &task = status[i];
+
+    if (task.pcTaskName == nullptr) {
+      continue;
+    }
+
+    // a task created since the previous report starts from zero
+    uint32_t &prev_run_time = _task_run_time[task.pcTaskName];
+    uint32_t delta = task.ulRunTimeCounter - prev_run_time;
+    uint32_t cpu_pm = (elapsed > 0) ? ((uint64_t)delta * 1000) / elapsed : 0;
+
+    prev_run_time = task.ulRunTimeCounter;
+
+    reading->add(task.pcTaskName, cpu_pm, task.usStackHighWaterMark,
+                 task.eCurrentState);
+  }
+
+  // the first report only establishes the run time counters
+  if (first_report == false) {
+    reading->publish();
+  }
+}
+
 void TimestampTask::updateTaskData() {
   for_each(_task_map.begin(), _task_map.end(), [this](TaskMapItem_t item) {
     auto stat = item.second;
@@ -0,0 +1,77 @@
+/*
+    trace.cpp -- MCR Event Trace Ring
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+#include <cstring>
+
+#include "misc/trace.hpp"
+
+namespace mcr {
+
+// source zero is reserved for events without a source (e.g. mqtt)
+static char _sources[mcrTrace::max_sources][mcrTrace::max_source_len] = {
+    "mcr"};
+static uint32_t _num_sources = 1;
+
+const char *mcrTrace::sourceName(uint8_t src) {
+  return (src < _num_sources) ? _sources[src] : "";
+}
+
+uint32_t mcrTrace::numSources() { return _num_sources; }
+
+#ifdef CONFIG_MCR_TRACE
+
+TraceEntry_t mcrTrace::_ring[mcrTrace::max_entries] = {};
+uint32_t mcrTrace::_next = 0;
+
+static portMUX_TYPE _sources_mux = portMUX_INITIALIZER_UNLOCKED;
+
+uint8_t mcrTrace::registerSource(const char *name) {
+  uint8_t src = 0;
+
+  portENTER_CRITICAL(&_sources_mux);
+  if (_num_sources < max_sources) {
+    src = _num_sources++;
+    strncpy(_sources[src], name, max_source_len - 1);
+  }
+  portEXIT_CRITICAL(&_sources_mux);
+
+  return src;
+}
+
+uint32_t mcrTrace::snapshot(TraceEntry_t *entries, bool clear) {
+  uint32_t next = __atomic_load_n(&_next, __ATOMIC_RELAXED);
+  uint32_t count = (next < max_entries) ? next : max_entries;
+  uint32_t first = next - count;
+
+  for (uint32_t i = 0; i < count; i++) {
+    entries[i] = _ring[(first + i) % max_entries];
+  }
+
+  // the ring is not cleared when an entry was recorded during the copy
+  if (clear) {
+    __atomic_compare_exchange_n(&_next, &next, 0, false, __ATOMIC_RELAXED,
+                                __ATOMIC_RELAXED);
+  }
+
+  return count;
+}
+
+#endif // CONFIG_MCR_TRACE
+} // namespace mcr
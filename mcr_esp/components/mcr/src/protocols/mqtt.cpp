@@ -31,9 +31,12 @@
 
 // MCR specific includes
 #include "external/mongoose.h"
+#include "misc/heap_trace.hpp"
 #include "misc/mcr_nvs.hpp"
 #include "misc/mcr_restart.hpp"
 #include "misc/mcr_types.hpp"
+#include "misc/metrics.hpp"
+#include "misc/trace.hpp"
 #include "misc/status_led.hpp"
 #include "net/mcr_net.hpp"
 #include "protocols/mqtt.hpp"
@@ -43,6 +46,10 @@
 using std::unique_ptr;
 namespace mcr {
 
+static mcrMetric_t _msgs_in("mqtt.msgs_in", METRIC_COUNTER);
+static mcrMetric_t _msgs_out("mqtt.msgs_out", METRIC_COUNTER);
+static mcrMetricHistogram_t _publish_us("mqtt.publish_us");
+
 static mcrMQTT *__singleton = nullptr;
 
 // SINGLETON!  use instance() for object access
@@ -98,7 +105,10 @@ void mcrMQTT::connect(int wait_ms) {
     vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(wait_ms));
   }
 
-  Net::waitForReady();
+  // hold the outbound readings while waiting for the network
+  while (Net::waitForReady(100) == false) {
+    holdOutbound();
+  }
 
   statusLED::instance()->brighter();
   _connection = mg_connect(&_mgr, _endpoint.c_str(), _ev_handler);
@@ -134,6 +144,8 @@ void mcrMQTT::handshake(struct mg_connection *nc) {
 }
 
 void mcrMQTT::incomingMsg(struct mg_str *in_topic, struct mg_str *in_payload) {
+  mcrHeapScope heap_scope(HEAP_TAG_INCOMING_MSG);
+
   // allocate a new string here and deallocate it once processed through MQTTin
   mqttInMsg_t *entry = new mqttInMsg_t;
   auto *topic = new std::string(in_topic->p, in_topic->len);
@@ -153,6 +165,8 @@ void mcrMQTT::incomingMsg(struct mg_str *in_topic, struct mg_str *in_payload) {
   q_rc = xQueueSendToBack(_q_in, (void *)&entry, _inbound_rb_wait_ticks);
 
   if (q_rc) {
+    mcrTrace::record(TRACE_MSG_IN_SEND, mcrTrace::len(in_payload->len));
+    _msgs_in.add();
     ESP_LOGV(tagEngine(),
              "INCOMING msg SENT to QUEUE (topic=%s,len=%u,json_len=%u)",
              topic->c_str(), sizeof(mqttInMsg_t), in_payload->len);
@@ -205,15 +219,21 @@ void mcrMQTT::outboundMsg() {
     const auto *json = entry->data;
     size_t json_len = entry->len;
 
+    mcrTrace::record(TRACE_MSG_OUT_RECV, mcrTrace::len(json_len));
+
     ESP_LOGV(tagEngine(), "send msg(len=%u), payload(len=%u)", len, json_len);
 
     mg_mqtt_publish(_connection, _rpt_feed.c_str(), _msg_id++, MG_MQTT_QOS(1),
                     json->data(), json_len);
+    mcrTrace::record(TRACE_PUBLISH, mcrTrace::len(json_len));
 
     delete json;
     delete entry;
 
     int64_t publish_us = publish_elapse;
+    _msgs_out.add();
+    _publish_us.record(publish_us);
+
     if (publish_us > 3000) {
       ESP_LOGD(tagOutbound(), "publish msg took %0.2fms",
                ((float)publish_us / 1000.0));
@@ -223,6 +243,44 @@ void mcrMQTT::outboundMsg() {
 
     q_rc = xQueueReceive(_q_out, &entry, pdMS_TO_TICKS(20));
   }
+
+  // the network went away after the entry was received, hold it for replay
+  if (q_rc == pdTRUE) {
+    _store.hold(entry->data);
+    delete entry;
+  }
+}
+
+void mcrMQTT::holdOutbound() {
+  mqttOutMsg_t *entry;
+
+  while (xQueueReceive(_q_out, &entry, 0) == pdTRUE) {
+    mcrTrace::record(TRACE_MSG_OUT_RECV, mcrTrace::len(entry->len));
+
+    _store.hold(entry->data);
+    delete entry;
+  }
+}
+
+// replay (at most) one held msg per interval so the backlog does not crowd
+// out the current readings once the connection returns
+void mcrMQTT::replayMsg() {
+  if (_store.empty() || (_replay_elapsed < _replay_interval_ms)) {
+    return;
+  }
+
+  string_t *msg = _store.next();
+
+  if (msg != nullptr) {
+    mg_mqtt_publish(_connection, _rpt_feed.c_str(), _msg_id++, MG_MQTT_QOS(1),
+                    msg->data(), msg->length());
+    mcrTrace::record(TRACE_PUBLISH, mcrTrace::len(msg->length()));
+    _msgs_out.add();
+
+    delete msg;
+  }
+
+  _replay_elapsed.reset();
 }
 
 void mcrMQTT::publish(string_t *json) {
@@ -232,14 +290,18 @@ void mcrMQTT::publish(string_t *json) {
   // setup the entry noting that the actual pointer to the string will
   // be included so be certain to deallocate when it comes out of the
   // ringbuffer
-  entry->len = json->length();
+  const size_t len = json->length();
+  entry->len = len;
   entry->data = json;
 
   // queue send takes a pointer to what should be copied to the queue
   // using the size defined when the queue was created
   q_rc = xQueueSendToBack(_q_out, (void *)&entry, pdMS_TO_TICKS(50));
 
-  if (q_rc == pdFALSE) {
+  if (q_rc == pdTRUE) {
+    // the entry now belongs to the outbound task, don't touch it
+    mcrTrace::record(TRACE_MSG_OUT_SEND, mcrTrace::len(len));
+  } else {
     delete entry;
     delete json;
 
@@ -302,6 +364,9 @@ void mcrMQTT::core(void *data) {
 
     if (isReady() && _connection) {
       outboundMsg();
+      replayMsg();
+    } else {
+      holdOutbound();
     }
   }
 }
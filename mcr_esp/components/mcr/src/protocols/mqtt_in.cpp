@@ -33,6 +33,7 @@
 // MCR specific includes
 #include "cmds/factory.hpp"
 #include "misc/mcr_types.hpp"
+#include "misc/trace.hpp"
 #include "net/mcr_net.hpp"
 #include "protocols/mqtt_in.hpp"
 #include "readings/readings.hpp"
@@ -65,7 +66,8 @@ void mcrMQTTin::restorePriority() {
 void mcrMQTTin::core(void *data) {
   mqttInMsg_t *msg;
   mcrCmdFactory_t factory;
-  DynamicJsonDocument doc(1024); // allocate the json buffer here
+  // allocate the json buffer here (sized for a pwm cmd with a profile)
+  DynamicJsonDocument doc(2048);
 
   // note:  no reason to wait for wifi, normal ops or other event group
   //        bits since mcrMQTTin waits for queue data from other tasks via
@@ -82,6 +84,8 @@ void mcrMQTTin::core(void *data) {
     q_rc = xQueueReceive(_q_in, &msg, portMAX_DELAY);
 
     if (q_rc == pdTRUE) {
+      mcrTrace::record(TRACE_MSG_IN_RECV, mcrTrace::len(msg->data->size()));
+
       // ESP_LOGI(TAG, "msg(%p) topic(%p) data(%p)", msg, msg->topic,
       // msg->data);
 
@@ -94,7 +98,11 @@ void mcrMQTTin::core(void *data) {
           ESP_LOGW(TAG, "could not create cmd from feed %s",
                    msg->topic->c_str());
         } else if (cmd->recent() && cmd->forThisHost()) {
+          const uint16_t cmd_type = (uint16_t)cmd->type();
+
+          mcrTrace::record(TRACE_CMD_PROCESS, cmd_type);
           cmd->process();
+          mcrTrace::record(TRACE_CMD_DONE, cmd_type);
         } else {
           ESP_LOGD(TAG, "ignoring topic(%s)", msg->topic->c_str());
         }
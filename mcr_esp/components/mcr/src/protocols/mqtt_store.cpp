@@ -0,0 +1,249 @@
+/*
+     mqtt_store.cpp - Master Control Remote MQTT Store and Forward
+     Copyright (C) 2020  Tim Hughey
+
+     This program is free software: you can redistribute it and/or modify
+     it under the terms of the GNU General Public License as published by
+     the Free Software Foundation, either version 3 of the License, or
+     (at your option) any later version.
+
+     This program is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+     GNU General Public License for more details.
+
+     You should have received a copy of the GNU General Public License
+     along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+     https://www.wisslanding.com
+ */
+
+#include <esp_log.h>
+#include <esp_spi_flash.h>
+
+#include "misc/metrics.hpp"
+#include "protocols/mqtt_store.hpp"
+
+namespace mcr {
+
+static const char *TAG = "mcrMQTTStore";
+
+static mcrMetric_t _held("mqtt.held", METRIC_COUNTER);
+static mcrMetric_t _replayed("mqtt.replayed", METRIC_COUNTER);
+static mcrMetric_t _discarded("mqtt.discarded", METRIC_COUNTER);
+static mcrMetric_t _spilled("mqtt.spilled", METRIC_COUNTER);
+
+mcrMQTTStore::mcrMQTTStore() {
+#ifdef CONFIG_MCR_MQTT_STORE_FLASH
+  _part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                   (esp_partition_subtype_t)0x40, "mcr_store");
+
+  if (_part == nullptr) {
+    ESP_LOGW(TAG, "mcr_store partition not found, readings held in RAM only");
+  } else {
+    ESP_LOGI(TAG, "spilling to mcr_store partition size(%uk)",
+             _part->size / 1024);
+  }
+#endif
+}
+
+void mcrMQTTStore::hold(string_t *msg) {
+  _held.add();
+
+  _ram.push_back(msg);
+  _ram_bytes += msg->length();
+
+  // make room by spilling (or discarding) the oldest readings, always
+  // retain the newest
+  while ((_ram_bytes > _max_ram_bytes) && (_ram.size() > 1)) {
+#ifdef CONFIG_MCR_MQTT_STORE_FLASH
+    string_t *oldest = _ram.front();
+
+    if (spill(oldest)) {
+      _ram.pop_front();
+      _ram_bytes -= oldest->length();
+      delete oldest;
+
+      continue;
+    }
+#endif
+
+    discardOldest();
+  }
+}
+
+string_t *mcrMQTTStore::next() {
+  string_t *msg = nullptr;
+
+#ifdef CONFIG_MCR_MQTT_STORE_FLASH
+  msg = unspill();
+#endif
+
+  if ((msg == nullptr) && (_ram.empty() == false)) {
+    msg = _ram.front();
+    _ram.pop_front();
+    _ram_bytes -= msg->length();
+  }
+
+  if (msg != nullptr) {
+    markReplay(*msg);
+    _replayed.add();
+  }
+
+  if (empty()) {
+    _discard_logged = false;
+  }
+
+  return msg;
+}
+
+bool mcrMQTTStore::empty() const {
+#ifdef CONFIG_MCR_MQTT_STORE_FLASH
+  if (_read_off < _write_off) {
+    return false;
+  }
+#endif
+
+  return _ram.empty();
+}
+
+void mcrMQTTStore::discardOldest() {
+  string_t *oldest = _ram.front();
+
+  _ram.pop_front();
+  _ram_bytes -= oldest->length();
+  delete oldest;
+
+  _discarded.add();
+
+  // log the first discard of each outage
+  if (_discard_logged == false) {
+    ESP_LOGW(TAG, "store full, discarding oldest readings");
+    _discard_logged = true;
+  }
+}
+
+// STATIC
+void mcrMQTTStore::markReplay(string_t &msg) {
+  // fixstr "replay" then true
+  static const char replay[] = {'\xa6', 'r', 'e', 'p', 'l', 'a', 'y', '\xc3'};
+
+  if (msg.empty()) {
+    return;
+  }
+
+  const uint8_t marker = msg[0];
+
+  if ((marker & 0xf0) == 0x80) {
+    // fixmap, up to 15 entries
+    const uint8_t entries = marker & 0x0f;
+
+    if (entries < 15) {
+      msg[0] = (char)(0x80 | (entries + 1));
+    } else {
+      // becomes a map16 of 16 entries
+      msg[0] = (char)0xde;
+      msg.insert(1, "\x00\x10", 2);
+    }
+  } else if ((marker == 0xde) && (msg.length() > 2)) {
+    // map16
+    uint16_t entries = ((uint8_t)msg[1] << 8) | (uint8_t)msg[2];
+
+    entries++;
+    msg[1] = (char)(entries >> 8);
+    msg[2] = (char)(entries & 0xff);
+  } else {
+    // not a MsgPack map, leave unchanged
+    return;
+  }
+
+  msg.append(replay, sizeof(replay));
+}
+
+#ifdef CONFIG_MCR_MQTT_STORE_FLASH
+bool mcrMQTTStore::spill(string_t *msg) {
+  if (_part == nullptr) {
+    return false;
+  }
+
+  const StoreRecord_t record = {.magic = _record_magic,
+                                .len = (uint16_t)msg->length()};
+  // records are word aligned
+  const uint32_t record_len = (sizeof(record) + record.len + 3) & ~0x03;
+
+  if ((msg->length() > UINT16_MAX) ||
+      ((_write_off + record_len) > _part->size)) {
+    return false;
+  }
+
+  while (_erased_to < (_write_off + record_len)) {
+    if (esp_partition_erase_range(_part, _erased_to, SPI_FLASH_SEC_SIZE) !=
+        ESP_OK) {
+      return false;
+    }
+
+    _erased_to += SPI_FLASH_SEC_SIZE;
+  }
+
+  esp_err_t esp_rc =
+      esp_partition_write(_part, _write_off, &record, sizeof(record));
+
+  if (esp_rc == ESP_OK) {
+    esp_rc = esp_partition_write(_part, _write_off + sizeof(record),
+                                 msg->data(), record.len);
+  }
+
+  if (esp_rc != ESP_OK) {
+    ESP_LOGW(TAG, "[%s] spill failed", esp_err_to_name(esp_rc));
+    return false;
+  }
+
+  _write_off += record_len;
+  _spilled.add();
+
+  return true;
+}
+
+string_t *mcrMQTTStore::unspill() {
+  if ((_part == nullptr) || (_read_off >= _write_off)) {
+    return nullptr;
+  }
+
+  StoreRecord_t record = {};
+  string_t *msg = nullptr;
+
+  esp_err_t esp_rc =
+      esp_partition_read(_part, _read_off, &record, sizeof(record));
+
+  if ((esp_rc == ESP_OK) && (record.magic == _record_magic)) {
+    msg = new string_t(record.len, 0x00);
+    esp_rc = esp_partition_read(_part, _read_off + sizeof(record),
+                                &((*msg)[0]), record.len);
+
+    if (esp_rc == ESP_OK) {
+      _read_off += (sizeof(record) + record.len + 3) & ~0x03;
+    } else {
+      delete msg;
+      msg = nullptr;
+    }
+  }
+
+  // the log is corrupt or unreadable, abandon the remainder
+  if (msg == nullptr) {
+    ESP_LOGW(TAG, "[%s] unspill failed at offset %u, discarding %u bytes",
+             esp_err_to_name(esp_rc), _read_off, (_write_off - _read_off));
+    _read_off = _write_off;
+  }
+
+  // once replayed the log is reset, the sectors written must be erased
+  // again before reuse
+  if (_read_off >= _write_off) {
+    _read_off = 0;
+    _write_off = 0;
+    _erased_to = 0;
+  }
+
+  return msg;
+}
+#endif
+} // namespace mcr
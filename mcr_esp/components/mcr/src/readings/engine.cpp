@@ -31,10 +31,36 @@ EngineReading::EngineReading(const std::string &engine, uint64_t discover_us,
       convert_us_(convert_us), report_us_(report_us),
       switch_cmd_us_(switch_cmd_us) {
   _type = ReadingType_t::ENGINE;
+
+  // room for the bus wait histograms
+  _json_capacity = 4096;
 };
 
+void EngineReading::addBusWait(const char *job, const mcrHistogram_t &hist) {
+  // only job classes that waited for the bus are of interest
+  if ((hist.count() == 0) || (bus_waits_count_ >= max_bus_waits_)) {
+    return;
+  }
+
+  bus_wait_jobs_[bus_waits_count_] = job;
+  bus_waits_[bus_waits_count_] = hist;
+  bus_waits_count_++;
+}
+
+void EngineReading::addPhase(const char *phase, const mcrHistogram_t &hist) {
+  // only phases that ran since the previous report are of interest
+  if ((hist.count() == 0) || (phases_count_ >= max_phases_)) {
+    return;
+  }
+
+  phase_names_[phases_count_] = phase;
+  phases_[phases_count_] = hist;
+  phases_count_++;
+}
+
 bool EngineReading::hasNonZeroValues() {
-  return (discover_us_ > 0) || (convert_us_ > 0) || (report_us_ > 0);
+  return (discover_us_ > 0) || (convert_us_ > 0) || (report_us_ > 0) ||
+         (first_reading_us_ > 0);
 }
 
 void EngineReading::populateJSON(JsonDocument &doc) {
@@ -44,5 +70,66 @@ void EngineReading::populateJSON(JsonDocument &doc) {
   doc["convert_us"] = convert_us_;
   doc["report_us"] = report_us_;
   doc["switch_cmd_us"] = switch_cmd_us_;
+
+  // only engines that release the bus during discover report the hold
+  if (discover_max_hold_us_ > 0) {
+    doc["discover_max_hold_us"] = discover_max_hold_us_;
+  }
+
+  if (first_reading_us_ > 0) {
+    doc["first_reading_us"] = first_reading_us_;
+    doc["restored_devs"] = restored_devs_;
+  }
+
+  if (has_config_) {
+    JsonObject config = doc.createNestedObject("config");
+
+    config["convert_secs"] = config_.convert_secs;
+    config["discover_secs"] = config_.discover_secs;
+    config["report_secs"] = config_.report_secs;
+    config["convert"] = config_.convert;
+    config["discover"] = config_.discover;
+  }
+
+  // phase and bus wait histograms are published compactly as:
+  //  {name: {count, min_us, max_us, buckets: [count of bucket 0, ...]}}
+  //  where bucket n counts values in [2^n, 2^(n+1)) microseconds and trailing
+  //  empty buckets are omitted.  the p99 of each phase is also published
+  //  (e.g. report_p99_us) as the upper bound of the bucket containing it.
+  if (phases_count_ > 0) {
+    JsonObject phases = doc.createNestedObject("phases");
+
+    for (uint32_t i = 0; i < phases_count_; i++) {
+      JsonObject phase = phases.createNestedObject(phase_names_[i]);
+      std::string p99_key = std::string(phase_names_[i]) + "_p99_us";
+
+      histogramJSON(phase, phases_[i]);
+      doc[p99_key] = phases_[i].percentile(99);
+    }
+  }
+
+  if (bus_waits_count_ == 0) {
+    return;
+  }
+
+  JsonObject bus_wait = doc.createNestedObject("bus_wait");
+
+  for (uint32_t i = 0; i < bus_waits_count_; i++) {
+    JsonObject job = bus_wait.createNestedObject(bus_wait_jobs_[i]);
+
+    histogramJSON(job, bus_waits_[i]);
+  }
 };
+
+void EngineReading::histogramJSON(JsonObject &obj,
+                                  const mcrHistogram_t &hist) {
+  obj["count"] = hist.count();
+  obj["min_us"] = hist.min();
+  obj["max_us"] = hist.max();
+
+  JsonArray buckets = obj.createNestedArray("buckets");
+  for (uint32_t b = 0; b < hist.usedBuckets(); b++) {
+    buckets.add(hist.bucket(b));
+  }
+}
 } // namespace mcr
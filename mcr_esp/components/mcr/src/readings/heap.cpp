@@ -0,0 +1,64 @@
+/*
+    heap.cpp - Master Control Remote Heap Trace Reading
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+#include <cstdlib>
+#include <ctime>
+
+#include <esp_system.h>
+
+#include "readings/heap.hpp"
+
+namespace mcr {
+
+heapTraceReading::heapTraceReading(bool reset)
+    : Reading(time(nullptr)), enabled_(mcrHeapTrace::enabled()) {
+  _type = ReadingType_t::HEAP;
+
+  free_heap_ = esp_get_free_heap_size();
+  min_free_heap_ = esp_get_minimum_free_heap_size();
+  mcrHeapTrace::snapshot(stats_, reset);
+}
+
+void heapTraceReading::populateJSON(JsonDocument &doc) {
+  doc["metric"] = "heap_trace";
+  doc["enabled"] = enabled_;
+  doc["free_heap"] = free_heap_;
+  doc["min_free_heap"] = min_free_heap_;
+
+  // when disabled the table is never populated
+  if (enabled_ == false) {
+    return;
+  }
+
+  JsonArray tags = doc.createNestedArray("tags");
+
+  for (uint32_t i = 0; i < HEAP_TAG_MAX; i++) {
+    const HeapTagStats_t &s = stats_[i];
+    JsonArray entry = tags.createNestedArray();
+
+    entry.add(mcrHeapTrace::tagName((HeapTag_t)i));
+    entry.add(s.allocs);
+    entry.add(s.frees);
+    entry.add(s.bytes);
+    entry.add(s.live_bytes);
+    entry.add(s.peak_bytes);
+  }
+};
+} // namespace mcr
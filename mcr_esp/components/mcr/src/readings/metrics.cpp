@@ -0,0 +1,92 @@
+/*
+    metrics.cpp - Master Control Remote Metrics Reading
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include "readings/engine.hpp"
+#include "readings/metrics.hpp"
+
+namespace mcr {
+
+metricsReading::metricsReading(uint32_t interval_ms)
+    : Reading(time(nullptr)), interval_ms_(interval_ms) {
+  _type = ReadingType_t::METRICS;
+
+  _json_capacity = 1024; // grows as metrics are added
+}
+
+// the names are copied into the document
+void metricsReading::addCounter(const char *name, uint32_t delta) {
+  counters_.push_back({name, delta});
+  _json_capacity += JSON_OBJECT_SIZE(1) + strlen(name) + 1;
+}
+
+void metricsReading::addGauge(const char *name, uint32_t value) {
+  gauges_.push_back({name, value});
+  _json_capacity += JSON_OBJECT_SIZE(1) + strlen(name) + 1;
+}
+
+void metricsReading::addHistogram(const char *name,
+                                  const mcrHistogram_t &hist) {
+  if (hist.count() > 0) {
+    histograms_.push_back({name, hist});
+    _json_capacity += JSON_OBJECT_SIZE(5) + strlen(name) + 1 +
+                      JSON_ARRAY_SIZE(mcrHistogram_t::num_buckets);
+  }
+}
+
+bool metricsReading::hasMetrics() const {
+  return (counters_.empty() == false) || (gauges_.empty() == false) ||
+         (histograms_.empty() == false);
+}
+
+void metricsReading::populateJSON(JsonDocument &doc) {
+  doc["metric"] = "metrics";
+  doc["interval_ms"] = interval_ms_;
+
+  if (counters_.empty() == false) {
+    JsonObject counters = doc.createNestedObject("counters");
+
+    for (const auto &counter : counters_) {
+      counters[counter.first] = counter.second;
+    }
+  }
+
+  if (gauges_.empty() == false) {
+    JsonObject gauges = doc.createNestedObject("gauges");
+
+    for (const auto &gauge : gauges_) {
+      gauges[gauge.first] = gauge.second;
+    }
+  }
+
+  if (histograms_.empty() == false) {
+    JsonObject histograms = doc.createNestedObject("histograms");
+
+    for (const auto &hist : histograms_) {
+      JsonObject obj = histograms.createNestedObject(hist.first);
+
+      EngineReading::histogramJSON(obj, hist.second);
+    }
+  }
+};
+} // namespace mcr
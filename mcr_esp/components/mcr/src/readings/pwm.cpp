@@ -41,5 +41,11 @@ void pwmReading::populateJSON(JsonDocument &doc) {
   doc["duty"] = duty_;
   doc["duty_max"] = duty_max_;
   doc["duty_min"] = duty_min_;
+
+  if (group_channels_ > 0) {
+    doc["group_channels"] = group_channels_;
+    doc["group_skew_us"] = group_skew_us_;
+    doc["group_late_us"] = group_late_us_;
+  }
 };
 } // namespace mcr
@@ -25,6 +25,7 @@
 #include <sys/time.h>
 #include <time.h>
 
+#include "misc/heap_trace.hpp"
 #include "net/mcr_net.hpp"
 #include "protocols/mqtt.hpp"
 #include "readings/reading.hpp"
@@ -86,18 +87,24 @@ void Reading::commonJSON(JsonDocument &doc) {
 }
 
 std::string *Reading::json(char *buffer, size_t len) {
+  mcrHeapScope heap_scope(HEAP_TAG_READING_JSON);
+
   // FUTURE IMPROVEMENT
   // std::unique_ptr<std::string> json_S(new std::string());
   // json_S.get()->reserve(1024);
   std::string *json_string = new std::string;
   json_string->reserve(2048);
 
-  DynamicJsonDocument doc(2048);
+  // the document pool is allocated by malloc() (not traced) and freed on
+  // return
+  DynamicJsonDocument doc(_json_capacity);
+  mcrHeapTrace::recordAlloc(HEAP_TAG_READING_JSON, _json_capacity);
 
   commonJSON(doc);
   populateJSON(doc);
 
   serializeMsgPack(doc, *json_string);
+  mcrHeapTrace::recordFree(HEAP_TAG_READING_JSON, _json_capacity);
 
   return json_string;
 }
@@ -116,7 +123,8 @@ void Reading::setCmdAck(uint32_t latency_us, mcrRefID_t &refid) {
 
 static const char *__type_string[] = {
     "base", "mcr_stat", "ph",     "stats", "remote_runtime", "relhum",
-    "soil", "boot",     "switch", "temp",  "text",           "pwm"};
+    "soil", "boot",     "switch", "temp",  "text",           "pwm",
+    "mcr_stat", "mcr_stat", "mcr_stat", "mcr_stat"};
 
 const char *Reading::typeString(ReadingType_t index) {
   return __type_string[index];
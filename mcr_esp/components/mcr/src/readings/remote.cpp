@@ -20,10 +20,13 @@
 
 #include <cstdlib>
 #include <ctime>
+#include <memory>
 
 #include <esp_log.h>
 #include <esp_system.h>
 #include <esp_wifi.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 
 #include "readings/remote.hpp"
 
@@ -42,6 +45,19 @@ remoteReading::remoteReading(uint32_t batt_mv)
   heap_free_ = esp_get_free_heap_size();
   heap_min_ = esp_get_minimum_free_heap_size();
   uptime_us_ = esp_timer_get_time();
+
+  tasks_ = uxTaskGetNumberOfTasks();
+  stack_free_ = 0;
+
+  // allow for tasks created between getting the count and the state
+  const UBaseType_t max_tasks = tasks_ + 2;
+  unique_ptr<TaskStatus_t[]> status(new TaskStatus_t[max_tasks]);
+
+  tasks_ = uxTaskGetSystemState(status.get(), max_tasks, nullptr);
+
+  for (uint32_t i = 0; i < tasks_; i++) {
+    stack_free_ += status[i].usStackHighWaterMark;
+  }
 };
 
 void remoteReading::populateJSON(JsonDocument &doc) {
@@ -57,5 +73,10 @@ void remoteReading::populateJSON(JsonDocument &doc) {
   doc["heap_free"] = heap_free_;
   doc["heap_min"] = heap_min_;
   doc["uptime_us"] = uptime_us_;
+  doc["tasks"] = tasks_;
+  doc["stack_free"] = stack_free_;
+#ifdef CONFIG_MCR_ENGINE_EXECUTOR
+  doc["executor"] = true;
+#endif
 };
 } // namespace mcr
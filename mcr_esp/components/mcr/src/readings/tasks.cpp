@@ -0,0 +1,75 @@
+/*
+    tasks.cpp - Master Control Remote Task Statistics Reading
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+#include <cstdlib>
+#include <ctime>
+
+#include "readings/tasks.hpp"
+
+namespace mcr {
+
+taskStatsReading::taskStatsReading(uint32_t interval_ms, uint32_t num_tasks)
+    : Reading(time(nullptr)), interval_ms_(interval_ms) {
+  _type = ReadingType_t::TASKS;
+
+  tasks_.reserve(num_tasks);
+
+  // room for a few dozen tasks
+  _json_capacity = 4096;
+}
+
+void taskStatsReading::add(const char *name, uint32_t cpu_pm,
+                           uint32_t stack_free, eTaskState state) {
+  tasks_.push_back({name, cpu_pm, stack_free, stateChar(state)});
+}
+
+char taskStatsReading::stateChar(eTaskState state) {
+  switch (state) {
+  case eRunning:
+    return 'X';
+  case eReady:
+    return 'R';
+  case eBlocked:
+    return 'B';
+  case eSuspended:
+    return 'S';
+  case eDeleted:
+    return 'D';
+  default:
+    return '?';
+  }
+}
+
+void taskStatsReading::populateJSON(JsonDocument &doc) {
+  doc["metric"] = "task_stats";
+  doc["interval_ms"] = interval_ms_;
+
+  JsonArray tasks = doc.createNestedArray("tasks");
+
+  for (const auto &task : tasks_) {
+    JsonArray entry = tasks.createNestedArray();
+
+    entry.add(task.name);
+    entry.add(task.cpu_pm);
+    entry.add(task.stack_free);
+    entry.add(std::string(1, task.state));
+  }
+};
+} // namespace mcr
@@ -0,0 +1,64 @@
+/*
+    trace.cpp - Master Control Remote Event Trace Reading
+    Copyright (C) 2020  Tim Hughey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    https://www.wisslanding.com
+*/
+
+#include <cstdlib>
+#include <ctime>
+
+#include "readings/trace.hpp"
+
+namespace mcr {
+
+traceReading::traceReading(uint32_t chunk, uint32_t chunks, uint32_t now_us,
+                           const TraceEntry_t *entries, uint32_t count)
+    : Reading(time(nullptr)), enabled_(mcrTrace::enabled()), chunk_(chunk),
+      chunks_(chunks), now_us_(now_us), entries_(entries), count_(count) {
+  _type = ReadingType_t::TRACE;
+
+  _json_capacity = JSON_OBJECT_SIZE(16) +
+                   JSON_ARRAY_SIZE(mcrTrace::max_sources) +
+                   JSON_ARRAY_SIZE(count) + (count * JSON_ARRAY_SIZE(4)) + 256;
+}
+
+void traceReading::populateJSON(JsonDocument &doc) {
+  doc["metric"] = "trace";
+  doc["enabled"] = enabled_;
+  doc["chunk"] = chunk_;
+  doc["chunks"] = chunks_;
+  doc["now_us"] = now_us_;
+
+  JsonArray sources = doc.createNestedArray("sources");
+
+  for (uint32_t i = 0; i < mcrTrace::numSources(); i++) {
+    sources.add(mcrTrace::sourceName(i));
+  }
+
+  JsonArray events = doc.createNestedArray("events");
+
+  for (uint32_t i = 0; i < count_; i++) {
+    const TraceEntry_t &entry = entries_[i];
+    JsonArray event = events.createNestedArray();
+
+    event.add(entry.us);
+    event.add(entry.event);
+    event.add(entry.core);
+    event.add(entry.arg);
+  }
+};
+} // namespace mcr
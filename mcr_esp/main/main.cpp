@@ -53,8 +53,8 @@ static const char *TAG = "mcrESP";
 static mcr::Net *network = nullptr;
 static TimestampTask *timestampTask = nullptr;
 static mcrMQTT *mqttTask = nullptr;
-static mcrDS *dsEngineTask = nullptr;
-static mcrI2c *i2cEngineTask = nullptr;
+static mcrDS *dsEngineTask[CONFIG_MCR_W1_BUSES] = {nullptr};
+static mcrI2c *i2cEngineTask[CONFIG_MCR_I2C_PORTS] = {nullptr};
 static pwmEngine_t *pwmEngineTask = nullptr;
 
 void app_main() {
@@ -79,8 +79,17 @@ void app_main() {
   network = mcr::Net::instance(); // singleton
   timestampTask = new TimestampTask();
   mqttTask = mcrMQTT::instance();        // singleton
-  dsEngineTask = mcrDS::instance();      // singleton
-  i2cEngineTask = mcrI2c::instance();    // singleton
+
+  // one engine instance per 1-Wire bus
+  for (uint32_t bus = 0; bus < mcrDS::numBuses(); bus++) {
+    dsEngineTask[bus] = mcrDS::instance(bus);
+  }
+
+  // one engine instance per i2c controller
+  for (uint32_t port = 0; port < mcrI2c::numPorts(); port++) {
+    i2cEngineTask[port] = mcrI2c::instance(port);
+  }
+
   pwmEngineTask = pwmEngine::instance(); // singleton
   statusLED::instance()->brighter();
 
@@ -89,8 +98,14 @@ void app_main() {
 
   timestampTask->start();
   mqttTask->start();
-  dsEngineTask->start();
-  i2cEngineTask->start();
+  for (auto ds_engine : dsEngineTask) {
+    ds_engine->start();
+  }
+
+  for (auto i2c_engine : i2cEngineTask) {
+    i2c_engine->start();
+  }
+
   pwmEngineTask->start();
 
   network->start();